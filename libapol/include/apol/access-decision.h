@@ -0,0 +1,222 @@
+/**
+ *  @file
+ *
+ *  Routines to simulate the kernel's access decision for a pair of
+ *  contexts, combining type enforcement rules, conditional rules
+ *  under a chosen boolean state, constraints, and MLS constraints.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_ACCESS_DECISION_H
+#define APOL_ACCESS_DECISION_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include "policy.h"
+#include "vector.h"
+#include "context-query.h"
+#include <stdint.h>
+
+	typedef struct apol_access_engine apol_access_engine_t;
+	typedef struct apol_access_decision apol_access_decision_t;
+
+/* reasons for the outcome of one permission */
+#define APOL_ACCESS_NOT_REQUESTED 0
+#define APOL_ACCESS_ALLOWED 1
+#define APOL_ACCESS_DENIED_TE 2	       /**< no enabled allow rule grants the permission */
+#define APOL_ACCESS_DENIED_CONSTRAINT 3	/**< allowed, but a constraint denies it */
+#define APOL_ACCESS_DENIED_MLS 4       /**< allowed, but an MLS constraint denies it */
+
+/******************** access decision engine ********************/
+
+/**
+ * Build an access decision engine for a policy.  Access vectors are
+ * precomputed for every (source, target, class) named by an allow,
+ * auditallow, or dontaudit rule; a decision then combines the
+ * vectors for the contexts' types and their attributes.  Conditional
+ * rules are governed by the engine's own boolean state, initially
+ * that of the policy, and constraints are compiled as by
+ * apol_constraint_evaluator_create().  The engine remains valid for
+ * as long as the policy does.
+ *
+ * @param p Policy to simulate.
+ *
+ * @return A newly allocated engine, or NULL upon error.  The caller
+ * must call apol_access_engine_destroy() afterwards.
+ */
+	extern apol_access_engine_t *apol_access_engine_create(const apol_policy_t * p);
+
+/**
+ * Deallocate all memory associated with the referenced access
+ * decision engine, and then set it to NULL.  This function does
+ * nothing if the engine is already NULL.
+ *
+ * @param e Reference to an engine to destroy.
+ */
+	extern void apol_access_engine_destroy(apol_access_engine_t ** e);
+
+/**
+ * Set the state of a boolean within an access decision engine.  The
+ * policy itself is not modified.
+ *
+ * @param e Engine to modify.
+ * @param name Name of the boolean.
+ * @param state Non-zero to enable the boolean, 0 to disable it.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_access_engine_set_bool(apol_access_engine_t * e, const char *name, int state);
+
+/**
+ * Convert a list of permission names into a mask suitable for
+ * apol_access_engine_decide().
+ *
+ * @param e Engine whose policy to use.
+ * @param class_name Name of the object class.
+ * @param perms Vector of permission names (char *).
+ * @param mask Reference to the resulting mask, where the permission
+ * with value v is bit (v - 1); see qpol_class_get_perm_value().
+ *
+ * @return 0 on success, < 0 if the class or any permission is
+ * unknown.
+ */
+	extern int apol_access_engine_get_perm_mask(const apol_access_engine_t * e, const char *class_name,
+						    const apol_vector_t * perms, uint32_t * mask);
+
+/**
+ * Decide whether a set of permissions would be allowed between two
+ * contexts.  The contexts must have their user, role, and type set;
+ * if the class has MLS constraints then they must have a range as
+ * well.
+ *
+ * @param e Engine to use.
+ * @param scontext Source context.
+ * @param tcontext Target context.
+ * @param class_name Name of the object class.
+ * @param requested Mask of requested permissions.
+ * @param d Reference to the resulting decision.  The caller must
+ * call apol_access_decision_destroy() afterwards.  This will be set
+ * to NULL upon error.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_access_engine_decide(const apol_access_engine_t * e, const apol_context_t * scontext,
+					     const apol_context_t * tcontext, const char *class_name, uint32_t requested,
+					     apol_access_decision_t ** d);
+
+/**
+ * Decide many access requests at once, such as those replayed from
+ * an audit log.  Request i consists of element i of each vector and
+ * of the requested array.
+ *
+ * @param e Engine to use.
+ * @param scontexts Vector of apol_context_t, the source contexts.
+ * @param tcontexts Vector of apol_context_t, the target contexts.
+ * @param class_names Vector of object class names (char *).
+ * @param requested Array of requested permission masks.
+ * @param decisions Reference to a vector of apol_access_decision_t,
+ * in the same order as the requests.  The caller must call
+ * apol_vector_destroy() afterwards.  This will be set to NULL upon
+ * error.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_access_engine_decide_batch(const apol_access_engine_t * e, const apol_vector_t * scontexts,
+						   const apol_vector_t * tcontexts, const apol_vector_t * class_names,
+						   const uint32_t * requested, apol_vector_t ** decisions);
+
+/******************** access decisions ********************/
+
+/**
+ * Deallocate all memory associated with the referenced access
+ * decision, and then set it to NULL.
+ *
+ * @param d Reference to a decision to destroy.
+ */
+	extern void apol_access_decision_destroy(apol_access_decision_t ** d);
+
+/**
+ * Return the permissions that were requested.
+ *
+ * @param d Decision to query.
+ *
+ * @return Mask of requested permissions.
+ */
+	extern uint32_t apol_access_decision_get_requested(const apol_access_decision_t * d);
+
+/**
+ * Return the requested permissions that are granted.
+ *
+ * @param d Decision to query.
+ *
+ * @return Mask of granted permissions.
+ */
+	extern uint32_t apol_access_decision_get_granted(const apol_access_decision_t * d);
+
+/**
+ * Return the requested permissions that are denied.  If the source
+ * type is permissive these are logged but not enforced; see
+ * apol_access_decision_get_is_permissive().
+ *
+ * @param d Decision to query.
+ *
+ * @return Mask of denied permissions.
+ */
+	extern uint32_t apol_access_decision_get_denied(const apol_access_decision_t * d);
+
+/**
+ * Return the requested permissions whose decision would be audited:
+ * granted permissions named by an auditallow rule, and denied
+ * permissions not named by a dontaudit rule.
+ *
+ * @param d Decision to query.
+ *
+ * @return Mask of audited permissions.
+ */
+	extern uint32_t apol_access_decision_get_audited(const apol_access_decision_t * d);
+
+/**
+ * Determine if the source context's type is permissive.
+ *
+ * @param d Decision to query.
+ *
+ * @return 1 if the source type is permissive, 0 if not.
+ */
+	extern int apol_access_decision_get_is_permissive(const apol_access_decision_t * d);
+
+/**
+ * Return why a permission was granted or denied.
+ *
+ * @param d Decision to query.
+ * @param perm_value Value of the permission within the class; see
+ * qpol_class_get_perm_value().
+ *
+ * @return One of APOL_ACCESS_NOT_REQUESTED, APOL_ACCESS_ALLOWED,
+ * APOL_ACCESS_DENIED_TE, APOL_ACCESS_DENIED_CONSTRAINT, or
+ * APOL_ACCESS_DENIED_MLS; < 0 on error.
+ */
+	extern int apol_access_decision_get_reason(const apol_access_decision_t * d, uint32_t perm_value);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -33,6 +33,7 @@ extern "C"
 #endif
 
 #include "policy.h"
+#include "render.h"
 #include "vector.h"
 #include <qpol/policy.h>
 
@@ -354,6 +355,21 @@ extern "C"
  */
 	extern char *apol_avrule_render(const apol_policy_t * policy, const qpol_avrule_t * rule);
 
+/**
+ *  Append the rendering of an avrule to a buffer.  Rendering many
+ *  rules into one buffer, particularly one that writes to a file,
+ *  avoids allocating a string for each rule.  Permission names are
+ *  cached within the policy.
+ *
+ *  @param policy Policy handler, to report errors.
+ *  @param rule The rule to render.
+ *  @param buf Buffer to which to append.
+ *
+ *  @return 0 on success, < 0 on failure; if the call fails, errno will
+ *  be set and the buffer is unchanged.
+ */
+	extern int apol_avrule_render_buf(const apol_policy_t * policy, const qpol_avrule_t * rule, apol_render_buf_t * buf);
+
 /**
  *  Render a syntactic avrule to a string.
  *
@@ -366,6 +382,18 @@ extern "C"
 */
 	extern char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule_t * rule);
 
+/**
+ *  Append the rendering of a syntactic avrule to a buffer.
+ *
+ *  @param policy Policy handler, to report errors.
+ *  @param rule The rule to render.
+ *  @param buf Buffer to which to append.
+ *
+ *  @return 0 on success, < 0 on failure; if the call fails, errno will
+ *  be set and the buffer is unchanged.
+ */
+	extern int apol_syn_avrule_render_buf(const apol_policy_t * policy, const qpol_syn_avrule_t * rule, apol_render_buf_t * buf);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,221 @@
+/**
+ *  @file
+ *  Contains the API for a fixed size bitmap.  Bitmaps are used to
+ *  represent sets of small integers, such as symbol values, where
+ *  union, intersection and membership tests must be fast.  Note that
+ *  bitmap functions are not thread-safe when operating upon the same
+ *  bitmap.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_BITMAP_H
+#define APOL_BITMAP_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stdlib.h>
+
+	typedef struct apol_bitmap apol_bitmap_t;
+
+/**
+ *  Allocate and initialize a bitmap with all bits cleared.
+ *
+ *  @param size Number of bits in the bitmap; valid indices range
+ *  from 0 to size - 1.
+ *
+ *  @return A pointer to a newly created bitmap on success and NULL
+ *  on failure.  If the call fails, errno will be set.  The caller is
+ *  responsible for calling apol_bitmap_destroy() to free memory used.
+ */
+	extern apol_bitmap_t *apol_bitmap_create(size_t size);
+
+/**
+ *  Allocate and return a copy of an existing bitmap.
+ *
+ *  @param b Bitmap to copy.
+ *
+ *  @return A pointer to a newly created bitmap on success and NULL
+ *  on failure.  If the call fails, errno will be set.  The caller is
+ *  responsible for calling apol_bitmap_destroy() to free memory used.
+ */
+	extern apol_bitmap_t *apol_bitmap_create_from_bitmap(const apol_bitmap_t * b);
+
+/**
+ *  Free a bitmap and any memory used by it.
+ *
+ *  @param b Pointer to the bitmap to free.  The pointer will be set
+ *  to NULL afterwards.  If already NULL then this function does
+ *  nothing.
+ */
+	extern void apol_bitmap_destroy(apol_bitmap_t ** b);
+
+/**
+ *  Get the number of bits in a bitmap.
+ *
+ *  @param b Bitmap to query.
+ *
+ *  @return Number of bits in the bitmap, or 0 if b is NULL.
+ */
+	extern size_t apol_bitmap_get_size(const apol_bitmap_t * b);
+
+/**
+ *  Set a bit within a bitmap.
+ *
+ *  @param b Bitmap to modify.
+ *  @param idx Index of the bit to set.
+ *
+ *  @return 0 on success, < 0 if idx is out of range.  If the call
+ *  fails, errno will be set and the bitmap will be unchanged.
+ */
+	extern int apol_bitmap_set(apol_bitmap_t * b, size_t idx);
+
+/**
+ *  Clear a bit within a bitmap.
+ *
+ *  @param b Bitmap to modify.
+ *  @param idx Index of the bit to clear.
+ *
+ *  @return 0 on success, < 0 if idx is out of range.  If the call
+ *  fails, errno will be set and the bitmap will be unchanged.
+ */
+	extern int apol_bitmap_clear(apol_bitmap_t * b, size_t idx);
+
+/**
+ *  Determine if a bit is set within a bitmap.
+ *
+ *  @param b Bitmap to query.
+ *  @param idx Index of the bit to test.
+ *
+ *  @return 1 if the bit is set, 0 if it is clear or if idx is out of
+ *  range.
+ */
+	extern int apol_bitmap_get(const apol_bitmap_t * b, size_t idx);
+
+/**
+ *  Clear every bit within a bitmap.
+ *
+ *  @param b Bitmap to clear.
+ */
+	extern void apol_bitmap_clear_all(apol_bitmap_t * b);
+
+/**
+ *  Set dest to the union of itself and src.  If the bitmaps differ in
+ *  size only the bits common to both are considered.
+ *
+ *  @param dest Bitmap to modify.
+ *  @param src Bitmap whose bits to add.
+ *
+ *  @return 1 if dest changed, 0 if it did not.
+ */
+	extern int apol_bitmap_or(apol_bitmap_t * dest, const apol_bitmap_t * src);
+
+/**
+ *  Set dest to the intersection of itself and src.  Bits of dest
+ *  beyond the size of src are cleared.
+ *
+ *  @param dest Bitmap to modify.
+ *  @param src Bitmap with which to intersect.
+ *
+ *  @return 1 if dest changed, 0 if it did not.
+ */
+	extern int apol_bitmap_and(apol_bitmap_t * dest, const apol_bitmap_t * src);
+
+/**
+ *  Remove from dest every bit that is set in src.
+ *
+ *  @param dest Bitmap to modify.
+ *  @param src Bitmap whose bits to remove.
+ *
+ *  @return 1 if dest changed, 0 if it did not.
+ */
+	extern int apol_bitmap_andnot(apol_bitmap_t * dest, const apol_bitmap_t * src);
+
+/**
+ *  Count the number of bits set within a bitmap.
+ *
+ *  @param b Bitmap to query.
+ *
+ *  @return Number of bits set, or 0 if b is NULL.
+ */
+	extern size_t apol_bitmap_count(const apol_bitmap_t * b);
+
+/**
+ *  Count the number of bits set in both of two bitmaps, without
+ *  allocating their intersection.
+ *
+ *  @param a First bitmap.
+ *  @param b Second bitmap.
+ *
+ *  @return Size of the intersection of a and b.
+ */
+	extern size_t apol_bitmap_count_intersection(const apol_bitmap_t * a, const apol_bitmap_t * b);
+
+/**
+ *  Determine if two bitmaps have any bit in common.
+ *
+ *  @param a First bitmap.
+ *  @param b Second bitmap.
+ *
+ *  @return 1 if the intersection of a and b is not empty, 0 otherwise.
+ */
+	extern int apol_bitmap_intersects(const apol_bitmap_t * a, const apol_bitmap_t * b);
+
+/**
+ *  Determine if every bit set within a is also set within b.
+ *
+ *  @param a Possible subset.
+ *  @param b Possible superset.
+ *
+ *  @return 1 if a is a subset of b, 0 otherwise.
+ */
+	extern int apol_bitmap_is_subset(const apol_bitmap_t * a, const apol_bitmap_t * b);
+
+/**
+ *  Determine if two bitmaps have exactly the same bits set.  Bitmaps
+ *  of differing sizes are equal if the extra bits are all clear.
+ *
+ *  @param a First bitmap.
+ *  @param b Second bitmap.
+ *
+ *  @return 1 if the bitmaps are equal, 0 otherwise.
+ */
+	extern int apol_bitmap_equal(const apol_bitmap_t * a, const apol_bitmap_t * b);
+
+/**
+ *  Find the next set bit at or after a given index.  To iterate over
+ *  all set bits:
+ *  <pre>
+ *  for (i = apol_bitmap_next(b, 0); i < apol_bitmap_get_size(b); i = apol_bitmap_next(b, i + 1))
+ *  </pre>
+ *
+ *  @param b Bitmap to search.
+ *  @param idx Index from which to start searching.
+ *
+ *  @return Index of the next set bit, or the size of the bitmap if
+ *  there are no more set bits.
+ */
+	extern size_t apol_bitmap_next(const apol_bitmap_t * b, size_t idx);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif				       /* APOL_BITMAP_H */
@@ -33,9 +33,11 @@ extern "C"
 
 #include "policy.h"
 #include "vector.h"
+#include "context-query.h"
 
 	typedef struct apol_constraint_query apol_constraint_query_t;
 	typedef struct apol_validatetrans_query apol_validatetrans_query_t;
+	typedef struct apol_constraint_evaluator apol_constraint_evaluator_t;
 
 /******************** constraint queries ********************/
 
@@ -181,6 +183,87 @@ extern "C"
  */
 	extern int apol_validatetrans_query_set_regex(const apol_policy_t * p, apol_validatetrans_query_t * vt, int is_regex);
 
+/******************** constraint evaluation ********************/
+
+/**
+ * Compile every constraint and mlsconstrain within a policy, so that
+ * they may be evaluated against concrete contexts.  Each constraint's
+ * expression becomes a short postfix program over user, role, and
+ * type values and interned MLS levels; names within the expression
+ * become bitmaps of values.  The evaluator remains valid for as long
+ * as the policy does.
+ *
+ * @param p Policy whose constraints to compile.
+ *
+ * @return A newly allocated evaluator, or NULL upon error.  The
+ * caller must call apol_constraint_evaluator_destroy() afterwards.
+ */
+	extern apol_constraint_evaluator_t *apol_constraint_evaluator_create(const apol_policy_t * p);
+
+/**
+ * Deallocate all memory associated with the referenced constraint
+ * evaluator, and then set it to NULL.  This function does nothing if
+ * the evaluator is already NULL.
+ *
+ * @param e Reference to a constraint evaluator to destroy.
+ */
+	extern void apol_constraint_evaluator_destroy(apol_constraint_evaluator_t ** e);
+
+/**
+ * Determine if the constraints on a class permit a permission
+ * between two contexts.  The contexts must have their user, role,
+ * and type set; if the class has MLS constraints then they must have
+ * a range as well.
+ *
+ * @param e Constraint evaluator to use.
+ * @param scontext Source context.
+ * @param tcontext Target context.
+ * @param class_name Name of the object class.
+ * @param perm_name Name of the permission within the class.
+ *
+ * @return 1 if every applicable constraint is satisfied, 0 if any is
+ * not, or < 0 on error.
+ */
+	extern int apol_constraint_evaluator_check(const apol_constraint_evaluator_t * e, const apol_context_t * scontext,
+						   const apol_context_t * tcontext, const char *class_name, const char *perm_name);
+
+/**
+ * Determine which permissions of a class its constraints deny
+ * between two contexts.
+ *
+ * @param e Constraint evaluator to use.
+ * @param scontext Source context.
+ * @param tcontext Target context.
+ * @param class_name Name of the object class.
+ * @param denied Reference to a mask of denied permissions, where the
+ * permission with value v is bit (v - 1); see
+ * qpol_class_get_perm_value().
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_constraint_evaluator_get_denied(const apol_constraint_evaluator_t * e, const apol_context_t * scontext,
+							const apol_context_t * tcontext, const char *class_name, uint32_t * denied);
+
+/**
+ * Determine which permissions of a class its constraints deny for
+ * each of many pairs of contexts.  Every context is interned once
+ * before any constraint is run.
+ *
+ * @param e Constraint evaluator to use.
+ * @param class_name Name of the object class.
+ * @param scontexts Vector of apol_context_t, the source contexts.
+ * @param tcontexts Vector of apol_context_t, the target contexts.
+ * This must be the same size as scontexts.
+ * @param denied Array of at least as many elements as scontexts.
+ * Element i will be set to the mask of permissions denied between
+ * scontexts[i] and tcontexts[i].
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_constraint_evaluator_check_pairs(const apol_constraint_evaluator_t * e, const char *class_name,
+							 const apol_vector_t * scontexts, const apol_vector_t * tcontexts,
+							 uint32_t * denied);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -37,6 +37,8 @@ extern "C"
 
 	typedef struct apol_domain_trans_analysis apol_domain_trans_analysis_t;
 	typedef struct apol_domain_trans_result apol_domain_trans_result_t;
+	typedef struct apol_domain_trans_reach_analysis apol_domain_trans_reach_analysis_t;
+	typedef struct apol_domain_trans_reach_result apol_domain_trans_reach_result_t;
 
 #define APOL_DOMAIN_TRANS_DIRECTION_FORWARD 0x01
 #define APOL_DOMAIN_TRANS_DIRECTION_REVERSE 0x02
@@ -62,13 +64,11 @@ extern "C"
 	extern int apol_policy_domain_trans_table_build(apol_policy_t * policy) __attribute__ ((deprecated));
 
 /**
- *  Reset the state of the domain transition table in a policy.  This
- *  is needed because by default subsequent calls to
- *  apol_domain_trans_analysis_do() will not produce results generated
- *  in a previous call.  If calls are to be considered independent or
- *  calls in a different direction are desired, call this function
- *  prior to apol_domain_trans_analysis_do().  If the table was not
- *  built yet then this function does nothing.
+ *  Reset the state of the domain transition table in a policy.
+ *  Each call to apol_domain_trans_analysis_do() tracks which
+ *  rules it has consumed separately from the table, so calls are
+ *  always independent and this function does nothing.  It is kept
+ *  for compatibility with existing callers.
  *
  *  @param policy Policy containing the table for which the state
  *  should be reset.
@@ -241,6 +241,9 @@ extern "C"
 
 /**
  *  Execute a domain transition analysis against a particular policy.
+ *  The analysis does not modify the policy's domain transition table,
+ *  so once the table has been built several analyses may be run
+ *  against the same policy at the same time.
  *  @param policy Policy containing the table to use.
  *  @param dta A non-NULL structure containng parameters for analysis.
  *  @param results A reference pointer to a vector of
@@ -249,8 +252,6 @@ extern "C"
  *  afterwards. This will be set to NULL upon error.
  *  @return 0 on success and < 0 on failure; if the call fails,
  *  errno will be set and *results will be NULL.
- *
- *  @see apol_policy_reset_domain_trans_table()
  */
 	extern int apol_domain_trans_analysis_do(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
 						 apol_vector_t ** results);
@@ -389,6 +390,137 @@ extern "C"
  */
 	extern void apol_domain_trans_result_destroy(apol_domain_trans_result_t ** res);
 
+/*************** functions to do transitive reachability ******************/
+
+/**
+ *  Allocate and return a new domain transition reachability analysis.
+ *  This analysis follows valid domain transitions transitively,
+ *  finding every domain that may be entered from a set of start
+ *  domains along with the shortest chain of transitions to reach it.
+ *  The caller must call apol_domain_trans_reach_analysis_destroy()
+ *  upon the return value afterwards.
+ *  @return An initialized reachability analysis structure, or NULL
+ *  upon error; if an error occurs errno will be set.
+ */
+	extern apol_domain_trans_reach_analysis_t *apol_domain_trans_reach_analysis_create(void);
+
+/**
+ *  Deallocate all memory associated with the referenced reachability
+ *  analysis structure, and then set it to NULL. This function does
+ *  nothing if the analysis is already NULL.
+ *  @param dra Reference to a reachability analysis structure to destroy.
+ */
+	extern void apol_domain_trans_reach_analysis_destroy(apol_domain_trans_reach_analysis_t ** dra);
+
+/**
+ *  Add a domain from which to begin searching.  At least one start
+ *  domain must be appended prior to running the analysis; when more
+ *  than one is given each result is reached from whichever start
+ *  domain is nearest.
+ *  @param policy Policy handler, to report errors.
+ *  @param dra Reachability analysis to set.
+ *  @param type_name Name of the type from which to begin searching.
+ *  This string will be duplicated.  Pass NULL to clear all
+ *  previously appended start types.
+ *  @return 0 on success, and < 0 on error; if the call fails,
+ *  errno will be set and dra will be unchanged.
+ */
+	extern int apol_domain_trans_reach_analysis_append_start_type(const apol_policy_t * policy,
+								      apol_domain_trans_reach_analysis_t * dra,
+								      const char *type_name);
+
+/**
+ *  Limit the number of transitions the analysis will follow from the
+ *  start domains.  The default for a newly created analysis is 0,
+ *  meaning that the full transitive closure is computed.
+ *  @param policy Policy handler, to report errors.
+ *  @param dra Reachability analysis to set.
+ *  @param max_hops Maximum length of a transition chain, or 0 for no
+ *  limit.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set.
+ */
+	extern int apol_domain_trans_reach_analysis_set_max_hops(const apol_policy_t * policy,
+								 apol_domain_trans_reach_analysis_t * dra, unsigned int max_hops);
+
+/**
+ *  Execute a reachability analysis against a particular policy.  The
+ *  policy's domain transition table will be built if needed.  Only
+ *  valid transitions are followed.
+ *  @param policy Policy containing the table to use.
+ *  @param dra A non-NULL structure containing parameters for analysis.
+ *  @param results A reference pointer to a vector of
+ *  apol_domain_trans_reach_result_t, one per reachable domain other
+ *  than the start domains.  Results are ordered by increasing number
+ *  of transitions.  The vector will be allocated by this function.
+ *  The caller must call apol_vector_destroy() afterwards. This will
+ *  be set to NULL upon error.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *results will be NULL.
+ */
+	extern int apol_domain_trans_reach_analysis_do(apol_policy_t * policy, apol_domain_trans_reach_analysis_t * dra,
+						       apol_vector_t ** results);
+
+/**
+ *  Return the start domain from which the result's domain was reached.
+ *  The caller should not free the returned pointer.
+ *  @param drr Reachability result node.
+ *  @return Pointer to the start domain of the transition chain.
+ */
+	extern const qpol_type_t *apol_domain_trans_reach_result_get_start_type(const apol_domain_trans_reach_result_t * drr);
+
+/**
+ *  Return the domain that was reached.  The caller should not free
+ *  the returned pointer.
+ *  @param drr Reachability result node.
+ *  @return Pointer to the last domain of the transition chain.
+ */
+	extern const qpol_type_t *apol_domain_trans_reach_result_get_end_type(const apol_domain_trans_reach_result_t * drr);
+
+/**
+ *  Return the number of transitions in the shortest chain from the
+ *  start domain to the reached domain.
+ *  @param drr Reachability result node.
+ *  @return Number of transitions, always at least 1.
+ */
+	extern unsigned int apol_domain_trans_reach_result_get_num_hops(const apol_domain_trans_reach_result_t * drr);
+
+/**
+ *  Return the domains along the shortest transition chain, from the
+ *  start domain to the reached domain inclusive.  The caller should
+ *  not free the returned pointer.
+ *  @param drr Reachability result node.
+ *  @return Vector of qpol_type_t, or NULL upon error.
+ */
+	extern const apol_vector_t *apol_domain_trans_reach_result_get_domains(const apol_domain_trans_reach_result_t * drr);
+
+/**
+ *  Return the entrypoint types used by each transition along the
+ *  shortest transition chain.  Entry i is the entrypoint used to go
+ *  from domain i to domain i + 1.  The caller should not free the
+ *  returned pointer.
+ *  @param drr Reachability result node.
+ *  @return Vector of qpol_type_t, or NULL upon error.
+ */
+	extern const apol_vector_t *apol_domain_trans_reach_result_get_entrypoints(const apol_domain_trans_reach_result_t *
+										   drr);
+
+/**
+ *  Build the supporting rules for each transition along a result's
+ *  chain.  This is done on demand, as whole-policy reachability can
+ *  produce many results whose rules are never examined.
+ *  @param policy Policy from which the result was generated.
+ *  @param drr Reachability result node.
+ *  @param steps Reference to a vector of apol_domain_trans_result_t,
+ *  one per transition, in chain order.  The vector will be allocated
+ *  by this function; the caller must call apol_vector_destroy()
+ *  afterwards.  This will be set to NULL upon error.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *steps will be NULL.
+ */
+	extern int apol_domain_trans_reach_result_get_steps(apol_policy_t * policy, const apol_domain_trans_reach_result_t * drr,
+							    apol_vector_t ** steps);
+
 /************************ utility functions *******************************/
 /* define the following for rule type */
 #define APOL_DOMAIN_TRANS_RULE_PROC_TRANS       0x01
@@ -191,7 +191,8 @@ extern "C"
  * @param search Source MLS level to compare.
  *
  * @return One of APOL_MLS_EQ, APOL_MLS_DOM, APOL_MLS_DOMBY, or
- * APOL_MLS_INCOMP; < 0 on error.
+ * APOL_MLS_INCOMP; < 0 on error, including if either level names a
+ * sensitivity or category that is not within the policy.
  *
  * @see apol_mls_level_validate()
  */
@@ -207,7 +208,8 @@ extern "C"
  * @param p Policy within which to look up MLS information.
  * @param level Level to check.
  *
- * @return 1 If level is legal, 0 if not; < 0 on error.
+ * @return 1 If level is legal, 0 if not (including if it names a
+ * category that is not within the policy); < 0 on error.
  *
  * @see apol_mls_level_compare()
  */
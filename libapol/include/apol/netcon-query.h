@@ -34,11 +34,13 @@ extern "C"
 #include "policy.h"
 #include "vector.h"
 #include "context-query.h"
+#include "render.h"
 #include <qpol/policy.h>
 
 	typedef struct apol_portcon_query apol_portcon_query_t;
 	typedef struct apol_netifcon_query apol_netifcon_query_t;
 	typedef struct apol_nodecon_query apol_nodecon_query_t;
+	typedef struct apol_netcon_index apol_netcon_index_t;
 
 /******************** portcon queries ********************/
 
@@ -144,6 +146,18 @@ extern "C"
  */
 	extern char *apol_portcon_render(const apol_policy_t * p, const qpol_portcon_t * portcon);
 
+/**
+ * Append the textual representation of a portcon statement to a
+ * render buffer.
+ * @param p Reference to a policy.
+ * @param portcon Reference to the portcon statement to be rendered.
+ * @param buf Buffer to which to append.
+ *
+ * @return 0 on success, < 0 on error.  Upon error the buffer is
+ * unchanged.
+ */
+	extern int apol_portcon_render_buf(const apol_policy_t * p, const qpol_portcon_t * portcon, apol_render_buf_t * buf);
+
 /******************** netifcon queries ********************/
 
 /**
@@ -243,6 +257,18 @@ extern "C"
  */
 	extern char *apol_netifcon_render(const apol_policy_t * p, const qpol_netifcon_t * netifcon);
 
+/**
+ * Append the textual representation of a netifcon statement to a
+ * render buffer.
+ * @param p Reference to a policy.
+ * @param netifcon Reference to the netifcon statement to be rendered.
+ * @param buf Buffer to which to append.
+ *
+ * @return 0 on success, < 0 on error.  Upon error the buffer is
+ * unchanged.
+ */
+	extern int apol_netifcon_render_buf(const apol_policy_t * p, const qpol_netifcon_t * netifcon, apol_render_buf_t * buf);
+
 /******************** nodecon queries ********************/
 
 /**
@@ -357,6 +383,107 @@ extern "C"
  */
 	extern char *apol_nodecon_render(const apol_policy_t * p, const qpol_nodecon_t * nodecon);
 
+/**
+ * Append the textual representation of a nodecon statement to a
+ * render buffer.
+ * @param p Reference to a policy.
+ * @param nodecon Reference to the nodecon statement to be rendered.
+ * @param buf Buffer to which to append.
+ *
+ * @return 0 on success, < 0 on error.  Upon error the buffer is
+ * unchanged.
+ */
+	extern int apol_nodecon_render_buf(const apol_policy_t * p, const qpol_nodecon_t * nodecon, apol_render_buf_t * buf);
+
+/******************** netcon index ********************/
+
+/**
+ * Build an index of a policy's portcons and nodecons, to answer
+ * which statement applies to a given port or address.  Portcons are
+ * flattened into sorted, disjoint port segments for each protocol;
+ * nodecons are placed into a prefix trie for each address family.
+ * Lookups follow the kernel's rule: the first matching statement in
+ * policy order applies.  The index remains valid for as long as the
+ * policy does.
+ *
+ * @param p Policy whose portcons and nodecons to index.
+ *
+ * @return A newly allocated index, or NULL upon error.  The caller
+ * must call apol_netcon_index_destroy() afterwards.
+ */
+	extern apol_netcon_index_t *apol_netcon_index_create(const apol_policy_t * p);
+
+/**
+ * Deallocate all memory associated with the referenced netcon index,
+ * and then set it to NULL.  This function does nothing if the index
+ * is already NULL.
+ *
+ * @param idx Reference to a netcon index to destroy.
+ */
+	extern void apol_netcon_index_destroy(apol_netcon_index_t ** idx);
+
+/**
+ * Find the portcon that applies to a port.
+ *
+ * @param idx Netcon index to search.
+ * @param protocol Protocol of the port, such as IPPROTO_TCP or
+ * IPPROTO_UDP from netinet/in.h.
+ * @param port Port number to look up.
+ *
+ * @return The applicable portcon, or NULL if none applies.
+ */
+	extern const qpol_portcon_t *apol_netcon_index_find_portcon(const apol_netcon_index_t * idx, uint8_t protocol,
+								    uint16_t port);
+
+/**
+ * Find the portcons that apply to many ports at once.  The ports are
+ * sorted and then answered in a single sweep across the index, which
+ * is faster than looking each up individually when there are many.
+ *
+ * @param idx Netcon index to search.
+ * @param protocol Protocol of the ports.
+ * @param ports Array of port numbers to look up.
+ * @param num Number of elements in ports.
+ * @param results Array of at least num elements.  Element i will be
+ * set to the portcon applicable to ports[i], or NULL if none applies.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_netcon_index_find_portcons(const apol_netcon_index_t * idx, uint8_t protocol, const uint16_t * ports,
+						   size_t num, const qpol_portcon_t ** results);
+
+/**
+ * Find the nodecon that applies to an address.
+ *
+ * @param idx Netcon index to search.
+ * @param protocol Format of the address, either QPOL_IPV4 or
+ * QPOL_IPV6.
+ * @param addr Address to look up, in the same format as written by
+ * apol_str_to_internal_ip().  For QPOL_IPV4 only the first element
+ * is used.
+ *
+ * @return The applicable nodecon, or NULL if none applies.  Do not
+ * free the nodecon; it is owned by the index.
+ */
+	extern const qpol_nodecon_t *apol_netcon_index_find_nodecon(const apol_netcon_index_t * idx, int protocol,
+								    const uint32_t addr[4]);
+
+/**
+ * Find the nodecons that apply to many addresses at once.
+ *
+ * @param idx Netcon index to search.
+ * @param protocol Format of all of the addresses, either QPOL_IPV4
+ * or QPOL_IPV6.
+ * @param addrs Array of addresses to look up.
+ * @param num Number of elements in addrs.
+ * @param results Array of at least num elements.  Element i will be
+ * set to the nodecon applicable to addrs[i], or NULL if none applies.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_netcon_index_find_nodecons(const apol_netcon_index_t * idx, int protocol, const uint32_t(*addrs)[4],
+						   size_t num, const qpol_nodecon_t ** results);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,84 @@
+/**
+ *  @file
+ *  Contains the API for running a set of independent tasks across
+ *  several threads.  Tasks must not share mutable state, and must
+ *  not call into a policy in ways that fill its lazily built tables
+ *  (such as the symbol catalog); build whatever they read before the
+ *  run.  Tasks should not call the policy's message callback either;
+ *  they should return an error and let the caller report it.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_PARALLEL_H
+#define APOL_PARALLEL_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stdlib.h>
+
+/**
+ *  Callback that performs one task of apol_parallel_run().
+ *
+ *  @param arg Argument given to apol_parallel_run().
+ *  @param task Index of the task to perform, from 0 to one less than
+ *  the number of tasks.
+ *
+ *  @return 0 on success, < 0 on error.  If the call fails, it must
+ *  set errno.
+ */
+	typedef int (apol_parallel_func) (void *arg, size_t task);
+
+/**
+ *  Get the number of processors that are online, which is the number
+ *  of threads apol_parallel_run() uses when asked for 0.
+ *
+ *  @return Number of online processors, at least 1.
+ */
+	extern size_t apol_parallel_get_num_cpus(void);
+
+/**
+ *  Perform tasks 0 through num_tasks - 1, spread across up to
+ *  num_threads threads.  The calling thread is one of them.  Each
+ *  thread takes the next unstarted task until none remain, so tasks
+ *  may finish in any order; the caller should write each task's
+ *  results into a slot of its own and combine them afterwards.  If a
+ *  task fails then no further tasks are started, though those
+ *  already running are allowed to finish.  If threads cannot be
+ *  created then the remaining tasks are performed by those that
+ *  were.
+ *
+ *  @param num_tasks Number of tasks to perform.
+ *  @param num_threads Largest number of threads to use, or 0 for one
+ *  per online processor.  If 1, every task is performed in order on
+ *  the calling thread.
+ *  @param fn Callback that performs a task.
+ *  @param arg Arbitrary argument to pass to fn.
+ *
+ *  @return 0 if every task succeeded, < 0 if any failed.  If the call
+ *  fails, errno will be set to that of a failed task.
+ */
+	extern int apol_parallel_run(size_t num_tasks, size_t num_threads, apol_parallel_func * fn, void *arg);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif				       /* APOL_PARALLEL_H */
@@ -77,8 +77,10 @@ extern "C"
 #include "range_trans-query.h"
 #include "constraint-query.h"
 
+#include "access-decision.h"
 #include "domain-trans-analysis.h"
 #include "infoflow-analysis.h"
+#include "rbac-analysis.h"
 #include "relabel-analysis.h"
 #include "types-relation-analysis.h"
 
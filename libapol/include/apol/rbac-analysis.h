@@ -0,0 +1,141 @@
+/**
+ *  @file
+ *
+ *  Routines to determine which roles and types each user may reach,
+ *  through the roles the user is authorized for and the policy's
+ *  role allow rules.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_RBAC_ANALYSIS_H
+#define APOL_RBAC_ANALYSIS_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include "policy.h"
+#include "bitmap.h"
+#include <qpol/policy.h>
+
+	typedef struct apol_rbac_reach apol_rbac_reach_t;
+
+/**
+ * Build the RBAC reachability tables for a policy.  In one pass over
+ * the policy this gathers, as bitmaps indexed by value, each role's
+ * types and each user's authorized roles.  Then a single parallel
+ * pass (see apol_parallel_run()), with one thread per online
+ * processor, computes each role's transitive closure over role allow
+ * rules and the types each user may reach through its roles.  The
+ * tables remain valid for as long as the policy does.
+ *
+ * @param p Policy to analyze.
+ *
+ * @return Newly allocated tables, or NULL upon error.  The caller
+ * must call apol_rbac_reach_destroy() afterwards.
+ */
+	extern apol_rbac_reach_t *apol_rbac_reach_create(const apol_policy_t * p);
+
+/**
+ * Deallocate all memory associated with the referenced RBAC
+ * reachability tables, and then set it to NULL.  This function does
+ * nothing if the tables are already NULL.
+ *
+ * @param r Reference to the tables to destroy.
+ */
+	extern void apol_rbac_reach_destroy(apol_rbac_reach_t ** r);
+
+/**
+ * Get the types that a role may be associated with, as a bitmap in
+ * which bit v is set for the type whose value is v.
+ *
+ * @param r RBAC reachability tables.
+ * @param role Role to look up.
+ *
+ * @return Bitmap of types, which the caller must not modify or
+ * destroy, or NULL upon error.
+ */
+	extern const apol_bitmap_t *apol_rbac_reach_get_role_types(const apol_rbac_reach_t * r, const qpol_role_t * role);
+
+/**
+ * Get the roles that may be reached from a role through any chain of
+ * role allow rules, as a bitmap in which bit v is set for the role
+ * whose value is v.  A role always reaches itself.  This ignores
+ * which roles a user is authorized for; see
+ * apol_rbac_reach_get_user_reachable_types().
+ *
+ * @param r RBAC reachability tables.
+ * @param role Starting role.
+ *
+ * @return Bitmap of roles, which the caller must not modify or
+ * destroy, or NULL upon error.
+ */
+	extern const apol_bitmap_t *apol_rbac_reach_get_role_closure(const apol_rbac_reach_t * r, const qpol_role_t * role);
+
+/**
+ * Get the roles that a user is authorized for, as a bitmap in which
+ * bit v is set for the role whose value is v.
+ *
+ * @param r RBAC reachability tables.
+ * @param user User to look up.
+ *
+ * @return Bitmap of roles, which the caller must not modify or
+ * destroy, or NULL upon error.
+ */
+	extern const apol_bitmap_t *apol_rbac_reach_get_user_roles(const apol_rbac_reach_t * r, const qpol_user_t * user);
+
+/**
+ * Get every type that a user may reach through any of its authorized
+ * roles, as a bitmap in which bit v is set for the type whose value
+ * is v.
+ *
+ * @param r RBAC reachability tables.
+ * @param user User to look up.
+ *
+ * @return Bitmap of types, which the caller must not modify or
+ * destroy, or NULL upon error.
+ */
+	extern const apol_bitmap_t *apol_rbac_reach_get_user_types(const apol_rbac_reach_t * r, const qpol_user_t * user);
+
+/**
+ * Determine which types a user may reach starting from one role.
+ * The user may change to another role only through a role allow
+ * rule, and only if it is authorized for the new role.
+ *
+ * @param r RBAC reachability tables.
+ * @param user User whose roles to follow.
+ * @param role Starting role.  If the user is not authorized for this
+ * role then no types are reachable.
+ * @param roles If not NULL, reference to a newly allocated bitmap of
+ * the roles reached.  The caller must call apol_bitmap_destroy()
+ * afterwards.
+ * @param types Reference to a newly allocated bitmap of the types
+ * reached.  The caller must call apol_bitmap_destroy() afterwards.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_rbac_reach_get_user_reachable_types(const apol_rbac_reach_t * r, const qpol_user_t * user,
+							    const qpol_role_t * role, apol_bitmap_t ** roles,
+							    apol_bitmap_t ** types);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
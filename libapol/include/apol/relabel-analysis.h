@@ -44,9 +44,25 @@ extern "C"
 	typedef struct apol_relabel_analysis apol_relabel_analysis_t;
 	typedef struct apol_relabel_result apol_relabel_result_t;
 	typedef struct apol_relabel_result_pair apol_relabel_result_pair_t;
+	typedef struct apol_relabel_bulk_result apol_relabel_bulk_result_t;
 
 /******************** functions to do relabel analysis ********************/
 
+/**
+ * Build an index of all allow rules in a policy that grant relabelto
+ * or relabelfrom.  Subsequent calls to apol_relabel_analysis_do() and
+ * apol_relabel_analysis_do_all() on this policy will use the index
+ * instead of rebuilding it for each analysis.  The index is
+ * destroyed along with the policy.  If the index was already built
+ * then this function does nothing.
+ *
+ * @param policy Policy to index.
+ *
+ * @return 0 on success, < 0 on error; if the call fails, errno will
+ * be set.
+ */
+	extern int apol_policy_build_relabel_table(apol_policy_t * policy);
+
 /**
  * Execute a relabel analysis against a particular policy.
  *
@@ -61,6 +77,24 @@ extern "C"
  */
 	extern int apol_relabel_analysis_do(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t ** v);
 
+/**
+ * Execute a relabel analysis for every type in a policy.  The
+ * analysis's starting type is ignored; all of its other parameters
+ * apply to each type in turn.  Attributes and aliases are not used
+ * as starting types.
+ *
+ * @param p Policy within which to look up allow rules.
+ * @param r A non-NULL structure containing parameters for analysis.
+ * @param v Reference to a vector of apol_relabel_bulk_result_t, one
+ * for each type that has at least one result.  The vector will be
+ * allocated by this function.  The caller must call
+ * apol_vector_destroy() afterwards.  This will be set to NULL upon
+ * error.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_relabel_analysis_do_all(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t ** v);
+
 /**
  * Allocate and return a new relabel analysis structure.  All fields
  * are cleared; one must fill in the details of the analysis before
@@ -251,6 +285,28 @@ extern "C"
  */
 	extern const qpol_type_t *apol_relabel_result_pair_get_intermediate_type(const apol_relabel_result_pair_t * p);
 
+/**
+ * Return the starting type for an apol_relabel_bulk_result node.
+ *
+ * @param r Bulk relabel result node.
+ *
+ * @return Pointer to the starting type.
+ */
+	extern const qpol_type_t *apol_relabel_bulk_result_get_start_type(const apol_relabel_bulk_result_t * r);
+
+/**
+ * Return the results of analyzing a single starting type within an
+ * apol_relabel_bulk_result node.  This is a vector of
+ * apol_relabel_result_t, as would be returned by
+ * apol_relabel_analysis_do() for that type.  The caller shall not
+ * call apol_vector_destroy() upon this pointer.
+ *
+ * @param r Bulk relabel result node.
+ *
+ * @return Pointer to a vector of relabel results.
+ */
+	extern const apol_vector_t *apol_relabel_bulk_result_get_results(const apol_relabel_bulk_result_t * r);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -38,8 +38,11 @@ extern "C"
 #include "policy.h"
 #include "mls-query.h"
 #include <qpol/policy.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+	typedef struct apol_render_buf apol_render_buf_t;
+
 /**
  * Given an IPv4 address (or mask) in qpol byte order, allocate and
  * return a string representing that address.
@@ -75,6 +78,116 @@ extern "C"
  */
 	extern char *apol_qpol_context_render(const apol_policy_t * p, const qpol_context_t * context);
 
+/**
+ * Append the textual representation of a security context to a
+ * render buffer.
+ *
+ * @param p Reference to a policy.
+ * @param context Reference to the security context to be rendered.
+ * @param buf Buffer to which to append.
+ *
+ * @return 0 on success, < 0 on error.  Upon error the buffer is
+ * unchanged.
+ */
+	extern int apol_qpol_context_render_buf(const apol_policy_t * p, const qpol_context_t * context, apol_render_buf_t * buf);
+
+/******************** render buffers ********************/
+
+/**
+ * Allocate and return a new growable buffer into which the
+ * *_render_buf() functions may write.  Reusing one buffer to render
+ * many items avoids allocating a new string for each one.
+ *
+ * @return A new buffer, or NULL upon error.  The caller must call
+ * apol_render_buf_destroy() afterwards.
+ */
+	extern apol_render_buf_t *apol_render_buf_create(void);
+
+/**
+ * Allocate and return a new buffer whose contents are written to a
+ * file.  Text accumulates in the buffer and is written out as each
+ * rendered item completes once enough has built up, and upon
+ * apol_render_buf_flush() or apol_render_buf_destroy().
+ *
+ * @param fp File to which to write.  The caller remains responsible
+ * for closing it, after destroying the buffer.
+ *
+ * @return A new buffer, or NULL upon error.  The caller must call
+ * apol_render_buf_destroy() afterwards.
+ */
+	extern apol_render_buf_t *apol_render_buf_create_file(FILE * fp);
+
+/**
+ * Deallocate all memory associated with the referenced buffer, and
+ * then set it to NULL.  If the buffer writes to a file, then first
+ * write out any remaining text.
+ *
+ * @param buf Reference to a buffer to destroy.
+ */
+	extern void apol_render_buf_destroy(apol_render_buf_t ** buf);
+
+/**
+ * Discard the buffer's contents without releasing its memory.
+ *
+ * @param buf Buffer to clear.
+ */
+	extern void apol_render_buf_clear(apol_render_buf_t * buf);
+
+/**
+ * Return the text accumulated within a buffer.  For a buffer that
+ * writes to a file, this is only the text not yet written.
+ *
+ * @param buf Buffer to query.
+ *
+ * @return The buffer's text.  The string remains valid until the
+ * buffer is next modified; do not free() it.
+ */
+	extern const char *apol_render_buf_get_string(const apol_render_buf_t * buf);
+
+/**
+ * Return the length of the text accumulated within a buffer.
+ *
+ * @param buf Buffer to query.
+ *
+ * @return Length of the buffer's text, not including the terminating
+ * NUL.
+ */
+	extern size_t apol_render_buf_get_length(const apol_render_buf_t * buf);
+
+/**
+ * Append a string to a buffer, growing it if necessary.
+ *
+ * @param buf Buffer to modify.
+ * @param str String to append.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_render_buf_append(apol_render_buf_t * buf, const char *str);
+
+/**
+ * Append a formatted string to a buffer, as per printf(3), growing
+ * it if necessary.
+ *
+ * @param buf Buffer to modify.
+ * @param fmt Format for the string to append.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_render_buf_appendf(apol_render_buf_t * buf, const char *fmt, ...);
+
+/* declaration duplicated below to satisfy doxygen */
+	extern int apol_render_buf_appendf(apol_render_buf_t * buf, const char *fmt, ...) __attribute__ ((format(printf, 2, 3)));
+
+/**
+ * If a buffer writes to a file, write out all of its text and then
+ * clear it.  Otherwise do nothing.
+ *
+ * @param buf Buffer to flush.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int apol_render_buf_flush(apol_render_buf_t * buf);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -33,6 +33,7 @@ extern "C"
 #endif
 
 #include "policy.h"
+#include "render.h"
 #include "vector.h"
 #include <qpol/policy.h>
 
@@ -302,6 +303,19 @@ extern "C"
  */
 	extern char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rule);
 
+/**
+ *  Append the rendering of a terule to a buffer, as
+ *  apol_avrule_render_buf() does for avrules.
+ *
+ *  @param policy Policy handler, to report errors.
+ *  @param rule The rule to render.
+ *  @param buf Buffer to which to append.
+ *
+ *  @return 0 on success, < 0 on failure; if the call fails, errno will
+ *  be set and the buffer is unchanged.
+ */
+	extern int apol_terule_render_buf(const apol_policy_t * policy, const qpol_terule_t * rule, apol_render_buf_t * buf);
+
 /**
  *  Render a syntactic terule to a string.
  *
@@ -314,6 +328,19 @@ extern "C"
 */
 	extern char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule_t * rule);
 
+/**
+ *  Append the rendering of a syntactic terule to a buffer, as
+ *  apol_avrule_render_buf() does for avrules.
+ *
+ *  @param policy Policy handler, to report errors.
+ *  @param rule The rule to render.
+ *  @param buf Buffer to which to append.
+ *
+ *  @return 0 on success, < 0 on failure; if the call fails, errno will
+ *  be set and the buffer is unchanged.
+ */
+	extern int apol_syn_terule_render_buf(const apol_policy_t * policy, const qpol_syn_terule_t * rule, apol_render_buf_t * buf);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -33,6 +33,7 @@ extern "C"
 
 #include "policy.h"
 #include "vector.h"
+#include "bitmap.h"
 #include <qpol/policy.h>
 
 	typedef struct apol_type_query apol_type_query_t;
@@ -165,6 +166,44 @@ extern "C"
  */
 	extern int apol_attr_query_set_regex(const apol_policy_t * p, apol_attr_query_t * a, int is_regex);
 
+/******************** type expansion ********************/
+
+/**
+ * Get the types to which a type or attribute expands, as a bitmap in
+ * which bit v is set for the type whose value is v (see
+ * qpol_type_get_value()).  An attribute expands to its types; a type
+ * or alias expands to just its primary.  The first call builds these
+ * bitmaps for every type in the policy at once, so that expanding
+ * many rules' attributes costs a bitmap operation each rather than a
+ * walk of the attributes' types.
+ *
+ * @param p Policy containing the type.
+ * @param type Type, alias, or attribute to expand.
+ *
+ * @return Bitmap of types.  The bitmap belongs to the policy and must
+ * not be modified; it remains valid for as long as the policy.  A
+ * bitmap obtained before the policy is rebuilt (see
+ * qpol_policy_rebuild()) still describes the types from before the
+ * rebuild; call this again for the rebuilt policy's types.  On error
+ * return NULL.
+ */
+	extern const apol_bitmap_t *apol_type_get_expansion_bitmap(const apol_policy_t * p, const qpol_type_t * type);
+
+/**
+ * Get the attributes that a type has, as a bitmap in which bit v is
+ * set for the attribute whose value is v.  An attribute has no
+ * attributes.
+ *
+ * @param p Policy containing the type.
+ * @param type Type, alias, or attribute to look up.
+ *
+ * @return Bitmap of attributes.  The bitmap belongs to the policy
+ * and must not be modified; it remains valid for as long as the
+ * policy, as described for apol_type_get_expansion_bitmap().  On
+ * error return NULL.
+ */
+	extern const apol_bitmap_t *apol_type_get_attr_bitmap(const apol_policy_t * p, const qpol_type_t * type);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -54,6 +54,7 @@ extern "C"
 	typedef struct apol_types_relation_analysis apol_types_relation_analysis_t;
 	typedef struct apol_types_relation_result apol_types_relation_result_t;
 	typedef struct apol_types_relation_access apol_types_relation_access_t;
+	typedef struct apol_types_relation_matrix apol_types_relation_matrix_t;
 
 /********** functions to do types relation analysis **********/
 
@@ -137,6 +138,107 @@ extern "C"
 	extern int apol_types_relation_analysis_set_analyses(const apol_policy_t * p, apol_types_relation_analysis_t * tr,
 							     unsigned int analyses);
 
+/**
+ * Append a type to the list of types compared by
+ * apol_types_relation_matrix_do().  If no types are appended then
+ * the matrix compares every type in the policy.  This list is
+ * ignored by apol_types_relation_analysis_do().
+ *
+ * @param p Policy handler, to report errors.
+ * @param tr Types relation analysis to set.
+ * @param name Name of a type (not an attribute) to compare.  If NULL,
+ * then clear all existing types.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_types_relation_analysis_append_type(const apol_policy_t * p, apol_types_relation_analysis_t * tr,
+							    const char *name);
+
+/**
+ * Compare every pair of types in a list at once, yielding a
+ * similarity matrix.  Each type's attributes, roles, users, and
+ * accessed types are gathered a single time, as bitmaps; a pair's
+ * similarity is then the number of those features the two types
+ * share divided by the number that either of them has.  Only the
+ * features selected by apol_types_relation_analysis_set_analyses()
+ * (APOL_TYPES_RELATION_COMMON_ATTRIBS,
+ * APOL_TYPES_RELATION_COMMON_ROLES, APOL_TYPES_RELATION_COMMON_USERS,
+ * and APOL_TYPES_RELATION_SIMILAR_ACCESS) are considered; if none
+ * of those are selected then all four are.  The analysis's first and
+ * other types are ignored.  The pairs are compared on one thread per
+ * online processor (see apol_parallel_run()).
+ *
+ * @param p Policy within which to look up types.
+ * @param tr A non-NULL types relation analysis.
+ * @param m Reference to the resulting matrix.  The caller is
+ * responsible for calling apol_types_relation_matrix_destroy()
+ * afterwards.  This will be set to NULL upon error.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_types_relation_matrix_do(const apol_policy_t * p, const apol_types_relation_analysis_t * tr,
+						 apol_types_relation_matrix_t ** m);
+
+/**
+ * Deallocate all space associated with a types relation matrix,
+ * including the pointer itself.  Afterwards set the pointer to NULL.
+ *
+ * @param m Reference to a types relation matrix to destroy.
+ */
+	extern void apol_types_relation_matrix_destroy(apol_types_relation_matrix_t ** m);
+
+/**
+ * Return the number of types (that is, rows and columns) within a
+ * types relation matrix.
+ *
+ * @param m Types relation matrix to query.
+ *
+ * @return Number of types in the matrix.
+ */
+	extern size_t apol_types_relation_matrix_get_size(const apol_types_relation_matrix_t * m);
+
+/**
+ * Return the type for a row (or column) of a types relation matrix.
+ *
+ * @param m Types relation matrix to query.
+ * @param i Index of the row, less than
+ * apol_types_relation_matrix_get_size().
+ *
+ * @return Type for the row, or NULL upon error.
+ */
+	extern const qpol_type_t *apol_types_relation_matrix_get_type(const apol_types_relation_matrix_t * m, size_t i);
+
+/**
+ * Return how similar two types within a matrix are.  The matrix is
+ * symmetric, and every type is completely similar to itself.
+ *
+ * @param m Types relation matrix to query.
+ * @param i Row of the first type.
+ * @param j Row of the second type.
+ *
+ * @return Similarity between 0.0 (no features in common) and 1.0
+ * (identical features), or 0.0 upon error.
+ */
+	extern double apol_types_relation_matrix_get_similarity(const apol_types_relation_matrix_t * m, size_t i, size_t j);
+
+/**
+ * Return the number of attributes, roles, users, or accessed types
+ * that two types within a matrix have in common.
+ *
+ * @param m Types relation matrix to query.
+ * @param i Row of the first type.
+ * @param j Row of the second type.
+ * @param feature One of APOL_TYPES_RELATION_COMMON_ATTRIBS,
+ * APOL_TYPES_RELATION_COMMON_ROLES, APOL_TYPES_RELATION_COMMON_USERS,
+ * or APOL_TYPES_RELATION_SIMILAR_ACCESS.  It must have been
+ * considered when the matrix was built.
+ *
+ * @return Number of features in common, or 0 upon error (in which
+ * case errno will be set).
+ */
+	extern size_t apol_types_relation_matrix_get_common(const apol_types_relation_matrix_t * m, size_t i, size_t j,
+							    unsigned int feature);
+
 /*************** functions to access types relation results ***************/
 
 /**
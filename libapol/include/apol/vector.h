@@ -154,6 +154,17 @@ extern "C"
  */
 	extern void apol_vector_destroy(apol_vector_t ** v);
 
+/**
+ *  Remove all elements from a vector, invoking the free function that
+ *  was stored within the vector when it was created upon each one.
+ *  The vector keeps its capacity, so it may be refilled without
+ *  reallocating.
+ *
+ *  @param v Vector to empty.  If NULL then this function does
+ *  nothing.
+ */
+	extern void apol_vector_clear(apol_vector_t * v);
+
 /**
  *  Get the number of elements in the vector.
  *
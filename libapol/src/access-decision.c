@@ -0,0 +1,785 @@
+/**
+ *  @file
+ *  Implementation of the access decision engine, which combines type
+ *  enforcement rules, conditional rules, constraints, and MLS
+ *  constraints as the kernel would.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "policy-query-internal.h"
+
+#include <apol/access-decision.h>
+#include <errno.h>
+#include <string.h>
+
+/* key of an access vector: the values of a rule's source type (or
+ * attribute), target type (or attribute), and class */
+typedef struct apol_av_key
+{
+	uint32_t source, target, obj_class;
+} apol_av_key_t;
+
+/* a conditional rule's contribution to an access vector */
+typedef struct apol_av_cond_rule
+{
+	size_t cond;
+	/** 1 if the rule applies when its conditional is true, 0 if
+	 *  when false */
+	uint32_t which_list;
+	uint32_t rule_type;
+	uint32_t perms;
+} apol_av_cond_rule_t;
+
+/* the combined access vectors of every rule with the same key */
+typedef struct apol_av_entry
+{
+	apol_av_key_t key;
+	uint32_t allowed, auditallow, dontaudit;
+	/** this entry's conditional rules are cond_rules[cond_start]
+	 *  through cond_rules[cond_start + num_cond - 1] */
+	size_t cond_start, num_cond;
+} apol_av_entry_t;
+
+/* one rule read from the policy, used while building */
+typedef struct apol_av_record
+{
+	apol_av_key_t key;
+	apol_av_cond_rule_t rule;
+	int is_cond;
+} apol_av_record_t;
+
+/* one instruction of a compiled conditional expression, in postfix
+ * order; code is one of QPOL_COND_EXPR_* */
+typedef struct apol_cond_insn
+{
+	uint32_t code, bool_val;
+} apol_cond_insn_t;
+
+typedef struct apol_cond_program
+{
+	const qpol_cond_t *cond;
+	apol_cond_insn_t *insns;
+	size_t num_insns;
+} apol_cond_program_t;
+
+struct apol_access_engine
+{
+	const apol_policy_t *policy;
+	/** sorted by key */
+	apol_av_entry_t *entries;
+	size_t num_entries;
+	apol_av_cond_rule_t *cond_rules;
+	/** conditionals, sorted by their qpol_cond_t pointers */
+	apol_cond_program_t *conds;
+	size_t num_conds;
+	/** current truth value of each conditional */
+	unsigned char *cond_state;
+	/** state of each boolean, indexed by boolean value */
+	unsigned char *bool_state;
+	size_t num_bools;
+	/** for each type value, the values of the type and of its
+	 *  attributes are type_map[type_map_start[v]] through
+	 *  type_map[type_map_start[v + 1] - 1] */
+	size_t *type_map_start;
+	uint32_t *type_map;
+	size_t num_types;
+	/** type values of permissive types */
+	apol_bitmap_t *permissive;
+	apol_constraint_evaluator_t *constraints;
+};
+
+struct apol_access_decision
+{
+	uint32_t requested, granted, denied, audited;
+	/** requested permissions that no enabled allow rule grants */
+	uint32_t te_denied;
+	/** requested permissions denied by constraints and by MLS
+	 *  constraints, respectively */
+	uint32_t constraint_denied, mls_denied;
+	int is_permissive;
+};
+
+static int apol_av_key_comp(const apol_av_key_t * a, const apol_av_key_t * b)
+{
+	if (a->source != b->source)
+		return (a->source < b->source ? -1 : 1);
+	if (a->target != b->target)
+		return (a->target < b->target ? -1 : 1);
+	if (a->obj_class != b->obj_class)
+		return (a->obj_class < b->obj_class ? -1 : 1);
+	return 0;
+}
+
+static int apol_av_record_comp(const void *a, const void *b)
+{
+	return apol_av_key_comp(&((const apol_av_record_t *)a)->key, &((const apol_av_record_t *)b)->key);
+}
+
+static int apol_cond_program_comp(const void *a, const void *b)
+{
+	uintptr_t x = (uintptr_t) ((const apol_cond_program_t *)a)->cond;
+	uintptr_t y = (uintptr_t) ((const apol_cond_program_t *)b)->cond;
+	return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+/**
+ * Evaluate a compiled conditional expression against the engine's
+ * boolean state.
+ */
+static int apol_cond_program_run(const apol_access_engine_t * e, const apol_cond_program_t * prog, unsigned char *stack)
+{
+	size_t i, sp = 0;
+	for (i = 0; i < prog->num_insns; i++) {
+		const apol_cond_insn_t *insn = prog->insns + i;
+		if (insn->code == QPOL_COND_EXPR_BOOL) {
+			stack[sp++] = (insn->bool_val < e->num_bools ? e->bool_state[insn->bool_val] : 0);
+			continue;
+		}
+		if (insn->code == QPOL_COND_EXPR_NOT) {
+			stack[sp - 1] = !stack[sp - 1];
+			continue;
+		}
+		sp--;
+		switch (insn->code) {
+		case QPOL_COND_EXPR_OR:
+			stack[sp - 1] = stack[sp - 1] || stack[sp];
+			break;
+		case QPOL_COND_EXPR_AND:
+			stack[sp - 1] = stack[sp - 1] && stack[sp];
+			break;
+		case QPOL_COND_EXPR_XOR:
+			stack[sp - 1] = stack[sp - 1] != stack[sp];
+			break;
+		case QPOL_COND_EXPR_EQ:
+			stack[sp - 1] = stack[sp - 1] == stack[sp];
+			break;
+		case QPOL_COND_EXPR_NEQ:
+			stack[sp - 1] = stack[sp - 1] != stack[sp];
+			break;
+		}
+	}
+	return stack[0];
+}
+
+/**
+ * Recompute the truth value of every conditional.
+ */
+static int apol_access_engine_eval_conds(apol_access_engine_t * e)
+{
+	unsigned char *stack;
+	size_t i, max_insns = 1;
+	for (i = 0; i < e->num_conds; i++) {
+		if (e->conds[i].num_insns > max_insns)
+			max_insns = e->conds[i].num_insns;
+	}
+	if ((stack = malloc(max_insns)) == NULL) {
+		ERR(e->policy, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < e->num_conds; i++) {
+		e->cond_state[i] = (unsigned char)apol_cond_program_run(e, e->conds + i, stack);
+	}
+	free(stack);
+	return 0;
+}
+
+/**
+ * Read the policy's booleans and compile its conditional
+ * expressions.
+ */
+static int apol_access_engine_build_conds(apol_access_engine_t * e)
+{
+	const apol_policy_t *p = e->policy;
+	qpol_iterator_t *iter = NULL, *expr_iter = NULL;
+	size_t num, depth;
+	uint32_t val;
+	int state, retval = -1;
+
+	if (qpol_policy_get_bool_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_bool_t *b;
+		if (qpol_iterator_get_item(iter, (void **)&b) < 0 || qpol_bool_get_value(p->p, b, &val) < 0) {
+			goto cleanup;
+		}
+		if (val >= e->num_bools)
+			e->num_bools = (size_t) val + 1;
+	}
+	qpol_iterator_destroy(&iter);
+	if ((e->bool_state = calloc(e->num_bools + 1, 1)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_bool_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_bool_t *b;
+		if (qpol_iterator_get_item(iter, (void **)&b) < 0 || qpol_bool_get_value(p->p, b, &val) < 0 ||
+		    qpol_bool_get_state(p->p, b, &state) < 0) {
+			goto cleanup;
+		}
+		e->bool_state[val] = (state != 0);
+	}
+	qpol_iterator_destroy(&iter);
+
+	if (qpol_policy_get_cond_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &num) < 0) {
+		goto cleanup;
+	}
+	if ((e->conds = calloc(num + 1, sizeof(*e->conds))) == NULL || (e->cond_state = calloc(num + 1, 1)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter) && e->num_conds < num; qpol_iterator_next(iter)) {
+		apol_cond_program_t *prog = e->conds + e->num_conds;
+		size_t num_nodes;
+		if (qpol_iterator_get_item(iter, (void **)&prog->cond) < 0 ||
+		    qpol_cond_get_expr_node_iter(p->p, prog->cond, &expr_iter) < 0 || qpol_iterator_get_size(expr_iter, &num_nodes) < 0) {
+			goto cleanup;
+		}
+		e->num_conds++;
+		if ((prog->insns = calloc(num_nodes + 1, sizeof(*prog->insns))) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		for (depth = 0; !qpol_iterator_end(expr_iter) && prog->num_insns < num_nodes; qpol_iterator_next(expr_iter)) {
+			qpol_cond_expr_node_t *node;
+			apol_cond_insn_t *insn = prog->insns + prog->num_insns;
+			if (qpol_iterator_get_item(expr_iter, (void **)&node) < 0 ||
+			    qpol_cond_expr_node_get_expr_type(p->p, node, &insn->code) < 0) {
+				goto cleanup;
+			}
+			if (insn->code == QPOL_COND_EXPR_BOOL) {
+				qpol_bool_t *b;
+				if (qpol_cond_expr_node_get_bool(p->p, node, &b) < 0 || qpol_bool_get_value(p->p, b, &insn->bool_val) < 0) {
+					goto cleanup;
+				}
+				depth++;
+			} else if (insn->code == QPOL_COND_EXPR_NOT) {
+				if (depth < 1)
+					goto malformed;
+			} else if (insn->code >= QPOL_COND_EXPR_OR && insn->code <= QPOL_COND_EXPR_NEQ) {
+				if (depth < 2)
+					goto malformed;
+				depth--;
+			} else {
+				goto malformed;
+			}
+			prog->num_insns++;
+		}
+		qpol_iterator_destroy(&expr_iter);
+		if (depth != 1) {
+			goto malformed;
+		}
+	}
+	qsort(e->conds, e->num_conds, sizeof(*e->conds), apol_cond_program_comp);
+	retval = apol_access_engine_eval_conds(e);
+	goto cleanup;
+
+      malformed:
+	ERR(p, "%s", "Malformed conditional expression.");
+	errno = EIO;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&expr_iter);
+	return retval;
+}
+
+/**
+ * Find the index of a conditional within the engine.
+ */
+static int apol_access_engine_find_cond(const apol_access_engine_t * e, const qpol_cond_t * cond, size_t * idx)
+{
+	apol_cond_program_t key, *found;
+	key.cond = cond;
+	if ((found = bsearch(&key, e->conds, e->num_conds, sizeof(*e->conds), apol_cond_program_comp)) == NULL) {
+		return -1;
+	}
+	*idx = (size_t) (found - e->conds);
+	return 0;
+}
+
+/**
+ * Read every allow, auditallow, and dontaudit rule, and merge those
+ * with the same key into one access vector entry.
+ */
+static int apol_access_engine_build_entries(apol_access_engine_t * e)
+{
+	const apol_policy_t *p = e->policy;
+	qpol_iterator_t *iter = NULL;
+	apol_av_record_t *records = NULL;
+	size_t num = 0, num_records = 0, num_cond = 0, i;
+	int retval = -1;
+
+	if (qpol_policy_get_avrule_iter(p->p, QPOL_RULE_ALLOW | QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT, &iter) < 0 ||
+	    qpol_iterator_get_size(iter, &num) < 0) {
+		goto cleanup;
+	}
+	if ((records = calloc(num + 1, sizeof(*records))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter) && num_records < num; qpol_iterator_next(iter)) {
+		qpol_avrule_t *rule;
+		const qpol_type_t *source, *target;
+		const qpol_class_t *obj_class;
+		const qpol_cond_t *cond;
+		apol_av_record_t *rec = records + num_records;
+		if (qpol_iterator_get_item(iter, (void **)&rule) < 0 ||
+		    qpol_avrule_get_source_type(p->p, rule, &source) < 0 ||
+		    qpol_avrule_get_target_type(p->p, rule, &target) < 0 ||
+		    qpol_avrule_get_object_class(p->p, rule, &obj_class) < 0 ||
+		    qpol_type_get_value(p->p, source, &rec->key.source) < 0 ||
+		    qpol_type_get_value(p->p, target, &rec->key.target) < 0 ||
+		    qpol_class_get_value(p->p, obj_class, &rec->key.obj_class) < 0 ||
+		    qpol_avrule_get_rule_type(p->p, rule, &rec->rule.rule_type) < 0 ||
+		    qpol_avrule_get_perm_mask(p->p, rule, &rec->rule.perms) < 0 || qpol_avrule_get_cond(p->p, rule, &cond) < 0) {
+			goto cleanup;
+		}
+		if (cond != NULL) {
+			if (qpol_avrule_get_which_list(p->p, rule, &rec->rule.which_list) < 0) {
+				goto cleanup;
+			}
+			if (apol_access_engine_find_cond(e, cond, &rec->rule.cond) < 0) {
+				ERR(p, "%s", "Rule refers to an unknown conditional.");
+				errno = EIO;
+				goto cleanup;
+			}
+			rec->is_cond = 1;
+			num_cond++;
+		}
+		num_records++;
+	}
+	qsort(records, num_records, sizeof(*records), apol_av_record_comp);
+
+	if ((e->entries = calloc(num_records + 1, sizeof(*e->entries))) == NULL ||
+	    (e->cond_rules = calloc(num_cond + 1, sizeof(*e->cond_rules))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	num_cond = 0;
+	for (i = 0; i < num_records; i++) {
+		apol_av_record_t *rec = records + i;
+		apol_av_entry_t *entry;
+		if (e->num_entries == 0 || apol_av_key_comp(&e->entries[e->num_entries - 1].key, &rec->key) != 0) {
+			entry = e->entries + e->num_entries++;
+			entry->key = rec->key;
+			entry->cond_start = num_cond;
+		}
+		entry = e->entries + e->num_entries - 1;
+		if (rec->is_cond) {
+			e->cond_rules[num_cond++] = rec->rule;
+			entry->num_cond++;
+		} else if (rec->rule.rule_type == QPOL_RULE_ALLOW) {
+			entry->allowed |= rec->rule.perms;
+		} else if (rec->rule.rule_type == QPOL_RULE_AUDITALLOW) {
+			entry->auditallow |= rec->rule.perms;
+		} else {
+			entry->dontaudit |= rec->rule.perms;
+		}
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	free(records);
+	return retval;
+}
+
+/**
+ * Record each type's attributes, and which types are permissive.
+ */
+static int apol_access_engine_build_types(apol_access_engine_t * e)
+{
+	const apol_policy_t *p = e->policy;
+	qpol_iterator_t *iter = NULL, *attr_iter = NULL;
+	apol_vector_t **attrs = NULL;
+	size_t num_map = 0, i, j;
+	uint32_t val, attr_val;
+	int retval = -1;
+
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_type_t *type;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &val) < 0) {
+			goto cleanup;
+		}
+		if (val >= e->num_types)
+			e->num_types = (size_t) val + 1;
+	}
+	qpol_iterator_destroy(&iter);
+	if ((attrs = calloc(e->num_types, sizeof(apol_vector_t *))) == NULL ||
+	    (e->type_map_start = calloc(e->num_types + 1, sizeof(size_t))) == NULL ||
+	    (e->permissive = apol_bitmap_create(e->num_types)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_type_t *type, *attr;
+		unsigned char isattr, isalias, ispermissive;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &val) < 0 ||
+		    qpol_type_get_isattr(p->p, type, &isattr) < 0 || qpol_type_get_isalias(p->p, type, &isalias) < 0) {
+			goto cleanup;
+		}
+		if (isattr || isalias || attrs[val] != NULL) {
+			continue;
+		}
+		if (qpol_type_get_ispermissive(p->p, type, &ispermissive) < 0) {
+			goto cleanup;
+		}
+		if (ispermissive)
+			apol_bitmap_set(e->permissive, val);
+		if ((attrs[val] = apol_vector_create(NULL)) == NULL || apol_vector_append(attrs[val], (void *)((size_t) val)) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if (qpol_type_get_attr_iter(p->p, type, &attr_iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(attr_iter); qpol_iterator_next(attr_iter)) {
+			if (qpol_iterator_get_item(attr_iter, (void **)&attr) < 0 || qpol_type_get_value(p->p, attr, &attr_val) < 0) {
+				goto cleanup;
+			}
+			if (apol_vector_append(attrs[val], (void *)((size_t) attr_val)) < 0) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+		}
+		qpol_iterator_destroy(&attr_iter);
+		num_map += apol_vector_get_size(attrs[val]);
+	}
+
+	if ((e->type_map = calloc(num_map + 1, sizeof(uint32_t))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (i = 0, num_map = 0; i < e->num_types; i++) {
+		e->type_map_start[i] = num_map;
+		for (j = 0; j < apol_vector_get_size(attrs[i]); j++)
+			e->type_map[num_map++] = (uint32_t) ((size_t) apol_vector_get_element(attrs[i], j));
+	}
+	e->type_map_start[e->num_types] = num_map;
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&attr_iter);
+	if (attrs != NULL) {
+		for (i = 0; i < e->num_types; i++)
+			apol_vector_destroy(&attrs[i]);
+		free(attrs);
+	}
+	return retval;
+}
+
+apol_access_engine_t *apol_access_engine_create(const apol_policy_t * p)
+{
+	apol_access_engine_t *e = NULL;
+	int error;
+
+	if (p == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((e = calloc(1, sizeof(*e))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	e->policy = p;
+	/* conditionals must be known before rules refer to them */
+	if (apol_access_engine_build_conds(e) < 0 || apol_access_engine_build_entries(e) < 0 ||
+	    apol_access_engine_build_types(e) < 0 || (e->constraints = apol_constraint_evaluator_create(p)) == NULL) {
+		error = errno;
+		apol_access_engine_destroy(&e);
+		errno = error;
+		return NULL;
+	}
+	return e;
+}
+
+void apol_access_engine_destroy(apol_access_engine_t ** e)
+{
+	size_t i;
+	if (e == NULL || *e == NULL)
+		return;
+	free((*e)->entries);
+	free((*e)->cond_rules);
+	if ((*e)->conds != NULL) {
+		for (i = 0; i < (*e)->num_conds; i++)
+			free((*e)->conds[i].insns);
+		free((*e)->conds);
+	}
+	free((*e)->cond_state);
+	free((*e)->bool_state);
+	free((*e)->type_map_start);
+	free((*e)->type_map);
+	apol_bitmap_destroy(&(*e)->permissive);
+	apol_constraint_evaluator_destroy(&(*e)->constraints);
+	free(*e);
+	*e = NULL;
+}
+
+int apol_access_engine_set_bool(apol_access_engine_t * e, const char *name, int state)
+{
+	qpol_bool_t *b;
+	uint32_t val;
+	if (e == NULL || name == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_bool_by_name(e->policy->p, name, &b) < 0 || qpol_bool_get_value(e->policy->p, b, &val) < 0) {
+		return -1;
+	}
+	if (val >= e->num_bools) {
+		errno = EINVAL;
+		return -1;
+	}
+	e->bool_state[val] = (state != 0);
+	return apol_access_engine_eval_conds(e);
+}
+
+int apol_access_engine_get_perm_mask(const apol_access_engine_t * e, const char *class_name, const apol_vector_t * perms,
+				     uint32_t * mask)
+{
+	const qpol_class_t *obj_class;
+	uint32_t val;
+	size_t i;
+	if (mask != NULL)
+		*mask = 0;
+	if (e == NULL || class_name == NULL || perms == NULL || mask == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_class_by_name(e->policy->p, class_name, &obj_class) < 0) {
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(perms); i++) {
+		const char *perm = apol_vector_get_element(perms, i);
+		if (qpol_class_get_perm_value(e->policy->p, obj_class, perm, &val) < 0) {
+			return -1;
+		}
+		if (val == 0 || val > 32) {
+			ERR(e->policy, "Class %s has no permission %s.", class_name, perm);
+			errno = EINVAL;
+			return -1;
+		}
+		*mask |= (uint32_t) 1 << (val - 1);
+	}
+	return 0;
+}
+
+static const apol_av_entry_t *apol_access_engine_find_entry(const apol_access_engine_t * e, const apol_av_key_t * key)
+{
+	size_t lo = 0, hi = e->num_entries;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = apol_av_key_comp(&e->entries[mid].key, key);
+		if (cmp == 0)
+			return e->entries + mid;
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return NULL;
+}
+
+/**
+ * Look up the value of a context's type.
+ */
+static int apol_access_engine_type_value(const apol_access_engine_t * e, const apol_context_t * context, uint32_t * val)
+{
+	const qpol_type_t *type;
+	if (context == NULL || apol_context_get_type(context) == NULL) {
+		ERR(e->policy, "%s", "Access decisions require complete contexts.");
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_type_by_name(e->policy->p, apol_context_get_type(context), &type) < 0 ||
+	    qpol_type_get_value(e->policy->p, type, val) < 0) {
+		return -1;
+	}
+	if (*val >= e->num_types) {
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+int apol_access_engine_decide(const apol_access_engine_t * e, const apol_context_t * scontext, const apol_context_t * tcontext,
+			      const char *class_name, uint32_t requested, apol_access_decision_t ** d)
+{
+	const qpol_class_t *obj_class;
+	apol_av_key_t key;
+	uint32_t source, target, allowed = 0, auditallow = 0, dontaudit = 0, constraint_denied, mls_denied;
+	size_t i, j, k;
+
+	if (d != NULL)
+		*d = NULL;
+	if (e == NULL || class_name == NULL || d == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (apol_access_engine_type_value(e, scontext, &source) < 0 || apol_access_engine_type_value(e, tcontext, &target) < 0 ||
+	    qpol_policy_get_class_by_name(e->policy->p, class_name, &obj_class) < 0 ||
+	    qpol_class_get_value(e->policy->p, obj_class, &key.obj_class) < 0) {
+		return -1;
+	}
+
+	/* combine the access vectors of every pairing of the source's
+	 * and target's types and attributes */
+	for (i = e->type_map_start[source]; i < e->type_map_start[source + 1]; i++) {
+		key.source = e->type_map[i];
+		for (j = e->type_map_start[target]; j < e->type_map_start[target + 1]; j++) {
+			const apol_av_entry_t *entry;
+			key.target = e->type_map[j];
+			if ((entry = apol_access_engine_find_entry(e, &key)) == NULL)
+				continue;
+			allowed |= entry->allowed;
+			auditallow |= entry->auditallow;
+			dontaudit |= entry->dontaudit;
+			for (k = entry->cond_start; k < entry->cond_start + entry->num_cond; k++) {
+				const apol_av_cond_rule_t *rule = e->cond_rules + k;
+				if (e->cond_state[rule->cond] != rule->which_list)
+					continue;
+				if (rule->rule_type == QPOL_RULE_ALLOW)
+					allowed |= rule->perms;
+				else if (rule->rule_type == QPOL_RULE_AUDITALLOW)
+					auditallow |= rule->perms;
+				else
+					dontaudit |= rule->perms;
+			}
+		}
+	}
+
+	if (apol_constraint_evaluator_get_denied_split(e->constraints, scontext, tcontext, class_name, &constraint_denied, &mls_denied)
+	    < 0) {
+		return -1;
+	}
+	if ((*d = calloc(1, sizeof(**d))) == NULL) {
+		ERR(e->policy, "%s", strerror(errno));
+		return -1;
+	}
+	(*d)->requested = requested;
+	(*d)->te_denied = requested & ~allowed;
+	(*d)->constraint_denied = requested & allowed & constraint_denied;
+	(*d)->mls_denied = requested & allowed & mls_denied;
+	(*d)->granted = requested & allowed & ~(constraint_denied | mls_denied);
+	(*d)->denied = requested & ~(*d)->granted;
+	(*d)->audited = ((*d)->granted & auditallow) | ((*d)->denied & ~dontaudit);
+	(*d)->is_permissive = apol_bitmap_get(e->permissive, source);
+	return 0;
+}
+
+static void apol_access_decision_free(void *elem)
+{
+	free(elem);
+}
+
+int apol_access_engine_decide_batch(const apol_access_engine_t * e, const apol_vector_t * scontexts,
+				    const apol_vector_t * tcontexts, const apol_vector_t * class_names, const uint32_t * requested,
+				    apol_vector_t ** decisions)
+{
+	apol_access_decision_t *d;
+	size_t i, num;
+
+	if (decisions != NULL)
+		*decisions = NULL;
+	if (e == NULL || scontexts == NULL || tcontexts == NULL || class_names == NULL || decisions == NULL ||
+	    (num = apol_vector_get_size(scontexts)) != apol_vector_get_size(tcontexts) ||
+	    num != apol_vector_get_size(class_names) || (num > 0 && requested == NULL)) {
+		errno = EINVAL;
+		return -1;
+	}
+	if ((*decisions = apol_vector_create_with_capacity(num, apol_access_decision_free)) == NULL) {
+		ERR(e->policy, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < num; i++) {
+		if (apol_access_engine_decide(e, apol_vector_get_element(scontexts, i), apol_vector_get_element(tcontexts, i),
+					      apol_vector_get_element(class_names, i), requested[i], &d) < 0) {
+			apol_vector_destroy(decisions);
+			return -1;
+		}
+		if (apol_vector_append(*decisions, d) < 0) {
+			ERR(e->policy, "%s", strerror(errno));
+			free(d);
+			apol_vector_destroy(decisions);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+void apol_access_decision_destroy(apol_access_decision_t ** d)
+{
+	if (d != NULL && *d != NULL) {
+		apol_access_decision_free(*d);
+		*d = NULL;
+	}
+}
+
+uint32_t apol_access_decision_get_requested(const apol_access_decision_t * d)
+{
+	return (d != NULL ? d->requested : 0);
+}
+
+uint32_t apol_access_decision_get_granted(const apol_access_decision_t * d)
+{
+	return (d != NULL ? d->granted : 0);
+}
+
+uint32_t apol_access_decision_get_denied(const apol_access_decision_t * d)
+{
+	return (d != NULL ? d->denied : 0);
+}
+
+uint32_t apol_access_decision_get_audited(const apol_access_decision_t * d)
+{
+	return (d != NULL ? d->audited : 0);
+}
+
+int apol_access_decision_get_is_permissive(const apol_access_decision_t * d)
+{
+	return (d != NULL ? d->is_permissive : 0);
+}
+
+int apol_access_decision_get_reason(const apol_access_decision_t * d, uint32_t perm_value)
+{
+	uint32_t bit;
+	if (d == NULL || perm_value == 0 || perm_value > 32) {
+		errno = EINVAL;
+		return -1;
+	}
+	bit = (uint32_t) 1 << (perm_value - 1);
+	if (!(d->requested & bit))
+		return APOL_ACCESS_NOT_REQUESTED;
+	if (d->granted & bit)
+		return APOL_ACCESS_ALLOWED;
+	if (d->te_denied & bit)
+		return APOL_ACCESS_DENIED_TE;
+	if (d->mls_denied & bit)
+		return APOL_ACCESS_DENIED_MLS;
+	return APOL_ACCESS_DENIED_CONSTRAINT;
+}
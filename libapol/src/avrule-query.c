@@ -738,178 +738,130 @@ apol_vector_t *apol_avrule_list_to_syn_avrules(const apol_policy_t * p, const ap
 	return v;
 }
 
-char *apol_avrule_render(const apol_policy_t * policy, const qpol_avrule_t * rule)
+int apol_avrule_render_buf(const apol_policy_t * policy, const qpol_avrule_t * rule, apol_render_buf_t * buf)
 {
-	char *tmp = NULL;
-	const char *rule_type_str, *tmp_name = NULL;
-	int error = 0;
-	uint32_t rule_type = 0;
+	const char *rule_type_str, *source_name, *target_name, *class_name;
+	const char *const *perm_names;
+	uint32_t rule_type = 0, class_value, perms;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
-	qpol_iterator_t *iter = NULL;
-	size_t tmp_sz = 0, num_perms = 0;
+	size_t mark, num_names, num_perms = 0, i;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
+	mark = apol_render_buf_get_length(buf);
 
 	/* rule type */
 	if (qpol_avrule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_ALLOW | QPOL_RULE_NEVERALLOW | QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT))) {
 		ERR(policy, "%s", "Invalid AV rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get AV rule type's string");
 		errno = EINVAL;
-		return NULL;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
-	}
-
-	/* source type */
-	if (qpol_avrule_get_source_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+		return -1;
 	}
 
-	/* target type */
-	if (qpol_avrule_get_target_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s : ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+	/* source type, target type, and object class */
+	if (qpol_avrule_get_source_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &source_name) ||
+	    qpol_avrule_get_target_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &target_name) ||
+	    qpol_avrule_get_object_class(policy->p, rule, &obj_class) ||
+	    qpol_class_get_name(policy->p, obj_class, &class_name) || qpol_class_get_value(policy->p, obj_class, &class_value)) {
+		return -1;
 	}
 
-	/* object class */
-	if (qpol_avrule_get_object_class(policy->p, rule, &obj_class)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_class_get_name(policy->p, obj_class, &tmp_name)) {
-		error = errno;
-		goto err;
+	/* perms, named from the policy's cache rather than allocated
+	 * anew for each rule */
+	if (qpol_avrule_get_perm_mask(policy->p, rule, &perms) ||
+	    apol_policy_get_perm_names(policy, class_value, &perm_names, &num_names)) {
+		return -1;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+	for (i = 0; i < num_names; i++) {
+		if ((perms & (1U << i)) && perm_names[i] != NULL)
+			num_perms++;
 	}
 
-	/* perms */
-	if (qpol_avrule_get_perm_iter(policy->p, rule, &iter)) {
-		error = errno;
+	if (apol_render_buf_appendf(buf, "%s %s %s : %s ", rule_type_str, source_name, target_name, class_name) ||
+	    (num_perms > 1 && apol_render_buf_append(buf, "{ "))) {
 		goto err;
 	}
-	if (qpol_iterator_get_size(iter, &num_perms)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
-	}
-	if (num_perms > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
-			error = errno;
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
-	}
-	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-		char *perm_name = NULL;
-		if (qpol_iterator_get_item(iter, (void **)&perm_name)) {
-			error = errno;
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", perm_name)) {
-			error = errno;
-			free(perm_name);
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
-		free(perm_name);
-		tmp_name = NULL;
-	}
-	if (num_perms > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
-			error = errno;
-			ERR(policy, "%s", strerror(error));
+	for (i = 0; i < num_names; i++) {
+		if (!(perms & (1U << i)) || perm_names[i] == NULL)
+			continue;
+		if (apol_render_buf_append(buf, perm_names[i]) || apol_render_buf_append(buf, " ")) {
 			goto err;
 		}
 	}
-
-	if (apol_str_append(&tmp, &tmp_sz, ";")) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
+	if ((num_perms > 1 && apol_render_buf_append(buf, "} ")) || apol_render_buf_append(buf, ";")) {
 		goto err;
 	}
-
-	qpol_iterator_destroy(&iter);
-	return tmp;
+	return render_buf_commit(policy, buf);
 
       err:
-	free(tmp);
-	qpol_iterator_destroy(&iter);
-	errno = error;
-	return NULL;
+	ERR(policy, "%s", strerror(errno));
+	render_buf_rollback(buf, mark);
+	return -1;
 }
 
-char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule_t * rule)
+char *apol_avrule_render(const apol_policy_t * policy, const qpol_avrule_t * rule)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(policy, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_avrule_render_buf(policy, rule, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
+}
+
+int apol_syn_avrule_render_buf(const apol_policy_t * policy, const qpol_syn_avrule_t * rule, apol_render_buf_t * buf)
 {
-	char *tmp = NULL;
 	const char *rule_type_str, *tmp_name = NULL;
 	int error = 0;
+	size_t mark;
 	uint32_t rule_type = 0, star = 0, comp = 0, self = 0;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
 	qpol_iterator_t *iter = NULL, *iter2 = NULL;
-	size_t tmp_sz = 0, iter_sz = 0, iter2_sz = 0;
+	size_t iter_sz = 0, iter2_sz = 0;
 	const qpol_type_set_t *set = NULL;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
+	mark = apol_render_buf_get_length(buf);
 
 	/* rule type */
 	if (qpol_syn_avrule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_ALLOW | QPOL_RULE_NEVERALLOW | QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT))) {
 		ERR(policy, "%s", "Invalid AV rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get AV rule type's string");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
+	if (apol_render_buf_appendf(buf, "%s ", rule_type_str)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -925,7 +877,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (star) {
-		if (apol_str_append(&tmp, &tmp_sz, "* ")) {
+		if (apol_render_buf_append(buf, "* ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -936,7 +888,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (comp) {
-			if (apol_str_append(&tmp, &tmp_sz, "~")) {
+			if (apol_render_buf_append(buf, "~")) {
 				error = errno;
 				ERR(policy, "%s", strerror(ENOMEM));
 				goto err;
@@ -956,7 +908,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+			if (apol_render_buf_append(buf, "{ ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(ENOMEM));
 				goto err;
@@ -972,7 +924,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -988,7 +940,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "-%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "-%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -997,7 +949,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		qpol_iterator_destroy(&iter);
 		qpol_iterator_destroy(&iter2);
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+			if (apol_render_buf_append(buf, "} ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1015,7 +967,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (star) {
-		if (apol_str_append(&tmp, &tmp_sz, "* ")) {
+		if (apol_render_buf_append(buf, "* ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1026,7 +978,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (comp) {
-			if (apol_str_append(&tmp, &tmp_sz, "~")) {
+			if (apol_render_buf_append(buf, "~")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1050,7 +1002,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (iter_sz + iter2_sz + self > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+			if (apol_render_buf_append(buf, "{ ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1066,7 +1018,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1082,7 +1034,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "-%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "-%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1091,14 +1043,14 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		qpol_iterator_destroy(&iter);
 		qpol_iterator_destroy(&iter2);
 		if (self) {
-			if (apol_str_append(&tmp, &tmp_sz, "self ")) {
+			if (apol_render_buf_append(buf, "self ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
 			}
 		}
 		if (iter_sz + iter2_sz + self > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+			if (apol_render_buf_append(buf, "} ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1106,7 +1058,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		}
 	}
 
-	if (apol_str_append(&tmp, &tmp_sz, ": ")) {
+	if (apol_render_buf_append(buf, ": ")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -1123,7 +1075,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+		if (apol_render_buf_append(buf, "{ ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1139,7 +1091,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			error = errno;
 			goto err;
 		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+		if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1147,7 +1099,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 	}
 	qpol_iterator_destroy(&iter);
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+		if (apol_render_buf_append(buf, "} ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1165,7 +1117,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+		if (apol_render_buf_append(buf, "{ ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1177,7 +1129,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			ERR(policy, "%s", strerror(error));
 			goto err;
 		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+		if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1185,25 +1137,43 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 	}
 	qpol_iterator_destroy(&iter);
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+		if (apol_render_buf_append(buf, "} ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
 		}
 	}
 
-	if (apol_str_append(&tmp, &tmp_sz, ";")) {
+	if (apol_render_buf_append(buf, ";")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
 	}
 
-	return tmp;
+	return render_buf_commit(policy, buf);
 
       err:
-	free(tmp);
+	render_buf_rollback(buf, mark);
 	qpol_iterator_destroy(&iter);
 	qpol_iterator_destroy(&iter2);
 	errno = error;
-	return NULL;
+	return -1;
+}
+
+char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule_t * rule)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(policy, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_syn_avrule_render_buf(policy, rule, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
 }
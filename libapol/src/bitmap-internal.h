@@ -0,0 +1,50 @@
+/**
+ *  @file
+ *  Protected definitions for bitmaps.  Analyses within libapol that
+ *  need to walk a bitmap's words directly (for example, to build a
+ *  search frontier) may use these; all other code should use the
+ *  functions declared in apol/bitmap.h.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_BITMAP_INTERNAL_H
+#define APOL_BITMAP_INTERNAL_H
+
+#include <apol/bitmap.h>
+#include <limits.h>
+
+typedef unsigned long apol_bitmap_word_t;
+
+#define APOL_BITMAP_WORD_BITS (sizeof(apol_bitmap_word_t) * CHAR_BIT)
+#define APOL_BITMAP_WORDS(n) (((n) + APOL_BITMAP_WORD_BITS - 1) / APOL_BITMAP_WORD_BITS)
+#define APOL_BITMAP_SET(w, i) ((w)[(i) / APOL_BITMAP_WORD_BITS] |= (apol_bitmap_word_t) 1 << ((i) % APOL_BITMAP_WORD_BITS))
+#define APOL_BITMAP_GET(w, i) ((w)[(i) / APOL_BITMAP_WORD_BITS] & ((apol_bitmap_word_t) 1 << ((i) % APOL_BITMAP_WORD_BITS)))
+#define APOL_BITMAP_POPCOUNT(x) ((size_t) __builtin_popcountl(x))
+#define APOL_BITMAP_CTZ(x) ((size_t) __builtin_ctzl(x))
+
+struct apol_bitmap
+{
+	/** number of valid bits */
+	size_t size;
+	/** number of words allocated for the bits */
+	size_t num_words;
+	/** the bits themselves; bits at or beyond size are always clear */
+	apol_bitmap_word_t *words;
+};
+
+#endif
@@ -0,0 +1,231 @@
+/**
+ *  @file
+ *  Implementation of a fixed size bitmap, stored as an array of
+ *  machine words so that set operations work a word at a time.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <apol/bitmap.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitmap-internal.h"
+
+apol_bitmap_t *apol_bitmap_create(size_t size)
+{
+	apol_bitmap_t *b = NULL;
+	if ((b = calloc(1, sizeof(*b))) == NULL) {
+		return NULL;
+	}
+	b->size = size;
+	b->num_words = APOL_BITMAP_WORDS(size);
+	if (b->num_words > 0 && (b->words = calloc(b->num_words, sizeof(apol_bitmap_word_t))) == NULL) {
+		free(b);
+		return NULL;
+	}
+	return b;
+}
+
+apol_bitmap_t *apol_bitmap_create_from_bitmap(const apol_bitmap_t * b)
+{
+	apol_bitmap_t *new_b = NULL;
+	if (b == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((new_b = apol_bitmap_create(b->size)) == NULL) {
+		return NULL;
+	}
+	if (b->num_words > 0)
+		memcpy(new_b->words, b->words, b->num_words * sizeof(apol_bitmap_word_t));
+	return new_b;
+}
+
+void apol_bitmap_destroy(apol_bitmap_t ** b)
+{
+	if (!b || !(*b))
+		return;
+	free((*b)->words);
+	free(*b);
+	*b = NULL;
+}
+
+size_t apol_bitmap_get_size(const apol_bitmap_t * b)
+{
+	if (b == NULL)
+		return 0;
+	return b->size;
+}
+
+int apol_bitmap_set(apol_bitmap_t * b, size_t idx)
+{
+	if (b == NULL || idx >= b->size) {
+		errno = EINVAL;
+		return -1;
+	}
+	APOL_BITMAP_SET(b->words, idx);
+	return 0;
+}
+
+int apol_bitmap_clear(apol_bitmap_t * b, size_t idx)
+{
+	if (b == NULL || idx >= b->size) {
+		errno = EINVAL;
+		return -1;
+	}
+	b->words[idx / APOL_BITMAP_WORD_BITS] &= ~((apol_bitmap_word_t) 1 << (idx % APOL_BITMAP_WORD_BITS));
+	return 0;
+}
+
+int apol_bitmap_get(const apol_bitmap_t * b, size_t idx)
+{
+	if (b == NULL || idx >= b->size)
+		return 0;
+	return APOL_BITMAP_GET(b->words, idx) ? 1 : 0;
+}
+
+void apol_bitmap_clear_all(apol_bitmap_t * b)
+{
+	if (b == NULL || b->num_words == 0)
+		return;
+	memset(b->words, 0, b->num_words * sizeof(apol_bitmap_word_t));
+}
+
+int apol_bitmap_or(apol_bitmap_t * dest, const apol_bitmap_t * src)
+{
+	size_t i, n;
+	apol_bitmap_word_t changed = 0;
+	if (dest == NULL || src == NULL)
+		return 0;
+	n = (dest->num_words < src->num_words ? dest->num_words : src->num_words);
+	for (i = 0; i < n; i++) {
+		apol_bitmap_word_t w = dest->words[i] | src->words[i];
+		/* do not let bits beyond the end of dest become set */
+		if (i == dest->num_words - 1 && dest->size % APOL_BITMAP_WORD_BITS)
+			w &= ((apol_bitmap_word_t) 1 << (dest->size % APOL_BITMAP_WORD_BITS)) - 1;
+		changed |= w ^ dest->words[i];
+		dest->words[i] = w;
+	}
+	return changed ? 1 : 0;
+}
+
+int apol_bitmap_and(apol_bitmap_t * dest, const apol_bitmap_t * src)
+{
+	size_t i, n;
+	apol_bitmap_word_t changed = 0;
+	if (dest == NULL || src == NULL)
+		return 0;
+	n = (dest->num_words < src->num_words ? dest->num_words : src->num_words);
+	for (i = 0; i < n; i++) {
+		apol_bitmap_word_t w = dest->words[i] & src->words[i];
+		changed |= w ^ dest->words[i];
+		dest->words[i] = w;
+	}
+	for (; i < dest->num_words; i++) {
+		changed |= dest->words[i];
+		dest->words[i] = 0;
+	}
+	return changed ? 1 : 0;
+}
+
+int apol_bitmap_andnot(apol_bitmap_t * dest, const apol_bitmap_t * src)
+{
+	size_t i, n;
+	apol_bitmap_word_t changed = 0;
+	if (dest == NULL || src == NULL)
+		return 0;
+	n = (dest->num_words < src->num_words ? dest->num_words : src->num_words);
+	for (i = 0; i < n; i++) {
+		changed |= dest->words[i] & src->words[i];
+		dest->words[i] &= ~src->words[i];
+	}
+	return changed ? 1 : 0;
+}
+
+size_t apol_bitmap_count(const apol_bitmap_t * b)
+{
+	size_t i, count = 0;
+	if (b == NULL)
+		return 0;
+	for (i = 0; i < b->num_words; i++)
+		count += APOL_BITMAP_POPCOUNT(b->words[i]);
+	return count;
+}
+
+size_t apol_bitmap_count_intersection(const apol_bitmap_t * a, const apol_bitmap_t * b)
+{
+	size_t i, n, count = 0;
+	if (a == NULL || b == NULL)
+		return 0;
+	n = (a->num_words < b->num_words ? a->num_words : b->num_words);
+	for (i = 0; i < n; i++)
+		count += APOL_BITMAP_POPCOUNT(a->words[i] & b->words[i]);
+	return count;
+}
+
+int apol_bitmap_intersects(const apol_bitmap_t * a, const apol_bitmap_t * b)
+{
+	size_t i, n;
+	if (a == NULL || b == NULL)
+		return 0;
+	n = (a->num_words < b->num_words ? a->num_words : b->num_words);
+	for (i = 0; i < n; i++) {
+		if (a->words[i] & b->words[i])
+			return 1;
+	}
+	return 0;
+}
+
+int apol_bitmap_is_subset(const apol_bitmap_t * a, const apol_bitmap_t * b)
+{
+	size_t i;
+	if (a == NULL)
+		return 1;
+	for (i = 0; i < a->num_words; i++) {
+		apol_bitmap_word_t bw = (b != NULL && i < b->num_words ? b->words[i] : 0);
+		if (a->words[i] & ~bw)
+			return 0;
+	}
+	return 1;
+}
+
+int apol_bitmap_equal(const apol_bitmap_t * a, const apol_bitmap_t * b)
+{
+	return apol_bitmap_is_subset(a, b) && apol_bitmap_is_subset(b, a);
+}
+
+size_t apol_bitmap_next(const apol_bitmap_t * b, size_t idx)
+{
+	size_t i;
+	apol_bitmap_word_t w;
+	if (b == NULL)
+		return 0;
+	if (idx >= b->size)
+		return b->size;
+	i = idx / APOL_BITMAP_WORD_BITS;
+	w = b->words[i] & (~(apol_bitmap_word_t) 0 << (idx % APOL_BITMAP_WORD_BITS));
+	while (w == 0) {
+		if (++i >= b->num_words)
+			return b->size;
+		w = b->words[i];
+	}
+	idx = i * APOL_BITMAP_WORD_BITS + APOL_BITMAP_CTZ(w);
+	return (idx < b->size ? idx : b->size);
+}
@@ -215,3 +215,800 @@ int apol_validatetrans_query_set_regex(const apol_policy_t * p, apol_validatetra
 {
 	return apol_query_set_regex(p, &vt->flags, is_regex);
 }
+
+/******************** constraint evaluation ********************/
+
+/* One instruction of a compiled constraint expression.  The
+ * expression is kept in postfix order; code is one of
+ * QPOL_CEXPR_TYPE_*, op one of QPOL_CEXPR_OP_*, and sym the
+ * QPOL_CEXPR_SYM_* bits of the original expression node. */
+typedef struct apol_cexpr_insn
+{
+	uint32_t code, op, sym;
+	/** for QPOL_CEXPR_TYPE_NAMES, index into the evaluator's
+	 *  name sets */
+	size_t names;
+} apol_cexpr_insn_t;
+
+typedef struct apol_cexpr_program
+{
+	/** permissions governed by the constraint, as a mask where
+	 *  permission value v is bit (v - 1) */
+	uint32_t perms;
+	apol_cexpr_insn_t *insns;
+	size_t num_insns;
+	/** non-zero if the expression compares MLS levels */
+	int is_mls;
+} apol_cexpr_program_t;
+
+struct apol_constraint_evaluator
+{
+	const apol_policy_t *policy;
+	/** for each class value, a vector of apol_cexpr_program_t, or
+	 *  NULL if the class has no constraints */
+	apol_vector_t **programs;
+	size_t num_classes;
+	/** vector of apol_bitmap_t, each the user, role, or type
+	 *  values named by an expression node */
+	apol_vector_t *name_sets;
+	/** for each role value, the values of roles it dominates;
+	 *  built only if an expression compares roles by dominance */
+	apol_bitmap_t **role_dominates;
+	size_t num_roles;
+	/** deepest evaluation stack needed by any program */
+	size_t max_depth;
+};
+
+/* A context with each component replaced by its value.  The category
+ * bitmaps are owned by the context. */
+typedef struct apol_cexpr_context
+{
+	uint32_t user, role, type;
+	int has_range;
+	uint32_t low_sens, high_sens;
+	apol_bitmap_t *low_cats, *high_cats;
+} apol_cexpr_context_t;
+
+static void apol_cexpr_program_free(void *elem)
+{
+	apol_cexpr_program_t *prog = elem;
+	if (prog != NULL) {
+		free(prog->insns);
+		free(prog);
+	}
+}
+
+static void apol_cexpr_bitmap_free(void *elem)
+{
+	apol_bitmap_t *b = elem;
+	apol_bitmap_destroy(&b);
+}
+
+/**
+ * Add a value to a growing list, used while building a name set.
+ */
+static int apol_cexpr_append_value(apol_vector_t * v, uint32_t val, uint32_t * max_val)
+{
+	if (val > *max_val)
+		*max_val = val;
+	return apol_vector_append(v, (void *)((size_t) val));
+}
+
+/**
+ * Look up the value of one name within a names expression.  Type
+ * names may be attributes, whose member types are all added.
+ */
+static int apol_cexpr_name_values(const apol_policy_t * p, uint32_t sym, const char *name, apol_vector_t * v, uint32_t * max_val)
+{
+	uint32_t val;
+	size_t i;
+	if (sym & QPOL_CEXPR_SYM_USER) {
+		const qpol_user_t *user;
+		if (qpol_policy_get_user_by_name(p->p, name, &user) < 0 || qpol_user_get_value(p->p, user, &val) < 0) {
+			return -1;
+		}
+	} else if (sym & QPOL_CEXPR_SYM_ROLE) {
+		const qpol_role_t *role;
+		if (qpol_policy_get_role_by_name(p->p, name, &role) < 0 || qpol_role_get_value(p->p, role, &val) < 0) {
+			return -1;
+		}
+	} else {
+		const qpol_type_t *type;
+		apol_vector_t *types;
+		if (qpol_policy_get_type_by_name(p->p, name, &type) < 0 || (types = apol_query_expand_type(p, type)) == NULL) {
+			return -1;
+		}
+		for (i = 0; i < apol_vector_get_size(types); i++) {
+			if (qpol_type_get_value(p->p, apol_vector_get_element(types, i), &val) < 0 ||
+			    apol_cexpr_append_value(v, val, max_val) < 0) {
+				apol_vector_destroy(&types);
+				return -1;
+			}
+		}
+		apol_vector_destroy(&types);
+		return 0;
+	}
+	return apol_cexpr_append_value(v, val, max_val);
+}
+
+/**
+ * Build the bitmap of values named by a names expression node.
+ * Names prefixed with '-' are subtracted from the set.
+ *
+ * @param idx Set to the index of the new name set.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int apol_cexpr_compile_names(apol_constraint_evaluator_t * e, const qpol_constraint_expr_node_t * expr, uint32_t sym,
+				    size_t * idx)
+{
+	const apol_policy_t *p = e->policy;
+	qpol_iterator_t *iter = NULL;
+	apol_vector_t *inc = NULL, *sub = NULL;
+	apol_bitmap_t *b = NULL, *sub_b = NULL;
+	uint32_t max_val = 0;
+	char *name = NULL;
+	size_t i;
+	int retval = -1;
+
+	if ((inc = apol_vector_create(NULL)) == NULL || (sub = apol_vector_create(NULL)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_constraint_expr_node_get_names_iter(p->p, expr, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&name) < 0) {
+			goto cleanup;
+		}
+		if (name[0] == '-') {
+			if (apol_cexpr_name_values(p, sym, name + 1, sub, &max_val) < 0)
+				goto cleanup;
+		} else if (apol_cexpr_name_values(p, sym, name, inc, &max_val) < 0) {
+			goto cleanup;
+		}
+		free(name);
+		name = NULL;
+	}
+	if ((b = apol_bitmap_create((size_t) max_val + 1)) == NULL || (sub_b = apol_bitmap_create((size_t) max_val + 1)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(inc); i++)
+		apol_bitmap_set(b, (size_t) apol_vector_get_element(inc, i));
+	for (i = 0; i < apol_vector_get_size(sub); i++)
+		apol_bitmap_set(sub_b, (size_t) apol_vector_get_element(sub, i));
+	apol_bitmap_andnot(b, sub_b);
+	if (apol_vector_append(e->name_sets, b) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	*idx = apol_vector_get_size(e->name_sets) - 1;
+	b = NULL;
+	retval = 0;
+      cleanup:
+	free(name);
+	qpol_iterator_destroy(&iter);
+	apol_vector_destroy(&inc);
+	apol_vector_destroy(&sub);
+	apol_bitmap_destroy(&b);
+	apol_bitmap_destroy(&sub_b);
+	return retval;
+}
+
+/**
+ * Build the role dominance bitmaps, the first time an expression
+ * needs them.
+ */
+static int apol_cexpr_build_role_dominates(apol_constraint_evaluator_t * e)
+{
+	const apol_policy_t *p = e->policy;
+	qpol_iterator_t *iter = NULL, *dom_iter = NULL;
+	uint32_t val, dom_val;
+	int retval = -1;
+
+	if (e->role_dominates != NULL) {
+		return 0;
+	}
+	if (qpol_policy_get_role_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (e->num_roles = 0; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_role_t *role;
+		if (qpol_iterator_get_item(iter, (void **)&role) < 0 || qpol_role_get_value(p->p, role, &val) < 0) {
+			goto cleanup;
+		}
+		if (val >= e->num_roles)
+			e->num_roles = (size_t) val + 1;
+	}
+	qpol_iterator_destroy(&iter);
+	if ((e->role_dominates = calloc(e->num_roles, sizeof(apol_bitmap_t *))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_role_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_role_t *role, *dom;
+		if (qpol_iterator_get_item(iter, (void **)&role) < 0 || qpol_role_get_value(p->p, role, &val) < 0 ||
+		    qpol_role_get_dominate_iter(p->p, role, &dom_iter) < 0) {
+			goto cleanup;
+		}
+		if ((e->role_dominates[val] = apol_bitmap_create(e->num_roles)) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(dom_iter); qpol_iterator_next(dom_iter)) {
+			if (qpol_iterator_get_item(dom_iter, (void **)&dom) < 0 || qpol_role_get_value(p->p, dom, &dom_val) < 0) {
+				goto cleanup;
+			}
+			apol_bitmap_set(e->role_dominates[val], dom_val);
+		}
+		qpol_iterator_destroy(&dom_iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&dom_iter);
+	return retval;
+}
+
+/**
+ * Compile one constraint into a program and add it to its class.
+ */
+static int apol_cexpr_compile(apol_constraint_evaluator_t * e, const qpol_constraint_t * constraint)
+{
+	const apol_policy_t *p = e->policy;
+	qpol_iterator_t *iter = NULL;
+	const qpol_class_t *obj_class;
+	apol_cexpr_program_t *prog = NULL;
+	uint32_t class_val, perm_val;
+	size_t num, depth = 0;
+	char *perm = NULL;
+	int retval = -1;
+
+	if ((prog = calloc(1, sizeof(*prog))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_constraint_get_class(p->p, constraint, &obj_class) < 0 || qpol_class_get_value(p->p, obj_class, &class_val) < 0) {
+		goto cleanup;
+	}
+	if (qpol_constraint_get_perm_iter(p->p, constraint, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&perm) < 0 || qpol_class_get_perm_value(p->p, obj_class, perm, &perm_val) < 0) {
+			goto cleanup;
+		}
+		if (perm_val > 0 && perm_val <= 32)
+			prog->perms |= (uint32_t) 1 << (perm_val - 1);
+		free(perm);
+		perm = NULL;
+	}
+	qpol_iterator_destroy(&iter);
+
+	if (qpol_constraint_get_expr_iter(p->p, constraint, &iter) < 0 || qpol_iterator_get_size(iter, &num) < 0) {
+		goto cleanup;
+	}
+	if ((prog->insns = calloc(num + 1, sizeof(*prog->insns))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter) && prog->num_insns < num; qpol_iterator_next(iter)) {
+		qpol_constraint_expr_node_t *expr;
+		apol_cexpr_insn_t *insn = prog->insns + prog->num_insns;
+		if (qpol_iterator_get_item(iter, (void **)&expr) < 0 ||
+		    qpol_constraint_expr_node_get_expr_type(p->p, expr, &insn->code) < 0) {
+			goto cleanup;
+		}
+		switch (insn->code) {
+		case QPOL_CEXPR_TYPE_NOT:
+			if (depth < 1)
+				goto malformed;
+			break;
+		case QPOL_CEXPR_TYPE_AND:
+		case QPOL_CEXPR_TYPE_OR:
+			if (depth < 2)
+				goto malformed;
+			depth--;
+			break;
+		case QPOL_CEXPR_TYPE_ATTR:
+		case QPOL_CEXPR_TYPE_NAMES:
+			if (qpol_constraint_expr_node_get_sym_type(p->p, expr, &insn->sym) < 0 ||
+			    qpol_constraint_expr_node_get_op(p->p, expr, &insn->op) < 0) {
+				goto cleanup;
+			}
+			if (insn->code == QPOL_CEXPR_TYPE_NAMES && apol_cexpr_compile_names(e, expr, insn->sym, &insn->names) < 0) {
+				goto cleanup;
+			}
+			if (insn->code == QPOL_CEXPR_TYPE_ATTR &&
+			    !(insn->sym & (QPOL_CEXPR_SYM_USER | QPOL_CEXPR_SYM_ROLE | QPOL_CEXPR_SYM_TYPE))) {
+				prog->is_mls = 1;
+			}
+			if (insn->code == QPOL_CEXPR_TYPE_ATTR && (insn->sym & QPOL_CEXPR_SYM_ROLE) &&
+			    insn->op != QPOL_CEXPR_OP_EQ && insn->op != QPOL_CEXPR_OP_NEQ && apol_cexpr_build_role_dominates(e) < 0) {
+				goto cleanup;
+			}
+			if (++depth > e->max_depth)
+				e->max_depth = depth;
+			break;
+		default:
+			goto malformed;
+		}
+		prog->num_insns++;
+	}
+	if (depth != 1) {
+		goto malformed;
+	}
+
+	if (class_val >= e->num_classes) {
+		goto malformed;
+	}
+	if (e->programs[class_val] == NULL && (e->programs[class_val] = apol_vector_create(apol_cexpr_program_free)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (apol_vector_append(e->programs[class_val], prog) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	prog = NULL;
+	retval = 0;
+	goto cleanup;
+
+      malformed:
+	ERR(p, "%s", "Malformed constraint expression.");
+	errno = EIO;
+      cleanup:
+	free(perm);
+	qpol_iterator_destroy(&iter);
+	apol_cexpr_program_free(prog);
+	return retval;
+}
+
+apol_constraint_evaluator_t *apol_constraint_evaluator_create(const apol_policy_t * p)
+{
+	apol_constraint_evaluator_t *e = NULL;
+	qpol_iterator_t *iter = NULL;
+	qpol_constraint_t *constraint = NULL;
+	uint32_t val;
+	int error = 0;
+
+	if (p == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((e = calloc(1, sizeof(*e))) == NULL || (e->name_sets = apol_vector_create(apol_cexpr_bitmap_free)) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto err;
+	}
+	e->policy = p;
+	if (qpol_policy_get_class_iter(p->p, &iter) < 0) {
+		error = errno;
+		goto err;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_class_t *obj_class;
+		if (qpol_iterator_get_item(iter, (void **)&obj_class) < 0 || qpol_class_get_value(p->p, obj_class, &val) < 0) {
+			error = errno;
+			goto err;
+		}
+		if (val >= e->num_classes)
+			e->num_classes = (size_t) val + 1;
+	}
+	qpol_iterator_destroy(&iter);
+	if ((e->programs = calloc(e->num_classes + 1, sizeof(apol_vector_t *))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto err;
+	}
+
+	if (qpol_policy_get_constraint_iter(p->p, &iter) < 0) {
+		error = errno;
+		goto err;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&constraint) < 0 || apol_cexpr_compile(e, constraint) < 0) {
+			error = errno;
+			goto err;
+		}
+		free(constraint);
+		constraint = NULL;
+	}
+	qpol_iterator_destroy(&iter);
+	return e;
+
+      err:
+	free(constraint);
+	qpol_iterator_destroy(&iter);
+	apol_constraint_evaluator_destroy(&e);
+	errno = error;
+	return NULL;
+}
+
+void apol_constraint_evaluator_destroy(apol_constraint_evaluator_t ** e)
+{
+	size_t i;
+	if (e == NULL || *e == NULL)
+		return;
+	if ((*e)->programs != NULL) {
+		for (i = 0; i < (*e)->num_classes; i++)
+			apol_vector_destroy(&(*e)->programs[i]);
+		free((*e)->programs);
+	}
+	if ((*e)->role_dominates != NULL) {
+		for (i = 0; i < (*e)->num_roles; i++)
+			apol_bitmap_destroy(&(*e)->role_dominates[i]);
+		free((*e)->role_dominates);
+	}
+	apol_vector_destroy(&(*e)->name_sets);
+	free(*e);
+	*e = NULL;
+}
+
+/**
+ * Replace each component of a context with its value within the
+ * policy.  The context must be complete, other than its range.
+ */
+static int apol_cexpr_context_intern(const apol_policy_t * p, const apol_context_t * context, apol_cexpr_context_t * c)
+{
+	const qpol_user_t *user;
+	const qpol_role_t *role;
+	const qpol_type_t *type;
+	const apol_mls_range_t *range;
+	const apol_mls_level_t *high;
+
+	memset(c, 0, sizeof(*c));
+	if (context == NULL || apol_context_get_user(context) == NULL || apol_context_get_role(context) == NULL ||
+	    apol_context_get_type(context) == NULL) {
+		ERR(p, "%s", "Constraint evaluation requires a complete context.");
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_user_by_name(p->p, apol_context_get_user(context), &user) < 0 ||
+	    qpol_user_get_value(p->p, user, &c->user) < 0 ||
+	    qpol_policy_get_role_by_name(p->p, apol_context_get_role(context), &role) < 0 ||
+	    qpol_role_get_value(p->p, role, &c->role) < 0 ||
+	    qpol_policy_get_type_by_name(p->p, apol_context_get_type(context), &type) < 0 ||
+	    qpol_type_get_value(p->p, type, &c->type) < 0) {
+		return -1;
+	}
+	if ((range = apol_context_get_range(context)) != NULL && apol_mls_range_get_low(range) != NULL) {
+		if ((high = apol_mls_range_get_high(range)) == NULL)
+			high = apol_mls_range_get_low(range);
+		if (apol_mls_level_get_interned(p, apol_mls_range_get_low(range), &c->low_sens, &c->low_cats) < 0 ||
+		    apol_mls_level_get_interned(p, high, &c->high_sens, &c->high_cats) < 0) {
+			apol_bitmap_destroy(&c->low_cats);
+			return -1;
+		}
+		c->has_range = 1;
+	}
+	return 0;
+}
+
+/**
+ * Free the category bitmaps of a context interned by
+ * apol_cexpr_context_intern().
+ */
+static void apol_cexpr_context_release(apol_cexpr_context_t * c)
+{
+	apol_bitmap_destroy(&c->low_cats);
+	apol_bitmap_destroy(&c->high_cats);
+}
+
+/**
+ * Compare two levels as an mlsconstrain expression would.
+ */
+static int apol_cexpr_level_op(uint32_t op, uint32_t sens1, const apol_bitmap_t * cats1, uint32_t sens2,
+			       const apol_bitmap_t * cats2)
+{
+	int dom = (sens1 >= sens2 && apol_bitmap_is_subset(cats2, cats1));
+	int domby = (sens2 >= sens1 && apol_bitmap_is_subset(cats1, cats2));
+	switch (op) {
+	case QPOL_CEXPR_OP_EQ:
+		return dom && domby;
+	case QPOL_CEXPR_OP_NEQ:
+		return !(dom && domby);
+	case QPOL_CEXPR_OP_DOM:
+		return dom;
+	case QPOL_CEXPR_OP_DOMBY:
+		return domby;
+	case QPOL_CEXPR_OP_INCOMP:
+		return !dom && !domby;
+	}
+	return 0;
+}
+
+static int apol_cexpr_eval_attr(const apol_constraint_evaluator_t * e, const apol_cexpr_insn_t * insn,
+				const apol_cexpr_context_t * s, const apol_cexpr_context_t * t)
+{
+	int dom, domby;
+	switch (insn->sym) {
+	case QPOL_CEXPR_SYM_USER:
+		return (insn->op == QPOL_CEXPR_OP_EQ ? s->user == t->user : s->user != t->user);
+	case QPOL_CEXPR_SYM_TYPE:
+		return (insn->op == QPOL_CEXPR_OP_EQ ? s->type == t->type : s->type != t->type);
+	case QPOL_CEXPR_SYM_ROLE:
+		if (insn->op == QPOL_CEXPR_OP_EQ)
+			return s->role == t->role;
+		if (insn->op == QPOL_CEXPR_OP_NEQ)
+			return s->role != t->role;
+		dom = (s->role < e->num_roles && apol_bitmap_get(e->role_dominates[s->role], t->role));
+		domby = (t->role < e->num_roles && apol_bitmap_get(e->role_dominates[t->role], s->role));
+		if (insn->op == QPOL_CEXPR_OP_DOM)
+			return dom;
+		if (insn->op == QPOL_CEXPR_OP_DOMBY)
+			return domby;
+		return !dom && !domby;
+	}
+	if (!s->has_range || !t->has_range) {
+		return -1;
+	}
+	switch (insn->sym) {
+	case QPOL_CEXPR_SYM_L1L2:
+		return apol_cexpr_level_op(insn->op, s->low_sens, s->low_cats, t->low_sens, t->low_cats);
+	case QPOL_CEXPR_SYM_L1H2:
+		return apol_cexpr_level_op(insn->op, s->low_sens, s->low_cats, t->high_sens, t->high_cats);
+	case QPOL_CEXPR_SYM_H1L2:
+		return apol_cexpr_level_op(insn->op, s->high_sens, s->high_cats, t->low_sens, t->low_cats);
+	case QPOL_CEXPR_SYM_H1H2:
+		return apol_cexpr_level_op(insn->op, s->high_sens, s->high_cats, t->high_sens, t->high_cats);
+	case QPOL_CEXPR_SYM_L1H1:
+		return apol_cexpr_level_op(insn->op, s->low_sens, s->low_cats, s->high_sens, s->high_cats);
+	case QPOL_CEXPR_SYM_L2H2:
+		return apol_cexpr_level_op(insn->op, t->low_sens, t->low_cats, t->high_sens, t->high_cats);
+	}
+	return -1;
+}
+
+static int apol_cexpr_eval_names(const apol_constraint_evaluator_t * e, const apol_cexpr_insn_t * insn,
+				 const apol_cexpr_context_t * s, const apol_cexpr_context_t * t)
+{
+	const apol_cexpr_context_t *c = (insn->sym & QPOL_CEXPR_SYM_TARGET ? t : s);
+	const apol_bitmap_t *names = apol_vector_get_element(e->name_sets, insn->names);
+	uint32_t val;
+	int found;
+	if (insn->sym & QPOL_CEXPR_SYM_XTARGET) {
+		/* only validatetrans statements name a third context */
+		return -1;
+	}
+	if (insn->sym & QPOL_CEXPR_SYM_USER)
+		val = c->user;
+	else if (insn->sym & QPOL_CEXPR_SYM_ROLE)
+		val = c->role;
+	else
+		val = c->type;
+	found = apol_bitmap_get(names, val);
+	return (insn->op == QPOL_CEXPR_OP_NEQ ? !found : found);
+}
+
+/**
+ * Run a compiled constraint against a pair of contexts.
+ *
+ * @param stack Scratch space of at least the evaluator's max_depth.
+ *
+ * @return 1 if the constraint is satisfied, 0 if not, < 0 if it
+ * could not be evaluated.
+ */
+static int apol_cexpr_program_run(const apol_constraint_evaluator_t * e, const apol_cexpr_program_t * prog,
+				  const apol_cexpr_context_t * s, const apol_cexpr_context_t * t, int *stack)
+{
+	size_t i, sp = 0;
+	for (i = 0; i < prog->num_insns; i++) {
+		const apol_cexpr_insn_t *insn = prog->insns + i;
+		switch (insn->code) {
+		case QPOL_CEXPR_TYPE_NOT:
+			stack[sp - 1] = !stack[sp - 1];
+			break;
+		case QPOL_CEXPR_TYPE_AND:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] && stack[sp];
+			break;
+		case QPOL_CEXPR_TYPE_OR:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] || stack[sp];
+			break;
+		case QPOL_CEXPR_TYPE_ATTR:
+			if ((stack[sp++] = apol_cexpr_eval_attr(e, insn, s, t)) < 0)
+				return -1;
+			break;
+		default:
+			if ((stack[sp++] = apol_cexpr_eval_names(e, insn, s, t)) < 0)
+				return -1;
+			break;
+		}
+	}
+	return stack[0];
+}
+
+/**
+ * Compute the permissions of a class that its constraints deny to a
+ * pair of interned contexts.  A permission is attributed to whichever
+ * constraint first denies it, in policy order.
+ *
+ * @param denied Set to the permissions denied by constraints that do
+ * not compare MLS levels.
+ * @param mls_denied Set to the permissions denied by constraints
+ * that do.
+ */
+static int apol_cexpr_denied(const apol_constraint_evaluator_t * e, const apol_vector_t * programs, const apol_cexpr_context_t * s,
+			     const apol_cexpr_context_t * t, int *stack, uint32_t * denied, uint32_t * mls_denied)
+{
+	size_t i;
+	int rt;
+	*denied = *mls_denied = 0;
+	for (i = 0; i < apol_vector_get_size(programs); i++) {
+		const apol_cexpr_program_t *prog = apol_vector_get_element(programs, i);
+		uint32_t perms = prog->perms & ~(*denied | *mls_denied);
+		if (perms == 0)
+			continue;
+		if ((rt = apol_cexpr_program_run(e, prog, s, t, stack)) < 0) {
+			ERR(e->policy, "%s", "Constraint requires an MLS range that a context lacks.");
+			errno = EINVAL;
+			return -1;
+		}
+		if (!rt) {
+			if (prog->is_mls)
+				*mls_denied |= perms;
+			else
+				*denied |= perms;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Find the compiled constraints for a class.
+ */
+static int apol_constraint_evaluator_get_class(const apol_constraint_evaluator_t * e, const char *class_name,
+					       const qpol_class_t ** obj_class, const apol_vector_t ** programs)
+{
+	uint32_t val;
+	if (qpol_policy_get_class_by_name(e->policy->p, class_name, obj_class) < 0 ||
+	    qpol_class_get_value(e->policy->p, *obj_class, &val) < 0) {
+		return -1;
+	}
+	*programs = (val < e->num_classes ? e->programs[val] : NULL);
+	return 0;
+}
+
+int apol_constraint_evaluator_get_denied_split(const apol_constraint_evaluator_t * e, const apol_context_t * scontext,
+					       const apol_context_t * tcontext, const char *class_name, uint32_t * denied,
+					       uint32_t * mls_denied)
+{
+	const qpol_class_t *obj_class;
+	const apol_vector_t *programs;
+	apol_cexpr_context_t s, t;
+	int *stack = NULL, retval = -1;
+
+	memset(&s, 0, sizeof(s));
+	memset(&t, 0, sizeof(t));
+
+	if (denied != NULL)
+		*denied = 0;
+	if (mls_denied != NULL)
+		*mls_denied = 0;
+	if (e == NULL || class_name == NULL || denied == NULL || mls_denied == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (apol_constraint_evaluator_get_class(e, class_name, &obj_class, &programs) < 0) {
+		return -1;
+	}
+	if (programs == NULL) {
+		return 0;
+	}
+	if (apol_cexpr_context_intern(e->policy, scontext, &s) < 0 || apol_cexpr_context_intern(e->policy, tcontext, &t) < 0) {
+		goto cleanup;
+	}
+	if ((stack = malloc((e->max_depth + 1) * sizeof(int))) == NULL) {
+		ERR(e->policy, "%s", strerror(errno));
+		goto cleanup;
+	}
+	retval = apol_cexpr_denied(e, programs, &s, &t, stack, denied, mls_denied);
+      cleanup:
+	apol_cexpr_context_release(&s);
+	apol_cexpr_context_release(&t);
+	free(stack);
+	return retval;
+}
+
+int apol_constraint_evaluator_get_denied(const apol_constraint_evaluator_t * e, const apol_context_t * scontext,
+					 const apol_context_t * tcontext, const char *class_name, uint32_t * denied)
+{
+	uint32_t mls_denied;
+	if (denied == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (apol_constraint_evaluator_get_denied_split(e, scontext, tcontext, class_name, denied, &mls_denied) < 0) {
+		return -1;
+	}
+	*denied |= mls_denied;
+	return 0;
+}
+
+int apol_constraint_evaluator_check(const apol_constraint_evaluator_t * e, const apol_context_t * scontext,
+				    const apol_context_t * tcontext, const char *class_name, const char *perm_name)
+{
+	const qpol_class_t *obj_class;
+	const apol_vector_t *programs;
+	uint32_t perm_val, denied;
+
+	if (e == NULL || class_name == NULL || perm_name == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (apol_constraint_evaluator_get_class(e, class_name, &obj_class, &programs) < 0 ||
+	    qpol_class_get_perm_value(e->policy->p, obj_class, perm_name, &perm_val) < 0) {
+		return -1;
+	}
+	if (perm_val == 0) {
+		ERR(e->policy, "Class %s has no permission %s.", class_name, perm_name);
+		errno = EINVAL;
+		return -1;
+	}
+	if (apol_constraint_evaluator_get_denied(e, scontext, tcontext, class_name, &denied) < 0) {
+		return -1;
+	}
+	return (perm_val <= 32 && (denied & ((uint32_t) 1 << (perm_val - 1)))) ? 0 : 1;
+}
+
+int apol_constraint_evaluator_check_pairs(const apol_constraint_evaluator_t * e, const char *class_name,
+					  const apol_vector_t * scontexts, const apol_vector_t * tcontexts, uint32_t * denied)
+{
+	const qpol_class_t *obj_class;
+	const apol_vector_t *programs;
+	apol_cexpr_context_t *s = NULL, *t = NULL;
+	size_t i, num;
+	int *stack = NULL, retval = -1;
+
+	if (e == NULL || class_name == NULL || scontexts == NULL || tcontexts == NULL ||
+	    apol_vector_get_size(scontexts) != apol_vector_get_size(tcontexts) || denied == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	num = apol_vector_get_size(scontexts);
+	memset(denied, 0, num * sizeof(uint32_t));
+	if (apol_constraint_evaluator_get_class(e, class_name, &obj_class, &programs) < 0) {
+		return -1;
+	}
+	if (programs == NULL || num == 0) {
+		return 0;
+	}
+	/* intern every context first, so that the evaluation loop is
+	 * purely integer and bitmap operations */
+	if ((s = calloc(num, sizeof(*s))) == NULL || (t = calloc(num, sizeof(*t))) == NULL ||
+	    (stack = malloc((e->max_depth + 1) * sizeof(int))) == NULL) {
+		ERR(e->policy, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (i = 0; i < num; i++) {
+		if (apol_cexpr_context_intern(e->policy, apol_vector_get_element(scontexts, i), s + i) < 0 ||
+		    apol_cexpr_context_intern(e->policy, apol_vector_get_element(tcontexts, i), t + i) < 0) {
+			goto cleanup;
+		}
+	}
+	for (i = 0; i < num; i++) {
+		uint32_t mls_denied;
+		if (apol_cexpr_denied(e, programs, s + i, t + i, stack, denied + i, &mls_denied) < 0) {
+			goto cleanup;
+		}
+		denied[i] |= mls_denied;
+	}
+	retval = 0;
+      cleanup:
+	for (i = 0; i < num && s != NULL && t != NULL; i++) {
+		apol_cexpr_context_release(s + i);
+		apol_cexpr_context_release(t + i);
+	}
+	free(s);
+	free(t);
+	free(stack);
+	return retval;
+}
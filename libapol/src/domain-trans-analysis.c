@@ -26,7 +26,7 @@
 #include "policy-query-internal.h"
 #include "domain-trans-analysis-internal.h"
 #include <apol/domain-trans-analysis.h>
-#include <apol/bst.h>
+#include <apol/bitmap.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,41 +35,91 @@
 #include <stdbool.h>
 
 /* private data structure definitions */
-struct apol_domain_trans_table
+typedef struct avrule_node
 {
-	apol_bst_t *domain_table;
-	apol_bst_t *entrypoint_table;
-};
+	const qpol_type_t *type;
+	const qpol_avrule_t *rule;
+	/** position of this node among all rule nodes in the table;
+	 * analyses use it to index their own visitation state */
+	size_t id;
+} avrule_node_t;
+
+typedef struct terule_node
+{
+	const qpol_type_t *src;
+	const qpol_type_t *dflt;
+	const qpol_terule_t *rule;
+	/** position of this node among all rule nodes in the table */
+	size_t id;
+} terule_node_t;
+
+/* growable arrays of rule nodes; once the table is built each list is
+ * sorted so that all nodes for a given type are contiguous */
+typedef struct avrule_list
+{
+	avrule_node_t *nodes;
+	size_t size;
+	size_t cap;
+} avrule_list_t;
+
+typedef struct terule_list
+{
+	terule_node_t *nodes;
+	size_t size;
+	size_t cap;
+} terule_list_t;
 
 typedef struct dom_node
 {
 	const qpol_type_t *type;
-	apol_bst_t *process_transition_tree;
-	apol_bst_t *entrypoint_tree;
+	avrule_list_t process_transition;
+	avrule_list_t entrypoint;
 	apol_vector_t *setexec_rules;
 } dom_node_t;
 
 typedef struct ep_node
 {
 	const qpol_type_t *type;
-	apol_bst_t *execute_tree;
-	apol_bst_t *type_transition_tree;
+	avrule_list_t execute;
+	terule_list_t type_transition;
 } ep_node_t;
 
-typedef struct avrule_node
+struct apol_domain_trans_table
 {
-	const qpol_type_t *type;
-	const qpol_avrule_t *rule;
-	bool used;
-} avrule_node_t;
+	/** number of slots in each array; one more than the highest type value */
+	size_t num_types;
+	/** domain nodes indexed by type value, NULL if a type has none */
+	dom_node_t **domains;
+	/** entrypoint nodes indexed by type value, NULL if a type has none */
+	ep_node_t **entrypoints;
+	/** total number of rule nodes in all of the lists above; each
+	 * node's id is less than this */
+	size_t num_rule_nodes;
+	/** valid transitions in compressed adjacency form: the domains
+	 * directly reachable from type value i are the type values
+	 * trans_targets[trans_start[i]] up to trans_start[i + 1] */
+	size_t *trans_start;
+	uint32_t *trans_targets;
+	/** for each entry in trans_targets, the value of the first
+	 * entrypoint type that makes the transition valid */
+	uint32_t *trans_eps;
+};
 
-typedef struct terule_node
+struct apol_domain_trans_reach_analysis
 {
-	const qpol_type_t *src;
-	const qpol_type_t *dflt;
-	const qpol_terule_t *rule;
-	bool used;
-} terule_node_t;
+	apol_vector_t *start_types;
+	unsigned int max_hops;
+};
+
+struct apol_domain_trans_reach_result
+{
+	const qpol_type_t *start_type;
+	const qpol_type_t *end_type;
+	/** domains along the chain, start_type to end_type inclusive */
+	apol_vector_t *domains;
+	/** entrypoint used for each transition; one fewer than domains */
+	apol_vector_t *entrypoints;
+};
 
 /* public data structure definitions */
 struct apol_domain_trans_analysis
@@ -102,124 +152,138 @@ struct apol_domain_trans_result
 
 /* private functions */
 /* avrule_node */
-static int avrule_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+static int avrule_node_cmp(const void *a, const void *b)
 {
 	const avrule_node_t *an = a;
 	const avrule_node_t *bn = b;
-	ssize_t retv = (const char *)an->type - (const char *)bn->type;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
+	if ((const char *)an->type < (const char *)bn->type)
 		return -1;
-	retv = (const char *)an->rule - (const char *)bn->rule;
-	if (retv > 0)
+	else if ((const char *)an->type > (const char *)bn->type)
 		return 1;
-	else if (retv < 0)
+	if ((const char *)an->rule < (const char *)bn->rule)
 		return -1;
+	else if ((const char *)an->rule > (const char *)bn->rule)
+		return 1;
 	return 0;
 }
 
-static int avrule_node_reset(void *a, void *b __attribute__ ((unused)))
+static int avrule_list_append(avrule_list_t * list, const qpol_type_t * type, const qpol_avrule_t * rule)
 {
-	avrule_node_t *an = a;
-	if (!a)
-		return -1;
-	an->used = false;
+	if (list->size >= list->cap) {
+		size_t new_cap = (list->cap ? list->cap * 2 : 4);
+		avrule_node_t *tmp = realloc(list->nodes, new_cap * sizeof(*tmp));
+		if (!tmp)
+			return -1;
+		list->nodes = tmp;
+		list->cap = new_cap;
+	}
+	list->nodes[list->size].type = type;
+	list->nodes[list->size].rule = rule;
+	list->size++;
 	return 0;
 }
 
-static avrule_node_t *avrule_node_create(const qpol_type_t * type, const qpol_avrule_t * rule)
+static void avrule_list_finalize(avrule_list_t * list, size_t * next_id)
 {
-	avrule_node_t *n = calloc(1, sizeof(*n));
-	if (!n)
-		return NULL;
-
-	n->type = type;
-	n->rule = rule;
+	if (list->size > 1)
+		qsort(list->nodes, list->size, sizeof(*list->nodes), avrule_node_cmp);
+	for (size_t i = 0; i < list->size; i++)
+		list->nodes[i].id = (*next_id)++;
+}
 
-	return n;
+/**
+ * Find the index of the first node in a sorted list whose type is not
+ * less than the given type.
+ */
+static size_t avrule_list_lower_bound(const avrule_list_t * list, const qpol_type_t * type)
+{
+	size_t lo = 0, hi = list->size;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if ((const char *)list->nodes[mid].type < (const char *)type)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
 }
 
 /* terule_node */
-static int terule_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+static int terule_node_cmp(const void *a, const void *b)
 {
 	const terule_node_t *an = a;
 	const terule_node_t *bn = b;
-	ssize_t retv = (const char *)an->src - (const char *)bn->src;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
+	if ((const char *)an->src < (const char *)bn->src)
 		return -1;
-	retv = (const char *)an->dflt - (const char *)bn->dflt;
-	if (retv > 0)
+	else if ((const char *)an->src > (const char *)bn->src)
 		return 1;
-	else if (retv < 0)
+	if ((const char *)an->dflt < (const char *)bn->dflt)
 		return -1;
-	retv = (const char *)an->rule - (const char *)bn->rule;
-	if (retv > 0)
+	else if ((const char *)an->dflt > (const char *)bn->dflt)
 		return 1;
-	else if (retv < 0)
+	if ((const char *)an->rule < (const char *)bn->rule)
 		return -1;
+	else if ((const char *)an->rule > (const char *)bn->rule)
+		return 1;
 	return 0;
 }
 
-static int terule_node_reset(void *a, void *b __attribute__ ((unused)))
+static int terule_list_append(terule_list_t * list, const qpol_type_t * src, const qpol_type_t * dflt,
+			      const qpol_terule_t * rule)
 {
-	terule_node_t *an = a;
-	if (!a)
-		return -1;
-	an->used = false;
+	if (list->size >= list->cap) {
+		size_t new_cap = (list->cap ? list->cap * 2 : 4);
+		terule_node_t *tmp = realloc(list->nodes, new_cap * sizeof(*tmp));
+		if (!tmp)
+			return -1;
+		list->nodes = tmp;
+		list->cap = new_cap;
+	}
+	list->nodes[list->size].src = src;
+	list->nodes[list->size].dflt = dflt;
+	list->nodes[list->size].rule = rule;
+	list->size++;
 	return 0;
 }
 
-static terule_node_t *terule_node_create(const qpol_type_t * src, const qpol_type_t * dflt, const qpol_terule_t * rule)
+static void terule_list_finalize(terule_list_t * list, size_t * next_id)
 {
-	terule_node_t *n = calloc(1, sizeof(*n));
-	if (!n)
-		return NULL;
-
-	n->src = src;
-	n->dflt = dflt;
-	n->rule = rule;
-
-	return n;
+	if (list->size > 1)
+		qsort(list->nodes, list->size, sizeof(*list->nodes), terule_node_cmp);
+	for (size_t i = 0; i < list->size; i++)
+		list->nodes[i].id = (*next_id)++;
 }
 
-/* dom_node */
-static int dom_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+/**
+ * Determine if a sorted list contains a rule from the given source
+ * to the given default type.
+ */
+static bool terule_list_contains(const terule_list_t * list, const qpol_type_t * src, const qpol_type_t * dflt)
 {
-	const dom_node_t *an = a;
-	const dom_node_t *bn = b;
-
-	if ((const char *)(an->type) < (const char *)(bn->type))
-		return -1;
-	else if ((const char *)(an->type) > (const char *)(bn->type))
-		return 1;
-	return 0;
+	size_t lo = 0, hi = list->size;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if ((const char *)list->nodes[mid].src < (const char *)src)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (; lo < list->size && list->nodes[lo].src == src; lo++) {
+		if (list->nodes[lo].dflt == dflt)
+			return true;
+	}
+	return false;
 }
 
-static void dom_node_free(void *x)
+/* dom_node */
+static void dom_node_free(dom_node_t * n)
 {
-	if (!x)
+	if (!n)
 		return;
-	apol_bst_destroy(&(((dom_node_t *) x)->process_transition_tree));
-	apol_bst_destroy(&(((dom_node_t *) x)->entrypoint_tree));
-	apol_vector_destroy(&(((dom_node_t *) x)->setexec_rules));
-	free(x);
-}
-
-static int dom_node_reset(void *a, void *b __attribute__ ((unused)))
-{
-	dom_node_t *an = a;
-	if (!a)
-		return -1;
-
-	if (apol_bst_inorder_map(an->process_transition_tree, avrule_node_reset, NULL) < 0)
-		return -1;
-	if (apol_bst_inorder_map(an->entrypoint_tree, avrule_node_reset, NULL) < 0)
-		return -1;
-
-	return 0;
+	free(n->process_transition.nodes);
+	free(n->entrypoint.nodes);
+	apol_vector_destroy(&n->setexec_rules);
+	free(n);
 }
 
 static dom_node_t *dom_node_create(const qpol_type_t * type)
@@ -229,11 +293,7 @@ static dom_node_t *dom_node_create(const qpol_type_t * type)
 		return NULL;
 
 	n->type = type;
-	if (!(n->process_transition_tree = apol_bst_create(avrule_node_cmp, free)) ||
-	    !(n->entrypoint_tree = apol_bst_create(avrule_node_cmp, free)) || !(n->setexec_rules = apol_vector_create(NULL))) {
-		apol_bst_destroy(&n->process_transition_tree);
-		apol_bst_destroy(&n->entrypoint_tree);
-		apol_vector_destroy(&n->setexec_rules);
+	if (!(n->setexec_rules = apol_vector_create(NULL))) {
 		free(n);
 		return NULL;
 	}
@@ -242,38 +302,13 @@ static dom_node_t *dom_node_create(const qpol_type_t * type)
 }
 
 /* ep_node */
-static int ep_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+static void ep_node_free(ep_node_t * n)
 {
-	const ep_node_t *an = a;
-	const ep_node_t *bn = b;
-
-	if ((const char *)(an->type) < (const char *)(bn->type))
-		return -1;
-	else if ((const char *)(an->type) > (const char *)(bn->type))
-		return 1;
-	return 0;
-}
-
-static void ep_node_free(void *x)
-{
-	if (!x)
+	if (!n)
 		return;
-	apol_bst_destroy(&(((ep_node_t *) x)->type_transition_tree));
-	apol_bst_destroy(&(((ep_node_t *) x)->execute_tree));
-	free(x);
-}
-
-static int ep_node_reset(void *a, void *b __attribute__ ((unused)))
-{
-	ep_node_t *an = a;
-	if (!a)
-		return -1;
-
-	if (apol_bst_inorder_map(an->execute_tree, avrule_node_reset, NULL) < 0)
-		return -1;
-	if (apol_bst_inorder_map(an->type_transition_tree, terule_node_reset, NULL) < 0)
-		return -1;
-	return 0;
+	free(n->execute.nodes);
+	free(n->type_transition.nodes);
+	free(n);
 }
 
 static ep_node_t *ep_node_create(const qpol_type_t * type)
@@ -283,13 +318,6 @@ static ep_node_t *ep_node_create(const qpol_type_t * type)
 		return NULL;
 
 	n->type = type;
-	if (!(n->execute_tree = apol_bst_create(avrule_node_cmp, free)) ||
-	    !(n->type_transition_tree = apol_bst_create(terule_node_cmp, free))) {
-		apol_bst_destroy(&n->execute_tree);
-		apol_bst_destroy(&n->type_transition_tree);
-		free(n);
-		return NULL;
-	}
 
 	return n;
 }
@@ -298,6 +326,8 @@ static ep_node_t *ep_node_create(const qpol_type_t * type)
 static apol_domain_trans_table_t *apol_domain_trans_table_new(apol_policy_t * policy)
 {
 	apol_domain_trans_table_t *new_table = NULL;
+	qpol_iterator_t *iter = NULL;
+	uint32_t max_val = 0;
 	int error;
 
 	if (!policy) {
@@ -306,19 +336,32 @@ static apol_domain_trans_table_t *apol_domain_trans_table_new(apol_policy_t * po
 		return NULL;
 	}
 
-	new_table = (apol_domain_trans_table_t *) calloc(1, sizeof(apol_domain_trans_table_t));
-	if (!new_table) {
-		ERR(policy, "%s", strerror(ENOMEM));
-		error = ENOMEM;
+	/* type values are dense, so size the tables by the largest one */
+	if (qpol_policy_get_type_iter(policy->p, &iter)) {
+		error = errno;
 		goto cleanup;
 	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_type_t *type;
+		uint32_t val;
+		if (qpol_iterator_get_item(iter, (void **)&type) || qpol_type_get_value(policy->p, type, &val)) {
+			error = errno;
+			goto cleanup;
+		}
+		if (val > max_val)
+			max_val = val;
+	}
+	qpol_iterator_destroy(&iter);
 
-	if (!(new_table->domain_table = apol_bst_create(dom_node_cmp, dom_node_free))) {
+	new_table = (apol_domain_trans_table_t *) calloc(1, sizeof(apol_domain_trans_table_t));
+	if (!new_table) {
 		ERR(policy, "%s", strerror(ENOMEM));
 		error = ENOMEM;
 		goto cleanup;
 	}
-	if (!(new_table->entrypoint_table = apol_bst_create(ep_node_cmp, ep_node_free))) {
+	new_table->num_types = (size_t) max_val + 1;
+	if (!(new_table->domains = calloc(new_table->num_types, sizeof(dom_node_t *))) ||
+	    !(new_table->entrypoints = calloc(new_table->num_types, sizeof(ep_node_t *)))) {
 		ERR(policy, "%s", strerror(ENOMEM));
 		error = ENOMEM;
 		goto cleanup;
@@ -326,173 +369,229 @@ static apol_domain_trans_table_t *apol_domain_trans_table_new(apol_policy_t * po
 
 	return new_table;
       cleanup:
+	qpol_iterator_destroy(&iter);
 	domain_trans_table_destroy(&new_table);
 	errno = error;
 	return NULL;
 }
 
-static int table_add_avrule(apol_policy_t * policy, apol_domain_trans_table_t * dta_table, const qpol_avrule_t * rule)
+static uint32_t table_type_index(const apol_policy_t * policy, const apol_domain_trans_table_t * table, const qpol_type_t * type)
+{
+	uint32_t val = 0;
+	if (!type || qpol_type_get_value(policy->p, type, &val) || val >= table->num_types)
+		return 0;
+	return val;
+}
+
+static dom_node_t *table_get_dom_node(const apol_policy_t * policy, const apol_domain_trans_table_t * table,
+				      const qpol_type_t * type)
+{
+	return table->domains[table_type_index(policy, table, type)];
+}
+
+static ep_node_t *table_get_ep_node(const apol_policy_t * policy, const apol_domain_trans_table_t * table,
+				    const qpol_type_t * type)
+{
+	return table->entrypoints[table_type_index(policy, table, type)];
+}
+
+static dom_node_t *table_get_or_add_dom_node(const apol_policy_t * policy, apol_domain_trans_table_t * table,
+					     const qpol_type_t * type)
+{
+	uint32_t val = table_type_index(policy, table, type);
+	if (!val) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if (!table->domains[val])
+		table->domains[val] = dom_node_create(type);
+	return table->domains[val];
+}
+
+static ep_node_t *table_get_or_add_ep_node(const apol_policy_t * policy, apol_domain_trans_table_t * table,
+					   const qpol_type_t * type)
+{
+	uint32_t val = table_type_index(policy, table, type);
+	if (!val) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if (!table->entrypoints[val])
+		table->entrypoints[val] = ep_node_create(type);
+	return table->entrypoints[val];
+}
+
+/**
+ * State used while building the table: the values of the relevant
+ * classes and permissions resolved once, and a cache of attribute
+ * expansions indexed by type value.
+ */
+typedef struct table_builder
+{
+	uint32_t file_class;
+	uint32_t process_class;
+	/** per class (0 = file, 1 = process) permission bit masks */
+	uint32_t execute[2], entrypoint[2], transition[2], setexec[2];
+	apol_vector_t **expansions;
+	size_t num_types;
+} table_builder_t;
+
+static uint32_t perm_bit(apol_policy_t * policy, const qpol_class_t * obj_class, const char *perm)
+{
+	uint32_t val = 0;
+	if (!obj_class || qpol_class_get_perm_value(policy->p, obj_class, perm, &val) || val == 0 || val > 32)
+		return 0;
+	return (uint32_t) 1 << (val - 1);
+}
+
+static int table_builder_init(apol_policy_t * policy, const apol_domain_trans_table_t * table, table_builder_t * b)
+{
+	const qpol_class_t *classes[2] = { NULL, NULL };
+	memset(b, 0, sizeof(*b));
+	/* a policy without these classes simply contributes nothing */
+	qpol_policy_get_class_by_name(policy->p, "file", &classes[0]);
+	qpol_policy_get_class_by_name(policy->p, "process", &classes[1]);
+	if (classes[0])
+		qpol_class_get_value(policy->p, classes[0], &b->file_class);
+	if (classes[1])
+		qpol_class_get_value(policy->p, classes[1], &b->process_class);
+	for (size_t i = 0; i < 2; i++) {
+		b->execute[i] = perm_bit(policy, classes[i], "execute");
+		b->entrypoint[i] = perm_bit(policy, classes[i], "entrypoint");
+		b->transition[i] = perm_bit(policy, classes[i], "transition");
+		b->setexec[i] = perm_bit(policy, classes[i], "setexec");
+	}
+	b->num_types = table->num_types;
+	if (!(b->expansions = calloc(b->num_types, sizeof(apol_vector_t *)))) {
+		ERR(policy, "%s", strerror(ENOMEM));
+		errno = ENOMEM;
+		return -1;
+	}
+	return 0;
+}
+
+static void table_builder_fini(table_builder_t * b)
+{
+	if (b->expansions) {
+		for (size_t i = 0; i < b->num_types; i++)
+			apol_vector_destroy(&b->expansions[i]);
+		free(b->expansions);
+		b->expansions = NULL;
+	}
+}
+
+static const apol_vector_t *table_builder_expand(apol_policy_t * policy, table_builder_t * b, const qpol_type_t * type)
+{
+	uint32_t val = 0;
+	if (qpol_type_get_value(policy->p, type, &val) || val >= b->num_types) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if (!b->expansions[val])
+		b->expansions[val] = apol_query_expand_type(policy, type);
+	return b->expansions[val];
+}
+
+static int table_add_avrule(apol_policy_t * policy, apol_domain_trans_table_t * dta_table, table_builder_t * b,
+			    const qpol_avrule_t * rule)
 {
 	qpol_policy_t *qp = apol_policy_get_qpol(policy);
+	const qpol_class_t *obj_class;
 	const qpol_type_t *src;
 	const qpol_type_t *tgt;
+	uint32_t class_val = 0, mask = 0;
+	size_t c;
+
+	if (qpol_avrule_get_object_class(qp, rule, &obj_class) || qpol_class_get_value(qp, obj_class, &class_val))
+		return -1;
+	if (class_val == b->file_class)
+		c = 0;
+	else if (class_val == b->process_class)
+		c = 1;
+	else
+		return 0;
+	if (qpol_avrule_get_perm_mask(qp, rule, &mask))
+		return -1;
+	bool exec = (mask & b->execute[c]) != 0;
+	bool ep = (mask & b->entrypoint[c]) != 0;
+	bool proc_trans = (mask & b->transition[c]) != 0;
+	bool setexec = (mask & b->setexec[c]) != 0;
+	if (!exec && !ep && !proc_trans && !setexec)
+		return 0;
+
 	qpol_avrule_get_source_type(qp, rule, &src);
 	qpol_avrule_get_target_type(qp, rule, &tgt);
-	apol_vector_t *sources = apol_query_expand_type(policy, src);
-	apol_vector_t *targets = apol_query_expand_type(policy, tgt);
-	bool exec = false, ep = false, proc_trans = false, setexec = false;
-	qpol_iterator_t *iter = NULL;
-	int error = 0;
-	qpol_avrule_get_perm_iter(qp, rule, &iter);
-	if (!iter || !sources || !targets) {
-		error = errno;
-		goto err;
-	}
-
-	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-		void *x;
-		qpol_iterator_get_item(iter, &x);
-		char *perm = x;
-		if (!strcmp("execute", perm))
-			exec = true;
-		if (!strcmp("entrypoint", perm))
-			ep = true;
-		if (!strcmp("transition", perm))
-			proc_trans = true;
-		if (!strcmp("setexec", perm))
-			setexec = true;
-		free(x);
-	}
-	qpol_iterator_destroy(&iter);
+	const apol_vector_t *sources = table_builder_expand(policy, b, src);
+	const apol_vector_t *targets = table_builder_expand(policy, b, tgt);
+	if (!sources || !targets)
+		return -1;
 
 	if (proc_trans || ep || setexec) {
 		for (size_t i = 0; i < apol_vector_get_size(sources); i++) {
-			dom_node_t *dnode = NULL;
-			dom_node_t dummy = { apol_vector_get_element(sources, i), NULL, NULL, NULL };
-			if (apol_bst_get_element(dta_table->domain_table, &dummy, NULL, (void **)&dnode)) {
-				dom_node_t *new_dnode = NULL;
-				if (!(new_dnode = dom_node_create(dummy.type)) ||
-				    apol_bst_insert(dta_table->domain_table, (void *)new_dnode, NULL)) {
-					error = errno;
-					dom_node_free(new_dnode);
-					goto err;
-				}
-				dnode = new_dnode;
-			}
-			if (setexec) {
-				if (apol_vector_append_unique(dnode->setexec_rules, (void *)rule, NULL, NULL)) {
-					error = errno;
-					goto err;
-				}
-			}
+			dom_node_t *dnode = table_get_or_add_dom_node(policy, dta_table, apol_vector_get_element(sources, i));
+			if (!dnode)
+				return -1;
+			if (setexec && apol_vector_append(dnode->setexec_rules, (void *)rule))
+				return -1;
 			for (size_t j = 0; j < apol_vector_get_size(targets); j++) {
-				if (proc_trans) {
-					avrule_node_t *new_node =
-						avrule_node_create((const qpol_type_t *)apol_vector_get_element(targets, j), rule);
-					if (!new_node ||
-					    apol_bst_insert_and_get(dnode->process_transition_tree, (void **)&new_node, NULL) < 0) {
-						error = errno;
-						free(new_node);
-						goto err;
-					}
-				}
-				if (ep) {
-					avrule_node_t *new_node =
-						avrule_node_create((const qpol_type_t *)apol_vector_get_element(targets, j), rule);
-					if (!new_node ||
-					    apol_bst_insert_and_get(dnode->entrypoint_tree, (void **)&new_node, NULL) < 0) {
-						error = errno;
-						free(new_node);
-						goto err;
-					}
-				}
+				const qpol_type_t *t = apol_vector_get_element(targets, j);
+				if (proc_trans && avrule_list_append(&dnode->process_transition, t, rule))
+					return -1;
+				if (ep && avrule_list_append(&dnode->entrypoint, t, rule))
+					return -1;
 			}
 		}
 	}
 	if (exec) {
 		for (size_t i = 0; i < apol_vector_get_size(targets); i++) {
-			ep_node_t *enode = NULL;
-			ep_node_t dummy = { apol_vector_get_element(targets, i), NULL, NULL };
-			if (apol_bst_get_element(dta_table->entrypoint_table, &dummy, NULL, (void **)&enode)) {
-				ep_node_t *new_enode = NULL;
-				if (!(new_enode = ep_node_create(dummy.type)) ||
-				    apol_bst_insert(dta_table->entrypoint_table, (void *)new_enode, NULL)) {
-					error = errno;
-					ep_node_free(new_enode);
-					goto err;
-				}
-				enode = new_enode;
-			}
+			ep_node_t *enode = table_get_or_add_ep_node(policy, dta_table, apol_vector_get_element(targets, i));
+			if (!enode)
+				return -1;
 			for (size_t j = 0; j < apol_vector_get_size(sources); j++) {
-				avrule_node_t *new_node =
-					avrule_node_create((const qpol_type_t *)apol_vector_get_element(sources, j), rule);
-				if (!new_node || apol_bst_insert_and_get(enode->execute_tree, (void **)&new_node, NULL) < 0) {
-					error = errno;
-					free(new_node);
-					goto err;
-				}
+				if (avrule_list_append(&enode->execute, apol_vector_get_element(sources, j), rule))
+					return -1;
 			}
 		}
 	}
 
-	apol_vector_destroy(&sources);
-	apol_vector_destroy(&targets);
 	return 0;
-
-      err:
-	qpol_iterator_destroy(&iter);
-	apol_vector_destroy(&sources);
-	apol_vector_destroy(&targets);
-	errno = error;
-	return -1;
 }
 
-static int table_add_terule(apol_policy_t * policy, apol_domain_trans_table_t * dta_table, const qpol_terule_t * rule)
+static int table_add_terule(apol_policy_t * policy, apol_domain_trans_table_t * dta_table, table_builder_t * b,
+			    const qpol_terule_t * rule)
 {
 	qpol_policy_t *qp = apol_policy_get_qpol(policy);
+	const qpol_class_t *obj_class;
 	const qpol_type_t *src;
 	const qpol_type_t *tgt;
 	const qpol_type_t *dflt;
+	uint32_t class_val = 0;
+
+	if (qpol_terule_get_object_class(qp, rule, &obj_class) || qpol_class_get_value(qp, obj_class, &class_val))
+		return -1;
+	if (class_val != b->process_class)
+		return 0;
 	qpol_terule_get_source_type(qp, rule, &src);
 	qpol_terule_get_target_type(qp, rule, &tgt);
 	qpol_terule_get_default_type(qp, rule, &dflt);
-	apol_vector_t *sources = apol_query_expand_type(policy, src);
-	apol_vector_t *targets = apol_query_expand_type(policy, tgt);
-	int error = 0;
+	const apol_vector_t *sources = table_builder_expand(policy, b, src);
+	const apol_vector_t *targets = table_builder_expand(policy, b, tgt);
+	if (!sources || !targets)
+		return -1;
 	for (size_t i = 0; i < apol_vector_get_size(targets); i++) {
-		ep_node_t *enode = NULL;
-		ep_node_t dummy = { apol_vector_get_element(targets, i), NULL, NULL };
-		if (apol_bst_get_element(dta_table->entrypoint_table, &dummy, NULL, (void **)&enode)) {
-			ep_node_t *new_enode = NULL;
-			if (!(new_enode = ep_node_create(dummy.type)) ||
-			    apol_bst_insert(dta_table->entrypoint_table, (void *)new_enode, NULL)) {
-				error = errno;
-				ep_node_free(new_enode);
-				goto err;
-			}
-			enode = new_enode;
-		}
+		ep_node_t *enode = table_get_or_add_ep_node(policy, dta_table, apol_vector_get_element(targets, i));
+		if (!enode)
+			return -1;
 		for (size_t j = 0; j < apol_vector_get_size(sources); j++) {
-			terule_node_t *new_node =
-				terule_node_create((const qpol_type_t *)apol_vector_get_element(sources, j), dflt, rule);
-			if (apol_bst_insert_and_get(enode->type_transition_tree, (void **)&new_node, NULL) < 0) {
-				error = errno;
-				free(new_node);
-				goto err;
-			}
+			if (terule_list_append(&enode->type_transition, apol_vector_get_element(sources, j), dflt, rule))
+				return -1;
 		}
 	}
 
-	apol_vector_destroy(&sources);
-	apol_vector_destroy(&targets);
 	return 0;
-      err:
-	apol_vector_destroy(&sources);
-	apol_vector_destroy(&targets);
-	errno = error;
-	return -1;
 }
 
+
 /* result */
 apol_domain_trans_result_t *domain_trans_result_create()
 {
@@ -515,15 +614,91 @@ apol_domain_trans_result_t *domain_trans_result_create()
 	return NULL;
 }
 
+static bool requires_setexec_or_type_trans(apol_policy_t * policy);
+
+/**
+ * Determine the first entrypoint through which the domain with the
+ * given node may validly transition to the domain end_node.
+ *
+ * @return The entrypoint's type value, or 0 if there is none.
+ */
+static uint32_t table_find_valid_entrypoint(apol_policy_t * policy, const apol_domain_trans_table_t * table,
+					    const dom_node_t * start_node, const dom_node_t * end_node, bool need_setexec_or_tt)
+{
+	bool has_setexec = apol_vector_get_size(start_node->setexec_rules) > 0;
+	const avrule_list_t *eps = &end_node->entrypoint;
+	for (size_t i = 0; i < eps->size; i++) {
+		if (i > 0 && eps->nodes[i].type == eps->nodes[i - 1].type)
+			continue;
+		uint32_t ep_val = table_type_index(policy, table, eps->nodes[i].type);
+		const ep_node_t *enode = table->entrypoints[ep_val];
+		if (!enode)
+			continue;
+		size_t x = avrule_list_lower_bound(&enode->execute, start_node->type);
+		if (x >= enode->execute.size || enode->execute.nodes[x].type != start_node->type)
+			continue;
+		if (need_setexec_or_tt && !has_setexec &&
+		    !terule_list_contains(&enode->type_transition, start_node->type, end_node->type))
+			continue;
+		return ep_val;
+	}
+	return 0;
+}
+
+/**
+ * Collapse the table's rule lists into an adjacency list of valid
+ * transitions, used for reachability searches.
+ */
+static int table_build_transitions(apol_policy_t * policy, apol_domain_trans_table_t * table)
+{
+	size_t num_edges = 0, cap = 0;
+	bool need_setexec_or_tt = requires_setexec_or_type_trans(policy);
+
+	if (!(table->trans_start = calloc(table->num_types + 1, sizeof(size_t))))
+		return -1;
+	for (size_t i = 0; i < table->num_types; i++) {
+		const dom_node_t *dnode = table->domains[i];
+		table->trans_start[i] = num_edges;
+		if (!dnode)
+			continue;
+		const avrule_list_t *pt = &dnode->process_transition;
+		for (size_t j = 0; j < pt->size; j++) {
+			if ((j > 0 && pt->nodes[j].type == pt->nodes[j - 1].type) || pt->nodes[j].type == dnode->type)
+				continue;
+			uint32_t end_val = table_type_index(policy, table, pt->nodes[j].type);
+			const dom_node_t *end_node = table->domains[end_val];
+			if (!end_node)
+				continue;
+			uint32_t ep_val = table_find_valid_entrypoint(policy, table, dnode, end_node, need_setexec_or_tt);
+			if (!ep_val)
+				continue;
+			if (num_edges >= cap) {
+				size_t new_cap = (cap ? cap * 2 : 64);
+				uint32_t *t = realloc(table->trans_targets, new_cap * sizeof(uint32_t));
+				if (!t)
+					return -1;
+				table->trans_targets = t;
+				if (!(t = realloc(table->trans_eps, new_cap * sizeof(uint32_t))))
+					return -1;
+				table->trans_eps = t;
+				cap = new_cap;
+			}
+			table->trans_targets[num_edges] = end_val;
+			table->trans_eps[num_edges] = ep_val;
+			num_edges++;
+		}
+	}
+	table->trans_start[table->num_types] = num_edges;
+	return 0;
+}
+
 /* public functions */
 /* table */
 int apol_policy_build_domain_trans_table(apol_policy_t * policy)
 {
 	int error = 0;
-	apol_avrule_query_t *avq = NULL;
-	apol_terule_query_t *teq = NULL;
-	apol_vector_t *avrules = NULL;
-	apol_vector_t *terules = NULL;
+	table_builder_t builder;
+	qpol_iterator_t *iter = NULL;
 
 	if (!policy) {
 		ERR(policy, "%s", strerror(EINVAL));
@@ -535,56 +710,68 @@ int apol_policy_build_domain_trans_table(apol_policy_t * policy)
 		return 0;	       /* already built */
 	}
 
+	memset(&builder, 0, sizeof(builder));
 	apol_domain_trans_table_t *dta_table = policy->domain_trans_table = apol_domain_trans_table_new(policy);
 	if (!policy->domain_trans_table) {
 		error = errno;
 		goto err;
 	}
+	if (table_builder_init(policy, dta_table, &builder)) {
+		error = errno;
+		goto err;
+	}
 
-	avq = apol_avrule_query_create();
-	apol_avrule_query_set_rules(policy, avq, QPOL_RULE_ALLOW);
-	apol_avrule_query_append_class(policy, avq, "file");
-	apol_avrule_query_append_class(policy, avq, "process");
-	apol_avrule_query_append_perm(policy, avq, "execute");
-	apol_avrule_query_append_perm(policy, avq, "entrypoint");
-	apol_avrule_query_append_perm(policy, avq, "transition");
-	apol_avrule_query_append_perm(policy, avq, "setexec");
-	if (apol_avrule_get_by_query(policy, avq, &avrules)) {
+	/* a single pass over each rule table picks out everything needed */
+	if (qpol_policy_get_avrule_iter(policy->p, QPOL_RULE_ALLOW, &iter)) {
 		error = errno;
 		goto err;
 	}
-	apol_avrule_query_destroy(&avq);
-	for (size_t i = 0; i < apol_vector_get_size(avrules); i++) {
-		if (table_add_avrule(policy, dta_table, (const qpol_avrule_t *)apol_vector_get_element(avrules, i))) {
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_avrule_t *rule;
+		if (qpol_iterator_get_item(iter, (void **)&rule) || table_add_avrule(policy, dta_table, &builder, rule)) {
 			error = errno;
+			ERR(policy, "%s", strerror(error));
 			goto err;
 		}
 	}
-	apol_vector_destroy(&avrules);
+	qpol_iterator_destroy(&iter);
 
-	teq = apol_terule_query_create();
-	apol_terule_query_set_rules(policy, teq, QPOL_RULE_TYPE_TRANS);
-	apol_terule_query_append_class(policy, teq, "process");
-	if (apol_terule_get_by_query(policy, teq, &terules)) {
+	if (qpol_policy_get_terule_iter(policy->p, QPOL_RULE_TYPE_TRANS, &iter)) {
 		error = errno;
 		goto err;
 	}
-	apol_terule_query_destroy(&teq);
-	for (size_t i = 0; i < apol_vector_get_size(terules); i++) {
-		if (table_add_terule(policy, dta_table, (const qpol_terule_t *)apol_vector_get_element(terules, i))) {
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_terule_t *rule;
+		if (qpol_iterator_get_item(iter, (void **)&rule) || table_add_terule(policy, dta_table, &builder, rule)) {
 			error = errno;
+			ERR(policy, "%s", strerror(error));
 			goto err;
 		}
 	}
-	apol_vector_destroy(&terules);
+	qpol_iterator_destroy(&iter);
+	table_builder_fini(&builder);
+
+	for (size_t i = 0; i < dta_table->num_types; i++) {
+		if (dta_table->domains[i]) {
+			avrule_list_finalize(&dta_table->domains[i]->process_transition, &dta_table->num_rule_nodes);
+			avrule_list_finalize(&dta_table->domains[i]->entrypoint, &dta_table->num_rule_nodes);
+		}
+		if (dta_table->entrypoints[i]) {
+			avrule_list_finalize(&dta_table->entrypoints[i]->execute, &dta_table->num_rule_nodes);
+			terule_list_finalize(&dta_table->entrypoints[i]->type_transition, &dta_table->num_rule_nodes);
+		}
+	}
+	if (table_build_transitions(policy, dta_table)) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
 
 	return 0;
 
       err:
-	apol_avrule_query_destroy(&avq);
-	apol_vector_destroy(&avrules);
-	apol_terule_query_destroy(&teq);
-	apol_vector_destroy(&terules);
+	qpol_iterator_destroy(&iter);
+	table_builder_fini(&builder);
 	domain_trans_table_destroy(&dta_table);
 	policy->domain_trans_table = NULL;
 	errno = error;
@@ -601,18 +788,27 @@ void domain_trans_table_destroy(apol_domain_trans_table_t ** table)
 	if (!table || !(*table))
 		return;
 
-	apol_bst_destroy(&(*table)->domain_table);
-	apol_bst_destroy(&(*table)->entrypoint_table);
+	if ((*table)->domains) {
+		for (size_t i = 0; i < (*table)->num_types; i++)
+			dom_node_free((*table)->domains[i]);
+		free((*table)->domains);
+	}
+	if ((*table)->entrypoints) {
+		for (size_t i = 0; i < (*table)->num_types; i++)
+			ep_node_free((*table)->entrypoints[i]);
+		free((*table)->entrypoints);
+	}
+	free((*table)->trans_start);
+	free((*table)->trans_targets);
+	free((*table)->trans_eps);
 	free(*table);
 	*table = NULL;
 }
 
-void apol_policy_reset_domain_trans_table(apol_policy_t * policy)
+void apol_policy_reset_domain_trans_table(apol_policy_t * policy __attribute__ ((unused)))
 {
-	if (!policy || !policy->domain_trans_table)
-		return;
-	apol_bst_inorder_map(policy->domain_trans_table->domain_table, dom_node_reset, NULL);
-	apol_bst_inorder_map(policy->domain_trans_table->entrypoint_table, ep_node_reset, NULL);
+	/* each analysis keeps its own visitation state, so the table
+	 * itself never needs to be reset */
 	return;
 }
 
@@ -621,6 +817,7 @@ void apol_domain_trans_table_reset(apol_policy_t * policy)
 	apol_policy_reset_domain_trans_table(policy);
 }
 
+
 /* analysis */
 apol_domain_trans_analysis_t *apol_domain_trans_analysis_create(void)
 {
@@ -873,64 +1070,28 @@ static bool requires_setexec_or_type_trans(apol_policy_t * policy)
 	return (policy_version >= 15 || is_modular);
 }
 
-struct rule_map_data
-{
-	const qpol_type_t *search;
-	const qpol_type_t *dflt;
-	apol_vector_t *node_list;
-	bool is_avnode;
-};
-
-static int node_list_map_fn(void *node, void *data)
-{
-	struct rule_map_data *rm = data;
-	if (rm->is_avnode) {
-		avrule_node_t *anode = node;
-		if (anode->type == rm->search && !anode->used)
-			if (apol_vector_append(rm->node_list, node))
-				return -1;
-		return 0;
-	} else {
-		terule_node_t *tnode = node;
-		if ((!rm->search || (rm->search == tnode->src)) && (!rm->dflt || (rm->dflt == tnode->dflt)) &&
-		    rm->search != rm->dflt && !tnode->used)
-			if (apol_vector_append(rm->node_list, node))
-				return -1;
-		return 0;
-	}
-}
-
-static apol_vector_t *find_avrules_in_node(void *node, unsigned int rule_type, const qpol_type_t * search)
+static apol_vector_t *find_avrules_in_node(void *node, unsigned int rule_type, const qpol_type_t * search,
+					   const apol_bitmap_t * used)
 {
 	int error = 0;
+	const avrule_list_t *list = NULL;
 	apol_vector_t *rule_nodes = apol_vector_create(NULL);	//shallow copies only
-	struct rule_map_data data = { search, NULL, rule_nodes, true };
+	if (!rule_nodes)
+		return NULL;
 	switch (rule_type) {
 	case APOL_DOMAIN_TRANS_RULE_PROC_TRANS:
 	{
-		dom_node_t *dnode = node;
-		if (apol_bst_inorder_map(dnode->process_transition_tree, node_list_map_fn, (void *)&data) < 0) {
-			error = errno;
-			goto err;
-		}
+		list = &((dom_node_t *) node)->process_transition;
 		break;
 	}
 	case APOL_DOMAIN_TRANS_RULE_ENTRYPOINT:
 	{
-		dom_node_t *dnode = node;
-		if (apol_bst_inorder_map(dnode->entrypoint_tree, node_list_map_fn, (void *)&data) < 0) {
-			error = errno;
-			goto err;
-		}
+		list = &((dom_node_t *) node)->entrypoint;
 		break;
 	}
 	case APOL_DOMAIN_TRANS_RULE_EXEC:
 	{
-		ep_node_t *enode = node;
-		if (apol_bst_inorder_map(enode->execute_tree, node_list_map_fn, (void *)&data) < 0) {
-			error = errno;
-			goto err;
-		}
+		list = &((ep_node_t *) node)->execute;
 		break;
 	}
 	default:
@@ -940,6 +1101,13 @@ static apol_vector_t *find_avrules_in_node(void *node, unsigned int rule_type, c
 	}
 	}
 
+	for (size_t i = avrule_list_lower_bound(list, search); i < list->size && list->nodes[i].type == search; i++) {
+		if (!(used && apol_bitmap_get(used, list->nodes[i].id)) && apol_vector_append(rule_nodes, &list->nodes[i])) {
+			error = errno;
+			goto err;
+		}
+	}
+
 	return rule_nodes;
 
       err:
@@ -948,14 +1116,21 @@ static apol_vector_t *find_avrules_in_node(void *node, unsigned int rule_type, c
 	return NULL;
 }
 
-static apol_vector_t *find_terules_in_node(ep_node_t * node, const qpol_type_t * search, const qpol_type_t * dflt)
+static apol_vector_t *find_terules_in_node(ep_node_t * node, const qpol_type_t * search, const qpol_type_t * dflt,
+					   const apol_bitmap_t * used)
 {
 	int error = 0;
 	apol_vector_t *rule_nodes = apol_vector_create(NULL);	//shallow copies only
-	struct rule_map_data data = { search, dflt, rule_nodes, false };
-	if (apol_bst_inorder_map(node->type_transition_tree, node_list_map_fn, (void *)&data) < 0) {
-		error = errno;
-		goto err;
+	if (!rule_nodes)
+		return NULL;
+	for (size_t i = 0; i < node->type_transition.size; i++) {
+		terule_node_t *tnode = &node->type_transition.nodes[i];
+		if ((!search || (search == tnode->src)) && (!dflt || (dflt == tnode->dflt)) && search != dflt &&
+		    !(used && apol_bitmap_get(used, tnode->id)))
+			if (apol_vector_append(rule_nodes, tnode)) {
+				error = errno;
+				goto err;
+			}
 	}
 
 	return rule_nodes;
@@ -978,28 +1153,28 @@ static apol_domain_trans_result_t *find_result(apol_vector_t * local_results, co
 }
 
 static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
-							   apol_vector_t * local_results)
+							   apol_vector_t * local_results, apol_bitmap_t * used)
 {
 	int error = 0;
 	const qpol_type_t *search = NULL;
 	qpol_policy_get_type_by_name(apol_policy_get_qpol(policy), dta->start_type, &search);
 	apol_domain_trans_result_t *tmp_result = NULL;
 	//walk ep table
-	apol_vector_t *epnodes = apol_bst_get_vector(policy->domain_trans_table->entrypoint_table, 0);
-	if (!epnodes)
-		return -1;
-	for (size_t i = 0; i < apol_vector_get_size(epnodes); i++) {
-		ep_node_t *node = apol_vector_get_element(epnodes, i);
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	for (size_t i = 0; i < table->num_types; i++) {
+		ep_node_t *node = table->entrypoints[i];
+		if (!node)
+			continue;
 		//find any unused type transitions
 		apol_vector_t *ttnodes = NULL;
 		if (dta->direction == APOL_DOMAIN_TRANS_DIRECTION_FORWARD)
-			ttnodes = find_terules_in_node(node, search, NULL);
+			ttnodes = find_terules_in_node(node, search, NULL, used);
 		else
-			ttnodes = find_terules_in_node(node, NULL, search);
+			ttnodes = find_terules_in_node(node, NULL, search, used);
 		for (size_t j = 0; j < apol_vector_get_size(ttnodes); j++) {
 			bool add = false;
 			terule_node_t *tn = apol_vector_get_element(ttnodes, j);
-			tn->used = true;
+			apol_bitmap_set(used, tn->id);
 			//if missing an entrypoint rule this transition may have already been added to the results
 			tmp_result = find_result(local_results, tn->src, node->type, tn->dflt);
 			if (!tmp_result) {
@@ -1016,7 +1191,7 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 			tmp_result->ep_type = node->type;
 			//check for exec
 			apol_vector_t *execrules =
-				find_avrules_in_node((void *)node, APOL_DOMAIN_TRANS_RULE_EXEC, tmp_result->start_type);
+				find_avrules_in_node((void *)node, APOL_DOMAIN_TRANS_RULE_EXEC, tmp_result->start_type, used);
 			for (size_t k = 0; k < apol_vector_get_size(execrules); k++) {
 				avrule_node_t *n = apol_vector_get_element(execrules, k);
 				if (apol_vector_append(tmp_result->exec_rules, (void *)n->rule)) {
@@ -1029,9 +1204,7 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 			}
 			apol_vector_destroy(&execrules);
 			//check for proc_trans and setexec
-			dom_node_t dummy = { tmp_result->start_type, NULL, NULL, NULL };
-			dom_node_t *start_node = NULL;
-			apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&start_node);
+			dom_node_t *start_node = table_get_dom_node(policy, table, tmp_result->start_type);
 			if (start_node) {
 				//only copy setexec_rules if a new result will be added
 				if (add && apol_vector_get_size(start_node->setexec_rules)) {
@@ -1043,7 +1216,7 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 				//add any unused proc_trans rules
 				apol_vector_t *proc_trans_rules =
 					find_avrules_in_node((void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS,
-							     tmp_result->end_type);
+							     tmp_result->end_type, used);
 				for (size_t k = 0; k < apol_vector_get_size(proc_trans_rules); k++) {
 					avrule_node_t *avr = apol_vector_get_element(proc_trans_rules, k);
 					if (apol_vector_append(tmp_result->proc_trans_rules, (void *)avr->rule)) {
@@ -1067,19 +1240,18 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 		}
 		apol_vector_destroy(&ttnodes);
 	}
-	apol_vector_destroy(&epnodes);
 
 	return 0;
 
       err:
-	apol_vector_destroy(&epnodes);
 	apol_domain_trans_result_destroy(&tmp_result);
 	errno = error;
 	return -1;
 }
 
 static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
-						    apol_vector_t * local_results, const qpol_type_t * start_type)
+						    apol_vector_t * local_results, const qpol_type_t * start_type,
+						    apol_bitmap_t * used)
 {
 	int error = 0;
 	//create template result this will hold common data for each step and be copied as needed
@@ -1089,9 +1261,8 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 		goto err;
 	}
 	//find start node
-	dom_node_t dummy = { start_type, NULL, NULL, NULL };
-	dom_node_t *start_node = NULL;
-	apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&start_node);
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	dom_node_t *start_node = table_get_dom_node(policy, table, start_type);
 	if (start_node) {
 		tmpl_result->start_type = start_type;
 		//if needed and present record setexec
@@ -1102,30 +1273,26 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 			}
 		}
 		//check all proc trans to build list of end types
-		apol_vector_t *proc_trans_rules = apol_bst_get_vector(start_node->process_transition_tree, 0);
 		apol_vector_t *potential_end_types = apol_vector_create(NULL);
-		for (size_t i = 0; i < apol_vector_get_size(proc_trans_rules); i++) {
-			avrule_node_t *ptnode = apol_vector_get_element(proc_trans_rules, i);
+		for (size_t i = 0; i < start_node->process_transition.size; i++) {
+			avrule_node_t *ptnode = &start_node->process_transition.nodes[i];
 			apol_vector_append(potential_end_types, (void *)ptnode->type);
 		}
-		apol_vector_destroy(&proc_trans_rules);
 		apol_vector_sort_uniquify(potential_end_types, NULL, NULL);
 		//for each end check ep
 		for (size_t i = 0; i < apol_vector_get_size(potential_end_types); i++) {
-			dummy.type = tmpl_result->end_type = apol_vector_get_element(potential_end_types, i);
-			dom_node_t *end_node = NULL;
-			apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&end_node);
-			const qpol_type_t *end_type = dummy.type;
+			const qpol_type_t *end_type = tmpl_result->end_type = apol_vector_get_element(potential_end_types, i);
+			dom_node_t *end_node = table_get_dom_node(policy, table, end_type);
 			if (end_type == start_type)
 				continue;
 			//get all proc trans rules for ths end (may be multiple due to attributes)
 			apol_vector_t *ptrules =
-				find_avrules_in_node((void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_type);
+				find_avrules_in_node((void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_type, used);
 			apol_vector_destroy(&tmpl_result->proc_trans_rules);
 			tmpl_result->proc_trans_rules = apol_vector_create(NULL);
 			for (size_t j = 0; j < apol_vector_get_size(ptrules); j++) {
 				avrule_node_t *pt_ent = apol_vector_get_element(ptrules, j);
-				pt_ent->used = true;
+				apol_bitmap_set(used, pt_ent->id);
 				if (apol_vector_append(tmpl_result->proc_trans_rules, (void *)pt_ent->rule)) {
 					error = errno;
 					apol_vector_destroy(&ptrules);
@@ -1137,34 +1304,27 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 			apol_vector_sort_uniquify(tmpl_result->proc_trans_rules, NULL, NULL);
 			if (end_node) {
 				//collect potential entrypoint types
-				apol_vector_t *eprules = apol_bst_get_vector(end_node->entrypoint_tree, 0);
+				apol_vector_t *eprules = NULL;
 				apol_vector_t *potential_ep_types = apol_vector_create(NULL);
-				if (!eprules || !potential_ep_types) {
+				if (!potential_ep_types) {
 					error = errno;
-					apol_vector_destroy(&eprules);
 					apol_vector_destroy(&potential_end_types);
 					goto err;
 				}
-				for (size_t j = 0; j < apol_vector_get_size(eprules); j++) {
-					avrule_node_t *epr = apol_vector_get_element(eprules, j);
+				for (size_t j = 0; j < end_node->entrypoint.size; j++) {
+					avrule_node_t *epr = &end_node->entrypoint.nodes[j];
 					if (apol_vector_append(potential_ep_types, (void *)epr->type)) {
 						error = errno;
-						apol_vector_destroy(&eprules);
 						apol_vector_destroy(&potential_end_types);
 						apol_vector_destroy(&potential_ep_types);
 						goto err;
 					}
 				}
-				apol_vector_destroy(&eprules);
 				apol_vector_sort_uniquify(potential_ep_types, NULL, NULL);
 				//for each ep find exec by start
 				for (size_t j = 0; j < apol_vector_get_size(potential_ep_types); j++) {
 					tmpl_result->ep_type = apol_vector_get_element(potential_ep_types, j);
-					ep_node_t edummy =
-						{ (const qpol_type_t *)apol_vector_get_element(potential_ep_types, j), NULL, NULL };
-					ep_node_t *epnode = NULL;
-					apol_bst_get_element(policy->domain_trans_table->entrypoint_table, (void *)&edummy, NULL,
-							     (void **)&epnode);
+					ep_node_t *epnode = table_get_ep_node(policy, table, tmpl_result->ep_type);
 					//get all entrypoint rules for ths end (may be multiple due to attributes)
 					apol_vector_destroy(&tmpl_result->ep_rules);
 					tmpl_result->ep_rules = apol_vector_create(NULL);
@@ -1175,10 +1335,10 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 						goto err;
 					}
 					eprules = find_avrules_in_node((void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT,
-								       tmpl_result->ep_type);
+								       tmpl_result->ep_type, used);
 					for (size_t k = 0; k < apol_vector_get_size(eprules); k++) {
 						avrule_node_t *ep_ent = apol_vector_get_element(eprules, k);
-						ep_ent->used = true;
+						apol_bitmap_set(used, ep_ent->id);
 						if (apol_vector_append(tmpl_result->ep_rules, (void *)ep_ent->rule)) {
 							error = errno;
 							apol_vector_destroy(&eprules);
@@ -1199,7 +1359,7 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 							apol_vector_destroy(&potential_ep_types);
 							goto err;
 						}
-						apol_vector_t *ttrules = find_terules_in_node(epnode, start_type, end_type);
+						apol_vector_t *ttrules = find_terules_in_node(epnode, start_type, end_type, used);
 						for (size_t l = 0; l < apol_vector_get_size(ttrules); l++) {
 							terule_node_t *tn = apol_vector_get_element(ttrules, l);
 							if (apol_vector_append(tmpl_result->type_trans_rules, (void *)tn->rule)) {
@@ -1222,7 +1382,7 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 							goto err;
 						}
 						apol_vector_t *execrules =
-							find_avrules_in_node(epnode, APOL_DOMAIN_TRANS_RULE_EXEC, start_type);
+							find_avrules_in_node(epnode, APOL_DOMAIN_TRANS_RULE_EXEC, start_type, used);
 						if (apol_vector_get_size(execrules)) {
 							for (size_t l = 0; l < apol_vector_get_size(execrules); l++) {
 								avrule_node_t *xnode = apol_vector_get_element(execrules, l);
@@ -1329,7 +1489,7 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 	}
 	//iff looking for invalid find orphan type_transition rules
 	if (dta->valid & APOL_DOMAIN_TRANS_SEARCH_INVALID) {
-		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results)) {
+		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results, used)) {
 			error = errno;
 			goto err;
 		}
@@ -1344,7 +1504,8 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 }
 
 static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
-						    apol_vector_t * local_results, const qpol_type_t * end_type)
+						    apol_vector_t * local_results, const qpol_type_t * end_type,
+						    apol_bitmap_t * used)
 {
 	int error = 0;
 	//create template result this will hold common data for each step and be copied as needed
@@ -1354,39 +1515,36 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 		goto err;
 	}
 	//find end node
-	dom_node_t dummy = { end_type, NULL, NULL, NULL };
-	dom_node_t *end_node = NULL;
-	apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&end_node);
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	dom_node_t *end_node = table_get_dom_node(policy, table, end_type);
 	if (end_node) {
 		tmpl_result->end_type = end_type;
 		//collect potential entrypoint types
-		apol_vector_t *eprules = apol_bst_get_vector(end_node->entrypoint_tree, 0);
+		apol_vector_t *eprules = NULL;
 		apol_vector_t *potential_ep_types = apol_vector_create(NULL);
-		if (!eprules || !potential_ep_types) {
+		if (!potential_ep_types) {
 			error = errno;
-			apol_vector_destroy(&eprules);
 			goto err;
 		}
-		for (size_t j = 0; j < apol_vector_get_size(eprules); j++) {
-			avrule_node_t *epr = apol_vector_get_element(eprules, j);
+		for (size_t j = 0; j < end_node->entrypoint.size; j++) {
+			avrule_node_t *epr = &end_node->entrypoint.nodes[j];
 			if (apol_vector_append(potential_ep_types, (void *)epr->type)) {
 				error = errno;
-				apol_vector_destroy(&eprules);
 				apol_vector_destroy(&potential_ep_types);
 				goto err;
 			}
 		}
-		apol_vector_destroy(&eprules);
 		apol_vector_sort_uniquify(potential_ep_types, NULL, NULL);
 		for (size_t i = 0; i < apol_vector_get_size(potential_ep_types); i++) {
 			tmpl_result->ep_type = apol_vector_get_element(potential_ep_types, i);
 			//get all ep rules for this end (may be multiple due to attributes)
-			eprules = find_avrules_in_node((void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, tmpl_result->ep_type);
+			eprules = find_avrules_in_node((void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, tmpl_result->ep_type,
+						       used);
 			apol_vector_destroy(&tmpl_result->ep_rules);
 			tmpl_result->ep_rules = apol_vector_create(NULL);
 			for (size_t j = 0; j < apol_vector_get_size(eprules); j++) {
 				avrule_node_t *ep_ent = apol_vector_get_element(eprules, j);
-				ep_ent->used = true;
+				apol_bitmap_set(used, ep_ent->id);
 				if (apol_vector_append(tmpl_result->ep_rules, (void *)ep_ent->rule)) {
 					error = errno;
 					apol_vector_destroy(&eprules);
@@ -1396,29 +1554,24 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 			}
 			apol_vector_destroy(&eprules);
 			apol_vector_sort_uniquify(tmpl_result->ep_rules, NULL, NULL);
-			ep_node_t edummy = { tmpl_result->ep_type, NULL, NULL };
-			ep_node_t *epnode = NULL;
-			apol_bst_get_element(policy->domain_trans_table->entrypoint_table, (void *)&edummy, NULL, (void **)&epnode);
+			ep_node_t *epnode = table_get_ep_node(policy, table, tmpl_result->ep_type);
 			//for each ep find exec rules to generate list of potential start types
 			if (epnode) {
-				apol_vector_t *execrules = apol_bst_get_vector(epnode->execute_tree, 0);
 				apol_vector_t *potential_start_types = apol_vector_create(NULL);
-				if (!execrules || !potential_start_types) {
+				if (!potential_start_types) {
 					error = errno;
-					apol_vector_destroy(&execrules);
+					apol_vector_destroy(&potential_ep_types);
 					goto err;
 				}
-				for (size_t k = 0; k < apol_vector_get_size(execrules); k++) {
-					avrule_node_t *n = apol_vector_get_element(execrules, k);
+				for (size_t k = 0; k < epnode->execute.size; k++) {
+					avrule_node_t *n = &epnode->execute.nodes[k];
 					if (apol_vector_append(potential_start_types, (void *)n->type)) {
 						error = errno;
-						apol_vector_destroy(&execrules);
 						apol_vector_destroy(&potential_start_types);
 						apol_vector_destroy(&potential_ep_types);
 						goto err;
 					}
 				}
-				apol_vector_destroy(&execrules);
 				apol_vector_sort_uniquify(potential_start_types, NULL, NULL);
 				for (size_t k = 0; k < apol_vector_get_size(potential_start_types); k++) {
 					tmpl_result->start_type = apol_vector_get_element(potential_start_types, k);
@@ -1428,12 +1581,12 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 					//get all execute rule for this start type
 					apol_vector_t *exec_rules =
 						find_avrules_in_node((void *)epnode, APOL_DOMAIN_TRANS_RULE_EXEC,
-								     tmpl_result->start_type);
+								     tmpl_result->start_type, used);
 					apol_vector_destroy(&tmpl_result->exec_rules);
 					tmpl_result->exec_rules = apol_vector_create(NULL);
 					for (size_t l = 0; l < apol_vector_get_size(exec_rules); l++) {
 						avrule_node_t *n = apol_vector_get_element(exec_rules, l);
-						n->used = true;
+						apol_bitmap_set(used, n->id);
 						if (apol_vector_append(tmpl_result->exec_rules, (void *)n->rule)) {
 							error = errno;
 							apol_vector_destroy(&exec_rules);
@@ -1446,7 +1599,7 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 					apol_vector_sort_uniquify(tmpl_result->exec_rules, NULL, NULL);
 					//check for type transition rules
 					apol_vector_t *ttrules =
-						find_terules_in_node(epnode, tmpl_result->start_type, tmpl_result->end_type);
+						find_terules_in_node(epnode, tmpl_result->start_type, tmpl_result->end_type, used);
 					apol_vector_destroy(&tmpl_result->type_trans_rules);
 					tmpl_result->type_trans_rules = apol_vector_create(NULL);
 					if (!tmpl_result->type_trans_rules) {
@@ -1458,7 +1611,7 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 					}
 					for (size_t l = 0; l < apol_vector_get_size(ttrules); l++) {
 						terule_node_t *n = apol_vector_get_element(ttrules, l);
-						n->used = true;
+						apol_bitmap_set(used, n->id);
 						if (apol_vector_append(tmpl_result->type_trans_rules, (void *)n->rule)) {
 							error = errno;
 							apol_vector_destroy(&ttrules);
@@ -1469,10 +1622,7 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 					}
 					apol_vector_destroy(&ttrules);
 					apol_vector_sort_uniquify(tmpl_result->type_trans_rules, NULL, NULL);
-					dummy.type = tmpl_result->start_type;
-					dom_node_t *start_node = NULL;
-					apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL,
-							     (void **)&start_node);
+					dom_node_t *start_node = table_get_dom_node(policy, table, tmpl_result->start_type);
 					if (start_node) {
 						//for each start check setexec if needed
 						if (requires_setexec_or_type_trans(policy)) {
@@ -1499,7 +1649,7 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 						apol_vector_t *pt_rules = NULL;
 						pt_rules =
 							find_avrules_in_node(start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS,
-									     tmpl_result->end_type);
+									     tmpl_result->end_type, used);
 						if (apol_vector_get_size(pt_rules)) {
 							for (size_t l = 0; l < apol_vector_get_size(pt_rules); l++) {
 								avrule_node_t *n = apol_vector_get_element(pt_rules, l);
@@ -1609,7 +1759,7 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 	}
 	//iff looking for invalid find orphan type_transition rules
 	if (dta->valid & APOL_DOMAIN_TRANS_SEARCH_INVALID) {
-		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results)) {
+		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results, used)) {
 			error = errno;
 			goto err;
 		}
@@ -1628,6 +1778,7 @@ int apol_domain_trans_analysis_do(apol_policy_t * policy, apol_domain_trans_anal
 {
 	apol_vector_t *local_results = NULL;
 	apol_avrule_query_t *accessq = NULL;
+	apol_bitmap_t *used = NULL;
 	int error = 0;
 	if (!results)
 		*results = NULL;
@@ -1675,15 +1826,22 @@ int apol_domain_trans_analysis_do(apol_policy_t * policy, apol_domain_trans_anal
 		goto err;
 	}
 
-	local_results = apol_vector_create(domain_trans_result_free);
+	/* rules consumed by this analysis; kept here rather than in the
+	 * shared table so that analyses are independent of each other */
+	if (!(used = apol_bitmap_create(policy->domain_trans_table->num_rule_nodes)) ||
+	    !(local_results = apol_vector_create(domain_trans_result_free))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
 	/* get all transitions for the requested direction */
 	if (dta->direction == APOL_DOMAIN_TRANS_DIRECTION_REVERSE) {
-		if (domain_trans_table_get_all_reverse_trans(policy, dta, local_results, start_type)) {
+		if (domain_trans_table_get_all_reverse_trans(policy, dta, local_results, start_type, used)) {
 			error = errno;
 			goto err;
 		}
 	} else {
-		if (domain_trans_table_get_all_forward_trans(policy, dta, local_results, start_type)) {
+		if (domain_trans_table_get_all_forward_trans(policy, dta, local_results, start_type, used)) {
 			error = errno;
 			goto err;
 		}
@@ -1792,16 +1950,395 @@ int apol_domain_trans_analysis_do(apol_policy_t * policy, apol_domain_trans_anal
 		}
 	}
 	apol_vector_destroy(&local_results);
+	apol_bitmap_destroy(&used);
 
 	return 0;
       err:
 	apol_vector_destroy(&local_results);
 	apol_vector_destroy(results);
 	apol_avrule_query_destroy(&accessq);
+	apol_bitmap_destroy(&used);
+	errno = error;
+	return -1;
+}
+
+/* reachability */
+apol_domain_trans_reach_analysis_t *apol_domain_trans_reach_analysis_create(void)
+{
+	apol_domain_trans_reach_analysis_t *dra = calloc(1, sizeof(*dra));
+	if (!dra)
+		return NULL;
+	return dra;
+}
+
+void apol_domain_trans_reach_analysis_destroy(apol_domain_trans_reach_analysis_t ** dra)
+{
+	if (!dra || !(*dra))
+		return;
+	apol_vector_destroy(&(*dra)->start_types);
+	free(*dra);
+	*dra = NULL;
+}
+
+int apol_domain_trans_reach_analysis_append_start_type(const apol_policy_t * policy, apol_domain_trans_reach_analysis_t * dra,
+						       const char *type_name)
+{
+	char *tmp = NULL;
+	int error = 0;
+
+	if (!dra) {
+		ERR(policy, "Error appending type to analysis: %s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!type_name) {
+		apol_vector_destroy(&dra->start_types);
+		return 0;
+	}
+
+	if (!dra->start_types) {
+		if (!(dra->start_types = apol_vector_create(free))) {
+			error = errno;
+			ERR(policy, "%s", strerror(error));
+			errno = error;
+			return -1;
+		}
+	}
+
+	if (!(tmp = strdup(type_name)) || apol_vector_append(dra->start_types, tmp)) {
+		error = errno;
+		free(tmp);
+		ERR(policy, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+int apol_domain_trans_reach_analysis_set_max_hops(const apol_policy_t * policy, apol_domain_trans_reach_analysis_t * dra,
+						  unsigned int max_hops)
+{
+	if (!dra) {
+		ERR(policy, "Error setting maximum hops: %s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	dra->max_hops = max_hops;
+	return 0;
+}
+
+static void domain_trans_reach_result_free(void *r)
+{
+	apol_domain_trans_reach_result_t *res = r;
+	if (!res)
+		return;
+	apol_vector_destroy(&res->domains);
+	apol_vector_destroy(&res->entrypoints);
+	free(res);
+}
+
+/**
+ * Create a result for the domain with value dom_val by walking the
+ * search's parent links back to a start domain.
+ */
+static apol_domain_trans_reach_result_t *domain_trans_reach_result_create(const apol_domain_trans_table_t * table,
+									  const uint32_t * parent, const uint32_t * parent_ep,
+									  const unsigned int *hops, uint32_t dom_val)
+{
+	apol_domain_trans_reach_result_t *res = NULL;
+	unsigned int num_hops = hops[dom_val];
+	uint32_t *chain = NULL;
+	int error = 0;
+
+	if (!(chain = malloc((num_hops + 1) * sizeof(*chain))) || !(res = calloc(1, sizeof(*res))) ||
+	    !(res->domains = apol_vector_create_with_capacity(num_hops + 1, NULL)) ||
+	    !(res->entrypoints = apol_vector_create_with_capacity(num_hops, NULL))) {
+		error = errno;
+		goto err;
+	}
+	/* parent links run backwards from the end domain */
+	chain[num_hops] = dom_val;
+	for (unsigned int i = num_hops; i > 0; i--)
+		chain[i - 1] = parent[chain[i]];
+	for (unsigned int i = 0; i <= num_hops; i++) {
+		if (apol_vector_append(res->domains, (void *)table->domains[chain[i]]->type) ||
+		    (i > 0 && apol_vector_append(res->entrypoints, (void *)table->entrypoints[parent_ep[chain[i]]]->type))) {
+			error = errno;
+			goto err;
+		}
+	}
+	res->start_type = table->domains[chain[0]]->type;
+	res->end_type = table->domains[dom_val]->type;
+	free(chain);
+	return res;
+      err:
+	free(chain);
+	domain_trans_reach_result_free(res);
+	errno = error;
+	return NULL;
+}
+
+int apol_domain_trans_reach_analysis_do(apol_policy_t * policy, apol_domain_trans_reach_analysis_t * dra,
+					apol_vector_t ** results)
+{
+	apol_domain_trans_table_t *table;
+	apol_bitmap_t *visited = NULL, *frontier = NULL, *next = NULL, *tmp;
+	uint32_t *parent = NULL, *parent_ep = NULL;
+	unsigned int *hops = NULL, level;
+	int error = 0;
+
+	if (results)
+		*results = NULL;
+	if (!policy || !dra || !results || apol_vector_get_size(dra->start_types) == 0) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* build table if not already present */
+	if (!(policy->domain_trans_table)) {
+		if (apol_policy_build_domain_trans_table(policy))
+			return -1;     /* errors already reported by build function */
+	}
+	table = policy->domain_trans_table;
+
+	if (!(visited = apol_bitmap_create(table->num_types)) || !(frontier = apol_bitmap_create(table->num_types)) ||
+	    !(next = apol_bitmap_create(table->num_types)) || !(parent = calloc(table->num_types, sizeof(*parent))) ||
+	    !(parent_ep = calloc(table->num_types, sizeof(*parent_ep))) || !(hops = calloc(table->num_types, sizeof(*hops))) ||
+	    !(*results = apol_vector_create(domain_trans_reach_result_free))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
+
+	for (size_t i = 0; i < apol_vector_get_size(dra->start_types); i++) {
+		const char *name = apol_vector_get_element(dra->start_types, i);
+		const qpol_type_t *start_type = NULL;
+		unsigned char isattr = 0;
+		if (qpol_policy_get_type_by_name(policy->p, name, &start_type)) {
+			error = errno;
+			ERR(policy, "Unable to perform analysis: Invalid starting type %s", name);
+			goto err;
+		}
+		qpol_type_get_isattr(policy->p, start_type, &isattr);
+		if (isattr) {
+			ERR(policy, "%s", "Attributes are not valid here.");
+			error = EINVAL;
+			goto err;
+		}
+		uint32_t val = table_type_index(policy, table, start_type);
+		/* a type with no process rules cannot go anywhere */
+		if (val && table->domains[val]) {
+			apol_bitmap_set(visited, val);
+			apol_bitmap_set(frontier, val);
+		}
+	}
+
+	/* breadth first search one level at a time, so that the first
+	 * time a domain is seen is along a shortest chain */
+	for (level = 1; apol_bitmap_count(frontier) > 0 && (dra->max_hops == 0 || level <= dra->max_hops); level++) {
+		apol_bitmap_clear_all(next);
+		for (size_t u = apol_bitmap_next(frontier, 0); u < table->num_types; u = apol_bitmap_next(frontier, u + 1)) {
+			for (size_t e = table->trans_start[u]; e < table->trans_start[u + 1]; e++) {
+				uint32_t v = table->trans_targets[e];
+				if (apol_bitmap_get(visited, v))
+					continue;
+				apol_bitmap_set(visited, v);
+				apol_bitmap_set(next, v);
+				parent[v] = (uint32_t) u;
+				parent_ep[v] = table->trans_eps[e];
+				hops[v] = level;
+			}
+		}
+		for (size_t v = apol_bitmap_next(next, 0); v < table->num_types; v = apol_bitmap_next(next, v + 1)) {
+			apol_domain_trans_reach_result_t *res =
+				domain_trans_reach_result_create(table, parent, parent_ep, hops, (uint32_t) v);
+			if (!res || apol_vector_append(*results, res)) {
+				error = errno;
+				domain_trans_reach_result_free(res);
+				ERR(policy, "%s", strerror(error));
+				goto err;
+			}
+		}
+		tmp = frontier;
+		frontier = next;
+		next = tmp;
+	}
+
+	apol_bitmap_destroy(&visited);
+	apol_bitmap_destroy(&frontier);
+	apol_bitmap_destroy(&next);
+	free(parent);
+	free(parent_ep);
+	free(hops);
+	return 0;
+      err:
+	apol_bitmap_destroy(&visited);
+	apol_bitmap_destroy(&frontier);
+	apol_bitmap_destroy(&next);
+	free(parent);
+	free(parent_ep);
+	free(hops);
+	apol_vector_destroy(results);
 	errno = error;
 	return -1;
 }
 
+const qpol_type_t *apol_domain_trans_reach_result_get_start_type(const apol_domain_trans_reach_result_t * drr)
+{
+	if (drr) {
+		return drr->start_type;
+	} else {
+		errno = EINVAL;
+		return NULL;
+	}
+}
+
+const qpol_type_t *apol_domain_trans_reach_result_get_end_type(const apol_domain_trans_reach_result_t * drr)
+{
+	if (drr) {
+		return drr->end_type;
+	} else {
+		errno = EINVAL;
+		return NULL;
+	}
+}
+
+unsigned int apol_domain_trans_reach_result_get_num_hops(const apol_domain_trans_reach_result_t * drr)
+{
+	if (drr) {
+		return (unsigned int)apol_vector_get_size(drr->entrypoints);
+	} else {
+		errno = EINVAL;
+		return 0;
+	}
+}
+
+const apol_vector_t *apol_domain_trans_reach_result_get_domains(const apol_domain_trans_reach_result_t * drr)
+{
+	if (drr) {
+		return drr->domains;
+	} else {
+		errno = EINVAL;
+		return NULL;
+	}
+}
+
+const apol_vector_t *apol_domain_trans_reach_result_get_entrypoints(const apol_domain_trans_reach_result_t * drr)
+{
+	if (drr) {
+		return drr->entrypoints;
+	} else {
+		errno = EINVAL;
+		return NULL;
+	}
+}
+
+/**
+ * Gather every rule supporting the transition start -> end through
+ * entrypoint ep.  The transition is known to be valid.
+ */
+static apol_domain_trans_result_t *domain_trans_table_make_step(apol_policy_t * policy, const qpol_type_t * start,
+								const qpol_type_t * ep, const qpol_type_t * end)
+{
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	const dom_node_t *start_node = table_get_dom_node(policy, table, start);
+	const dom_node_t *end_node = table_get_dom_node(policy, table, end);
+	const ep_node_t *ep_node = table_get_ep_node(policy, table, ep);
+	apol_domain_trans_result_t *res = NULL;
+	size_t i;
+	int error = 0;
+
+	if (!start_node || !end_node || !ep_node) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if (!(res = domain_trans_result_create())) {
+		return NULL;
+	}
+	res->start_type = start;
+	res->ep_type = ep;
+	res->end_type = end;
+	res->valid = true;
+	for (i = avrule_list_lower_bound(&start_node->process_transition, end);
+	     i < start_node->process_transition.size && start_node->process_transition.nodes[i].type == end; i++) {
+		if (apol_vector_append(res->proc_trans_rules, (void *)start_node->process_transition.nodes[i].rule)) {
+			error = errno;
+			goto err;
+		}
+	}
+	for (i = avrule_list_lower_bound(&end_node->entrypoint, ep);
+	     i < end_node->entrypoint.size && end_node->entrypoint.nodes[i].type == ep; i++) {
+		if (apol_vector_append(res->ep_rules, (void *)end_node->entrypoint.nodes[i].rule)) {
+			error = errno;
+			goto err;
+		}
+	}
+	for (i = avrule_list_lower_bound(&ep_node->execute, start);
+	     i < ep_node->execute.size && ep_node->execute.nodes[i].type == start; i++) {
+		if (apol_vector_append(res->exec_rules, (void *)ep_node->execute.nodes[i].rule)) {
+			error = errno;
+			goto err;
+		}
+	}
+	for (i = 0; i < ep_node->type_transition.size; i++) {
+		const terule_node_t *tn = &ep_node->type_transition.nodes[i];
+		if (tn->src == start && tn->dflt == end && apol_vector_append(res->type_trans_rules, (void *)tn->rule)) {
+			error = errno;
+			goto err;
+		}
+	}
+	if (requires_setexec_or_type_trans(policy) && apol_vector_cat(res->setexec_rules, start_node->setexec_rules)) {
+		error = errno;
+		goto err;
+	}
+	apol_vector_sort_uniquify(res->proc_trans_rules, NULL, NULL);
+	apol_vector_sort_uniquify(res->ep_rules, NULL, NULL);
+	apol_vector_sort_uniquify(res->exec_rules, NULL, NULL);
+	apol_vector_sort_uniquify(res->type_trans_rules, NULL, NULL);
+	return res;
+      err:
+	apol_domain_trans_result_destroy(&res);
+	errno = error;
+	return NULL;
+}
+
+int apol_domain_trans_reach_result_get_steps(apol_policy_t * policy, const apol_domain_trans_reach_result_t * drr,
+					     apol_vector_t ** steps)
+{
+	int error = 0;
+	if (steps)
+		*steps = NULL;
+	if (!policy || !drr || !steps || !policy->domain_trans_table) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (!(*steps = apol_vector_create_with_capacity(apol_vector_get_size(drr->entrypoints), domain_trans_result_free))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	for (size_t i = 0; i < apol_vector_get_size(drr->entrypoints); i++) {
+		apol_domain_trans_result_t *res = domain_trans_table_make_step(policy,
+									      apol_vector_get_element(drr->domains, i),
+									      apol_vector_get_element(drr->entrypoints, i),
+									      apol_vector_get_element(drr->domains, i + 1));
+		if (!res || apol_vector_append(*steps, res)) {
+			error = errno;
+			domain_trans_result_free(res);
+			ERR(policy, "%s", strerror(error));
+			apol_vector_destroy(steps);
+			errno = error;
+			return -1;
+		}
+	}
+	return 0;
+}
+
 /* result */
 
 const qpol_type_t *apol_domain_trans_result_get_start_type(const apol_domain_trans_result_t * dtr)
@@ -1913,41 +2450,30 @@ int apol_domain_trans_table_verify_trans(apol_policy_t * policy, const qpol_type
 		errno = EINVAL;
 		return -1;
 	}
-	//reset the table
-	apol_policy_reset_domain_trans_table(policy);
 	//find nodes for each type
-	dom_node_t start_dummy = { start_dom, NULL, NULL, NULL };
-	dom_node_t *start_node = NULL;
-	if (start_dom)
-		apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&start_dummy, NULL, (void **)&start_node);
-	ep_node_t ep_dummy = { ep_type, NULL, NULL };
-	ep_node_t *ep_node = NULL;
-	if (ep_type)
-		apol_bst_get_element(policy->domain_trans_table->entrypoint_table, (void *)&ep_dummy, NULL, (void **)&ep_node);
-	dom_node_t end_dummy = { end_dom, NULL, NULL, NULL };
-	dom_node_t *end_node = NULL;
-	if (end_dom)
-		apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&end_dummy, NULL, (void **)&end_node);
+	dom_node_t *start_node = table_get_dom_node(policy, policy->domain_trans_table, start_dom);
+	ep_node_t *ep_node = table_get_ep_node(policy, policy->domain_trans_table, ep_type);
+	dom_node_t *end_node = table_get_dom_node(policy, policy->domain_trans_table, end_dom);
 
 	bool tt = false, sx = false, ex = false, pt = false, ep = false;
 
 	//find process transition rule
 	if (start_node && end_dom) {
-		apol_vector_t *v = find_avrules_in_node(start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_dom);
+		apol_vector_t *v = find_avrules_in_node(start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_dom, NULL);
 		if (apol_vector_get_size(v))
 			pt = true;
 		apol_vector_destroy(&v);
 	}
 	//find execute rule
 	if (start_dom && ep_node) {
-		apol_vector_t *v = find_avrules_in_node(ep_node, APOL_DOMAIN_TRANS_RULE_EXEC, start_dom);
+		apol_vector_t *v = find_avrules_in_node(ep_node, APOL_DOMAIN_TRANS_RULE_EXEC, start_dom, NULL);
 		if (apol_vector_get_size(v))
 			ex = true;
 		apol_vector_destroy(&v);
 	}
 	//find entrypoint rules
 	if (end_node && ep_type) {
-		apol_vector_t *v = find_avrules_in_node(end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, ep_type);
+		apol_vector_t *v = find_avrules_in_node(end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, ep_type, NULL);
 		if (apol_vector_get_size(v))
 			ep = true;
 		apol_vector_destroy(&v);
@@ -1959,7 +2485,7 @@ int apol_domain_trans_table_verify_trans(apol_policy_t * policy, const qpol_type
 				sx = true;
 		//find type_transition rule
 		if (ep_node && start_dom && end_dom) {
-			apol_vector_t *v = find_terules_in_node(ep_node, start_dom, end_dom);
+			apol_vector_t *v = find_terules_in_node(ep_node, start_dom, end_dom, NULL);
 			if (apol_vector_get_size(v)) {
 				tt = true;
 			}
@@ -35,6 +35,7 @@
 #include "policy-query-internal.h"
 
 #include <qpol/iterator.h>
+#include <apol/bitmap.h>
 #include <apol/vector.h>
 
 struct apol_mls_level
@@ -46,26 +47,6 @@ struct apol_mls_level
 
 /********************* miscellaneous routines *********************/
 
-/* Given a category datum and a category name, returns < 0 if a has
- * higher value than b, > 0 if b is higher according to the given
- * policy.  If the two are equal or upon error, return 0.
- */
-static int apol_mls_cat_vector_compare(const void *a, const void *b, void *data)
-{
-	const qpol_cat_t *cat1 = a;
-	const char *cat2_name = b;
-	apol_policy_t *p = (apol_policy_t *) data;
-	const qpol_cat_t *cat2;
-	uint32_t cat_value1, cat_value2;
-	if (qpol_policy_get_cat_by_name(p->p, cat2_name, &cat2) < 0) {
-		return 0;
-	}
-	if (qpol_cat_get_value(p->p, cat1, &cat_value1) < 0 || qpol_cat_get_value(p->p, cat2, &cat_value2) < 0) {
-		return 0;
-	}
-	return (cat_value2 - cat_value1);
-}
-
 /**
  * Given two category names, returns < 0 if a has higher value than b,
  * > 0 if b is higher. The comparison is against the categories'
@@ -95,6 +76,119 @@ static int apol_mls_cat_name_compare(const void *a, const void *b, void *data)
 	return (cat_value1 - cat_value2);
 }
 
+/**
+ * Build a bitmap of category values from an iterator of qpol_cat_t
+ * pointers.
+ *
+ * @param p Policy containing the categories.
+ * @param iter Iterator over categories.  This will be consumed.
+ *
+ * @return Bitmap of the categories' values, or NULL upon error.
+ */
+static apol_bitmap_t *mls_cat_iter_to_bitmap(const apol_policy_t * p, qpol_iterator_t * iter)
+{
+	apol_vector_t *values = NULL;
+	apol_bitmap_t *bits = NULL;
+	uint32_t val, max_val = 0;
+	size_t i;
+
+	if ((values = apol_vector_create(NULL)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_cat_t *cat;
+		if (qpol_iterator_get_item(iter, (void **)&cat) < 0 || qpol_cat_get_value(p->p, cat, &val) < 0) {
+			goto cleanup;
+		}
+		if (apol_vector_append(values, (void *)((size_t) val)) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if (val > max_val)
+			max_val = val;
+	}
+	if ((bits = apol_bitmap_create((size_t) max_val + 1)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(values); i++) {
+		apol_bitmap_set(bits, (size_t) apol_vector_get_element(values, i));
+	}
+      cleanup:
+	apol_vector_destroy(&values);
+	return bits;
+}
+
+/**
+ * Look up a level's sensitivity value and build a bitmap of its
+ * categories' values, so that comparisons become integer and
+ * word-wide bitmap operations.  The level itself is not modified.
+ *
+ * @param p Policy within which to look up the level's components.
+ * @param level Level to intern.
+ * @param sens_value Reference to the sensitivity's value.
+ * @param cat_bits Reference to the new bitmap of category values.
+ * The caller must call apol_bitmap_destroy() upon it afterwards.
+ * This will be set to NULL upon error.
+ *
+ * @return 0 on success, < 0 if the sensitivity or a category is not
+ * within the policy.
+ */
+static int mls_level_intern(const apol_policy_t * p, const apol_mls_level_t * level, uint32_t * sens_value,
+			    apol_bitmap_t ** cat_bits)
+{
+	const qpol_level_t *level_datum;
+	const qpol_cat_t *cat;
+	uint32_t val, max_val = 0;
+	size_t i;
+
+	*cat_bits = NULL;
+	if (level->sens == NULL || level->cats == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_level_by_name(p->p, level->sens, &level_datum) < 0 ||
+	    qpol_level_get_value(p->p, level_datum, sens_value) < 0) {
+		return -1;
+	}
+	/* categories are kept sorted by name, not value, so find the
+	 * largest value first to size the bitmap */
+	for (i = 0; i < apol_vector_get_size(level->cats); i++) {
+		if (qpol_policy_get_cat_by_name(p->p, apol_vector_get_element(level->cats, i), &cat) < 0 ||
+		    qpol_cat_get_value(p->p, cat, &val) < 0) {
+			return -1;
+		}
+		if (val > max_val)
+			max_val = val;
+	}
+	if ((*cat_bits = apol_bitmap_create((size_t) max_val + 1)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(level->cats); i++) {
+		if (qpol_policy_get_cat_by_name(p->p, apol_vector_get_element(level->cats, i), &cat) < 0 ||
+		    qpol_cat_get_value(p->p, cat, &val) < 0) {
+			apol_bitmap_destroy(cat_bits);
+			return -1;
+		}
+		apol_bitmap_set(*cat_bits, val);
+	}
+	return 0;
+}
+
+int apol_mls_level_get_interned(const apol_policy_t * p, const apol_mls_level_t * level, uint32_t * sens_value,
+				apol_bitmap_t ** cat_bits)
+{
+	if (cat_bits != NULL)
+		*cat_bits = NULL;
+	if (p == NULL || level == NULL || level->cats == NULL || sens_value == NULL || cat_bits == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return mls_level_intern(p, level, sens_value, cat_bits);
+}
+
 /********************* level *********************/
 
 apol_mls_level_t *apol_mls_level_create(void)
@@ -370,66 +464,45 @@ const apol_vector_t *apol_mls_level_get_cats(const apol_mls_level_t * level)
 
 int apol_mls_level_compare(const apol_policy_t * p, const apol_mls_level_t * l1, const apol_mls_level_t * l2)
 {
-	const qpol_level_t *level_datum1, *level_datum2;
-	int level1_sens, level2_sens, sens_cmp;
-	size_t l1_size, l2_size, i, j;
-	int m_list, ucat = 0;
-	apol_vector_t *cat_list_master, *cat_list_subset;
+	apol_bitmap_t *cats1 = NULL, *cats2 = NULL;
+	uint32_t sens1, sens2;
+	int dom, domby, retval = -1;
 	if (l2 == NULL) {
 		return APOL_MLS_EQ;
 	}
-	if ((l1 != NULL && l1->cats == NULL) || (l2->cats == NULL)) {
+	if (p == NULL || l1 == NULL || l1->cats == NULL || l2->cats == NULL) {
 		errno = EINVAL;
 		return -1;
 	}
-	if (qpol_policy_get_level_by_name(p->p, l1->sens, &level_datum1) < 0 ||
-	    qpol_policy_get_level_by_name(p->p, l2->sens, &level_datum2) < 0) {
-		return -1;
-	}
-
-	/* compare the level's senstitivity value */
-	if (qpol_level_get_value(p->p, level_datum1, (uint32_t *) (&level1_sens)) < 0 ||
-	    qpol_level_get_value(p->p, level_datum2, (uint32_t *) (&level2_sens)) < 0) {
-		return -1;
+	if (mls_level_intern(p, l1, &sens1, &cats1) < 0 || mls_level_intern(p, l2, &sens2, &cats2) < 0) {
+		goto cleanup;
 	}
-	sens_cmp = level1_sens - level2_sens;
 
 	/* determine if all the categories in one level are in the other set */
-	l1_size = apol_vector_get_size(l1->cats);
-	l2_size = apol_vector_get_size(l2->cats);
-	if (l1_size < l2_size) {
-		m_list = 2;
-		cat_list_master = l2->cats;
-		cat_list_subset = l1->cats;
-	} else {
-		m_list = 1;
-		cat_list_master = l1->cats;
-		cat_list_subset = l2->cats;
-	}
-	for (i = 0; i < apol_vector_get_size(cat_list_subset); i++) {
-		char *cat = (char *)apol_vector_get_element(cat_list_subset, i);
-		if (apol_vector_get_index(cat_list_master, cat, apol_mls_cat_name_compare, (void *)p, &j) < 0) {
-			ucat = 1;
-			break;
-		}
-	}
-
-	if (!sens_cmp && !ucat && l1_size == l2_size)
-		return APOL_MLS_EQ;
-	if (sens_cmp >= 0 && m_list == 1 && !ucat)
-		return APOL_MLS_DOM;
-	if (sens_cmp <= 0 && (m_list == 2 || l1_size == l2_size) && !ucat)
-		return APOL_MLS_DOMBY;
-	return APOL_MLS_INCOMP;
+	dom = apol_bitmap_is_subset(cats2, cats1);
+	domby = apol_bitmap_is_subset(cats1, cats2);
+
+	if (sens1 == sens2 && dom && domby)
+		retval = APOL_MLS_EQ;
+	else if (sens1 >= sens2 && dom)
+		retval = APOL_MLS_DOM;
+	else if (sens1 <= sens2 && domby)
+		retval = APOL_MLS_DOMBY;
+	else
+		retval = APOL_MLS_INCOMP;
+      cleanup:
+	apol_bitmap_destroy(&cats1);
+	apol_bitmap_destroy(&cats2);
+	return retval;
 }
 
 int apol_mls_level_validate(const apol_policy_t * p, const apol_mls_level_t * level)
 {
 	const qpol_level_t *level_datum;
 	qpol_iterator_t *iter = NULL;
-	apol_vector_t *cat_vector;
+	apol_bitmap_t *sens_cats = NULL, *level_cats = NULL;
+	uint32_t sens;
 	int retval = -1;
-	size_t i, j;
 
 	if (p == NULL || level == NULL || level->cats == NULL) {
 		ERR(p, "%s", strerror(EINVAL));
@@ -443,23 +516,20 @@ int apol_mls_level_validate(const apol_policy_t * p, const apol_mls_level_t * le
 	    qpol_level_get_cat_iter(p->p, level_datum, &iter) < 0) {
 		return -1;
 	}
-	if ((cat_vector = apol_vector_create_from_iter(iter, NULL)) == NULL) {
-		ERR(p, "%s", strerror(errno));
+	if ((sens_cats = mls_cat_iter_to_bitmap(p, iter)) == NULL) {
 		goto cleanup;
 	}
-
-	for (i = 0; i < apol_vector_get_size(level->cats); i++) {
-		char *cat_name = (char *)apol_vector_get_element(level->cats, i);
-		if (apol_vector_get_index(cat_vector, cat_name, apol_mls_cat_vector_compare, (void *)p, &j) < 0) {
+	if (mls_level_intern(p, level, &sens, &level_cats) < 0) {
+		/* a category is not within the policy */
+		if (errno != ENOMEM)
 			retval = 0;
-			goto cleanup;
-		}
+		goto cleanup;
 	}
-
-	retval = 1;
+	retval = apol_bitmap_is_subset(level_cats, sens_cats);
       cleanup:
 	qpol_iterator_destroy(&iter);
-	apol_vector_destroy(&cat_vector);
+	apol_bitmap_destroy(&sens_cats);
+	apol_bitmap_destroy(&level_cats);
 	return retval;
 }
 
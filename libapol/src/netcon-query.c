@@ -173,64 +173,69 @@ int apol_portcon_query_set_context(const apol_policy_t * p __attribute__ ((unuse
 	return 0;
 }
 
-char *apol_portcon_render(const apol_policy_t * p, const qpol_portcon_t * portcon)
+int apol_portcon_render_buf(const apol_policy_t * p, const qpol_portcon_t * portcon, apol_render_buf_t * buf)
 {
-	char *line = NULL, *retval = NULL;
-	char *buff = NULL;
 	const char *proto_str = NULL;
-	char *context_str = NULL;
 	const qpol_context_t *ctxt = NULL;
 	uint16_t low_port, high_port;
 	uint8_t proto;
+	size_t mark;
 
-	const size_t bufflen = 50;     /* arbitrary size big enough to hold port no. */
-	if (!portcon || !p)
-		goto cleanup;
-
-	buff = (char *)calloc(bufflen + 1, sizeof(char));
-	if (!buff) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
+	if (!portcon || !p || !buf) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
 	}
+	mark = apol_render_buf_get_length(buf);
 
 	if (qpol_portcon_get_protocol(p->p, portcon, &proto))
-		goto cleanup;
-
+		return -1;
 	if ((proto_str = apol_protocol_to_str(proto)) == NULL) {
 		ERR(p, "%s", "Could not get protocol string.");
-		goto cleanup;
+		return -1;
 	}
 	if (qpol_portcon_get_low_port(p->p, portcon, &low_port))
-		goto cleanup;
+		return -1;
 	if (qpol_portcon_get_high_port(p->p, portcon, &high_port))
-		goto cleanup;
-	if (low_port == high_port)
-		snprintf(buff, bufflen, "%d", low_port);
-	else
-		snprintf(buff, bufflen, "%d-%d", low_port, high_port);
-
+		return -1;
 	if (qpol_portcon_get_context(p->p, portcon, &ctxt))
-		goto cleanup;
-	context_str = apol_qpol_context_render(p, ctxt);
-	if (!context_str)
-		goto cleanup;
+		return -1;
 
-	line = (char *)calloc(4 + strlen("portcon") + strlen(proto_str) + strlen(buff) + strlen(context_str), sizeof(char));
-	if (!line) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
+	if (low_port == high_port) {
+		if (apol_render_buf_appendf(buf, "portcon %s %d ", proto_str, low_port))
+			goto err;
+	} else {
+		if (apol_render_buf_appendf(buf, "portcon %s %d-%d ", proto_str, low_port, high_port))
+			goto err;
 	}
+	if (apol_qpol_context_render_buf(p, ctxt, buf)) {
+		render_buf_rollback(buf, mark);
+		return -1;
+	}
+	return render_buf_commit(p, buf);
 
-	sprintf(line, "portcon %s %s %s", proto_str, buff, context_str);
+      err:
+	ERR(p, "%s", strerror(errno));
+	render_buf_rollback(buf, mark);
+	return -1;
+}
 
-	retval = line;
-      cleanup:
-	free(buff);
-	free(context_str);
-	if (retval != line) {
-		free(line);
+char *apol_portcon_render(const apol_policy_t * p, const qpol_portcon_t * portcon)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
 	}
-	return retval;
+	if (apol_portcon_render_buf(p, portcon, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
 }
 
 /******************** netifcon queries ********************/
@@ -337,44 +342,61 @@ int apol_netifcon_query_set_msg_context(const apol_policy_t * p __attribute__ ((
 	return 0;
 }
 
-char *apol_netifcon_render(const apol_policy_t * p, const qpol_netifcon_t * netifcon)
+int apol_netifcon_render_buf(const apol_policy_t * p, const qpol_netifcon_t * netifcon, apol_render_buf_t * buf)
 {
-	char *line = NULL, *retval = NULL;
-	char *devcon_str = NULL;
-	char *pktcon_str = NULL;
 	const char *iface_str = NULL;
-	const qpol_context_t *ctxt = NULL;
+	const qpol_context_t *devcon = NULL, *pktcon = NULL;
+	size_t mark;
 
-	if (!netifcon || !p)
-		goto cleanup;
+	if (!netifcon || !p || !buf) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	mark = apol_render_buf_get_length(buf);
 
-	if (qpol_netifcon_get_if_con(p->p, netifcon, &ctxt))
-		goto cleanup;
-	devcon_str = apol_qpol_context_render(p, ctxt);
-	if (!devcon_str)
-		goto cleanup;
+	if (qpol_netifcon_get_if_con(p->p, netifcon, &devcon))
+		return -1;
+	if (qpol_netifcon_get_msg_con(p->p, netifcon, &pktcon))
+		return -1;
+	if (qpol_netifcon_get_name(p->p, netifcon, &iface_str))
+		return -1;
 
-	if (qpol_netifcon_get_msg_con(p->p, netifcon, &ctxt))
-		goto cleanup;
-	pktcon_str = apol_qpol_context_render(p, ctxt);
-	if (!pktcon_str) {
-		goto cleanup;
+	if (apol_render_buf_appendf(buf, "netifcon %s ", iface_str)) {
+		ERR(p, "%s", strerror(errno));
+		goto err;
+	}
+	if (apol_qpol_context_render_buf(p, devcon, buf))
+		goto err;
+	if (apol_render_buf_append(buf, " ")) {
+		ERR(p, "%s", strerror(errno));
+		goto err;
 	}
+	if (apol_qpol_context_render_buf(p, pktcon, buf))
+		goto err;
+	return render_buf_commit(p, buf);
 
-	if (qpol_netifcon_get_name(p->p, netifcon, &iface_str))
+      err:
+	render_buf_rollback(buf, mark);
+	return -1;
+}
+
+char *apol_netifcon_render(const apol_policy_t * p, const qpol_netifcon_t * netifcon)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(p, "%s", strerror(errno));
 		return NULL;
-	line = (char *)calloc(4 + strlen(iface_str) + strlen(devcon_str) + strlen(pktcon_str) + strlen("netifcon"), sizeof(char));
-	if (!line) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
 	}
-	sprintf(line, "netifcon %s %s %s", iface_str, devcon_str, pktcon_str);
-
-	retval = line;
-      cleanup:
-	free(devcon_str);
-	free(pktcon_str);
-	return retval;
+	if (apol_netifcon_render_buf(p, netifcon, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
 }
 
 /******************** nodecon queries ********************/
@@ -535,18 +557,22 @@ int apol_nodecon_query_set_context(const apol_policy_t * p __attribute__ ((unuse
 	return 0;
 }
 
-char *apol_nodecon_render(const apol_policy_t * p, const qpol_nodecon_t * nodecon)
+int apol_nodecon_render_buf(const apol_policy_t * p, const qpol_nodecon_t * nodecon, apol_render_buf_t * buf)
 {
-	char *line = NULL, *retval = NULL;
-	char *context_str = NULL;
 	char *addr_str = NULL;
 	char *mask_str = NULL;
 	const qpol_context_t *ctxt = NULL;
 	unsigned char protocol, addr_proto, mask_proto;
 	uint32_t *addr = NULL, *mask = NULL;
+	size_t mark;
+	int retval = -1;
 
-	if (!nodecon || !p)
-		goto cleanup;
+	if (!nodecon || !p || !buf) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	mark = apol_render_buf_get_length(buf);
 
 	if (qpol_nodecon_get_protocol(p->p, nodecon, &protocol))
 		goto cleanup;
@@ -566,27 +592,591 @@ char *apol_nodecon_render(const apol_policy_t * p, const qpol_nodecon_t * nodeco
 		}
 		break;
 	default:
-		break;
+		ERR(p, "%s", "Unknown nodecon protocol.");
+		errno = EINVAL;
+		goto cleanup;
 	}
 
 	if (qpol_nodecon_get_context(p->p, nodecon, &ctxt))
 		goto cleanup;
-	context_str = apol_qpol_context_render(p, ctxt);
-	if (!context_str)
+	if (apol_render_buf_appendf(buf, "nodecon %s %s ", addr_str, mask_str)) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (apol_qpol_context_render_buf(p, ctxt, buf))
 		goto cleanup;
+	retval = render_buf_commit(p, buf);
+      cleanup:
+	if (retval != 0)
+		render_buf_rollback(buf, mark);
+	free(addr_str);
+	free(mask_str);
+	return retval;
+}
+
+char *apol_nodecon_render(const apol_policy_t * p, const qpol_nodecon_t * nodecon)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_nodecon_render_buf(p, nodecon, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
+}
+
+/******************** netcon index ********************/
+
+/* Every portcon of one protocol, flattened into sorted, disjoint
+ * port segments.  Segment i covers ports start[i] through
+ * start[i + 1] - 1 (or through 65535 for the last segment), and
+ * match[i] is the first portcon in policy order that covers it. */
+typedef struct apol_port_table
+{
+	uint8_t proto;
+	size_t num_segments;
+	uint32_t *start;
+	const qpol_portcon_t **match;
+} apol_port_table_t;
 
-	line = (char *)calloc(4 + strlen("nodecon") + strlen(addr_str) + strlen(mask_str) + strlen(context_str), sizeof(char));
-	if (!line) {
-		ERR(p, "%s", strerror(ENOMEM));
+/* A node within a binary trie of nodecon address prefixes.  Child
+ * index 0 means no child, as the root (node 0) is never a child. */
+typedef struct apol_node_trie_node
+{
+	size_t child[2];
+	/** position of the first nodecon whose prefix ends here, or
+	 *  SIZE_MAX if none */
+	size_t first;
+} apol_node_trie_node_t;
+
+typedef struct apol_node_trie
+{
+	apol_node_trie_node_t *nodes;
+	size_t num_nodes, capacity;
+	/** positions of nodecons whose masks are not prefixes, and
+	 *  thus are checked individually */
+	apol_vector_t *irregular;
+} apol_node_trie_t;
+
+struct apol_netcon_index
+{
+	/** vector of apol_port_table_t, one per protocol */
+	apol_vector_t *ports;
+	/** vector of qpol_nodecon_t, in policy order; the index owns
+	 *  these */
+	apol_vector_t *nodecons;
+	/** copies of each nodecon's address and mask, parallel to
+	 *  nodecons */
+	uint32_t (*addrs)[4], (*masks)[4];
+	/** prefix tries indexed by QPOL_IPV4 and QPOL_IPV6 */
+	apol_node_trie_t tries[2];
+};
+
+/* one port range read from the policy, used while building */
+typedef struct apol_port_entry
+{
+	uint16_t low, high;
+	const qpol_portcon_t *portcon;
+} apol_port_entry_t;
+
+static void apol_port_table_free(void *elem)
+{
+	apol_port_table_t *t = elem;
+	if (t != NULL) {
+		free(t->start);
+		free(t->match);
+		free(t);
+	}
+}
+
+static int apol_port_start_comp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+/**
+ * Find the segment within a port table that covers a port.
+ */
+static size_t apol_port_table_find(const apol_port_table_t * t, uint32_t port)
+{
+	size_t lo = 0, hi = t->num_segments;
+	/* start[0] is always 0, so the answer is the last segment
+	 * starting at or before the port */
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (t->start[mid] <= port)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * Follow a chain of painted segments to the next unpainted one, with
+ * path compression.
+ */
+static size_t apol_port_next_unpainted(size_t * next, size_t i)
+{
+	size_t root = i, tmp;
+	while (next[root] != root)
+		root = next[root];
+	while (next[i] != root) {
+		tmp = next[i];
+		next[i] = root;
+		i = tmp;
+	}
+	return root;
+}
+
+/**
+ * Build the segment table for the portcons of one protocol.  Each
+ * portcon, in policy order, claims those of its segments that no
+ * earlier portcon has claimed; thus each segment records the portcon
+ * the kernel would select for its ports.
+ *
+ * @param p Policy, to report errors.
+ * @param proto Protocol of the portcons.
+ * @param entries Vector of apol_port_entry_t, in policy order.
+ *
+ * @return New port table, or NULL upon error.
+ */
+static apol_port_table_t *apol_port_table_create(const apol_policy_t * p, uint8_t proto, const apol_vector_t * entries)
+{
+	apol_port_table_t *t = NULL;
+	size_t *next = NULL, num = apol_vector_get_size(entries), n = 0, i, j, s, e;
+	int error = 0;
+
+	if ((t = calloc(1, sizeof(*t))) == NULL || (t->start = malloc((2 * num + 1) * sizeof(uint32_t))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto err;
+	}
+	t->proto = proto;
+	t->start[n++] = 0;
+	for (i = 0; i < num; i++) {
+		apol_port_entry_t *pe = apol_vector_get_element(entries, i);
+		t->start[n++] = pe->low;
+		if (pe->high < UINT16_MAX)
+			t->start[n++] = (uint32_t) pe->high + 1;
+	}
+	qsort(t->start, n, sizeof(uint32_t), apol_port_start_comp);
+	for (i = 1, j = 1; i < n; i++) {
+		if (t->start[i] != t->start[j - 1])
+			t->start[j++] = t->start[i];
+	}
+	t->num_segments = j;
+
+	if ((t->match = calloc(t->num_segments, sizeof(*t->match))) == NULL ||
+	    (next = malloc((t->num_segments + 1) * sizeof(size_t))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto err;
+	}
+	for (i = 0; i <= t->num_segments; i++)
+		next[i] = i;
+	for (i = 0; i < num; i++) {
+		apol_port_entry_t *pe = apol_vector_get_element(entries, i);
+		s = apol_port_table_find(t, pe->low);
+		e = apol_port_table_find(t, pe->high);
+		for (j = apol_port_next_unpainted(next, s); j <= e; j = apol_port_next_unpainted(next, j + 1)) {
+			t->match[j] = pe->portcon;
+			next[j] = j + 1;
+		}
+	}
+	free(next);
+	return t;
+
+      err:
+	free(next);
+	apol_port_table_free(t);
+	errno = error;
+	return NULL;
+}
+
+/**
+ * Build one port table per protocol from the policy's portcons.
+ */
+static int apol_netcon_index_build_ports(const apol_policy_t * p, apol_netcon_index_t * idx)
+{
+	qpol_iterator_t *iter = NULL;
+	apol_vector_t *entries = NULL, *protos[UINT8_MAX + 1];
+	apol_port_table_t *t;
+	size_t i;
+	int retval = -1;
+
+	memset(protos, 0, sizeof(protos));
+	if ((idx->ports = apol_vector_create(apol_port_table_free)) == NULL ||
+	    (entries = apol_vector_create(free)) == NULL) {
+		ERR(p, "%s", strerror(errno));
 		goto cleanup;
 	}
+	if (qpol_policy_get_portcon_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_portcon_t *portcon;
+		apol_port_entry_t *pe;
+		uint8_t proto;
+		if ((pe = calloc(1, sizeof(*pe))) == NULL || apol_vector_append(entries, pe) < 0) {
+			ERR(p, "%s", strerror(errno));
+			free(pe);
+			goto cleanup;
+		}
+		if (qpol_iterator_get_item(iter, (void **)&portcon) < 0 ||
+		    qpol_portcon_get_low_port(p->p, portcon, &pe->low) < 0 ||
+		    qpol_portcon_get_high_port(p->p, portcon, &pe->high) < 0 ||
+		    qpol_portcon_get_protocol(p->p, portcon, &proto) < 0) {
+			goto cleanup;
+		}
+		pe->portcon = portcon;
+		if (pe->low > pe->high) {
+			/* can never match, so do not index it */
+			continue;
+		}
+		if (protos[proto] == NULL && (protos[proto] = apol_vector_create(NULL)) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if (apol_vector_append(protos[proto], pe) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+	}
+	for (i = 0; i <= UINT8_MAX; i++) {
+		if (protos[i] == NULL)
+			continue;
+		if ((t = apol_port_table_create(p, (uint8_t) i, protos[i])) == NULL) {
+			goto cleanup;
+		}
+		if (apol_vector_append(idx->ports, t) < 0) {
+			ERR(p, "%s", strerror(errno));
+			apol_port_table_free(t);
+			goto cleanup;
+		}
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	for (i = 0; i <= UINT8_MAX; i++)
+		apol_vector_destroy(&protos[i]);
+	apol_vector_destroy(&entries);
+	return retval;
+}
 
-	sprintf(line, "nodecon %s %s %s", addr_str, mask_str, context_str);
+/**
+ * Return bit k of an address, counting from the most significant bit
+ * of its first byte.  Addresses are kept in network byte order.
+ */
+static int apol_node_addr_bit(const uint32_t * addr, size_t k)
+{
+	const unsigned char *b = (const unsigned char *)addr;
+	return (b[k / 8] >> (7 - k % 8)) & 1;
+}
+
+/**
+ * Return the length of a netmask if it is a prefix (all ones followed
+ * by all zeroes), or -1 if it is not.
+ */
+static int apol_node_mask_prefix_len(const uint32_t * mask, size_t num_bits)
+{
+	size_t k, len = 0;
+	while (len < num_bits && apol_node_addr_bit(mask, len))
+		len++;
+	for (k = len; k < num_bits; k++) {
+		if (apol_node_addr_bit(mask, k))
+			return -1;
+	}
+	return (int)len;
+}
 
-	retval = line;
+static int apol_node_trie_new_node(apol_node_trie_t * trie, size_t * n)
+{
+	if (trie->num_nodes >= trie->capacity) {
+		size_t cap = (trie->capacity ? trie->capacity * 2 : 64);
+		apol_node_trie_node_t *tmp = realloc(trie->nodes, cap * sizeof(*tmp));
+		if (tmp == NULL)
+			return -1;
+		trie->nodes = tmp;
+		trie->capacity = cap;
+	}
+	trie->nodes[trie->num_nodes].child[0] = trie->nodes[trie->num_nodes].child[1] = 0;
+	trie->nodes[trie->num_nodes].first = SIZE_MAX;
+	*n = trie->num_nodes++;
+	return 0;
+}
+
+/**
+ * Record a nodecon within a prefix trie.  Because nodecons are added
+ * in policy order, only the first to end at any node is kept.
+ */
+static int apol_node_trie_insert(apol_node_trie_t * trie, const uint32_t * addr, size_t prefix_len, size_t pos)
+{
+	size_t n = 0, k, c;
+	if (trie->num_nodes == 0 && apol_node_trie_new_node(trie, &n) < 0) {
+		return -1;
+	}
+	for (k = 0; k < prefix_len; k++) {
+		int bit = apol_node_addr_bit(addr, k);
+		if ((c = trie->nodes[n].child[bit]) == 0) {
+			if (apol_node_trie_new_node(trie, &c) < 0) {
+				return -1;
+			}
+			trie->nodes[n].child[bit] = c;
+		}
+		n = c;
+	}
+	if (trie->nodes[n].first == SIZE_MAX)
+		trie->nodes[n].first = pos;
+	return 0;
+}
+
+static int apol_node_addr_matches(const uint32_t * addr, const uint32_t * entry_addr, const uint32_t * mask, size_t num_words)
+{
+	size_t i;
+	for (i = 0; i < num_words; i++) {
+		if ((addr[i] & mask[i]) != entry_addr[i])
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * Build the prefix tries from the policy's nodecons.
+ */
+static int apol_netcon_index_build_nodes(const apol_policy_t * p, apol_netcon_index_t * idx)
+{
+	qpol_iterator_t *iter = NULL;
+	qpol_nodecon_t *nodecon = NULL;
+	size_t num, pos;
+	int retval = -1;
+
+	if (qpol_policy_get_nodecon_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &num) < 0) {
+		goto cleanup;
+	}
+	if ((idx->nodecons = apol_vector_create_with_capacity(num, free)) == NULL ||
+	    (idx->addrs = calloc(num + 1, sizeof(*idx->addrs))) == NULL ||
+	    (idx->masks = calloc(num + 1, sizeof(*idx->masks))) == NULL ||
+	    (idx->tries[QPOL_IPV4].irregular = apol_vector_create(NULL)) == NULL ||
+	    (idx->tries[QPOL_IPV6].irregular = apol_vector_create(NULL)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (pos = 0; !qpol_iterator_end(iter) && pos < num; qpol_iterator_next(iter), pos++) {
+		unsigned char proto, proto_a, proto_m;
+		uint32_t *addr, *mask;
+		size_t num_words, i;
+		int prefix_len;
+		if (qpol_iterator_get_item(iter, (void **)&nodecon) < 0) {
+			goto cleanup;
+		}
+		if (apol_vector_append(idx->nodecons, nodecon) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		/* the vector now owns the nodecon */
+		nodecon = apol_vector_get_element(idx->nodecons, pos);
+		if (qpol_nodecon_get_protocol(p->p, nodecon, &proto) < 0 ||
+		    qpol_nodecon_get_addr(p->p, nodecon, &addr, &proto_a) < 0 ||
+		    qpol_nodecon_get_mask(p->p, nodecon, &mask, &proto_m) < 0) {
+			nodecon = NULL;
+			goto cleanup;
+		}
+		nodecon = NULL;
+		if (proto != QPOL_IPV4 && proto != QPOL_IPV6) {
+			continue;
+		}
+		num_words = (proto == QPOL_IPV4 ? 1 : 4);
+		memcpy(idx->addrs[pos], addr, num_words * sizeof(uint32_t));
+		memcpy(idx->masks[pos], mask, num_words * sizeof(uint32_t));
+		for (i = 0; i < num_words; i++) {
+			if (addr[i] & ~mask[i])
+				break;
+		}
+		if (i < num_words) {
+			/* address has bits outside its mask, so it
+			 * can never match */
+			continue;
+		}
+		if ((prefix_len = apol_node_mask_prefix_len(mask, num_words * 32)) < 0) {
+			if (apol_vector_append(idx->tries[proto].irregular, (void *)pos) < 0) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+		} else if (apol_node_trie_insert(&idx->tries[proto], addr, (size_t) prefix_len, pos) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+	}
+	retval = 0;
       cleanup:
-	free(addr_str);
-	free(mask_str);
-	free(context_str);
+	free(nodecon);
+	qpol_iterator_destroy(&iter);
 	return retval;
 }
+
+apol_netcon_index_t *apol_netcon_index_create(const apol_policy_t * p)
+{
+	apol_netcon_index_t *idx = NULL;
+	if (p == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((idx = calloc(1, sizeof(*idx))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_netcon_index_build_ports(p, idx) < 0 || apol_netcon_index_build_nodes(p, idx) < 0) {
+		int error = errno;
+		apol_netcon_index_destroy(&idx);
+		errno = error;
+		return NULL;
+	}
+	return idx;
+}
+
+void apol_netcon_index_destroy(apol_netcon_index_t ** idx)
+{
+	size_t i;
+	if (idx == NULL || *idx == NULL)
+		return;
+	apol_vector_destroy(&(*idx)->ports);
+	apol_vector_destroy(&(*idx)->nodecons);
+	free((*idx)->addrs);
+	free((*idx)->masks);
+	for (i = 0; i < 2; i++) {
+		free((*idx)->tries[i].nodes);
+		apol_vector_destroy(&(*idx)->tries[i].irregular);
+	}
+	free(*idx);
+	*idx = NULL;
+}
+
+static const apol_port_table_t *apol_netcon_index_get_port_table(const apol_netcon_index_t * idx, uint8_t protocol)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(idx->ports); i++) {
+		const apol_port_table_t *t = apol_vector_get_element(idx->ports, i);
+		if (t->proto == protocol)
+			return t;
+	}
+	return NULL;
+}
+
+const qpol_portcon_t *apol_netcon_index_find_portcon(const apol_netcon_index_t * idx, uint8_t protocol, uint16_t port)
+{
+	const apol_port_table_t *t;
+	if (idx == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((t = apol_netcon_index_get_port_table(idx, protocol)) == NULL) {
+		return NULL;
+	}
+	return t->match[apol_port_table_find(t, port)];
+}
+
+/* one port being looked up in a batch, used to sort the batch */
+typedef struct apol_port_lookup
+{
+	uint16_t port;
+	size_t i;
+} apol_port_lookup_t;
+
+static int apol_port_lookup_comp(const void *a, const void *b)
+{
+	const apol_port_lookup_t *x = a, *y = b;
+	return ((int)x->port) - ((int)y->port);
+}
+
+int apol_netcon_index_find_portcons(const apol_netcon_index_t * idx, uint8_t protocol, const uint16_t * ports, size_t num,
+				    const qpol_portcon_t ** results)
+{
+	const apol_port_table_t *t;
+	apol_port_lookup_t *lookups;
+	size_t i, seg;
+	if (idx == NULL || (num > 0 && (ports == NULL || results == NULL))) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (num == 0) {
+		return 0;
+	}
+	if ((t = apol_netcon_index_get_port_table(idx, protocol)) == NULL) {
+		for (i = 0; i < num; i++)
+			results[i] = NULL;
+		return 0;
+	}
+	/* sort the ports, then answer them all in one sweep across
+	 * the segments */
+	if ((lookups = malloc(num * sizeof(*lookups))) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < num; i++) {
+		lookups[i].port = ports[i];
+		lookups[i].i = i;
+	}
+	qsort(lookups, num, sizeof(*lookups), apol_port_lookup_comp);
+	for (i = 0, seg = 0; i < num; i++) {
+		while (seg + 1 < t->num_segments && t->start[seg + 1] <= lookups[i].port)
+			seg++;
+		results[lookups[i].i] = t->match[seg];
+	}
+	free(lookups);
+	return 0;
+}
+
+const qpol_nodecon_t *apol_netcon_index_find_nodecon(const apol_netcon_index_t * idx, int protocol, const uint32_t addr[4])
+{
+	const apol_node_trie_t *trie;
+	size_t best = SIZE_MAX, n = 0, k, i, num_bits, num_words;
+	if (idx == NULL || addr == NULL || (protocol != QPOL_IPV4 && protocol != QPOL_IPV6)) {
+		errno = EINVAL;
+		return NULL;
+	}
+	trie = &idx->tries[protocol];
+	num_words = (protocol == QPOL_IPV4 ? 1 : 4);
+	num_bits = num_words * 32;
+	/* every prefix along the address's path matches it; keep
+	 * the one earliest in the policy */
+	if (trie->num_nodes > 0) {
+		for (k = 0;; k++) {
+			if (trie->nodes[n].first < best)
+				best = trie->nodes[n].first;
+			if (k == num_bits || (n = trie->nodes[n].child[apol_node_addr_bit(addr, k)]) == 0)
+				break;
+		}
+	}
+	for (i = 0; i < apol_vector_get_size(trie->irregular); i++) {
+		size_t pos = (size_t) apol_vector_get_element(trie->irregular, i);
+		if (pos < best && apol_node_addr_matches(addr, idx->addrs[pos], idx->masks[pos], num_words))
+			best = pos;
+	}
+	if (best == SIZE_MAX) {
+		return NULL;
+	}
+	return apol_vector_get_element(idx->nodecons, best);
+}
+
+int apol_netcon_index_find_nodecons(const apol_netcon_index_t * idx, int protocol, const uint32_t(*addrs)[4], size_t num,
+				    const qpol_nodecon_t ** results)
+{
+	size_t i;
+	if (idx == NULL || (protocol != QPOL_IPV4 && protocol != QPOL_IPV6) || (num > 0 && (addrs == NULL || results == NULL))) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (i = 0; i < num; i++) {
+		results[i] = apol_netcon_index_find_nodecon(idx, protocol, addrs[i]);
+	}
+	return 0;
+}
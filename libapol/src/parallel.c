@@ -0,0 +1,138 @@
+/**
+ *  @file
+ *  Implementation of running independent tasks across threads.  The
+ *  threads share a counter of the next task to start, guarded by a
+ *  mutex, so that long tasks do not hold up the others.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <apol/parallel.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct apol_parallel
+{
+	pthread_mutex_t lock;
+	/** index of the next task to start */
+	size_t next;
+	size_t num_tasks;
+	apol_parallel_func *fn;
+	void *arg;
+	/** errno of the first task to fail, or 0 */
+	int error;
+} apol_parallel_t;
+
+size_t apol_parallel_get_num_cpus(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n < 1) {
+		return 1;
+	}
+	return (size_t) n;
+}
+
+/**
+ * Take and perform tasks until none remain or one has failed.
+ *
+ * @param varg The shared apol_parallel_t.
+ *
+ * @return Always NULL.
+ */
+static void *parallel_worker(void *varg)
+{
+	apol_parallel_t *par = (apol_parallel_t *) varg;
+	size_t task;
+	int error;
+
+	for (;;) {
+		pthread_mutex_lock(&par->lock);
+		if (par->error != 0 || par->next >= par->num_tasks) {
+			pthread_mutex_unlock(&par->lock);
+			break;
+		}
+		task = par->next++;
+		pthread_mutex_unlock(&par->lock);
+		if (par->fn(par->arg, task) < 0) {
+			error = (errno != 0 ? errno : EIO);
+			pthread_mutex_lock(&par->lock);
+			if (par->error == 0)
+				par->error = error;
+			pthread_mutex_unlock(&par->lock);
+			break;
+		}
+	}
+	return NULL;
+}
+
+int apol_parallel_run(size_t num_tasks, size_t num_threads, apol_parallel_func * fn, void *arg)
+{
+	apol_parallel_t par;
+	pthread_t *threads = NULL;
+	size_t i, num_started = 0;
+
+	if (fn == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (num_threads == 0) {
+		num_threads = apol_parallel_get_num_cpus();
+	}
+	if (num_threads > num_tasks) {
+		num_threads = num_tasks;
+	}
+	if (num_threads <= 1) {
+		for (i = 0; i < num_tasks; i++) {
+			if (fn(arg, i) < 0) {
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	par.next = 0;
+	par.num_tasks = num_tasks;
+	par.fn = fn;
+	par.arg = arg;
+	par.error = 0;
+	if (pthread_mutex_init(&par.lock, NULL) != 0) {
+		errno = ENOMEM;
+		return -1;
+	}
+	/* the calling thread is the last worker, so a failure to
+	 * allocate or start the others only makes the run slower */
+	if ((threads = calloc(num_threads - 1, sizeof(*threads))) != NULL) {
+		for (; num_started < num_threads - 1; num_started++) {
+			if (pthread_create(&threads[num_started], NULL, parallel_worker, &par) != 0) {
+				break;
+			}
+		}
+	}
+	parallel_worker(&par);
+	for (i = 0; i < num_started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+	pthread_mutex_destroy(&par.lock);
+	if (par.error != 0) {
+		errno = par.error;
+		return -1;
+	}
+	return 0;
+}
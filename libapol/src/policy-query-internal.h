@@ -37,6 +37,8 @@ extern "C"
 
 #include <apol/policy.h>
 #include <apol/policy-query.h>
+#include <apol/bitmap.h>
+#include <apol/render.h>
 #include <apol/util.h>
 #include <apol/vector.h>
 
@@ -50,9 +52,26 @@ extern "C"
 /* forward declaration. the definition resides within domain-trans-analysis.c */
 	typedef struct apol_domain_trans_table apol_domain_trans_table_t;
 
+/* forward declaration. the definition resides within relabel-analysis.c */
+	typedef struct apol_relabel_table apol_relabel_table_t;
+
 /* declared in perm-map.c */
 	typedef struct apol_permmap apol_permmap_t;
 
+/* forward declaration. the definition resides within symbol-catalog.c */
+	typedef struct apol_symbol_catalog apol_symbol_catalog_t;
+
+/** kinds of symbols within an apol_symbol_catalog_t */
+	typedef enum apol_symbol_kind
+	{
+		APOL_SYMBOL_TYPE = 0,	/**< types and attributes */
+		APOL_SYMBOL_ROLE,
+		APOL_SYMBOL_USER,
+		APOL_SYMBOL_CLASS,
+		APOL_SYMBOL_BOOL,
+		APOL_SYMBOL_NUM_KINDS
+	} apol_symbol_kind_e;
+
 	struct apol_policy
 	{
 		qpol_policy_t *p;
@@ -63,6 +82,12 @@ extern "C"
 		struct apol_permmap *pmap;
 	/** for domain trans analysis; table built as needed */
 		struct apol_domain_trans_table *domain_trans_table;
+	/** for relabel analysis; table built upon request */
+		struct apol_relabel_table *relabel_table;
+	/** names and values of the policy's symbols; built when the
+	 *  policy is loaded and refilled after it is rebuilt; get it
+	 *  through apol_policy_get_catalog() */
+		struct apol_symbol_catalog *catalog;
 	};
 
 /** Every query allows the treatment of strings as regular expressions
@@ -179,10 +204,8 @@ extern "C"
  * @param name Source target from which to compare.
  * @param flags If APOL_QUERY_REGEX bit is set, treat name as a
  * regular expression.
- * @param regex If using regexp comparison, the compiled regular
- * expression to use; the pointer will be allocated space if regexp is
- * legal.  If NULL, then compile the regexp pattern given by name and
- * cache it here.
+ * @param regex Unused; regular expressions are matched through the
+ * policy's symbol catalog, which remembers their results.
  *
  * @return 1 If comparison succeeds, 0 if not; < 0 on error.
  */
@@ -283,6 +306,22 @@ extern "C"
 	int apol_compare_level(const apol_policy_t * p, const qpol_level_t * level, const char *name, unsigned int flags,
 			       regex_t ** level_regex);
 
+/**
+ * Return a level's sensitivity value and a bitmap of its category
+ * values within a policy.
+ *
+ * @param p Policy within which to look up the level's components.
+ * @param level Level to query.  It must have its sensitivity and
+ * categories set.
+ * @param sens_value Reference to the sensitivity's value.
+ * @param cat_bits Reference to a new bitmap of category values.  The
+ * caller must call apol_bitmap_destroy() upon it afterwards.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	int apol_mls_level_get_interned(const apol_policy_t * p, const apol_mls_level_t * level, uint32_t * sens_value,
+					apol_bitmap_t ** cat_bits);
+
 /**
  * Determines if a category query matches a qpol_cat_t, either
  * the category name or any of its aliases.
@@ -509,6 +548,26 @@ extern "C"
  */
 	int apol_query_type_set_uses_types_directly(const apol_policy_t * p, const qpol_type_set_t * set, const apol_vector_t * v);
 
+/**
+ * Determine which permissions of a class its constraints deny
+ * between two contexts, separating those denied by constraints that
+ * compare MLS levels from the rest.
+ *
+ * @param e Constraint evaluator to use.
+ * @param scontext Source context.
+ * @param tcontext Target context.
+ * @param class_name Name of the object class.
+ * @param denied Reference to the mask of permissions denied by
+ * constraints that do not compare MLS levels.
+ * @param mls_denied Reference to the mask of permissions denied by
+ * constraints that do.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	int apol_constraint_evaluator_get_denied_split(const apol_constraint_evaluator_t * e, const apol_context_t * scontext,
+						       const apol_context_t * tcontext, const char *class_name, uint32_t * denied,
+						       uint32_t * mls_denied);
+
 /**
  * Deallocate all space associated with a particular policy's permmap,
  * including the pointer itself.  Afterwards set the pointer to NULL.
@@ -523,6 +582,215 @@ extern "C"
  */
 	void domain_trans_table_destroy(apol_domain_trans_table_t ** table);
 
+/**
+ *  Destroy the relabel table freeing all memory used.
+ *  @param table Reference pointer to the table to be destroyed.
+ */
+	void relabel_table_destroy(apol_relabel_table_t ** table);
+
+/**
+ * Build a catalog of a policy's types, roles, users, classes, and
+ * booleans.  Each kind of symbol is held in arrays indexed by value,
+ * along with an index of every name (including aliases) to its value,
+ * so that neither direction of lookup goes through the policy's own
+ * symbol tables.  The catalog also holds each class's permission
+ * names.  Its strings and objects belong to the policy; use
+ * apol_policy_get_catalog() rather than the policy's catalog field,
+ * so that a catalog is refilled after qpol_policy_rebuild().
+ *
+ * @param p Policy to catalog.
+ *
+ * @return A new catalog, or NULL on error.  The caller must call
+ * symbol_catalog_destroy() afterwards.
+ */
+	apol_symbol_catalog_t *apol_symbol_catalog_create(const apol_policy_t * p);
+
+/**
+ *  Destroy a symbol catalog freeing all memory used.
+ *  @param c Reference pointer to the catalog to be destroyed.
+ */
+	void symbol_catalog_destroy(apol_symbol_catalog_t ** c);
+
+/**
+ * Get a policy's symbol catalog, first refilling it if the qpol
+ * policy has been rebuilt since the catalog was last filled.  A
+ * refill also forgets remembered regular expression matches and the
+ * type matrices, as those hold the old policy's values.  Names,
+ * objects and bitmaps obtained from the catalog before a rebuild must
+ * not be used after it.
+ *
+ * @param p Policy whose catalog to get.
+ *
+ * @return The policy's catalog, or NULL on error.
+ */
+	apol_symbol_catalog_t *apol_policy_get_catalog(const apol_policy_t * p);
+
+/**
+ * Look up a symbol's value by its name or by one of its aliases.
+ *
+ * @param c Catalog to search.
+ * @param kind Kind of symbol.
+ * @param name Name or alias to find.
+ * @param value Reference to the symbol's value.  For an alias this
+ * is the value of its primary.
+ *
+ * @return 0 if found, < 0 if not (with errno set to ENOENT).  No
+ * error message is reported.
+ */
+	int apol_symbol_catalog_lookup(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, const char *name,
+				       uint32_t * value);
+
+/**
+ * Find the symbols of a kind whose name, or any of whose aliases,
+ * matches a regular expression.  Each policy remembers the results
+ * for its most recently used expressions, so that queries repeated
+ * with the same pattern, or using it for more than one field, do not
+ * match it against every name again.  The remembered results are
+ * updated through a const policy, so, as with the rest of libapol,
+ * callers sharing a policy across threads must serialize access.
+ *
+ * @param p Policy whose catalog to search.
+ * @param kind Kind of symbol.
+ * @param regex Extended regular expression to match.
+ * @param matches Reference to a bitmap in which bit v is set if the
+ * symbol with value v matches.  The bitmap belongs to the policy and
+ * is valid until the next call to this function, even if the policy
+ * is rebuilt in between.
+ *
+ * @return 0 on success, < 0 on error (including an invalid
+ * expression).
+ */
+	int apol_symbol_catalog_match_regex(const apol_policy_t * p, apol_symbol_kind_e kind, const char *regex,
+					    const apol_bitmap_t ** matches);
+
+/**
+ * Get the types that a type or attribute expands to, as a bitmap
+ * indexed by type value.  An attribute expands to its types; a type
+ * expands to just itself.  Each policy builds this matrix for all of
+ * its types upon first use, with one row of words per type value.
+ *
+ * @param p Policy containing the type.
+ * @param value Value of the type or attribute.
+ *
+ * @return A bitmap which belongs to the policy and remains valid for
+ * as long as the policy, even once the policy is rebuilt, or NULL on
+ * error.
+ */
+	const apol_bitmap_t *apol_symbol_catalog_get_type_members(const apol_policy_t * p, uint32_t value);
+
+/**
+ * Get the attributes that a type has, as a bitmap indexed by type
+ * value.  An attribute has no attributes.  This matrix is built
+ * along with that of apol_symbol_catalog_get_type_members().
+ *
+ * @param p Policy containing the type.
+ * @param value Value of the type or attribute.
+ *
+ * @return A bitmap which belongs to the policy and remains valid for
+ * as long as the policy, or NULL on error.
+ */
+	const apol_bitmap_t *apol_symbol_catalog_get_type_attrs(const apol_policy_t * p, uint32_t value);
+
+/**
+ * Get one more than the highest value of any symbol of a kind, such
+ * that values from 1 up to but not including the result may be
+ * passed to the other catalog accessors.
+ *
+ * @param c Catalog to query.
+ * @param kind Kind of symbol.
+ *
+ * @return Bound on the symbols' values, or 0 if there are none.
+ */
+	size_t apol_symbol_catalog_get_num_values(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind);
+
+/**
+ * Get the primary name of a symbol.
+ *
+ * @param c Catalog to search.
+ * @param kind Kind of symbol.
+ * @param value Value of the symbol.
+ *
+ * @return The symbol's name, or NULL if no symbol has that value.
+ */
+	const char *apol_symbol_catalog_get_name(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, uint32_t value);
+
+/**
+ * Get the policy's object for a symbol, such as a qpol_type_t or
+ * qpol_role_t.  For types this is never an alias.
+ *
+ * @param c Catalog to search.
+ * @param kind Kind of symbol.
+ * @param value Value of the symbol.
+ *
+ * @return The symbol's object, or NULL if no symbol has that value.
+ */
+	const void *apol_symbol_catalog_get_object(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, uint32_t value);
+
+/**
+ * Get the aliases of a symbol.
+ *
+ * @param c Catalog to search.
+ * @param kind Kind of symbol.
+ * @param value Value of the symbol.
+ * @param num_aliases Reference to the number of aliases.
+ *
+ * @return Array of the symbol's aliases, which the caller must not
+ * free.
+ */
+	const char *const *apol_symbol_catalog_get_aliases(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind,
+							   uint32_t value, size_t * num_aliases);
+
+/**
+ * Get the names of a class's permissions, including those inherited
+ * from its common, indexed by permission value less one.  The names
+ * come from the policy's symbol catalog, so that rendering many rules
+ * does not allocate memory for each one.
+ *
+ * @param p Policy containing the class.
+ * @param class_value Value of the class.
+ * @param names Reference to the class's permission names; an entry
+ * is NULL if no permission has that value.  The caller must not free
+ * the array or its strings.
+ * @param num_names Reference to the number of entries in names.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	int apol_policy_get_perm_names(const apol_policy_t * p, uint32_t class_value, const char *const **names,
+				       size_t * num_names);
+
+/**
+ * Discard everything appended to a render buffer after the given
+ * length, such as the partial output of a failed render.
+ *
+ * @param buf Buffer to modify.
+ * @param len Length to which to truncate the buffer.
+ */
+	void render_buf_rollback(apol_render_buf_t * buf, size_t len);
+
+/**
+ * Mark the end of one rendered item.  If the buffer writes to a file
+ * and has accumulated enough text, write it out now.
+ *
+ * @param p Policy, for reporting errors.
+ * @param buf Buffer to flush.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	int render_buf_commit(const apol_policy_t * p, apol_render_buf_t * buf);
+
+/**
+ * Destroy a render buffer, but return its string rather than freeing
+ * it.  This is how the rendering functions that return newly
+ * allocated strings are built atop those that take a buffer.
+ *
+ * @param buf Reference to a buffer to destroy.  Afterwards it will be
+ * set to NULL.
+ *
+ * @return The buffer's string, which the caller must free(), or NULL
+ * if buf was NULL.
+ */
+	char *render_buf_release(apol_render_buf_t ** buf);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -138,26 +138,26 @@ int apol_compare_iter(const apol_policy_t * p, qpol_iterator_t * iter,
 }
 
 int apol_compare_type(const apol_policy_t * p, const qpol_type_t * type, const char *name, unsigned int flags,
-		      regex_t ** type_regex)
+		      regex_t ** type_regex __attribute__ ((unused)))
 {
-	const char *type_name;
-	int compval;
-	qpol_iterator_t *alias_iter = NULL;
-	if (qpol_type_get_name(p->p, type, &type_name) < 0) {
+	const apol_bitmap_t *matches;
+	uint32_t type_value, value;
+	if (name == NULL || *name == '\0') {
+		return 1;
+	}
+	if (qpol_type_get_value(p->p, type, &type_value) < 0) {
 		return -1;
 	}
-	compval = apol_compare(p, type_name, name, flags, type_regex);
-	if (compval != 0) {
-		return compval;
+	if (!(flags & APOL_QUERY_REGEX)) {
+		/* a name matches if it or one of its aliases denotes
+		 * the same type */
+		return (apol_symbol_catalog_lookup(apol_policy_get_catalog(p), APOL_SYMBOL_TYPE, name, &value) == 0 &&
+			value == type_value);
 	}
-	/* also check if the matches against one of the type's
-	 * aliases */
-	if (qpol_type_get_alias_iter(p->p, type, &alias_iter) < 0) {
+	if (apol_symbol_catalog_match_regex(p, APOL_SYMBOL_TYPE, name, &matches) < 0) {
 		return -1;
 	}
-	compval = apol_compare_iter(p, alias_iter, name, flags, type_regex, 0);
-	qpol_iterator_destroy(&alias_iter);
-	return compval;
+	return apol_bitmap_get(matches, type_value);
 }
 
 int apol_compare_permissive(const apol_policy_t * p, const qpol_permissive_t * permissive, const char *name, unsigned int flags,
@@ -307,18 +307,14 @@ int apol_compare_context(const apol_policy_t * p, const qpol_context_t * target,
 
 int apol_query_get_type(const apol_policy_t * p, const char *type_name, const qpol_type_t ** type)
 {
-	unsigned char isalias;
-	if (qpol_policy_get_type_by_name(p->p, type_name, type) < 0 || qpol_type_get_isalias(p->p, *type, &isalias) < 0) {
-		return -1;
-	}
-	if (isalias) {
-		const char *primary_name;
-		if (qpol_type_get_name(p->p, *type, &primary_name) < 0 ||
-		    qpol_policy_get_type_by_name(p->p, primary_name, type) < 0) {
-			return -1;
-		}
+	const apol_symbol_catalog_t *c = apol_policy_get_catalog(p);
+	uint32_t value;
+	if (apol_symbol_catalog_lookup(c, APOL_SYMBOL_TYPE, type_name, &value) == 0 &&
+	    (*type = apol_symbol_catalog_get_object(c, APOL_SYMBOL_TYPE, value)) != NULL) {
+		return 0;
 	}
-	return 0;
+	/* not in the policy; let qpol report the error */
+	return qpol_policy_get_type_by_name(p->p, type_name, type);
 }
 
 /**
@@ -334,17 +330,15 @@ int apol_query_get_type(const apol_policy_t * p, const char *type_name, const qp
  */
 static int apol_query_append_type(const apol_policy_t * p, apol_vector_t * v, const qpol_type_t * type)
 {
-	unsigned char isalias;
-	const qpol_type_t *real_type = type;
-	if (qpol_type_get_isalias(p->p, type, &isalias) < 0) {
+	uint32_t value;
+	const qpol_type_t *real_type;
+	/* the catalog holds only primaries, so this also resolves
+	 * aliases */
+	if (qpol_type_get_value(p->p, type, &value) < 0) {
 		return -1;
 	}
-	if (isalias) {
-		const char *primary_name;
-		if (qpol_type_get_name(p->p, type, &primary_name) < 0 ||
-		    qpol_policy_get_type_by_name(p->p, primary_name, &real_type) < 0) {
-			return -1;
-		}
+	if ((real_type = apol_symbol_catalog_get_object(apol_policy_get_catalog(p), APOL_SYMBOL_TYPE, value)) == NULL) {
+		real_type = type;
 	}
 	if (apol_vector_append(v, (void *)real_type) < 0) {
 		ERR(p, "%s", strerror(ENOMEM));
@@ -358,13 +352,10 @@ apol_vector_t *apol_query_create_candidate_type_list(const apol_policy_t * p, co
 {
 	apol_vector_t *list = apol_vector_create(NULL);
 	const qpol_type_t *type;
-	regex_t *regex = NULL;
-	qpol_iterator_t *iter = NULL, *alias_iter = NULL;
+	apol_bitmap_t *indirect = NULL;
 	int retval = -1, error = 0;
-	unsigned char isalias, isattr;
-	const char *type_name;
-	int compval;
-	size_t i, orig_vector_size;
+	unsigned char isattr;
+	size_t i;
 
 	if (list == NULL) {
 		error = EINVAL;
@@ -386,50 +377,21 @@ apol_vector_t *apol_query_create_candidate_type_list(const apol_policy_t * p, co
 	}
 
 	if (do_regex) {
-		if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		const apol_bitmap_t *matches;
+		size_t value;
+		if (apol_symbol_catalog_match_regex(p, APOL_SYMBOL_TYPE, symbol, &matches) < 0) {
 			error = errno;
 			goto cleanup;
 		}
-		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-			if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_name(p->p, type, &type_name) < 0) {
+		for (value = apol_bitmap_next(matches, 0); value < apol_bitmap_get_size(matches);
+		     value = apol_bitmap_next(matches, value + 1)) {
+			type = apol_symbol_catalog_get_object(apol_policy_get_catalog(p), APOL_SYMBOL_TYPE, (uint32_t) value);
+			if (apol_vector_append(list, (void *)type) < 0) {
 				error = errno;
+				ERR(p, "%s", strerror(error));
 				goto cleanup;
 			}
-			compval = apol_compare(p, type_name, symbol, APOL_QUERY_REGEX, &regex);
-			if (compval < 0) {
-				error = errno;
-				goto cleanup;
-			}
-			if (compval && apol_query_append_type(p, list, type)) {
-				error = errno;
-				goto cleanup;
-			}
-			if (compval)
-				continue;
-			if (qpol_type_get_alias_iter(p->p, type, &alias_iter) < 0) {
-				error = errno;
-				goto cleanup;
-			}
-			for (; !qpol_iterator_end(alias_iter); qpol_iterator_next(alias_iter)) {
-				if (qpol_iterator_get_item(alias_iter, (void **)&type_name) < 0) {
-					error = errno;
-					goto cleanup;
-				}
-				compval = apol_compare(p, type_name, symbol, APOL_QUERY_REGEX, &regex);
-				if (compval < 0) {
-					error = errno;
-					goto cleanup;
-				}
-				if (compval && apol_query_append_type(p, list, type)) {
-					error = errno;
-					goto cleanup;
-				}
-				if (compval)
-					break;
-			}
-			qpol_iterator_destroy(&alias_iter);
 		}
-		qpol_iterator_destroy(&iter);
 	}
 
 	/* prune to match ta_flag */
@@ -446,45 +408,46 @@ apol_vector_t *apol_query_create_candidate_type_list(const apol_policy_t * p, co
 	}
 
 	if (do_indirect) {
-		orig_vector_size = apol_vector_get_size(list);
-		for (i = 0; i < orig_vector_size; i++) {
+		/* add every type's attributes and every attribute's
+		 * types, all at once */
+		const apol_symbol_catalog_t *c;
+		if ((c = apol_policy_get_catalog(p)) == NULL) {
+			error = errno;
+			goto cleanup;
+		}
+		if ((indirect = apol_bitmap_create(apol_symbol_catalog_get_num_values(c, APOL_SYMBOL_TYPE))) == NULL) {
+			error = errno;
+			ERR(p, "%s", strerror(error));
+			goto cleanup;
+		}
+		for (i = 0; i < apol_vector_get_size(list); i++) {
+			const apol_bitmap_t *row;
+			uint32_t value;
 			type = (qpol_type_t *) apol_vector_get_element(list, i);
-			if (qpol_type_get_isalias(p->p, type, &isalias) < 0 || qpol_type_get_isattr(p->p, type, &isattr) < 0) {
+			if (qpol_type_get_isattr(p->p, type, &isattr) < 0 || qpol_type_get_value(p->p, type, &value) < 0) {
 				error = errno;
 				goto cleanup;
 			}
-			if (isalias) {
-				continue;
-			}
-			if ((isattr &&
-			     qpol_type_get_type_iter(p->p, type, &iter) < 0) ||
-			    (!isattr && qpol_type_get_attr_iter(p->p, type, &iter) < 0)) {
+			row = (isattr ? apol_symbol_catalog_get_type_members(p, value) : apol_symbol_catalog_get_type_attrs(p, value));
+			if (row == NULL || apol_bitmap_or(indirect, row) < 0) {
 				error = errno;
 				goto cleanup;
 			}
-			for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-				if (qpol_iterator_get_item(iter, (void **)&type) < 0) {
-					error = errno;
-					goto cleanup;
-				}
-				if (apol_query_append_type(p, list, type)) {
-					error = errno;
-					goto cleanup;
-				}
+		}
+		for (i = apol_bitmap_next(indirect, 0); i < apol_bitmap_get_size(indirect); i = apol_bitmap_next(indirect, i + 1)) {
+			type = apol_symbol_catalog_get_object(c, APOL_SYMBOL_TYPE, (uint32_t) i);
+			if (apol_vector_append(list, (void *)type) < 0) {
+				error = errno;
+				ERR(p, "%s", strerror(error));
+				goto cleanup;
 			}
-			qpol_iterator_destroy(&iter);
 		}
 	}
 
 	apol_vector_sort_uniquify(list, NULL, NULL);
 	retval = 0;
       cleanup:
-	if (regex != NULL) {
-		regfree(regex);
-		free(regex);
-	}
-	qpol_iterator_destroy(&iter);
-	qpol_iterator_destroy(&alias_iter);
+	apol_bitmap_destroy(&indirect);
 	if (retval < 0) {
 		apol_vector_destroy(&list);
 		errno = error;
@@ -641,17 +604,21 @@ apol_vector_t *apol_query_create_candidate_syn_type_list(const apol_policy_t * p
 apol_vector_t *apol_query_create_candidate_role_list(const apol_policy_t * p, char *symbol, int do_regex)
 {
 	apol_vector_t *list = apol_vector_create(NULL);
+	const apol_symbol_catalog_t *c;
 	const qpol_role_t *role;
-	regex_t *regex = NULL;
-	qpol_iterator_t *iter = NULL;
+	uint32_t value;
 	int retval = -1;
 
 	if (list == NULL) {
 		ERR(p, "%s", strerror(errno));
 		goto cleanup;
 	}
+	if ((c = apol_policy_get_catalog(p)) == NULL) {
+		goto cleanup;
+	}
 
-	if (!do_regex && qpol_policy_get_role_by_name(p->p, symbol, &role) == 0) {
+	if (!do_regex && apol_symbol_catalog_lookup(c, APOL_SYMBOL_ROLE, symbol, &value) == 0) {
+		role = apol_symbol_catalog_get_object(c, APOL_SYMBOL_ROLE, value);
 		if (apol_vector_append(list, (void *)role) < 0) {
 			ERR(p, "%s", strerror(ENOMEM));
 			goto cleanup;
@@ -659,34 +626,22 @@ apol_vector_t *apol_query_create_candidate_role_list(const apol_policy_t * p, ch
 	}
 
 	if (do_regex) {
-		if (qpol_policy_get_role_iter(p->p, &iter) < 0) {
+		const apol_bitmap_t *matches;
+		size_t i;
+		if (apol_symbol_catalog_match_regex(p, APOL_SYMBOL_ROLE, symbol, &matches) < 0) {
 			goto cleanup;
 		}
-		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-			const char *role_name;
-			int compval;
-			if (qpol_iterator_get_item(iter, (void **)&role) < 0 || qpol_role_get_name(p->p, role, &role_name) < 0) {
-				goto cleanup;
-			}
-			compval = apol_compare(p, role_name, symbol, APOL_QUERY_REGEX, &regex);
-			if (compval < 0) {
-				goto cleanup;
-			}
-			if (compval && apol_vector_append(list, (void *)role)) {
+		for (i = apol_bitmap_next(matches, 0); i < apol_bitmap_get_size(matches); i = apol_bitmap_next(matches, i + 1)) {
+			role = apol_symbol_catalog_get_object(c, APOL_SYMBOL_ROLE, (uint32_t) i);
+			if (apol_vector_append(list, (void *)role)) {
 				ERR(p, "%s", strerror(ENOMEM));
 				goto cleanup;
 			}
 		}
-		qpol_iterator_destroy(&iter);
 	}
 	apol_vector_sort_uniquify(list, NULL, NULL);
 	retval = 0;
       cleanup:
-	if (regex != NULL) {
-		regfree(regex);
-		free(regex);
-	}
-	qpol_iterator_destroy(&iter);
 	if (retval < 0) {
 		apol_vector_destroy(&list);
 		list = NULL;
@@ -697,6 +652,7 @@ apol_vector_t *apol_query_create_candidate_role_list(const apol_policy_t * p, ch
 apol_vector_t *apol_query_create_candidate_class_list(const apol_policy_t * p, apol_vector_t * classes)
 {
 	apol_vector_t *list = apol_vector_create(NULL);
+	const apol_symbol_catalog_t *c;
 	size_t i;
 	int retval = -1;
 
@@ -704,11 +660,16 @@ apol_vector_t *apol_query_create_candidate_class_list(const apol_policy_t * p, a
 		ERR(p, "%s", strerror(errno));
 		goto cleanup;
 	}
+	if ((c = apol_policy_get_catalog(p)) == NULL) {
+		goto cleanup;
+	}
 
 	for (i = 0; i < apol_vector_get_size(classes); i++) {
 		char *class_string = (char *)apol_vector_get_element(classes, i);
 		const qpol_class_t *class;
-		if (qpol_policy_get_class_by_name(p->p, class_string, &class) == 0) {
+		uint32_t value;
+		if (apol_symbol_catalog_lookup(c, APOL_SYMBOL_CLASS, class_string, &value) == 0) {
+			class = apol_symbol_catalog_get_object(c, APOL_SYMBOL_CLASS, value);
 			if (apol_vector_append(list, (void *)class) < 0) {
 				ERR(p, "%s", strerror(ENOMEM));
 				goto cleanup;
@@ -728,43 +689,26 @@ apol_vector_t *apol_query_create_candidate_class_list(const apol_policy_t * p, a
 apol_vector_t *apol_query_expand_type(const apol_policy_t * p, const qpol_type_t * t)
 {
 	apol_vector_t *v = NULL;
-	int retval = -1;
-	unsigned char isattr;
-	qpol_iterator_t *iter = NULL;
+	const apol_symbol_catalog_t *c;
+	const apol_bitmap_t *members;
+	uint32_t value;
+	size_t i;
 
-	if ((v = apol_vector_create(NULL)) == NULL) {
-		ERR(p, "%s", strerror(errno));
-		goto cleanup;
+	if (qpol_type_get_value(p->p, t, &value) < 0 || (members = apol_symbol_catalog_get_type_members(p, value)) == NULL ||
+	    (c = apol_policy_get_catalog(p)) == NULL) {
+		return NULL;
 	}
-	if (qpol_type_get_isattr(p->p, t, &isattr) < 0) {
-		goto cleanup;
+	if ((v = apol_vector_create_with_capacity(apol_bitmap_count(members), NULL)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
 	}
-	if (!isattr) {
-		if (apol_vector_append(v, (void *)t) < 0) {
+	for (i = apol_bitmap_next(members, 0); i < apol_bitmap_get_size(members); i = apol_bitmap_next(members, i + 1)) {
+		const void *type = apol_symbol_catalog_get_object(c, APOL_SYMBOL_TYPE, (uint32_t) i);
+		if (apol_vector_append(v, (void *)type) < 0) {
 			ERR(p, "%s", strerror(ENOMEM));
-			goto cleanup;
+			apol_vector_destroy(&v);
+			return NULL;
 		}
-	} else {
-		if (qpol_type_get_type_iter(p->p, t, &iter) < 0) {
-			goto cleanup;
-		}
-		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-			qpol_type_t *type;
-			if (qpol_iterator_get_item(iter, (void **)&type) < 0) {
-				goto cleanup;
-			}
-			if (apol_vector_append(v, type) < 0) {
-				ERR(p, "%s", strerror(ENOMEM));
-				goto cleanup;
-			}
-		}
-	}
-	retval = 0;
-      cleanup:
-	qpol_iterator_destroy(&iter);
-	if (retval != 0) {
-		apol_vector_destroy(&v);
-		return NULL;
 	}
 	return v;
 }
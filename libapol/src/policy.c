@@ -106,7 +106,7 @@ apol_policy_t *apol_policy_create_from_policy_path(const apol_policy_path_t * pa
 	if (apol_policy_path_get_type(path) == APOL_POLICY_PATH_TYPE_MODULAR) {
 		if (!qpol_policy_has_capability(policy->p, QPOL_CAP_MODULES)) {
 			INFO(policy, "%s is not a base policy.", primary_path);
-			return policy;
+			goto catalog;
 		}
 		const apol_vector_t *modules = apol_policy_path_get_modules(path);
 		size_t i;
@@ -132,6 +132,11 @@ apol_policy_t *apol_policy_create_from_policy_path(const apol_policy_path_t * pa
 			return NULL;
 		}
 	}
+      catalog:
+	if ((policy->catalog = apol_symbol_catalog_create(policy)) == NULL) {
+		apol_policy_destroy(&policy);
+		return NULL;
+	}
 	return policy;
 }
 
@@ -141,6 +146,8 @@ void apol_policy_destroy(apol_policy_t ** policy)
 		qpol_policy_destroy(&((*policy)->p));
 		permmap_destroy(&(*policy)->pmap);
 		domain_trans_table_destroy(&(*policy)->domain_trans_table);
+		relabel_table_destroy(&(*policy)->relabel_table);
+		symbol_catalog_destroy(&(*policy)->catalog);
 		free(*policy);
 		*policy = NULL;
 	}
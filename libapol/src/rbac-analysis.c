@@ -0,0 +1,454 @@
+/**
+ * @file
+ *
+ * Implementation of RBAC reachability, which follows users through
+ * their authorized roles and role allow rules to the types they may
+ * reach.  Every relation is held as bitmaps indexed by value, so that
+ * following it is a matter of ORing rows together.
+ *
+ * Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "policy-query-internal.h"
+
+#include <apol/parallel.h>
+#include <apol/rbac-analysis.h>
+#include <errno.h>
+#include <string.h>
+
+struct apol_rbac_reach
+{
+	const apol_policy_t *p;
+	/** one more than the highest role, user, and type values */
+	size_t num_roles, num_users, num_types;
+	/** indexed by role value: the role's types, the roles named
+	 *  by its role allow rules, and the roles reachable through
+	 *  any chain of those rules */
+	apol_bitmap_t **role_types, **role_allows, **role_closure;
+	/** indexed by user value: the user's roles, and the union of
+	 *  those roles' types */
+	apol_bitmap_t **user_roles, **user_types;
+};
+
+/**
+ * Allocate num_rows empty bitmaps of size bits each.
+ */
+static apol_bitmap_t **rbac_reach_alloc_rows(size_t num_rows, size_t size)
+{
+	apol_bitmap_t **rows;
+	size_t i;
+	if ((rows = calloc(num_rows, sizeof(*rows))) == NULL) {
+		return NULL;
+	}
+	for (i = 0; i < num_rows; i++) {
+		if ((rows[i] = apol_bitmap_create(size)) == NULL) {
+			int error = errno;
+			while (i > 0)
+				apol_bitmap_destroy(&rows[--i]);
+			free(rows);
+			errno = error;
+			return NULL;
+		}
+	}
+	return rows;
+}
+
+static void rbac_reach_free_rows(apol_bitmap_t *** rows, size_t num_rows)
+{
+	size_t i;
+	if (*rows == NULL)
+		return;
+	for (i = 0; i < num_rows; i++)
+		apol_bitmap_destroy(&(*rows)[i]);
+	free(*rows);
+	*rows = NULL;
+}
+
+/**
+ * Record each role's types, expanding any attributes, and the roles
+ * named by its role allow rules.
+ */
+static int rbac_reach_add_roles(apol_rbac_reach_t * r)
+{
+	const apol_policy_t *p = r->p;
+	qpol_iterator_t *iter = NULL, *type_iter = NULL;
+	const qpol_role_t *role, *target;
+	const qpol_type_t *type;
+	const qpol_role_allow_t *rule;
+	const apol_bitmap_t *members;
+	uint32_t role_value, target_value, type_value;
+	int retval = -1;
+
+	if (qpol_policy_get_role_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&role) < 0 || qpol_role_get_value(p->p, role, &role_value) < 0 ||
+		    qpol_role_get_type_iter(p->p, role, &type_iter) < 0) {
+			goto cleanup;
+		}
+		if (role_value >= r->num_roles) {
+			qpol_iterator_destroy(&type_iter);
+			continue;
+		}
+		for (; !qpol_iterator_end(type_iter); qpol_iterator_next(type_iter)) {
+			if (qpol_iterator_get_item(type_iter, (void **)&type) < 0 ||
+			    qpol_type_get_value(p->p, type, &type_value) < 0 ||
+			    (members = apol_symbol_catalog_get_type_members(p, type_value)) == NULL ||
+			    apol_bitmap_or(r->role_types[role_value], members) < 0) {
+				goto cleanup;
+			}
+		}
+		qpol_iterator_destroy(&type_iter);
+	}
+	qpol_iterator_destroy(&iter);
+
+	if (qpol_policy_get_role_allow_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&rule) < 0 ||
+		    qpol_role_allow_get_source_role(p->p, rule, &role) < 0 ||
+		    qpol_role_allow_get_target_role(p->p, rule, &target) < 0 ||
+		    qpol_role_get_value(p->p, role, &role_value) < 0 || qpol_role_get_value(p->p, target, &target_value) < 0) {
+			goto cleanup;
+		}
+		if (role_value < r->num_roles) {
+			apol_bitmap_set(r->role_allows[role_value], target_value);
+		}
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&type_iter);
+	return retval;
+}
+
+/**
+ * Record each user's roles.
+ */
+static int rbac_reach_add_users(apol_rbac_reach_t * r)
+{
+	const apol_policy_t *p = r->p;
+	qpol_iterator_t *iter = NULL, *role_iter = NULL;
+	const qpol_user_t *user;
+	const qpol_role_t *role;
+	uint32_t user_value, role_value;
+	int retval = -1;
+
+	if (qpol_policy_get_user_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&user) < 0 || qpol_user_get_value(p->p, user, &user_value) < 0 ||
+		    qpol_user_get_role_iter(p->p, user, &role_iter) < 0) {
+			goto cleanup;
+		}
+		if (user_value >= r->num_users) {
+			qpol_iterator_destroy(&role_iter);
+			continue;
+		}
+		for (; !qpol_iterator_end(role_iter); qpol_iterator_next(role_iter)) {
+			if (qpol_iterator_get_item(role_iter, (void **)&role) < 0 ||
+			    qpol_role_get_value(p->p, role, &role_value) < 0) {
+				goto cleanup;
+			}
+			if (role_value < r->num_roles) {
+				apol_bitmap_set(r->user_roles[user_value], role_value);
+			}
+		}
+		qpol_iterator_destroy(&role_iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&role_iter);
+	return retval;
+}
+
+/**
+ * Fill in one role's transitive closure over the role allow rules,
+ * breadth first from the role itself.
+ */
+static int rbac_reach_close_role(apol_rbac_reach_t * r, size_t role_value)
+{
+	apol_bitmap_t *closure = r->role_closure[role_value], *frontier = NULL, *next = NULL;
+	size_t i;
+	int retval = -1, error = 0;
+
+	if ((frontier = apol_bitmap_create(r->num_roles)) == NULL || (next = apol_bitmap_create(r->num_roles)) == NULL) {
+		error = errno;
+		goto cleanup;
+	}
+	apol_bitmap_set(closure, role_value);
+	apol_bitmap_set(frontier, role_value);
+	while (apol_bitmap_count(frontier) > 0) {
+		apol_bitmap_clear_all(next);
+		for (i = apol_bitmap_next(frontier, 0); i < r->num_roles; i = apol_bitmap_next(frontier, i + 1)) {
+			apol_bitmap_or(next, r->role_allows[i]);
+		}
+		apol_bitmap_andnot(next, closure);
+		apol_bitmap_or(closure, next);
+		apol_bitmap_clear_all(frontier);
+		apol_bitmap_or(frontier, next);
+	}
+	retval = 0;
+      cleanup:
+	apol_bitmap_destroy(&frontier);
+	apol_bitmap_destroy(&next);
+	errno = error;
+	return retval;
+}
+
+/**
+ * One task of the parallel pass in apol_rbac_reach_create().  The
+ * first num_roles tasks each close one role over the role allow
+ * rules; the rest each take the union of one user's roles' types.
+ * Every task writes only its own row, and reads rows that were
+ * complete before the pass began.
+ */
+static int rbac_reach_fill_row(void *arg, size_t task)
+{
+	apol_rbac_reach_t *r = (apol_rbac_reach_t *) arg;
+	size_t user_value, i;
+
+	if (task < r->num_roles) {
+		/* role value 0 is not used */
+		return (task == 0 ? 0 : rbac_reach_close_role(r, task));
+	}
+	user_value = task - r->num_roles;
+	for (i = apol_bitmap_next(r->user_roles[user_value], 0); i < r->num_roles;
+	     i = apol_bitmap_next(r->user_roles[user_value], i + 1)) {
+		apol_bitmap_or(r->user_types[user_value], r->role_types[i]);
+	}
+	return 0;
+}
+
+apol_rbac_reach_t *apol_rbac_reach_create(const apol_policy_t * p)
+{
+	apol_rbac_reach_t *r = NULL;
+	const apol_symbol_catalog_t *c;
+	int error;
+
+	if (p == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((c = apol_policy_get_catalog(p)) == NULL) {
+		return NULL;
+	}
+	if ((r = calloc(1, sizeof(*r))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	r->p = p;
+	r->num_roles = apol_symbol_catalog_get_num_values(c, APOL_SYMBOL_ROLE);
+	r->num_users = apol_symbol_catalog_get_num_values(c, APOL_SYMBOL_USER);
+	r->num_types = apol_symbol_catalog_get_num_values(c, APOL_SYMBOL_TYPE);
+	if ((r->role_types = rbac_reach_alloc_rows(r->num_roles, r->num_types)) == NULL ||
+	    (r->role_allows = rbac_reach_alloc_rows(r->num_roles, r->num_roles)) == NULL ||
+	    (r->role_closure = rbac_reach_alloc_rows(r->num_roles, r->num_roles)) == NULL ||
+	    (r->user_roles = rbac_reach_alloc_rows(r->num_users, r->num_roles)) == NULL ||
+	    (r->user_types = rbac_reach_alloc_rows(r->num_users, r->num_types)) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto err;
+	}
+	/* the policy's tables and catalog fill in lazily, so read them
+	 * here; the pass below only combines rows of bitmaps */
+	if (rbac_reach_add_roles(r) < 0 || rbac_reach_add_users(r) < 0) {
+		error = errno;
+		goto err;
+	}
+	if (apol_parallel_run(r->num_roles + r->num_users, 0, rbac_reach_fill_row, r) < 0) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto err;
+	}
+	return r;
+
+      err:
+	apol_rbac_reach_destroy(&r);
+	errno = error;
+	return NULL;
+}
+
+void apol_rbac_reach_destroy(apol_rbac_reach_t ** r)
+{
+	if (r == NULL || *r == NULL)
+		return;
+	rbac_reach_free_rows(&(*r)->role_types, (*r)->num_roles);
+	rbac_reach_free_rows(&(*r)->role_allows, (*r)->num_roles);
+	rbac_reach_free_rows(&(*r)->role_closure, (*r)->num_roles);
+	rbac_reach_free_rows(&(*r)->user_roles, (*r)->num_users);
+	rbac_reach_free_rows(&(*r)->user_types, (*r)->num_users);
+	free(*r);
+	*r = NULL;
+}
+
+/**
+ * Get a role's value, checking that it is within the tables.
+ */
+static int rbac_reach_get_role_value(const apol_rbac_reach_t * r, const qpol_role_t * role, uint32_t * value)
+{
+	if (r == NULL || role == NULL) {
+		ERR(NULL, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_role_get_value(r->p->p, role, value) < 0) {
+		return -1;
+	}
+	if (*value == 0 || *value >= r->num_roles) {
+		ERR(r->p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Get a user's value, checking that it is within the tables.
+ */
+static int rbac_reach_get_user_value(const apol_rbac_reach_t * r, const qpol_user_t * user, uint32_t * value)
+{
+	if (r == NULL || user == NULL) {
+		ERR(NULL, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_user_get_value(r->p->p, user, value) < 0) {
+		return -1;
+	}
+	if (*value == 0 || *value >= r->num_users) {
+		ERR(r->p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+const apol_bitmap_t *apol_rbac_reach_get_role_types(const apol_rbac_reach_t * r, const qpol_role_t * role)
+{
+	uint32_t value;
+	if (rbac_reach_get_role_value(r, role, &value) < 0) {
+		return NULL;
+	}
+	return r->role_types[value];
+}
+
+const apol_bitmap_t *apol_rbac_reach_get_role_closure(const apol_rbac_reach_t * r, const qpol_role_t * role)
+{
+	uint32_t value;
+	if (rbac_reach_get_role_value(r, role, &value) < 0) {
+		return NULL;
+	}
+	return r->role_closure[value];
+}
+
+const apol_bitmap_t *apol_rbac_reach_get_user_roles(const apol_rbac_reach_t * r, const qpol_user_t * user)
+{
+	uint32_t value;
+	if (rbac_reach_get_user_value(r, user, &value) < 0) {
+		return NULL;
+	}
+	return r->user_roles[value];
+}
+
+const apol_bitmap_t *apol_rbac_reach_get_user_types(const apol_rbac_reach_t * r, const qpol_user_t * user)
+{
+	uint32_t value;
+	if (rbac_reach_get_user_value(r, user, &value) < 0) {
+		return NULL;
+	}
+	return r->user_types[value];
+}
+
+int apol_rbac_reach_get_user_reachable_types(const apol_rbac_reach_t * r, const qpol_user_t * user,
+					     const qpol_role_t * role, apol_bitmap_t ** roles, apol_bitmap_t ** types)
+{
+	apol_bitmap_t *reached = NULL, *frontier = NULL, *next = NULL;
+	uint32_t user_value, role_value;
+	size_t i;
+	int retval = -1, error = 0;
+
+	if (roles != NULL)
+		*roles = NULL;
+	if (types == NULL) {
+		ERR(r == NULL ? NULL : r->p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	*types = NULL;
+	if (rbac_reach_get_user_value(r, user, &user_value) < 0 || rbac_reach_get_role_value(r, role, &role_value) < 0) {
+		return -1;
+	}
+	if ((reached = apol_bitmap_create(r->num_roles)) == NULL ||
+	    (frontier = apol_bitmap_create(r->num_roles)) == NULL ||
+	    (next = apol_bitmap_create(r->num_roles)) == NULL || (*types = apol_bitmap_create(r->num_types)) == NULL) {
+		error = errno;
+		ERR(r->p, "%s", strerror(error));
+		goto cleanup;
+	}
+
+	/* breadth first, one whole frontier of roles at a time,
+	 * staying within the user's roles */
+	if (apol_bitmap_get(r->user_roles[user_value], role_value)) {
+		apol_bitmap_set(reached, role_value);
+		apol_bitmap_set(frontier, role_value);
+	}
+	while (apol_bitmap_count(frontier) > 0) {
+		apol_bitmap_clear_all(next);
+		for (i = apol_bitmap_next(frontier, 0); i < r->num_roles; i = apol_bitmap_next(frontier, i + 1)) {
+			if (apol_bitmap_or(next, r->role_allows[i]) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+		}
+		if (apol_bitmap_and(next, r->user_roles[user_value]) < 0 || apol_bitmap_andnot(next, reached) < 0 ||
+		    apol_bitmap_or(reached, next) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		apol_bitmap_clear_all(frontier);
+		if (apol_bitmap_or(frontier, next) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+	for (i = apol_bitmap_next(reached, 0); i < r->num_roles; i = apol_bitmap_next(reached, i + 1)) {
+		if (apol_bitmap_or(*types, r->role_types[i]) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+	if (roles != NULL) {
+		*roles = reached;
+		reached = NULL;
+	}
+	retval = 0;
+      cleanup:
+	apol_bitmap_destroy(&reached);
+	apol_bitmap_destroy(&frontier);
+	apol_bitmap_destroy(&next);
+	if (retval < 0) {
+		apol_bitmap_destroy(types);
+		errno = error;
+	}
+	return retval;
+}
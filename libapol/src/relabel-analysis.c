@@ -24,6 +24,7 @@
 
 #include "policy-query-internal.h"
 
+#include <apol/bitmap.h>
 #include <errno.h>
 #include <string.h>
 
@@ -57,72 +58,406 @@ struct apol_relabel_result_pair
 	const qpol_type_t *intermed;
 };
 
+/**
+ * Results of a bulk relabel analysis; one node for each type that
+ * has at least one relabel result.
+ */
+struct apol_relabel_bulk_result
+{
+	const qpol_type_t *type;
+	/** vector of apol_relabel_result_t */
+	apol_vector_t *results;
+};
+
+/** an allow rule that grants relabelto and/or relabelfrom */
+typedef struct relabel_node
+{
+	const qpol_avrule_t *rule;
+	const qpol_type_t *source, *target;
+	const qpol_class_t *obj_class;
+	uint32_t source_val, target_val;
+	/** one of APOL_RELABEL_DIR_TO, APOL_RELABEL_DIR_FROM, or
+	 * APOL_RELABEL_DIR_BOTH */
+	unsigned int dir;
+} relabel_node_t;
+
+/**
+ * Index of all relabelling rules within a policy.  Nodes are kept in
+ * rule iteration order; every per-type list below is a run of node
+ * indices in ascending order, so results come out in the same order
+ * that a plain avrule query would produce.
+ */
+struct apol_relabel_table
+{
+	/** number of slots in each per-type array; one more than the
+	 * highest type value */
+	size_t num_types;
+	relabel_node_t *nodes;
+	size_t num_nodes;
+	/** nodes whose rule has source type value i are
+	 * by_source[source_start[i]] up to source_start[i + 1] */
+	size_t *source_start, *by_source;
+	/** likewise for the rules' target type values */
+	size_t *target_start, *by_target;
+	/** for each type value used by some rule, the types it expands
+	 * to (in apol_query_expand_type() order) and the same set as a
+	 * bitmap of type values */
+	apol_vector_t **expansions;
+	apol_bitmap_t **expansion_bits;
+	/** for each type value used as a rule source, a bitmap of the
+	 * nodes whose source shares at least one type with it */
+	apol_bitmap_t **source_peers;
+};
+
+/** per-analysis result accumulator */
+typedef struct relabel_results
+{
+	/** vector of apol_relabel_result_t */
+	apol_vector_t *results;
+	/** result node for each type value, or NULL if none yet */
+	apol_relabel_result_t **by_type;
+	/** cached result regex match for each type value: 0 if not yet
+	 * checked, 1 if matched, -1 if not */
+	signed char *result_match;
+	size_t num_types;
+} relabel_results_t;
+
 #define PERM_RELABELTO "relabelto"
 #define PERM_RELABELFROM "relabelfrom"
 
-/******************** actual analysis rountines ********************/
+/******************** relabel table ********************/
+
+void relabel_table_destroy(apol_relabel_table_t ** table)
+{
+	size_t i;
+	if (table == NULL || *table == NULL)
+		return;
+	for (i = 0; i < (*table)->num_types; i++) {
+		if ((*table)->expansions != NULL)
+			apol_vector_destroy(&(*table)->expansions[i]);
+		if ((*table)->expansion_bits != NULL)
+			apol_bitmap_destroy(&(*table)->expansion_bits[i]);
+		if ((*table)->source_peers != NULL)
+			apol_bitmap_destroy(&(*table)->source_peers[i]);
+	}
+	free((*table)->expansions);
+	free((*table)->expansion_bits);
+	free((*table)->source_peers);
+	free((*table)->nodes);
+	free((*table)->source_start);
+	free((*table)->by_source);
+	free((*table)->target_start);
+	free((*table)->by_target);
+	free(*table);
+	*table = NULL;
+}
+
+/**
+ * Return the bit within an avrule's permission mask that corresponds
+ * to the named permission of a class, or 0 if the class does not
+ * have that permission.
+ */
+static uint32_t relabel_perm_bit(const apol_policy_t * p, const qpol_class_t * obj_class, const char *perm)
+{
+	uint32_t val = 0;
+	if (qpol_class_get_perm_value(p->p, obj_class, perm, &val) < 0 || val == 0 || val > 32)
+		return 0;
+	return (uint32_t) 1 << (val - 1);
+}
 
 /**
- * Given an avrule, determine which relabel direction it has (to,
- * from, or both).
+ * Calculate the relabelto and relabelfrom permission bits for every
+ * object class, indexed by class value.
  *
- * @param p Policy containing avrule.
- * @param avrule Rule to examine.
+ * @param p Policy containing the classes.
+ * @param to_mask Reference to an array of relabelto bits.
+ * @param from_mask Reference to an array of relabelfrom bits.
+ * @param num_classes Set to the number of entries in each array.
  *
- * @return One of APOL_RELABEL_DIR_TO, APOL_RELABEL_DIR_FROM,
- * APOL_RELABEL_DIR_BOTH, or < 0 if direction could not be determined.
+ * @return 0 on success, < 0 on error.
  */
-static int relabel_analysis_get_direction(const apol_policy_t * p, const qpol_avrule_t * avrule)
+static int relabel_table_get_perm_masks(const apol_policy_t * p, uint32_t ** to_mask, uint32_t ** from_mask, size_t * num_classes)
 {
-	qpol_iterator_t *iter;
-	int to = 0, from = 0, retval = -1;
+	qpol_iterator_t *iter = NULL;
+	const qpol_class_t *obj_class;
+	uint32_t val, max_val = 0;
+	int retval = -1;
 
-	if (qpol_avrule_get_perm_iter(p->p, avrule, &iter) < 0) {
+	*to_mask = *from_mask = NULL;
+	if (qpol_policy_get_class_iter(p->p, &iter) < 0) {
 		goto cleanup;
 	}
 	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-		char *perm;
-		if (qpol_iterator_get_item(iter, (void **)&perm) < 0) {
+		if (qpol_iterator_get_item(iter, (void **)&obj_class) < 0 || qpol_class_get_value(p->p, obj_class, &val) < 0) {
 			goto cleanup;
 		}
-		if (strcmp(perm, PERM_RELABELTO) == 0) {
-			to = 1;
-		} else if (strcmp(perm, PERM_RELABELFROM) == 0) {
-			from = 1;
-		}
-		free(perm);
-		perm = NULL;
+		if (val > max_val)
+			max_val = val;
 	}
-	if (to && from) {
-		retval = APOL_RELABEL_DIR_BOTH;
-	} else if (to) {
-		retval = APOL_RELABEL_DIR_TO;
-	} else if (from) {
-		retval = APOL_RELABEL_DIR_FROM;
+	qpol_iterator_destroy(&iter);
+	*num_classes = (size_t) max_val + 1;
+	if ((*to_mask = calloc(*num_classes, sizeof(uint32_t))) == NULL ||
+	    (*from_mask = calloc(*num_classes, sizeof(uint32_t))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_class_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&obj_class) < 0 || qpol_class_get_value(p->p, obj_class, &val) < 0) {
+			goto cleanup;
+		}
+		(*to_mask)[val] = relabel_perm_bit(p, obj_class, PERM_RELABELTO);
+		(*from_mask)[val] = relabel_perm_bit(p, obj_class, PERM_RELABELFROM);
 	}
+	retval = 0;
       cleanup:
 	qpol_iterator_destroy(&iter);
+	if (retval != 0) {
+		free(*to_mask);
+		free(*from_mask);
+		*to_mask = *from_mask = NULL;
+	}
 	return retval;
 }
 
 /**
- * Given an apol_relabel_result_t node and a qpol_type_t, determine if
- * the two match.
+ * Record the expansion of a type used by a relabelling rule, if not
+ * already recorded.
+ *
+ * @param p Policy containing the type.
+ * @param table Table being built.
+ * @param type Type or attribute to expand.
+ * @param val Value of the type.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_table_add_expansion(const apol_policy_t * p, apol_relabel_table_t * table, const qpol_type_t * type,
+				       uint32_t val)
+{
+	size_t i;
+	uint32_t tval;
+	if (table->expansions[val] != NULL) {
+		return 0;
+	}
+	if ((table->expansions[val] = apol_query_expand_type(p, type)) == NULL) {
+		return -1;
+	}
+	if ((table->expansion_bits[val] = apol_bitmap_create(table->num_types)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(table->expansions[val]); i++) {
+		const qpol_type_t *t = apol_vector_get_element(table->expansions[val], i);
+		if (qpol_type_get_value(p->p, t, &tval) < 0) {
+			return -1;
+		}
+		apol_bitmap_set(table->expansion_bits[val], tval);
+	}
+	return 0;
+}
+
+/**
+ * Build the compressed lists of node indices keyed by a type value.
+ *
+ * @param table Table whose nodes have been added.
+ * @param use_source If non-zero key by the rules' sources, else by
+ * their targets.
+ * @param start Reference to the array of list offsets to allocate.
+ * @param list Reference to the array of node indices to allocate.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_table_build_lists(apol_relabel_table_t * table, int use_source, size_t ** start, size_t ** list)
+{
+	size_t i, *fill = NULL;
+	if ((*start = calloc(table->num_types + 1, sizeof(size_t))) == NULL ||
+	    (*list = malloc((table->num_nodes ? table->num_nodes : 1) * sizeof(size_t))) == NULL ||
+	    (fill = malloc(table->num_types * sizeof(size_t))) == NULL) {
+		free(fill);
+		return -1;
+	}
+	for (i = 0; i < table->num_nodes; i++) {
+		(*start)[(use_source ? table->nodes[i].source_val : table->nodes[i].target_val) + 1]++;
+	}
+	for (i = 0; i < table->num_types; i++) {
+		(*start)[i + 1] += (*start)[i];
+		fill[i] = (*start)[i];
+	}
+	for (i = 0; i < table->num_nodes; i++) {
+		uint32_t val = (use_source ? table->nodes[i].source_val : table->nodes[i].target_val);
+		(*list)[fill[val]++] = i;
+	}
+	free(fill);
+	return 0;
+}
+
+/**
+ * For each type used as a rule source, find all nodes whose source
+ * has a type in common with it.
  *
- * @param a Pointer to a apol_relabel_result_t.
- * @param b Pointer to a type.
- * @param data (Unused).
+ * @param p Policy, used for error reporting.
+ * @param table Table whose lists and expansions have been built.
  *
- * @return 0 if the result node's type matches the given type,
- * non-zero if not.
+ * @return 0 on success, < 0 on error.
  */
-static int relabel_result_comp_func(const void *a, const void *b, void *data __attribute__ ((unused)))
+static int relabel_table_build_peers(const apol_policy_t * p, apol_relabel_table_t * table)
 {
-	apol_relabel_result_t *r = (apol_relabel_result_t *) a;
-	qpol_type_t *t = (qpol_type_t *) b;
-	return (int)((char *)r->type - (char *)t);
+	size_t v, w, k;
+	for (v = 0; v < table->num_types; v++) {
+		if (table->source_start[v] == table->source_start[v + 1])
+			continue;
+		if ((table->source_peers[v] = apol_bitmap_create(table->num_nodes)) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			return -1;
+		}
+		for (w = 0; w < table->num_types; w++) {
+			if (table->source_start[w] == table->source_start[w + 1] ||
+			    !apol_bitmap_intersects(table->expansion_bits[v], table->expansion_bits[w]))
+				continue;
+			for (k = table->source_start[w]; k < table->source_start[w + 1]; k++)
+				apol_bitmap_set(table->source_peers[v], table->by_source[k]);
+		}
+	}
+	return 0;
 }
 
+/**
+ * Build a relabel table for a policy, by making a single pass over
+ * its allow rules.
+ *
+ * @param p Policy to index.
+ *
+ * @return A newly allocated table which the caller must destroy with
+ * relabel_table_destroy(), or NULL on error.
+ */
+static apol_relabel_table_t *relabel_table_create(const apol_policy_t * p)
+{
+	apol_relabel_table_t *table = NULL;
+	qpol_iterator_t *iter = NULL;
+	uint32_t *to_mask = NULL, *from_mask = NULL, val, max_val = 0;
+	size_t num_classes = 0, cap = 0;
+	int retval = -1;
+
+	if ((table = calloc(1, sizeof(*table))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_type_t *type;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &val) < 0) {
+			goto cleanup;
+		}
+		if (val > max_val)
+			max_val = val;
+	}
+	qpol_iterator_destroy(&iter);
+	table->num_types = (size_t) max_val + 1;
+	if ((table->expansions = calloc(table->num_types, sizeof(apol_vector_t *))) == NULL ||
+	    (table->expansion_bits = calloc(table->num_types, sizeof(apol_bitmap_t *))) == NULL ||
+	    (table->source_peers = calloc(table->num_types, sizeof(apol_bitmap_t *))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (relabel_table_get_perm_masks(p, &to_mask, &from_mask, &num_classes) < 0) {
+		goto cleanup;
+	}
+
+	if (qpol_policy_get_avrule_iter(p->p, QPOL_RULE_ALLOW, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_avrule_t *rule;
+		relabel_node_t *node;
+		uint32_t class_val, mask;
+		const qpol_class_t *obj_class;
+		if (qpol_iterator_get_item(iter, (void **)&rule) < 0 ||
+		    qpol_avrule_get_object_class(p->p, rule, &obj_class) < 0 ||
+		    qpol_class_get_value(p->p, obj_class, &class_val) < 0 || qpol_avrule_get_perm_mask(p->p, rule, &mask) < 0) {
+			goto cleanup;
+		}
+		if (class_val >= num_classes || (mask & (to_mask[class_val] | from_mask[class_val])) == 0) {
+			continue;
+		}
+		if (table->num_nodes >= cap) {
+			size_t new_cap = (cap ? cap * 2 : 64);
+			relabel_node_t *tmp = realloc(table->nodes, new_cap * sizeof(*tmp));
+			if (tmp == NULL) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+			table->nodes = tmp;
+			cap = new_cap;
+		}
+		node = &table->nodes[table->num_nodes];
+		node->rule = rule;
+		node->obj_class = obj_class;
+		node->dir = 0;
+		if (mask & to_mask[class_val])
+			node->dir |= APOL_RELABEL_DIR_TO;
+		if (mask & from_mask[class_val])
+			node->dir |= APOL_RELABEL_DIR_FROM;
+		if (qpol_avrule_get_source_type(p->p, rule, &node->source) < 0 ||
+		    qpol_avrule_get_target_type(p->p, rule, &node->target) < 0 ||
+		    qpol_type_get_value(p->p, node->source, &node->source_val) < 0 ||
+		    qpol_type_get_value(p->p, node->target, &node->target_val) < 0 ||
+		    node->source_val >= table->num_types || node->target_val >= table->num_types) {
+			goto cleanup;
+		}
+		if (relabel_table_add_expansion(p, table, node->source, node->source_val) < 0 ||
+		    relabel_table_add_expansion(p, table, node->target, node->target_val) < 0) {
+			goto cleanup;
+		}
+		table->num_nodes++;
+	}
+	qpol_iterator_destroy(&iter);
+
+	if (relabel_table_build_lists(table, 1, &table->source_start, &table->by_source) < 0 ||
+	    relabel_table_build_lists(table, 0, &table->target_start, &table->by_target) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (relabel_table_build_peers(p, table) < 0) {
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	free(to_mask);
+	free(from_mask);
+	if (retval != 0) {
+		relabel_table_destroy(&table);
+	}
+	return table;
+}
+
+/**
+ * Return the policy's relabel table if one was built, else build a
+ * temporary one.
+ *
+ * @param p Policy to index.
+ * @param tmp Reference to a table that the caller must destroy with
+ * relabel_table_destroy() afterwards; set to NULL if the policy's own
+ * table was returned.
+ *
+ * @return Table to use, or NULL on error.
+ */
+static const apol_relabel_table_t *relabel_table_get(const apol_policy_t * p, apol_relabel_table_t ** tmp)
+{
+	*tmp = NULL;
+	if (p->relabel_table != NULL) {
+		return p->relabel_table;
+	}
+	*tmp = relabel_table_create(p);
+	return *tmp;
+}
+
+/******************** actual analysis rountines ********************/
+
 static void relabel_result_free(void *result)
 {
 	if (result != NULL) {
@@ -134,40 +469,132 @@ static void relabel_result_free(void *result)
 	}
 }
 
+static void relabel_bulk_result_free(void *result)
+{
+	if (result != NULL) {
+		apol_relabel_bulk_result_t *r = (apol_relabel_bulk_result_t *) result;
+		apol_vector_destroy(&r->results);
+		free(result);
+	}
+}
+
+static int relabel_results_init(const apol_policy_t * p, const apol_relabel_table_t * table, relabel_results_t * res)
+{
+	memset(res, 0, sizeof(*res));
+	res->num_types = table->num_types;
+	if ((res->results = apol_vector_create(relabel_result_free)) == NULL ||
+	    (res->by_type = calloc(res->num_types, sizeof(apol_relabel_result_t *))) == NULL ||
+	    (res->result_match = calloc(res->num_types, sizeof(signed char))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		apol_vector_destroy(&res->results);
+		free(res->by_type);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Start a new set of results, keeping the cached regex matches.
+ *
+ * @param p Policy, used for error handling.
+ * @param res Results being built.
+ * @param prev The previous results, now owned by the caller.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_results_clear(const apol_policy_t * p, relabel_results_t * res, const apol_vector_t * prev)
+{
+	size_t i;
+	uint32_t val;
+	for (i = 0; i < apol_vector_get_size(prev); i++) {
+		const apol_relabel_result_t *result = apol_vector_get_element(prev, i);
+		if (qpol_type_get_value(p->p, result->type, &val) == 0 && val < res->num_types)
+			res->by_type[val] = NULL;
+	}
+	if ((res->results = apol_vector_create(relabel_result_free)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+static void relabel_results_fini(relabel_results_t * res)
+{
+	apol_vector_destroy(&res->results);
+	free(res->by_type);
+	free(res->result_match);
+	res->by_type = NULL;
+	res->result_match = NULL;
+}
+
 /**
- * Given a qpol_type_t pointer, find and return the first
- * apol_relabel_result_t node within vector v that matches the type.
- * If there does not exist a node with that type, then allocate a new
- * one, append it to the vector, and return it.  The caller is
- * expected to eventually call apol_vector_destroy() upon the vector.
+ * Given a qpol_type_t pointer, find and return the
+ * apol_relabel_result_t node for that type.  If there does not exist
+ * a node with that type, then allocate a new one, append it to the
+ * results vector, and return it.
  *
  * @param p Policy, used for error handling.
- * @param results A vector of apol_relabel_result_t nodes.
+ * @param res Results being built.
  * @param type Target type to find.
+ * @param val Value of the target type.
  *
  * @return An apol_relabel_result_t node from which to append results,
  * or NULL upon error.
  */
-static apol_relabel_result_t *relabel_result_get_node(const apol_policy_t * p, apol_vector_t * results, const qpol_type_t * type)
+static apol_relabel_result_t *relabel_result_get_node(const apol_policy_t * p, relabel_results_t * res, const qpol_type_t * type,
+						      uint32_t val)
 {
 	apol_relabel_result_t *result;
-	size_t i;
-	if (apol_vector_get_index(results, type, relabel_result_comp_func, NULL, &i) == 0) {
-		return (apol_relabel_result_t *) apol_vector_get_element(results, i);
+	if (res->by_type[val] != NULL) {
+		return res->by_type[val];
 	}
 	/* make a new result node */
 	if ((result = calloc(1, sizeof(*result))) == NULL ||
 	    (result->to = apol_vector_create(free)) == NULL ||
 	    (result->from = apol_vector_create(free)) == NULL ||
-	    (result->both = apol_vector_create(free)) == NULL || apol_vector_append(results, result) < 0) {
+	    (result->both = apol_vector_create(free)) == NULL || apol_vector_append(res->results, result) < 0) {
 		ERR(p, "%s", strerror(errno));
 		relabel_result_free(result);
 		return NULL;
 	}
 	result->type = type;
+	res->by_type[val] = result;
 	return result;
 }
 
+/**
+ * Determine if a resulting type should be reported, i.e., it is not
+ * the starting type and it matches the analysis's result regex.
+ *
+ * @param p Policy containing the type.
+ * @param r Relabel analysis query object.
+ * @param res Results being built, caching regex matches.
+ * @param start_type Type being analyzed.
+ * @param type Candidate result type.
+ * @param val Set to the value of the candidate type.
+ *
+ * @return 1 if the type should be reported, 0 if not, < 0 on error.
+ */
+static int relabel_analysis_check_result(const apol_policy_t * p, apol_relabel_analysis_t * r, relabel_results_t * res,
+					 const qpol_type_t * start_type, const qpol_type_t * type, uint32_t * val)
+{
+	int compval;
+	if (type == start_type) {
+		return 0;	       /* don't care about relabels to itself */
+	}
+	if (qpol_type_get_value(p->p, type, val) < 0 || *val >= res->num_types) {
+		return -1;
+	}
+	if (res->result_match[*val] == 0) {
+		compval = apol_compare_type(p, type, r->result, APOL_QUERY_REGEX, &r->result_regex);
+		if (compval < 0) {
+			return -1;
+		}
+		res->result_match[*val] = (compval ? 1 : -1);
+	}
+	return res->result_match[*val] > 0;
+}
+
 /**
  * Given a vector of strings representing type names, allocate and
  * return a vector of qpol_type_t pointers into the given policy for
@@ -213,131 +640,187 @@ static apol_vector_t *relabel_analysis_get_type_vector(const apol_policy_t * p,
 }
 
 /**
- * Given a type, see if it is an element within a vector of
- * qpol_type_t pointers.  If the type is really an attribute, also
- * check if any of the attribute's types are a member of v.  If v is
- * NULL then the comparison always succeeds.
+ * Allocate a bitmap of the values of the types named by the
+ * analysis's subjects.
  *
  * @param p Policy to which look up types.
- * @param v Target vector of qpol_type_t pointers.
- * @param type Source type to find.
+ * @param table Relabel table, giving the number of type values.
+ * @param r Relabel analysis query object.
+ * @param subjects Reference to the bitmap to allocate; set to NULL if
+ * the analysis has no subjects.
  *
- * @return 1 if type is a member of v, 0 if not, < 0 on error.
+ * @return 0 on success, < 0 on error.
  */
-static int relabel_analysis_compare_type_to_vector(const apol_policy_t * p, const apol_vector_t * v, const qpol_type_t * type)
+static int relabel_analysis_get_subjects(const apol_policy_t * p, const apol_relabel_table_t * table, apol_relabel_analysis_t * r,
+					 apol_bitmap_t ** subjects)
 {
+	apol_vector_t *subjects_v = NULL;
 	size_t i;
-	unsigned char isattr;
-	qpol_iterator_t *iter = NULL;
+	uint32_t val;
 	int retval = -1;
-	if (v == NULL || apol_vector_get_index(v, type, NULL, NULL, &i) == 0) {
-		retval = 1;	       /* found it */
+
+	*subjects = NULL;
+	if (r->subjects == NULL) {
+		return 0;
+	}
+	if ((subjects_v = relabel_analysis_get_type_vector(p, r->subjects)) == NULL) {
 		goto cleanup;
 	}
-	if (qpol_type_get_isattr(p->p, type, &isattr) < 0) {
+	if ((*subjects = apol_bitmap_create(table->num_types)) == NULL) {
+		ERR(p, "%s", strerror(errno));
 		goto cleanup;
 	}
-	if (!isattr) {		       /* not an attribute, so comparison failed */
-		retval = 0;
+	for (i = 0; i < apol_vector_get_size(subjects_v); i++) {
+		if (qpol_type_get_value(p->p, apol_vector_get_element(subjects_v, i), &val) < 0) {
+			goto cleanup;
+		}
+		apol_bitmap_set(*subjects, val);
+	}
+	retval = 0;
+      cleanup:
+	apol_vector_destroy(&subjects_v);
+	if (retval != 0) {
+		apol_bitmap_destroy(subjects);
+	}
+	return retval;
+}
+
+/**
+ * Find all relabelling rules whose source (for subject mode) or
+ * target (for object mode) is the given type, or an attribute of the
+ * type, or if the type is an attribute one of its types.  This
+ * matches the candidates of an indirect avrule query.
+ *
+ * @param p Policy containing the type.
+ * @param table Relabel table.
+ * @param type Type to look up.
+ * @param use_source If non-zero match rules' sources, else their targets.
+ * @param nodes Bitmap of table nodes to which to add matches.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_analysis_find_nodes(const apol_policy_t * p, const apol_relabel_table_t * table, const qpol_type_t * type,
+				       int use_source, apol_bitmap_t * nodes)
+{
+	const size_t *start = (use_source ? table->source_start : table->target_start);
+	const size_t *list = (use_source ? table->by_source : table->by_target);
+	qpol_iterator_t *iter = NULL;
+	unsigned char isattr;
+	uint32_t val;
+	size_t k;
+	int retval = -1;
+
+	if (qpol_type_get_value(p->p, type, &val) < 0 || qpol_type_get_isattr(p->p, type, &isattr) < 0) {
 		goto cleanup;
 	}
-	if (qpol_type_get_type_iter(p->p, type, &iter) < 0) {
+	if (val < table->num_types) {
+		for (k = start[val]; k < start[val + 1]; k++)
+			apol_bitmap_set(nodes, list[k]);
+	}
+	if ((isattr && qpol_type_get_type_iter(p->p, type, &iter) < 0) ||
+	    (!isattr && qpol_type_get_attr_iter(p->p, type, &iter) < 0)) {
 		goto cleanup;
 	}
 	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-		qpol_type_t *t;
-		if (qpol_iterator_get_item(iter, (void **)&t) < 0) {
-			goto cleanup;
-		}
-		if (apol_vector_get_index(v, t, NULL, NULL, &i) == 0) {
-			retval = 1;
+		const qpol_type_t *t;
+		if (qpol_iterator_get_item(iter, (void **)&t) < 0 || qpol_type_get_value(p->p, t, &val) < 0) {
 			goto cleanup;
 		}
+		if (val >= table->num_types)
+			continue;
+		for (k = start[val]; k < start[val + 1]; k++)
+			apol_bitmap_set(nodes, list[k]);
 	}
-	retval = 0;		       /* no matches */
+	retval = 0;
       cleanup:
 	qpol_iterator_destroy(&iter);
 	return retval;
 }
 
 /**
- * Given two avrules, possbily append it to the object results vector
- * onto the appropriate rules vector.  The decision to actually append
- * or not is dependent upon the filtering options stored within the
- * relabel analysis object.
+ * Determine if a node's class is among those requested.
+ *
+ * @param class_list Vector of qpol_class_t pointers, or NULL to
+ * accept all classes.
+ * @param node Node to check.
+ *
+ * @return Non-zero if the class matches, 0 if not.
+ */
+static int relabel_analysis_class_matches(const apol_vector_t * class_list, const relabel_node_t * node)
+{
+	size_t i;
+	return (class_list == NULL || apol_vector_get_index(class_list, node->obj_class, NULL, NULL, &i) == 0);
+}
+
+/**
+ * Given two relabelling rules, possibly append them to the object
+ * results onto the appropriate rules vector.  The decision to
+ * actually append or not is dependent upon the filtering options
+ * stored within the relabel analysis object.
  *
  * @param p Policy containing avrule.
  * @param r Relabel analysis query object, containing filtering options.
- * @param ruleA First AV rule to add.
- * @param ruleB Other AV rule to add.
- * @param result Results vector being built.
+ * @param table Relabel table containing the nodes.
+ * @param start_type Type being analyzed.
+ * @param a First rule to add.
+ * @param b Other rule to add.
+ * @param res Results being built.
  *
  * @return 0 on success, < 0 on error.
  */
-static int append_avrules_to_object_vector(const apol_policy_t * p,
-					   apol_relabel_analysis_t * r,
-					   const qpol_avrule_t * ruleA, const qpol_avrule_t * ruleB, apol_vector_t * results)
+static int append_avrules_to_object_vector(const apol_policy_t * p, apol_relabel_analysis_t * r, const apol_relabel_table_t * table,
+					   const qpol_type_t * start_type, const relabel_node_t * a, const relabel_node_t * b,
+					   relabel_results_t * res)
 {
-	const qpol_type_t *sourceA, *sourceB, *target, *intermed;
+	const qpol_type_t *target, *intermed;
+	const apol_vector_t *target_v = table->expansions[b->target_val];
 	unsigned char isattrA, isattrB;
-	apol_vector_t *target_v = NULL, *result_list;
+	apol_vector_t *result_list;
 	size_t i;
+	uint32_t val;
 	apol_relabel_result_t *result;
 	apol_relabel_result_pair_t *pair = NULL;
-	int retval = -1, compval, dirA, dirB;
-	if (qpol_avrule_get_target_type(p->p, ruleB, &target) < 0 || (target_v = apol_query_expand_type(p, target)) == NULL) {
-		goto cleanup;
-	}
-	if (qpol_avrule_get_source_type(p->p, ruleA, &sourceA) < 0 ||
-	    qpol_avrule_get_source_type(p->p, ruleB, &sourceB) < 0 ||
-	    qpol_type_get_isattr(p->p, sourceA, &isattrA) < 0 || qpol_type_get_isattr(p->p, sourceB, &isattrB) < 0) {
+	int retval = -1, compval;
+
+	if (qpol_type_get_isattr(p->p, a->source, &isattrA) < 0 || qpol_type_get_isattr(p->p, b->source, &isattrB) < 0) {
 		goto cleanup;
 	}
 	/* If both rules use the same attribute, retain the attribute
 	 * to minimize the number of results and to indicate that all
 	 * types with that attribute have the permission to relabel. */
 	if ((isattrA && isattrB) || !isattrA) {
-		intermed = sourceA;
+		intermed = a->source;
 	} else {
-		intermed = sourceB;
+		intermed = b->source;
 	}
 	for (i = 0; i < apol_vector_get_size(target_v); i++) {
 		target = (qpol_type_t *) apol_vector_get_element(target_v, i);
 		/* exclude if B(t) does not match search criteria */
-		compval = apol_compare_type(p, target, r->type, 0, NULL);
-		if (compval < 0) {
-			goto cleanup;
-		} else if (compval == 1) {
-			continue;      /* don't care about relabels to itself */
-		}
-		compval = apol_compare_type(p, target, r->result, APOL_QUERY_REGEX, &r->result_regex);
+		compval = relabel_analysis_check_result(p, r, res, start_type, target, &val);
 		if (compval < 0) {
 			goto cleanup;
 		} else if (compval == 0) {
 			continue;
 		}
-		if ((result = relabel_result_get_node(p, results, target)) == NULL) {
-			goto cleanup;
-		}
-		if ((dirA = relabel_analysis_get_direction(p, ruleA)) < 0 || (dirB = relabel_analysis_get_direction(p, ruleB)) < 0) {
+		if ((result = relabel_result_get_node(p, res, target, val)) == NULL) {
 			goto cleanup;
 		}
 		if ((pair = calloc(1, sizeof(*pair))) == NULL) {
 			ERR(p, "%s", strerror(ENOMEM));
 			goto cleanup;
 		}
-		if (dirA == APOL_RELABEL_DIR_BOTH && dirB == APOL_RELABEL_DIR_BOTH) {
+		if (a->dir == APOL_RELABEL_DIR_BOTH && b->dir == APOL_RELABEL_DIR_BOTH) {
 			result_list = result->both;
-			pair->ruleA = ruleA;
-			pair->ruleB = ruleB;
-		} else if (dirA == APOL_RELABEL_DIR_FROM || dirB == APOL_RELABEL_DIR_TO) {
+			pair->ruleA = a->rule;
+			pair->ruleB = b->rule;
+		} else if (a->dir == APOL_RELABEL_DIR_FROM || b->dir == APOL_RELABEL_DIR_TO) {
 			result_list = result->to;
-			pair->ruleA = ruleA;
-			pair->ruleB = ruleB;
+			pair->ruleA = a->rule;
+			pair->ruleB = b->rule;
 		} else {
 			result_list = result->from;
-			pair->ruleA = ruleB;
-			pair->ruleB = ruleA;
+			pair->ruleA = b->rule;
+			pair->ruleB = a->rule;
 		}
 		pair->intermed = intermed;
 		if ((apol_vector_append(result_list, pair)) < 0) {
@@ -349,211 +832,107 @@ static int append_avrules_to_object_vector(const apol_policy_t * p,
 	retval = 0;
       cleanup:
 	free(pair);
-	apol_vector_destroy(&target_v);
 	return retval;
 }
 
 /**
- * Search through sets av and bv, finding pairs of avrules that
- * satisfy a relabel and adding those pairs to result vector v.
+ * Find pairs of rules A and B that together allow a subject to
+ * relabel an object from/to the starting type.  A must have the
+ * starting type as its target and the permission <i>opposite</i> of
+ * the direction given (e.g., relabelfrom if given DIR_TO); B must
+ * have the permission of the direction given, a source that shares a
+ * type with A's source, a different target, and the same class as A.
+ * Only rules whose class is a member of the analysis's classes and
+ * (for A) whose source is among the subjects are considered.
  *
- * @param p Policy containing avrules.
- * @param r Relabel analysis query object.
- * @param v Vector of apol_relabel_result_t nodes.
- * @param av Vector of qpol_avrule_t pointers.
- * @param bv Vector of qpol_avrule_t pointers.
- * @param subjects_v Vector of permitted qpol_type_t subjects, or NULL
- * to allow all types.
+ * @param p Policy to which look up rules.
+ * @param r Structure containing parameters for object relabel analysis.
+ * @param table Relabel table.
+ * @param start_type Type being analyzed.
+ * @param a_nodes Bitmap of nodes whose target matches the starting type.
+ * @param class_list If not NULL, vector of permitted qpol_class_t pointers.
+ * @param subjects If not NULL, bitmap of permitted subject type values.
+ * @param direction Relabelling direction to search.
+ * @param res Results being built.
  *
- * @return 0 on success, < 0 upon error.
+ * @return 0 on success, < 0 on error.
  */
-static int relabel_analysis_matchup(const apol_policy_t * p,
-				    apol_relabel_analysis_t * r,
-				    apol_vector_t * av, apol_vector_t * bv, const apol_vector_t * subjects_v, apol_vector_t * v)
-{
-	const qpol_avrule_t *a_avrule, *b_avrule;
-	const qpol_type_t *a_source, *a_target, *b_source, *b_target, *start_type;
-	const qpol_class_t *a_class, *b_class;
-	apol_vector_t *start_v = NULL;
+static int relabel_analysis_object(const apol_policy_t * p, apol_relabel_analysis_t * r, const apol_relabel_table_t * table,
+				   const qpol_type_t * start_type, const apol_bitmap_t * a_nodes, const apol_vector_t * class_list,
+				   const apol_bitmap_t * subjects, unsigned int direction, relabel_results_t * res)
+{
+	unsigned int perm1 = (direction == APOL_RELABEL_DIR_TO ? APOL_RELABEL_DIR_FROM : APOL_RELABEL_DIR_TO);
+	unsigned int perm2 = direction;
 	size_t i, j;
-	int compval, retval = -1;
 
-	if (apol_query_get_type(p, r->type, &start_type) < 0) {
-		goto cleanup;
-	}
-	for (i = 0; i < apol_vector_get_size(av); i++) {
-		a_avrule = apol_vector_get_element(av, i);
-		if (qpol_avrule_get_source_type(p->p, a_avrule, &a_source) < 0 ||
-		    qpol_avrule_get_target_type(p->p, a_avrule, &a_target) < 0 ||
-		    qpol_avrule_get_object_class(p->p, a_avrule, &a_class) < 0) {
-			goto cleanup;
-		}
-		compval = relabel_analysis_compare_type_to_vector(p, subjects_v, a_source);
-		if (compval < 0) {
-			goto cleanup;
-		} else if (compval == 0) {
+	for (i = apol_bitmap_next(a_nodes, 0); i < table->num_nodes; i = apol_bitmap_next(a_nodes, i + 1)) {
+		const relabel_node_t *a = &table->nodes[i];
+		const apol_bitmap_t *peers = table->source_peers[a->source_val];
+		if (!(a->dir & perm1) || !relabel_analysis_class_matches(class_list, a)) {
 			continue;
 		}
-		if ((start_v = apol_query_expand_type(p, a_source)) == NULL) {
-			goto cleanup;
+		if (subjects != NULL && !apol_bitmap_get(subjects, a->source_val) &&
+		    !apol_bitmap_intersects(subjects, table->expansion_bits[a->source_val])) {
+			continue;
 		}
-
-		/* check if there exists a B s.t. B(s) = source and
-		 * B(t) != r->type and B(o) = A(o) */
-		for (j = 0; j < apol_vector_get_size(bv); j++) {
-			b_avrule = apol_vector_get_element(bv, j);
-			if (qpol_avrule_get_source_type(p->p, b_avrule, &b_source) < 0 ||
-			    qpol_avrule_get_target_type(p->p, b_avrule, &b_target) < 0 ||
-			    qpol_avrule_get_object_class(p->p, b_avrule, &b_class) < 0) {
-				goto cleanup;
-			}
-			if (relabel_analysis_compare_type_to_vector(p, start_v, b_source) != 1 ||
-			    b_target == start_type || a_class != b_class) {
+		for (j = apol_bitmap_next(peers, 0); j < table->num_nodes; j = apol_bitmap_next(peers, j + 1)) {
+			const relabel_node_t *b = &table->nodes[j];
+			if (!(b->dir & perm2) || b->target == start_type || a->obj_class != b->obj_class) {
 				continue;
 			}
-			if (append_avrules_to_object_vector(p, r, a_avrule, b_avrule, v) < 0) {
-				goto cleanup;
+			if (append_avrules_to_object_vector(p, r, table, start_type, a, b, res) < 0) {
+				return -1;
 			}
 		}
-		apol_vector_destroy(&start_v);
-	}
-
-	retval = 0;
-      cleanup:
-	apol_vector_destroy(&start_v);
-	return retval;
-}
-
-/**
- * Get a list of allow rules, whose target type matches r->type and
- * whose permission is <i>opposite</i> of the direction given (e.g.,
- * relabelfrom if given DIR_TO).  Only include rules whose class is a
- * member of r->classes and whose source is a member of subjects_v.
- *
- * @param p Policy to which look up rules.
- * @param r Structure containing parameters for subject relabel analysis.
- * @param v Target vector to which append discovered rules.
- * @param direction Relabelling direction to search.
- * @param subjects_v If not NULL, then a vector of qpol_type_t pointers.
- *
- * @return 0 on success, < 0 on error.
- */
-static int relabel_analysis_object(const apol_policy_t * p,
-				   apol_relabel_analysis_t * r,
-				   apol_vector_t * v, unsigned int direction, const apol_vector_t * subjects_v)
-{
-	apol_avrule_query_t *a = NULL, *b = NULL;
-	apol_vector_t *a_rules = NULL, *b_rules = NULL;
-	char *perm1, *perm2;
-	size_t i;
-	int retval = -1;
-
-	if (direction == APOL_RELABEL_DIR_TO) {
-		perm1 = PERM_RELABELFROM;
-		perm2 = PERM_RELABELTO;
-	} else {
-		perm1 = PERM_RELABELTO;
-		perm2 = PERM_RELABELFROM;
-	}
-
-	if ((a = apol_avrule_query_create()) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
-	}
-	if (apol_avrule_query_set_rules(p, a, QPOL_RULE_ALLOW) < 0 ||
-	    apol_avrule_query_set_target(p, a, r->type, 1) < 0 || apol_avrule_query_append_perm(p, a, perm1) < 0) {
-		goto cleanup;
-	}
-	for (i = 0; r->classes != NULL && i < apol_vector_get_size(r->classes); i++) {
-		if (apol_avrule_query_append_class(p, a, apol_vector_get_element(r->classes, i)) < 0) {
-			goto cleanup;
-		}
-	}
-	if (apol_avrule_get_by_query(p, a, &a_rules) < 0) {
-		goto cleanup;
-	}
-
-	if ((b = apol_avrule_query_create()) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
-	}
-	if (apol_avrule_query_set_rules(p, b, QPOL_RULE_ALLOW) < 0 || apol_avrule_query_append_perm(p, b, perm2) < 0) {
-		goto cleanup;
-	}
-	for (i = 0; r->classes != NULL && i < apol_vector_get_size(r->classes); i++) {
-		if (apol_avrule_query_append_class(p, b, apol_vector_get_element(r->classes, i)) < 0) {
-			goto cleanup;
-		}
 	}
-	if (apol_avrule_get_by_query(p, b, &b_rules) < 0) {
-		goto cleanup;
-	}
-
-	if (relabel_analysis_matchup(p, r, a_rules, b_rules, subjects_v, v) < 0) {
-		goto cleanup;
-	}
-	retval = 0;
-      cleanup:
-	apol_avrule_query_destroy(&a);
-	apol_vector_destroy(&a_rules);
-	apol_avrule_query_destroy(&b);
-	apol_vector_destroy(&b_rules);
-	return retval;
+	return 0;
 }
 
 /**
- * Given an avrule, possbily append it to the subject results vector
+ * Given a relabelling rule, possibly append it to the subject results
  * onto the appropriate rules vector.  The decision to actually append
  * or not is dependent upon the filtering options stored within the
  * relabel analysis object.
  *
  * @param p Policy containing avrule.
  * @param r Relabel analysis query object, containing filtering options.
- * @param avrule AV rule to add.
- * @param result Results vector being built.
+ * @param table Relabel table containing the node.
+ * @param start_type Type being analyzed.
+ * @param node Rule to add.
+ * @param res Results being built.
  *
  * @return 0 on success, < 0 on error.
  */
-static int append_avrule_to_subject_vector(const apol_policy_t * p,
-					   apol_relabel_analysis_t * r, const qpol_avrule_t * avrule, apol_vector_t * results)
+static int append_avrule_to_subject_vector(const apol_policy_t * p, apol_relabel_analysis_t * r, const apol_relabel_table_t * table,
+					   const qpol_type_t * start_type, const relabel_node_t * node, relabel_results_t * res)
 {
 	const qpol_type_t *target;
-	apol_vector_t *target_v = NULL, *result_list = NULL;
+	const apol_vector_t *target_v = table->expansions[node->target_val];
+	apol_vector_t *result_list = NULL;
 	size_t i;
+	uint32_t val;
 	apol_relabel_result_t *result;
 	apol_relabel_result_pair_t *pair = NULL;
-	int retval = -1, dir, compval;
-	if ((dir = relabel_analysis_get_direction(p, avrule)) < 0) {
-		goto cleanup;
-	}
-	if (qpol_avrule_get_target_type(p->p, avrule, &target) < 0 || (target_v = apol_query_expand_type(p, target)) == NULL) {
-		goto cleanup;
-	}
+	int retval = -1, compval;
 	for (i = 0; i < apol_vector_get_size(target_v); i++) {
 		target = (qpol_type_t *) apol_vector_get_element(target_v, i);
-		compval = apol_compare_type(p, target, r->type, 0, NULL);
-		if (compval < 0) {
-			goto cleanup;
-		} else if (compval == 1) {
-			continue;      /* don't care about relabels to itself */
-		}
-		compval = apol_compare_type(p, target, r->result, APOL_QUERY_REGEX, &r->result_regex);
+		compval = relabel_analysis_check_result(p, r, res, start_type, target, &val);
 		if (compval < 0) {
 			goto cleanup;
 		} else if (compval == 0) {
 			continue;
 		}
-		if ((result = relabel_result_get_node(p, results, target)) == NULL) {
+		if ((result = relabel_result_get_node(p, res, target, val)) == NULL) {
 			goto cleanup;
 		}
 		if ((pair = calloc(1, sizeof(*pair))) == NULL) {
 			ERR(p, "%s", strerror(ENOMEM));
 			goto cleanup;
 		}
-		pair->ruleA = avrule;
+		pair->ruleA = node->rule;
 		pair->ruleB = NULL;
 		pair->intermed = NULL;
-		switch (dir) {
+		switch (node->dir) {
 		case APOL_RELABEL_DIR_TO:
 			result_list = result->to;
 			break;
@@ -572,71 +951,128 @@ static int append_avrule_to_subject_vector(const apol_policy_t * p,
 	}
 	retval = 0;
       cleanup:
-	apol_vector_destroy(&target_v);
 	free(pair);
 	return retval;
 }
 
 /**
- * Get a list of all allow rules, whose source type matches r->type
- * and whose permission list has either "relabelto" or "relabelfrom".
- * Only include rules whose class is a member of r->classes.  Add
- * instances of those to the result vector.
+ * Run a relabel analysis for a single starting type against a
+ * relabel table.
  *
- * @param p Policy to which look up rules.
- * @param r Structure containing parameters for subject relabel analysis.
- * @param v Target vector to which append discovered rules.
+ * @param p Policy containing the table.
+ * @param r Structure containing parameters for analysis.
+ * @param table Relabel table.
+ * @param start_type Type being analyzed.
+ * @param class_list If not NULL, vector of permitted qpol_class_t pointers.
+ * @param subjects If not NULL, bitmap of permitted subject type values.
+ * @param nodes Scratch bitmap sized to the number of table nodes.
+ * @param res Results being built.
  *
  * @return 0 on success, < 0 on error.
  */
-static int relabel_analysis_subject(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t * v)
+static int relabel_analysis_run(const apol_policy_t * p, apol_relabel_analysis_t * r, const apol_relabel_table_t * table,
+				const qpol_type_t * start_type, const apol_vector_t * class_list, const apol_bitmap_t * subjects,
+				apol_bitmap_t * nodes, relabel_results_t * res)
 {
-	apol_avrule_query_t *a = NULL;
-	apol_vector_t *avrules_v = NULL;
-	const qpol_avrule_t *avrule;
 	size_t i;
-	int retval = -1;
 
-	if ((a = apol_avrule_query_create()) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
+	apol_bitmap_clear_all(nodes);
+	if (r->mode == APOL_RELABEL_MODE_OBJ) {
+		if (relabel_analysis_find_nodes(p, table, start_type, 0, nodes) < 0) {
+			return -1;
+		}
+		if ((r->direction & APOL_RELABEL_DIR_TO) &&
+		    relabel_analysis_object(p, r, table, start_type, nodes, class_list, subjects, APOL_RELABEL_DIR_TO, res) < 0) {
+			return -1;
+		}
+		if ((r->direction & APOL_RELABEL_DIR_FROM) &&
+		    relabel_analysis_object(p, r, table, start_type, nodes, class_list, subjects, APOL_RELABEL_DIR_FROM, res) < 0) {
+			return -1;
+		}
+	} else {
+		if (relabel_analysis_find_nodes(p, table, start_type, 1, nodes) < 0) {
+			return -1;
+		}
+		for (i = apol_bitmap_next(nodes, 0); i < table->num_nodes; i = apol_bitmap_next(nodes, i + 1)) {
+			if (!relabel_analysis_class_matches(class_list, &table->nodes[i])) {
+				continue;
+			}
+			if (append_avrule_to_subject_vector(p, r, table, start_type, &table->nodes[i], res) < 0) {
+				return -1;
+			}
+		}
 	}
-	if (apol_avrule_query_set_rules(p, a, QPOL_RULE_ALLOW) < 0 ||
-	    apol_avrule_query_set_source(p, a, r->type, 1) < 0 ||
-	    apol_avrule_query_append_perm(p, a, PERM_RELABELTO) < 0 || apol_avrule_query_append_perm(p, a, PERM_RELABELFROM) < 0) {
-		goto cleanup;
+	return 0;
+}
+
+/**
+ * Look up everything an analysis needs beyond its starting type.
+ *
+ * @param p Policy to analyze.
+ * @param r Structure containing parameters for analysis.
+ * @param table Reference to the relabel table to use.
+ * @param tmp_table Reference to a temporary table to destroy afterwards.
+ * @param class_list Reference to the vector of permitted classes, or
+ * NULL if unrestricted.
+ * @param subjects Reference to the bitmap of permitted subjects, or
+ * NULL if unrestricted.
+ * @param nodes Reference to a scratch bitmap of table nodes.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_analysis_prepare(const apol_policy_t * p, apol_relabel_analysis_t * r, const apol_relabel_table_t ** table,
+				    apol_relabel_table_t ** tmp_table, apol_vector_t ** class_list, apol_bitmap_t ** subjects,
+				    apol_bitmap_t ** nodes)
+{
+	*class_list = NULL;
+	*subjects = NULL;
+	*nodes = NULL;
+	if ((*table = relabel_table_get(p, tmp_table)) == NULL) {
+		return -1;
 	}
-	for (i = 0; r->classes != NULL && i < apol_vector_get_size(r->classes); i++) {
-		if (apol_avrule_query_append_class(p, a, apol_vector_get_element(r->classes, i)) < 0) {
-			goto cleanup;
-		}
+	if (r->classes != NULL && apol_vector_get_size(r->classes) > 0 &&
+	    (*class_list = apol_query_create_candidate_class_list(p, r->classes)) == NULL) {
+		return -1;
 	}
-	if (apol_avrule_get_by_query(p, a, &avrules_v) < 0) {
-		goto cleanup;
+	if (r->mode == APOL_RELABEL_MODE_OBJ && relabel_analysis_get_subjects(p, *table, r, subjects) < 0) {
+		return -1;
 	}
-
-	for (i = 0; i < apol_vector_get_size(avrules_v); i++) {
-		avrule = (qpol_avrule_t *) apol_vector_get_element(avrules_v, i);
-		if (append_avrule_to_subject_vector(p, r, avrule, v) < 0) {
-			goto cleanup;
-		}
+	if ((*nodes = apol_bitmap_create((*table)->num_nodes)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
 	}
-
-	retval = 0;
-      cleanup:
-	apol_avrule_query_destroy(&a);
-	apol_vector_destroy(&avrules_v);
-	return retval;
+	return 0;
 }
 
 /******************** public functions below ********************/
 
+int apol_policy_build_relabel_table(apol_policy_t * policy)
+{
+	if (policy == NULL) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (policy->relabel_table != NULL) {
+		return 0;	       /* already built */
+	}
+	if ((policy->relabel_table = relabel_table_create(policy)) == NULL) {
+		return -1;
+	}
+	return 0;
+}
+
 int apol_relabel_analysis_do(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t ** v)
 {
-	apol_vector_t *subjects_v = NULL;
+	const apol_relabel_table_t *table = NULL;
+	apol_relabel_table_t *tmp_table = NULL;
+	apol_vector_t *class_list = NULL;
+	apol_bitmap_t *subjects = NULL, *nodes = NULL;
+	relabel_results_t res;
 	const qpol_type_t *start_type;
 	int retval = -1;
 	*v = NULL;
+	memset(&res, 0, sizeof(res));
 
 	if (r->mode == 0 || r->type == NULL) {
 		ERR(p, "%s", strerror(EINVAL));
@@ -645,32 +1081,95 @@ int apol_relabel_analysis_do(const apol_policy_t * p, apol_relabel_analysis_t *
 	if (apol_query_get_type(p, r->type, &start_type) < 0) {
 		goto cleanup;
 	}
-
-	if ((*v = apol_vector_create(relabel_result_free)) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
+	if (relabel_analysis_prepare(p, r, &table, &tmp_table, &class_list, &subjects, &nodes) < 0 ||
+	    relabel_results_init(p, table, &res) < 0) {
 		goto cleanup;
 	}
+	if (relabel_analysis_run(p, r, table, start_type, class_list, subjects, nodes, &res) < 0) {
+		goto cleanup;
+	}
+	*v = res.results;
+	res.results = NULL;
+	retval = 0;
+      cleanup:
+	relabel_results_fini(&res);
+	apol_bitmap_destroy(&nodes);
+	apol_bitmap_destroy(&subjects);
+	apol_vector_destroy(&class_list);
+	relabel_table_destroy(&tmp_table);
+	return retval;
+}
 
-	if (r->mode == APOL_RELABEL_MODE_OBJ) {
-		if (r->subjects != NULL && (subjects_v = relabel_analysis_get_type_vector(p, r->subjects)) == NULL) {
+int apol_relabel_analysis_do_all(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t ** v)
+{
+	const apol_relabel_table_t *table = NULL;
+	apol_relabel_table_t *tmp_table = NULL;
+	apol_vector_t *class_list = NULL;
+	apol_bitmap_t *subjects = NULL, *nodes = NULL;
+	apol_relabel_bulk_result_t *bulk = NULL;
+	qpol_iterator_t *iter = NULL;
+	relabel_results_t res;
+	int retval = -1;
+	*v = NULL;
+	memset(&res, 0, sizeof(res));
+
+	if (p == NULL || r == NULL || r->mode == 0) {
+		ERR(p, "%s", strerror(EINVAL));
+		goto cleanup;
+	}
+	if (relabel_analysis_prepare(p, r, &table, &tmp_table, &class_list, &subjects, &nodes) < 0 ||
+	    relabel_results_init(p, table, &res) < 0) {
+		goto cleanup;
+	}
+	if ((*v = apol_vector_create(relabel_bulk_result_free)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_type_t *type;
+		unsigned char isattr, isalias;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 ||
+		    qpol_type_get_isattr(p->p, type, &isattr) < 0 || qpol_type_get_isalias(p->p, type, &isalias) < 0) {
 			goto cleanup;
 		}
-		if ((r->direction & APOL_RELABEL_DIR_TO) && relabel_analysis_object(p, r, *v, APOL_RELABEL_DIR_TO, subjects_v) < 0) {
+		if (isattr || isalias) {
+			continue;
+		}
+		if (relabel_analysis_run(p, r, table, type, class_list, subjects, nodes, &res) < 0) {
 			goto cleanup;
 		}
-		if ((r->direction & APOL_RELABEL_DIR_FROM) &&
-		    relabel_analysis_object(p, r, *v, APOL_RELABEL_DIR_FROM, subjects_v) < 0) {
+		if (apol_vector_get_size(res.results) == 0) {
+			continue;
+		}
+		if ((bulk = calloc(1, sizeof(*bulk))) == NULL) {
+			ERR(p, "%s", strerror(errno));
 			goto cleanup;
 		}
-	} else {
-		if (relabel_analysis_subject(p, r, *v) < 0) {
+		bulk->type = type;
+		bulk->results = res.results;
+		res.results = NULL;
+		if (apol_vector_append(*v, bulk) < 0) {
+			ERR(p, "%s", strerror(errno));
 			goto cleanup;
 		}
+		if (relabel_results_clear(p, &res, bulk->results) < 0) {
+			bulk = NULL;
+			goto cleanup;
+		}
+		bulk = NULL;
 	}
-
 	retval = 0;
       cleanup:
-	apol_vector_destroy(&subjects_v);
+	qpol_iterator_destroy(&iter);
+	relabel_bulk_result_free(bulk);
+	relabel_results_fini(&res);
+	apol_bitmap_destroy(&nodes);
+	apol_bitmap_destroy(&subjects);
+	apol_vector_destroy(&class_list);
+	relabel_table_destroy(&tmp_table);
 	if (retval != 0) {
 		apol_vector_destroy(v);
 	}
@@ -811,3 +1310,15 @@ const qpol_type_t *apol_relabel_result_pair_get_intermediate_type(const apol_rel
 {
 	return p->intermed;
 }
+
+/******************** functions to access bulk relabel results ********************/
+
+const qpol_type_t *apol_relabel_bulk_result_get_start_type(const apol_relabel_bulk_result_t * r)
+{
+	return r->type;
+}
+
+const apol_vector_t *apol_relabel_bulk_result_get_results(const apol_relabel_bulk_result_t * r)
+{
+	return r->results;
+}
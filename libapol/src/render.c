@@ -24,13 +24,14 @@
  *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
-#include <config.h>
+#include "policy-query-internal.h"
 
 #include <apol/context-query.h>
 #include <apol/policy.h>
 #include <apol/render.h>
 
 #include <errno.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -156,3 +157,242 @@ char *apol_qpol_context_render(const apol_policy_t * p, const qpol_context_t * c
 	apol_context_destroy(&c);
 	return rendered_context;
 }
+
+int apol_qpol_context_render_buf(const apol_policy_t * p, const qpol_context_t * context, apol_render_buf_t * buf)
+{
+	const qpol_user_t *user;
+	const qpol_role_t *role;
+	const qpol_type_t *type;
+	const qpol_mls_range_t *range;
+	const char *user_name, *role_name, *type_name;
+	apol_mls_range_t *apol_range = NULL;
+	char *range_str = NULL;
+	size_t mark;
+	int retval = -1;
+
+	if (p == NULL || context == NULL || buf == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	mark = apol_render_buf_get_length(buf);
+	if (qpol_context_get_user(p->p, context, &user) < 0 ||
+	    qpol_context_get_role(p->p, context, &role) < 0 ||
+	    qpol_context_get_type(p->p, context, &type) < 0 || qpol_context_get_range(p->p, context, &range) < 0) {
+		goto cleanup;
+	}
+	if (qpol_user_get_name(p->p, user, &user_name) < 0 ||
+	    qpol_role_get_name(p->p, role, &role_name) < 0 || qpol_type_get_name(p->p, type, &type_name) < 0) {
+		goto cleanup;
+	}
+	if (apol_render_buf_appendf(buf, "%s:%s:%s", user_name, role_name, type_name) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (apol_policy_is_mls(p)) {
+		if ((apol_range = apol_mls_range_create_from_qpol_mls_range(p, range)) == NULL ||
+		    (range_str = apol_mls_range_render(p, apol_range)) == NULL) {
+			goto cleanup;
+		}
+		if (apol_render_buf_appendf(buf, ":%s", range_str) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+	}
+	retval = 0;
+      cleanup:
+	if (retval != 0)
+		render_buf_rollback(buf, mark);
+	apol_mls_range_destroy(&apol_range);
+	free(range_str);
+	return retval;
+}
+
+/******************** render buffers ********************/
+
+/* once a file-backed buffer holds this much text, write it out */
+#define APOL_RENDER_BUF_FLUSH_SIZE 8192
+
+struct apol_render_buf
+{
+	char *str;
+	/** length of str, not counting the terminating NUL */
+	size_t len;
+	/** number of bytes allocated to str */
+	size_t size;
+	/** file to which to write, or NULL to only accumulate */
+	FILE *fp;
+};
+
+apol_render_buf_t *apol_render_buf_create(void)
+{
+	apol_render_buf_t *buf;
+	if ((buf = calloc(1, sizeof(*buf))) == NULL) {
+		return NULL;
+	}
+	buf->size = 128;
+	if ((buf->str = malloc(buf->size)) == NULL) {
+		free(buf);
+		return NULL;
+	}
+	buf->str[0] = '\0';
+	return buf;
+}
+
+apol_render_buf_t *apol_render_buf_create_file(FILE * fp)
+{
+	apol_render_buf_t *buf;
+	if (fp == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((buf = apol_render_buf_create()) == NULL) {
+		return NULL;
+	}
+	buf->fp = fp;
+	return buf;
+}
+
+void apol_render_buf_destroy(apol_render_buf_t ** buf)
+{
+	if (buf != NULL && *buf != NULL) {
+		apol_render_buf_flush(*buf);
+		free((*buf)->str);
+		free(*buf);
+		*buf = NULL;
+	}
+}
+
+void apol_render_buf_clear(apol_render_buf_t * buf)
+{
+	render_buf_rollback(buf, 0);
+}
+
+const char *apol_render_buf_get_string(const apol_render_buf_t * buf)
+{
+	if (buf == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return buf->str;
+}
+
+size_t apol_render_buf_get_length(const apol_render_buf_t * buf)
+{
+	return (buf != NULL ? buf->len : 0);
+}
+
+/**
+ * Ensure that a buffer has room for another len bytes of text.
+ */
+static int apol_render_buf_reserve(apol_render_buf_t * buf, size_t len)
+{
+	size_t size = buf->size;
+	char *s;
+	if (buf->len + len < size) {
+		return 0;
+	}
+	while (buf->len + len >= size)
+		size *= 2;
+	if ((s = realloc(buf->str, size)) == NULL) {
+		return -1;
+	}
+	buf->str = s;
+	buf->size = size;
+	return 0;
+}
+
+int apol_render_buf_append(apol_render_buf_t * buf, const char *str)
+{
+	size_t len;
+	if (buf == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (str == NULL || (len = strlen(str)) == 0) {
+		return 0;
+	}
+	if (apol_render_buf_reserve(buf, len) < 0) {
+		return -1;
+	}
+	memcpy(buf->str + buf->len, str, len + 1);
+	buf->len += len;
+	return 0;
+}
+
+int apol_render_buf_appendf(apol_render_buf_t * buf, const char *fmt, ...)
+{
+	va_list ap;
+	int len;
+	if (buf == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (fmt == NULL || fmt[0] == '\0') {
+		return 0;
+	}
+	va_start(ap, fmt);
+	len = vsnprintf(buf->str + buf->len, buf->size - buf->len, fmt, ap);
+	va_end(ap);
+	if (len < 0) {
+		buf->str[buf->len] = '\0';
+		return -1;
+	}
+	if ((size_t) len >= buf->size - buf->len) {
+		/* did not fit; grow the buffer and try again */
+		if (apol_render_buf_reserve(buf, (size_t) len) < 0) {
+			buf->str[buf->len] = '\0';
+			return -1;
+		}
+		va_start(ap, fmt);
+		vsnprintf(buf->str + buf->len, buf->size - buf->len, fmt, ap);
+		va_end(ap);
+	}
+	buf->len += (size_t) len;
+	return 0;
+}
+
+int apol_render_buf_flush(apol_render_buf_t * buf)
+{
+	if (buf == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (buf->fp == NULL || buf->len == 0) {
+		return 0;
+	}
+	if (fwrite(buf->str, 1, buf->len, buf->fp) != buf->len) {
+		return -1;
+	}
+	apol_render_buf_clear(buf);
+	return 0;
+}
+
+void render_buf_rollback(apol_render_buf_t * buf, size_t len)
+{
+	if (buf != NULL && len < buf->len) {
+		buf->len = len;
+		buf->str[len] = '\0';
+	}
+}
+
+int render_buf_commit(const apol_policy_t * p, apol_render_buf_t * buf)
+{
+	if (buf->fp != NULL && buf->len >= APOL_RENDER_BUF_FLUSH_SIZE && apol_render_buf_flush(buf) < 0) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+char *render_buf_release(apol_render_buf_t ** buf)
+{
+	char *str;
+	if (buf == NULL || *buf == NULL) {
+		return NULL;
+	}
+	str = (*buf)->str;
+	free(*buf);
+	*buf = NULL;
+	return str;
+}
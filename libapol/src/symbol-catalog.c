@@ -0,0 +1,811 @@
+/**
+ * @file
+ *
+ * Implementation of the per-policy symbol catalog, which maps symbol
+ * values to names and objects, and names (including aliases) back to
+ * values, without going through the policy's symbol tables.
+ *
+ * Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "policy-query-internal.h"
+#include "bitmap-internal.h"
+
+#include <errno.h>
+#include <regex.h>
+#include <string.h>
+
+/** number of regular expression matches remembered per policy */
+#define APOL_SYMBOL_REGEX_CACHE_SIZE 16
+
+/* the symbols of one kind */
+typedef struct apol_symbol_table
+{
+	/** one more than the highest value; index 0 is unused */
+	size_t num_values;
+	/** primary name and object of each value, NULL if unused */
+	const char **names;
+	const void **objects;
+	/** the aliases of value v are aliases[alias_start[v]] through
+	 *  aliases[alias_start[v + 1] - 1] */
+	size_t *alias_start;
+	const char **aliases;
+	/** every name, primary or alias, with the value it denotes */
+	const char **entry_names;
+	uint32_t *entry_values;
+	size_t num_entries;
+	/** open addressed index into the entries; a slot holds an entry
+	 *  index plus one, or 0 if empty */
+	size_t *slots;
+	size_t slot_mask;
+} apol_symbol_table_t;
+
+/* the symbols of one kind that match a regular expression */
+typedef struct apol_symbol_regex_entry
+{
+	apol_symbol_kind_e kind;
+	char *regex;
+	/** bit v is set if value v's name or an alias matches */
+	apol_bitmap_t *matches;
+	/** catalog's clock when this entry was last used, or 0 if the
+	 *  entry is empty; an emptied entry keeps its expression and
+	 *  bitmap until it is reused */
+	unsigned long last_use;
+} apol_symbol_regex_entry_t;
+
+/* each type's members and attributes, as rows of one block of words */
+typedef struct apol_symbol_type_matrix
+{
+	apol_bitmap_t *members;
+	apol_bitmap_t *attrs;
+	apol_bitmap_word_t *words;
+	/** next older matrix, once this one is retired */
+	struct apol_symbol_type_matrix *next;
+} apol_symbol_type_matrix_t;
+
+struct apol_symbol_catalog
+{
+	apol_symbol_table_t tables[APOL_SYMBOL_NUM_KINDS];
+	/** for each class value, its permission names indexed by
+	 *  permission value less one, and the highest permission
+	 *  value */
+	const char *(*perms)[32];
+	size_t *num_perms;
+	/** recently matched regular expressions, least recently used
+	 *  evicted first */
+	apol_symbol_regex_entry_t regex_cache[APOL_SYMBOL_REGEX_CACHE_SIZE];
+	unsigned long clock;
+	/** for each type value, the types that it expands to and the
+	 *  attributes that it has; built upon first use */
+	apol_symbol_type_matrix_t *type_matrix;
+	/** matrices built before the policy was rebuilt; their rows
+	 *  were handed out to callers, so they are kept until the
+	 *  catalog is destroyed */
+	apol_symbol_type_matrix_t *retired;
+	/** qpol generation of the policy when this catalog was built;
+	 *  a rebuilt policy frees every name and object held above */
+	unsigned long generation;
+};
+
+static uint32_t apol_symbol_hash(const char *s)
+{
+	/* FNV-1a */
+	uint32_t h = 2166136261U;
+	for (; *s != '\0'; s++) {
+		h ^= (unsigned char)*s;
+		h *= 16777619U;
+	}
+	return h;
+}
+
+static void apol_symbol_table_free(apol_symbol_table_t * t)
+{
+	free(t->names);
+	free(t->objects);
+	free(t->alias_start);
+	free(t->aliases);
+	free(t->entry_names);
+	free(t->entry_values);
+	free(t->slots);
+}
+
+/**
+ * Index every name of a table, once its primary names and aliases
+ * are known.
+ */
+static int apol_symbol_table_index(apol_symbol_table_t * t)
+{
+	size_t num_slots = 16, v, i;
+	t->num_entries = 0;
+	for (v = 1; v < t->num_values; v++) {
+		if (t->names[v] != NULL)
+			t->num_entries++;
+	}
+	t->num_entries += t->alias_start[t->num_values];
+	if ((t->entry_names = calloc(t->num_entries + 1, sizeof(char *))) == NULL ||
+	    (t->entry_values = calloc(t->num_entries + 1, sizeof(uint32_t))) == NULL) {
+		return -1;
+	}
+	t->num_entries = 0;
+	for (v = 1; v < t->num_values; v++) {
+		if (t->names[v] == NULL)
+			continue;
+		t->entry_names[t->num_entries] = t->names[v];
+		t->entry_values[t->num_entries++] = (uint32_t) v;
+		for (i = t->alias_start[v]; i < t->alias_start[v + 1]; i++) {
+			t->entry_names[t->num_entries] = t->aliases[i];
+			t->entry_values[t->num_entries++] = (uint32_t) v;
+		}
+	}
+
+	/* keep the table at most half full, so that probe sequences
+	 * stay short */
+	while (num_slots < 2 * t->num_entries)
+		num_slots *= 2;
+	if ((t->slots = calloc(num_slots, sizeof(size_t))) == NULL) {
+		return -1;
+	}
+	t->slot_mask = num_slots - 1;
+	for (i = 0; i < t->num_entries; i++) {
+		size_t slot = apol_symbol_hash(t->entry_names[i]) & t->slot_mask;
+		while (t->slots[slot] != 0)
+			slot = (slot + 1) & t->slot_mask;
+		t->slots[slot] = i + 1;
+	}
+	return 0;
+}
+
+/**
+ * Allocate a table for values 1 through max_value.
+ */
+static int apol_symbol_table_alloc(apol_symbol_table_t * t, uint32_t max_value)
+{
+	t->num_values = (size_t) max_value + 1;
+	if ((t->names = calloc(t->num_values, sizeof(char *))) == NULL ||
+	    (t->objects = calloc(t->num_values, sizeof(void *))) == NULL ||
+	    (t->alias_start = calloc(t->num_values + 1, sizeof(size_t))) == NULL) {
+		return -1;
+	}
+	return 0;
+}
+
+static int apol_symbol_catalog_add_types(const apol_policy_t * p, apol_symbol_table_t * t)
+{
+	qpol_iterator_t *iter = NULL, *alias_iter = NULL;
+	const qpol_type_t *type;
+	const char *name;
+	uint32_t value, max_value = 0;
+	unsigned char isalias;
+	size_t num_aliases = 0, num, v;
+	int retval = -1;
+
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &value) < 0) {
+			goto cleanup;
+		}
+		if (value > max_value)
+			max_value = value;
+	}
+	qpol_iterator_destroy(&iter);
+	if (apol_symbol_table_alloc(t, max_value) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+
+	/* record primaries, and count each one's aliases */
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &value) < 0 ||
+		    qpol_type_get_isalias(p->p, type, &isalias) < 0) {
+			goto cleanup;
+		}
+		if (isalias || t->names[value] != NULL) {
+			continue;
+		}
+		if (qpol_type_get_name(p->p, type, &name) < 0 || qpol_type_get_alias_iter(p->p, type, &alias_iter) < 0 ||
+		    qpol_iterator_get_size(alias_iter, &num) < 0) {
+			goto cleanup;
+		}
+		qpol_iterator_destroy(&alias_iter);
+		t->names[value] = name;
+		t->objects[value] = type;
+		t->alias_start[value + 1] = num;
+		num_aliases += num;
+	}
+	qpol_iterator_destroy(&iter);
+
+	for (v = 1; v <= t->num_values; v++)
+		t->alias_start[v] += t->alias_start[v - 1];
+	if ((t->aliases = calloc(num_aliases + 1, sizeof(char *))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (v = 1; v < t->num_values; v++) {
+		size_t i = t->alias_start[v];
+		if (t->objects[v] == NULL)
+			continue;
+		if (qpol_type_get_alias_iter(p->p, t->objects[v], &alias_iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(alias_iter) && i < t->alias_start[v + 1]; qpol_iterator_next(alias_iter)) {
+			if (qpol_iterator_get_item(alias_iter, (void **)&t->aliases[i++]) < 0) {
+				goto cleanup;
+			}
+		}
+		qpol_iterator_destroy(&alias_iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&alias_iter);
+	return retval;
+}
+
+static int apol_symbol_get_iter(const apol_policy_t * p, apol_symbol_kind_e kind, qpol_iterator_t ** iter)
+{
+	switch (kind) {
+	case APOL_SYMBOL_ROLE:
+		return qpol_policy_get_role_iter(p->p, iter);
+	case APOL_SYMBOL_USER:
+		return qpol_policy_get_user_iter(p->p, iter);
+	case APOL_SYMBOL_CLASS:
+		return qpol_policy_get_class_iter(p->p, iter);
+	case APOL_SYMBOL_BOOL:
+		return qpol_policy_get_bool_iter(p->p, iter);
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+static int apol_symbol_get_value(const apol_policy_t * p, apol_symbol_kind_e kind, const void *obj, uint32_t * value)
+{
+	switch (kind) {
+	case APOL_SYMBOL_ROLE:
+		return qpol_role_get_value(p->p, obj, value);
+	case APOL_SYMBOL_USER:
+		return qpol_user_get_value(p->p, obj, value);
+	case APOL_SYMBOL_CLASS:
+		return qpol_class_get_value(p->p, obj, value);
+	case APOL_SYMBOL_BOOL:
+		return qpol_bool_get_value(p->p, obj, value);
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+static int apol_symbol_get_name(const apol_policy_t * p, apol_symbol_kind_e kind, const void *obj, const char **name)
+{
+	switch (kind) {
+	case APOL_SYMBOL_ROLE:
+		return qpol_role_get_name(p->p, obj, name);
+	case APOL_SYMBOL_USER:
+		return qpol_user_get_name(p->p, obj, name);
+	case APOL_SYMBOL_CLASS:
+		return qpol_class_get_name(p->p, obj, name);
+	case APOL_SYMBOL_BOOL:
+		return qpol_bool_get_name(p->p, obj, name);
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+/**
+ * Record every symbol of a kind that has no aliases.
+ */
+static int apol_symbol_catalog_add_plain(const apol_policy_t * p, apol_symbol_catalog_t * c, apol_symbol_kind_e kind)
+{
+	apol_symbol_table_t *t = c->tables + kind;
+	qpol_iterator_t *iter = NULL;
+	const void *obj;
+	uint32_t value, max_value = 0;
+	int retval = -1;
+
+	if (apol_symbol_get_iter(p, kind, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&obj) < 0 || apol_symbol_get_value(p, kind, obj, &value) < 0) {
+			goto cleanup;
+		}
+		if (value > max_value)
+			max_value = value;
+	}
+	qpol_iterator_destroy(&iter);
+	if (apol_symbol_table_alloc(t, max_value) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (apol_symbol_get_iter(p, kind, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&obj) < 0 || apol_symbol_get_value(p, kind, obj, &value) < 0 ||
+		    apol_symbol_get_name(p, kind, obj, &t->names[value]) < 0) {
+			goto cleanup;
+		}
+		t->objects[value] = obj;
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+/**
+ * Record the value of each permission from an iterator of permission
+ * names into one class's table.
+ */
+static int apol_symbol_catalog_add_perms(const apol_policy_t * p, apol_symbol_catalog_t * c, const qpol_class_t * obj_class,
+					 uint32_t class_value, qpol_iterator_t * iter)
+{
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const char *perm;
+		uint32_t perm_value;
+		if (qpol_iterator_get_item(iter, (void **)&perm) < 0 ||
+		    qpol_class_get_perm_value(p->p, obj_class, perm, &perm_value) < 0) {
+			return -1;
+		}
+		if (perm_value == 0 || perm_value > 32) {
+			continue;
+		}
+		c->perms[class_value][perm_value - 1] = perm;
+		if (perm_value > c->num_perms[class_value])
+			c->num_perms[class_value] = perm_value;
+	}
+	return 0;
+}
+
+static int apol_symbol_catalog_add_class_perms(const apol_policy_t * p, apol_symbol_catalog_t * c)
+{
+	const apol_symbol_table_t *t = c->tables + APOL_SYMBOL_CLASS;
+	qpol_iterator_t *iter = NULL;
+	const qpol_common_t *common;
+	size_t v;
+	int retval = -1;
+
+	if ((c->perms = calloc(t->num_values, sizeof(*c->perms))) == NULL ||
+	    (c->num_perms = calloc(t->num_values, sizeof(size_t))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (v = 1; v < t->num_values; v++) {
+		const qpol_class_t *obj_class = t->objects[v];
+		if (obj_class == NULL)
+			continue;
+		if (qpol_class_get_common(p->p, obj_class, &common) < 0) {
+			goto cleanup;
+		}
+		if (common != NULL) {
+			if (qpol_common_get_perm_iter(p->p, common, &iter) < 0 ||
+			    apol_symbol_catalog_add_perms(p, c, obj_class, (uint32_t) v, iter) < 0) {
+				goto cleanup;
+			}
+			qpol_iterator_destroy(&iter);
+		}
+		if (qpol_class_get_perm_iter(p->p, obj_class, &iter) < 0 ||
+		    apol_symbol_catalog_add_perms(p, c, obj_class, (uint32_t) v, iter) < 0) {
+			goto cleanup;
+		}
+		qpol_iterator_destroy(&iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+static void apol_symbol_type_matrix_free(apol_symbol_type_matrix_t * m)
+{
+	if (m == NULL)
+		return;
+	free(m->members);
+	free(m->attrs);
+	free(m->words);
+	free(m);
+}
+
+/**
+ * Empty a catalog of everything that refers to the policy's names and
+ * objects.  Bitmaps already returned to callers stay valid: the type
+ * matrix is retired rather than freed, and the remembered regular
+ * expression matches are only marked unused, to be freed when
+ * apol_symbol_catalog_match_regex() reuses their entries.
+ */
+static void apol_symbol_catalog_clear(apol_symbol_catalog_t * c)
+{
+	int kind;
+	size_t i;
+	for (kind = 0; kind < APOL_SYMBOL_NUM_KINDS; kind++)
+		apol_symbol_table_free(c->tables + kind);
+	memset(c->tables, 0, sizeof(c->tables));
+	for (i = 0; i < APOL_SYMBOL_REGEX_CACHE_SIZE; i++)
+		c->regex_cache[i].last_use = 0;
+	free(c->perms);
+	free(c->num_perms);
+	c->perms = NULL;
+	c->num_perms = NULL;
+	if (c->type_matrix != NULL) {
+		c->type_matrix->next = c->retired;
+		c->retired = c->type_matrix;
+		c->type_matrix = NULL;
+	}
+	c->generation = 0;
+}
+
+/**
+ * Fill an empty catalog from the policy's current contents.  Upon
+ * error the catalog is left empty.
+ */
+static int apol_symbol_catalog_fill(const apol_policy_t * p, apol_symbol_catalog_t * c)
+{
+	unsigned long generation;
+	int kind, error;
+
+	if (qpol_policy_get_generation(p->p, &generation) < 0 ||
+	    apol_symbol_catalog_add_types(p, c->tables + APOL_SYMBOL_TYPE) < 0 ||
+	    apol_symbol_catalog_add_plain(p, c, APOL_SYMBOL_ROLE) < 0 ||
+	    apol_symbol_catalog_add_plain(p, c, APOL_SYMBOL_USER) < 0 ||
+	    apol_symbol_catalog_add_plain(p, c, APOL_SYMBOL_CLASS) < 0 ||
+	    apol_symbol_catalog_add_plain(p, c, APOL_SYMBOL_BOOL) < 0 || apol_symbol_catalog_add_class_perms(p, c) < 0) {
+		goto err;
+	}
+	for (kind = 0; kind < APOL_SYMBOL_NUM_KINDS; kind++) {
+		if (apol_symbol_table_index(c->tables + kind) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto err;
+		}
+	}
+	c->generation = generation;
+	return 0;
+
+      err:
+	error = errno;
+	apol_symbol_catalog_clear(c);
+	errno = error;
+	return -1;
+}
+
+apol_symbol_catalog_t *apol_symbol_catalog_create(const apol_policy_t * p)
+{
+	apol_symbol_catalog_t *c = NULL;
+	int error;
+
+	if ((c = calloc(1, sizeof(*c))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_symbol_catalog_fill(p, c) < 0) {
+		error = errno;
+		free(c);
+		errno = error;
+		return NULL;
+	}
+	return c;
+}
+
+void symbol_catalog_destroy(apol_symbol_catalog_t ** c)
+{
+	apol_symbol_type_matrix_t *m;
+	size_t i;
+	if (c == NULL || *c == NULL)
+		return;
+	apol_symbol_catalog_clear(*c);
+	for (i = 0; i < APOL_SYMBOL_REGEX_CACHE_SIZE; i++) {
+		free((*c)->regex_cache[i].regex);
+		apol_bitmap_destroy(&(*c)->regex_cache[i].matches);
+	}
+	while ((m = (*c)->retired) != NULL) {
+		(*c)->retired = m->next;
+		apol_symbol_type_matrix_free(m);
+	}
+	free(*c);
+	*c = NULL;
+}
+
+apol_symbol_catalog_t *apol_policy_get_catalog(const apol_policy_t * p)
+{
+	apol_symbol_catalog_t *c;
+	unsigned long generation;
+	if (p == NULL || p->catalog == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	c = p->catalog;
+	if (qpol_policy_get_generation(p->p, &generation) < 0) {
+		return NULL;
+	}
+	/* an empty catalog (from a failed refill) has no tables */
+	if (generation != c->generation || c->tables[APOL_SYMBOL_TYPE].slots == NULL) {
+		apol_symbol_catalog_clear(c);
+		if (apol_symbol_catalog_fill(p, c) < 0) {
+			return NULL;
+		}
+	}
+	return c;
+}
+
+int apol_symbol_catalog_lookup(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, const char *name, uint32_t * value)
+{
+	const apol_symbol_table_t *t;
+	size_t slot;
+	if (c == NULL || kind < 0 || kind >= APOL_SYMBOL_NUM_KINDS || name == NULL || value == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	t = c->tables + kind;
+	slot = apol_symbol_hash(name) & t->slot_mask;
+	for (; t->slots[slot] != 0; slot = (slot + 1) & t->slot_mask) {
+		size_t i = t->slots[slot] - 1;
+		if (strcmp(t->entry_names[i], name) == 0) {
+			*value = t->entry_values[i];
+			return 0;
+		}
+	}
+	errno = ENOENT;
+	return -1;
+}
+
+/**
+ * Find every value of a kind whose name or alias matches a compiled
+ * regular expression.
+ */
+static apol_bitmap_t *apol_symbol_table_match(const apol_symbol_table_t * t, const regex_t * regex)
+{
+	apol_bitmap_t *matches;
+	size_t v, i;
+	if ((matches = apol_bitmap_create(t->num_values)) == NULL) {
+		return NULL;
+	}
+	for (v = 1; v < t->num_values; v++) {
+		if (t->names[v] == NULL)
+			continue;
+		if (regexec(regex, t->names[v], 0, NULL, 0) == 0) {
+			apol_bitmap_set(matches, v);
+			continue;
+		}
+		for (i = t->alias_start[v]; i < t->alias_start[v + 1]; i++) {
+			if (regexec(regex, t->aliases[i], 0, NULL, 0) == 0) {
+				apol_bitmap_set(matches, v);
+				break;
+			}
+		}
+	}
+	return matches;
+}
+
+int apol_symbol_catalog_match_regex(const apol_policy_t * p, apol_symbol_kind_e kind, const char *regex,
+				    const apol_bitmap_t ** matches)
+{
+	apol_symbol_catalog_t *c;
+	apol_symbol_regex_entry_t *e, *victim;
+	regex_t compiled;
+	char errbuf[1024] = { '\0' };
+	char *s = NULL;
+	apol_bitmap_t *b = NULL;
+	int regretv;
+	size_t i;
+
+	if (matches != NULL)
+		*matches = NULL;
+	if (p == NULL || kind < 0 || kind >= APOL_SYMBOL_NUM_KINDS || regex == NULL || matches == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((c = apol_policy_get_catalog(p)) == NULL) {
+		return -1;
+	}
+	victim = c->regex_cache;
+	for (i = 0; i < APOL_SYMBOL_REGEX_CACHE_SIZE; i++) {
+		e = c->regex_cache + i;
+		if (e->last_use != 0 && e->kind == kind && strcmp(e->regex, regex) == 0) {
+			e->last_use = ++c->clock;
+			*matches = e->matches;
+			return 0;
+		}
+		if (e->last_use < victim->last_use)
+			victim = e;
+	}
+
+	if ((regretv = regcomp(&compiled, regex, REG_EXTENDED | REG_NOSUB)) != 0) {
+		regerror(regretv, &compiled, errbuf, sizeof(errbuf));
+		ERR(p, "%s", errbuf);
+		errno = EINVAL;
+		return -1;
+	}
+	b = apol_symbol_table_match(c->tables + kind, &compiled);
+	regfree(&compiled);
+	if (b == NULL || (s = strdup(regex)) == NULL) {
+		int error = errno;
+		apol_bitmap_destroy(&b);
+		ERR(p, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	free(victim->regex);
+	apol_bitmap_destroy(&victim->matches);
+	victim->kind = kind;
+	victim->regex = s;
+	victim->matches = b;
+	victim->last_use = ++c->clock;
+	*matches = b;
+	return 0;
+}
+
+/**
+ * Build the matrices of each type's members and attributes, by
+ * walking each attribute's types once.
+ */
+static int apol_symbol_catalog_build_type_matrix(const apol_policy_t * p, apol_symbol_catalog_t * c)
+{
+	const apol_symbol_table_t *t = c->tables + APOL_SYMBOL_TYPE;
+	size_t row_words = APOL_BITMAP_WORDS(t->num_values), v;
+	qpol_iterator_t *iter = NULL;
+	const qpol_type_t *type;
+	unsigned char isattr;
+	uint32_t member;
+	apol_symbol_type_matrix_t *m = NULL;
+	int retval = -1, error = 0;
+
+	if ((m = calloc(1, sizeof(*m))) == NULL ||
+	    (m->words = calloc(2 * t->num_values * row_words + 1, sizeof(apol_bitmap_word_t))) == NULL ||
+	    (m->members = calloc(t->num_values, sizeof(apol_bitmap_t))) == NULL ||
+	    (m->attrs = calloc(t->num_values, sizeof(apol_bitmap_t))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (v = 0; v < t->num_values; v++) {
+		m->members[v].size = m->attrs[v].size = t->num_values;
+		m->members[v].num_words = m->attrs[v].num_words = row_words;
+		m->members[v].words = m->words + v * row_words;
+		m->attrs[v].words = m->words + (t->num_values + v) * row_words;
+	}
+	for (v = 1; v < t->num_values; v++) {
+		if (t->objects[v] == NULL)
+			continue;
+		if (qpol_type_get_isattr(p->p, t->objects[v], &isattr) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		if (!isattr) {
+			APOL_BITMAP_SET(m->members[v].words, v);
+			continue;
+		}
+		if (qpol_type_get_type_iter(p->p, t->objects[v], &iter) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &member) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+			if (member >= t->num_values)
+				continue;
+			APOL_BITMAP_SET(m->members[v].words, member);
+			APOL_BITMAP_SET(m->attrs[member].words, v);
+		}
+		qpol_iterator_destroy(&iter);
+	}
+	c->type_matrix = m;
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	if (retval < 0) {
+		apol_symbol_type_matrix_free(m);
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Get one row of a type matrix, building the matrices if needed.
+ */
+static const apol_bitmap_t *apol_symbol_catalog_get_type_row(const apol_policy_t * p, uint32_t value, int want_attrs)
+{
+	apol_symbol_catalog_t *c;
+	if ((c = apol_policy_get_catalog(p)) == NULL) {
+		return NULL;
+	}
+	if (value == 0 || value >= c->tables[APOL_SYMBOL_TYPE].num_values) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if (c->type_matrix == NULL && apol_symbol_catalog_build_type_matrix(p, c) < 0) {
+		return NULL;
+	}
+	return (want_attrs ? c->type_matrix->attrs : c->type_matrix->members) + value;
+}
+
+const apol_bitmap_t *apol_symbol_catalog_get_type_members(const apol_policy_t * p, uint32_t value)
+{
+	return apol_symbol_catalog_get_type_row(p, value, 0);
+}
+
+const apol_bitmap_t *apol_symbol_catalog_get_type_attrs(const apol_policy_t * p, uint32_t value)
+{
+	return apol_symbol_catalog_get_type_row(p, value, 1);
+}
+
+size_t apol_symbol_catalog_get_num_values(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind)
+{
+	if (c == NULL || kind < 0 || kind >= APOL_SYMBOL_NUM_KINDS) {
+		return 0;
+	}
+	return c->tables[kind].num_values;
+}
+
+const char *apol_symbol_catalog_get_name(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, uint32_t value)
+{
+	if (c == NULL || kind < 0 || kind >= APOL_SYMBOL_NUM_KINDS || value >= c->tables[kind].num_values) {
+		return NULL;
+	}
+	return c->tables[kind].names[value];
+}
+
+const void *apol_symbol_catalog_get_object(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, uint32_t value)
+{
+	if (c == NULL || kind < 0 || kind >= APOL_SYMBOL_NUM_KINDS || value >= c->tables[kind].num_values) {
+		return NULL;
+	}
+	return c->tables[kind].objects[value];
+}
+
+const char *const *apol_symbol_catalog_get_aliases(const apol_symbol_catalog_t * c, apol_symbol_kind_e kind, uint32_t value,
+						   size_t * num_aliases)
+{
+	const apol_symbol_table_t *t;
+	*num_aliases = 0;
+	if (c == NULL || kind < 0 || kind >= APOL_SYMBOL_NUM_KINDS || value >= c->tables[kind].num_values) {
+		return NULL;
+	}
+	t = c->tables + kind;
+	*num_aliases = t->alias_start[value + 1] - t->alias_start[value];
+	return t->aliases + t->alias_start[value];
+}
+
+int apol_policy_get_perm_names(const apol_policy_t * p, uint32_t class_value, const char *const **names, size_t * num_names)
+{
+	const apol_symbol_catalog_t *c;
+	if (p == NULL || names == NULL || num_names == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((c = apol_policy_get_catalog(p)) == NULL) {
+		return -1;
+	}
+	if (class_value >= c->tables[APOL_SYMBOL_CLASS].num_values) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	*names = c->perms[class_value];
+	*num_names = c->num_perms[class_value];
+	return 0;
+}
@@ -651,38 +651,38 @@ apol_vector_t *apol_terule_list_to_syn_terules(const apol_policy_t * p, const ap
 	return v;
 }
 
-char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rule)
+int apol_terule_render_buf(const apol_policy_t * policy, const qpol_terule_t * rule, apol_render_buf_t * buf)
 {
-	char *tmp = NULL;
 	const char *tmp_name = NULL;
 	const char *rule_type_str;
 	int error = 0;
-	size_t tmp_sz = 0;
+	size_t mark;
 	uint32_t rule_type = 0;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
+	mark = apol_render_buf_get_length(buf);
 
 	/* rule type */
 	if (qpol_terule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_TYPE_TRANS | QPOL_RULE_TYPE_CHANGE | QPOL_RULE_TYPE_MEMBER))) {
 		ERR(policy, "%s", "Invalid TE rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get TE rule type's string");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
+	if (apol_render_buf_appendf(buf, "%s ", rule_type_str)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -697,7 +697,7 @@ char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rul
 		error = errno;
 		goto err;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+	if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -712,7 +712,7 @@ char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rul
 		error = errno;
 		goto err;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s : ", tmp_name)) {
+	if (apol_render_buf_appendf(buf, "%s : ", tmp_name)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -727,7 +727,7 @@ char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rul
 		error = errno;
 		goto err;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+	if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -742,54 +742,73 @@ char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rul
 		error = errno;
 		goto err;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s;", tmp_name)) {
+	if (apol_render_buf_appendf(buf, "%s;", tmp_name)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
 	}
 
-	return tmp;
+	return render_buf_commit(policy, buf);
 
       err:
-	free(tmp);
+	render_buf_rollback(buf, mark);
 	errno = error;
-	return NULL;
+	return -1;
 }
 
-char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule_t * rule)
+char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rule)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(policy, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_terule_render_buf(policy, rule, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
+}
+
+int apol_syn_terule_render_buf(const apol_policy_t * policy, const qpol_syn_terule_t * rule, apol_render_buf_t * buf)
 {
-	char *tmp = NULL;
 	const char *tmp_name = NULL;
 	const char *rule_type_str;
 	int error = 0;
+	size_t mark;
 	uint32_t rule_type = 0, star = 0, comp = 0;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
 	qpol_iterator_t *iter = NULL, *iter2 = NULL;
-	size_t tmp_sz = 0, iter_sz = 0, iter2_sz = 0;
+	size_t iter_sz = 0, iter2_sz = 0;
 	const qpol_type_set_t *set = NULL;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
+	mark = apol_render_buf_get_length(buf);
 
 	/* rule type */
 	if (qpol_syn_terule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_TYPE_TRANS | QPOL_RULE_TYPE_CHANGE | QPOL_RULE_TYPE_MEMBER))) {
 		ERR(policy, "%s", "Invalid TE rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get TE rule type's string");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
+	if (apol_render_buf_appendf(buf, "%s ", rule_type_str)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -805,7 +824,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		goto err;
 	}
 	if (star) {
-		if (apol_str_append(&tmp, &tmp_sz, "* ")) {
+		if (apol_render_buf_append(buf, "* ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -816,7 +835,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 			goto err;
 		}
 		if (comp) {
-			if (apol_str_append(&tmp, &tmp_sz, "~")) {
+			if (apol_render_buf_append(buf, "~")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -836,7 +855,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 			goto err;
 		}
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+			if (apol_render_buf_append(buf, "{ ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -852,7 +871,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -868,7 +887,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "-%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "-%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -877,7 +896,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		qpol_iterator_destroy(&iter);
 		qpol_iterator_destroy(&iter2);
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+			if (apol_render_buf_append(buf, "} ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -895,7 +914,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		goto err;
 	}
 	if (star) {
-		if (apol_str_append(&tmp, &tmp_sz, "* ")) {
+		if (apol_render_buf_append(buf, "* ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -906,7 +925,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 			goto err;
 		}
 		if (comp) {
-			if (apol_str_append(&tmp, &tmp_sz, "~")) {
+			if (apol_render_buf_append(buf, "~")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -926,7 +945,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 			goto err;
 		}
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+			if (apol_render_buf_append(buf, "{ ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -942,7 +961,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -958,7 +977,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "-%s ", tmp_name)) {
+			if (apol_render_buf_appendf(buf, "-%s ", tmp_name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -967,7 +986,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		qpol_iterator_destroy(&iter);
 		qpol_iterator_destroy(&iter2);
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+			if (apol_render_buf_append(buf, "} ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -975,7 +994,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		}
 	}
 
-	if (apol_str_append(&tmp, &tmp_sz, ": ")) {
+	if (apol_render_buf_append(buf, ": ")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -992,7 +1011,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		goto err;
 	}
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+		if (apol_render_buf_append(buf, "{ ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1008,7 +1027,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 			error = errno;
 			goto err;
 		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+		if (apol_render_buf_appendf(buf, "%s ", tmp_name)) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1016,7 +1035,7 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 	}
 	qpol_iterator_destroy(&iter);
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+		if (apol_render_buf_append(buf, "} ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1032,18 +1051,36 @@ char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule
 		error = errno;
 		goto err;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s;", tmp_name)) {
+	if (apol_render_buf_appendf(buf, "%s;", tmp_name)) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
 	}
 
-	return tmp;
+	return render_buf_commit(policy, buf);
 
       err:
-	free(tmp);
+	render_buf_rollback(buf, mark);
 	qpol_iterator_destroy(&iter);
 	qpol_iterator_destroy(&iter2);
 	errno = error;
-	return NULL;
+	return -1;
+}
+
+char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule_t * rule)
+{
+	apol_render_buf_t *buf;
+	int error;
+
+	if ((buf = apol_render_buf_create()) == NULL) {
+		ERR(policy, "%s", strerror(errno));
+		return NULL;
+	}
+	if (apol_syn_terule_render_buf(policy, rule, buf)) {
+		error = errno;
+		apol_render_buf_destroy(&buf);
+		errno = error;
+		return NULL;
+	}
+	return render_buf_release(&buf);
 }
@@ -200,3 +200,33 @@ int apol_attr_query_set_regex(const apol_policy_t * p, apol_attr_query_t * a, in
 {
 	return apol_query_set_regex(p, &a->flags, is_regex);
 }
+
+/******************** type expansion ********************/
+
+const apol_bitmap_t *apol_type_get_expansion_bitmap(const apol_policy_t * p, const qpol_type_t * type)
+{
+	uint32_t value;
+	if (p == NULL || type == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if (qpol_type_get_value(p->p, type, &value) < 0) {
+		return NULL;
+	}
+	return apol_symbol_catalog_get_type_members(p, value);
+}
+
+const apol_bitmap_t *apol_type_get_attr_bitmap(const apol_policy_t * p, const qpol_type_t * type)
+{
+	uint32_t value;
+	if (p == NULL || type == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if (qpol_type_get_value(p->p, type, &value) < 0) {
+		return NULL;
+	}
+	return apol_symbol_catalog_get_type_attrs(p, value);
+}
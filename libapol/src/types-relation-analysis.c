@@ -26,6 +26,8 @@
 #include "domain-trans-analysis-internal.h"
 #include "infoflow-analysis-internal.h"
 
+#include <apol/bitmap.h>
+#include <apol/parallel.h>
 #include <errno.h>
 #include <string.h>
 
@@ -33,6 +35,8 @@ struct apol_types_relation_analysis
 {
 	char *typeA, *typeB;
 	unsigned int analyses;
+	/** names of types to compare when building a matrix */
+	apol_vector_t *types;
 };
 
 struct apol_types_relation_result
@@ -1004,6 +1008,7 @@ void apol_types_relation_analysis_destroy(apol_types_relation_analysis_t ** tr)
 	if (*tr != NULL) {
 		free((*tr)->typeA);
 		free((*tr)->typeB);
+		apol_vector_destroy(&(*tr)->types);
 		free(*tr);
 		*tr = NULL;
 	}
@@ -1038,6 +1043,617 @@ int apol_types_relation_analysis_set_analyses(const apol_policy_t * p __attribut
 	return 0;
 }
 
+int apol_types_relation_analysis_append_type(const apol_policy_t * p, apol_types_relation_analysis_t * tr, const char *name)
+{
+	char *tmp = NULL;
+	if (name == NULL) {
+		apol_vector_destroy(&tr->types);
+		return 0;
+	}
+	if (tr->types == NULL && (tr->types = apol_vector_create(free)) == NULL) {
+		ERR(p, "Error appending type to analysis: %s", strerror(ENOMEM));
+		return -1;
+	}
+	if ((tmp = strdup(name)) == NULL || apol_vector_append(tr->types, tmp) < 0) {
+		free(tmp);
+		ERR(p, "Error appending type to analysis: %s", strerror(ENOMEM));
+		return -1;
+	}
+	return 0;
+}
+
+/******************** types relation matrix ********************/
+
+#define APOL_TYPES_RELATION_MATRIX_FEATURES \
+	(APOL_TYPES_RELATION_COMMON_ATTRIBS | APOL_TYPES_RELATION_COMMON_ROLES | \
+	 APOL_TYPES_RELATION_COMMON_USERS | APOL_TYPES_RELATION_SIMILAR_ACCESS)
+
+/* indices into a matrix's per-feature arrays */
+#define MATRIX_ATTRIBS 0
+#define MATRIX_ROLES 1
+#define MATRIX_USERS 2
+#define MATRIX_ACCESS 3
+#define MATRIX_NUM_FEATURES 4
+
+struct apol_types_relation_matrix
+{
+	/** vector of qpol_type_t pointers, one for each row and column */
+	apol_vector_t *types;
+	/** which of APOL_TYPES_RELATION_MATRIX_FEATURES were computed */
+	unsigned int features;
+	/** for each computed feature, a bitmap per row: the values of
+	 * the type's attributes, roles, users, or accessed types */
+	apol_bitmap_t **bits[MATRIX_NUM_FEATURES];
+	/** for each computed feature, the number of bits set per row */
+	size_t *counts[MATRIX_NUM_FEATURES];
+	/** similarity of rows i and j, where j < i, is stored at
+	 * index i * (i - 1) / 2 + j */
+	float *similarity;
+};
+
+static unsigned int types_relation_matrix_feature_index(unsigned int feature)
+{
+	switch (feature) {
+	case APOL_TYPES_RELATION_COMMON_ATTRIBS:
+		return MATRIX_ATTRIBS;
+	case APOL_TYPES_RELATION_COMMON_ROLES:
+		return MATRIX_ROLES;
+	case APOL_TYPES_RELATION_COMMON_USERS:
+		return MATRIX_USERS;
+	case APOL_TYPES_RELATION_SIMILAR_ACCESS:
+		return MATRIX_ACCESS;
+	}
+	return MATRIX_NUM_FEATURES;
+}
+
+/**
+ * Allocate one empty bitmap per matrix row for a feature.
+ *
+ * @param p Policy, used for error reporting.
+ * @param m Matrix being built.
+ * @param f Feature index.
+ * @param size Number of bits in each bitmap.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int types_relation_matrix_alloc_feature(const apol_policy_t * p, apol_types_relation_matrix_t * m, unsigned int f,
+					       size_t size)
+{
+	size_t i, n = apol_vector_get_size(m->types);
+	if ((m->bits[f] = calloc(n, sizeof(apol_bitmap_t *))) == NULL || (m->counts[f] = calloc(n, sizeof(size_t))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if ((m->bits[f][i] = apol_bitmap_create(size)) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Return one more than the highest value of the items returned by an
+ * iterator.
+ *
+ * @param p Policy containing the items.
+ * @param iter Iterator over roles, users, or types.
+ * @param get_value Function returning an item's value.
+ * @param size Set to one more than the highest value.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int types_relation_matrix_value_range(const apol_policy_t * p, qpol_iterator_t * iter,
+					     int (*get_value) (const qpol_policy_t *, const void *, uint32_t *), size_t * size)
+{
+	uint32_t val, max_val = 0;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		void *item;
+		if (qpol_iterator_get_item(iter, &item) < 0 || get_value(p->p, item, &val) < 0) {
+			return -1;
+		}
+		if (val > max_val)
+			max_val = val;
+	}
+	*size = (size_t) max_val + 1;
+	return 0;
+}
+
+static int types_relation_role_value(const qpol_policy_t * q, const void *item, uint32_t * val)
+{
+	return qpol_role_get_value(q, (const qpol_role_t *)item, val);
+}
+
+static int types_relation_user_value(const qpol_policy_t * q, const void *item, uint32_t * val)
+{
+	return qpol_user_get_value(q, (const qpol_user_t *)item, val);
+}
+
+static int types_relation_type_value(const qpol_policy_t * q, const void *item, uint32_t * val)
+{
+	return qpol_type_get_value(q, (const qpol_type_t *)item, val);
+}
+
+/**
+ * Set each row's attribute bitmap.
+ */
+static int types_relation_matrix_attribs(const apol_policy_t * p, apol_types_relation_matrix_t * m, size_t num_types)
+{
+	qpol_iterator_t *iter = NULL;
+	size_t i;
+	uint32_t val;
+	int retval = -1;
+	if (types_relation_matrix_alloc_feature(p, m, MATRIX_ATTRIBS, num_types) < 0) {
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(m->types); i++) {
+		if (qpol_type_get_attr_iter(p->p, apol_vector_get_element(m->types, i), &iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			qpol_type_t *attr;
+			if (qpol_iterator_get_item(iter, (void **)&attr) < 0 || qpol_type_get_value(p->p, attr, &val) < 0) {
+				goto cleanup;
+			}
+			apol_bitmap_set(m->bits[MATRIX_ATTRIBS][i], val);
+		}
+		qpol_iterator_destroy(&iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+/**
+ * Set each row's role and/or user bitmaps.  A row's roles are those
+ * whose allowed types include the row's type; its users are those
+ * that have at least one of those roles.
+ */
+static int types_relation_matrix_roles_users(const apol_policy_t * p, apol_types_relation_matrix_t * m, const size_t * row_of,
+					     size_t num_types)
+{
+	qpol_iterator_t *iter = NULL, *subiter = NULL;
+	apol_bitmap_t **role_users = NULL;
+	size_t num_roles = 0, num_users = 0, i;
+	uint32_t val, role_val;
+	int do_roles = (m->features & APOL_TYPES_RELATION_COMMON_ROLES) != 0;
+	int do_users = (m->features & APOL_TYPES_RELATION_COMMON_USERS) != 0;
+	int retval = -1;
+
+	if (qpol_policy_get_role_iter(p->p, &iter) < 0 || types_relation_matrix_value_range(p, iter, types_relation_role_value, &num_roles) < 0) {
+		goto cleanup;
+	}
+	qpol_iterator_destroy(&iter);
+	if (do_roles && types_relation_matrix_alloc_feature(p, m, MATRIX_ROLES, num_roles) < 0) {
+		goto cleanup;
+	}
+	if (do_users) {
+		/* first find the users of each role */
+		if (qpol_policy_get_user_iter(p->p, &iter) < 0 ||
+		    types_relation_matrix_value_range(p, iter, types_relation_user_value, &num_users) < 0) {
+			goto cleanup;
+		}
+		qpol_iterator_destroy(&iter);
+		if (types_relation_matrix_alloc_feature(p, m, MATRIX_USERS, num_users) < 0) {
+			goto cleanup;
+		}
+		if ((role_users = calloc(num_roles, sizeof(apol_bitmap_t *))) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if (qpol_policy_get_user_iter(p->p, &iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			qpol_user_t *user;
+			if (qpol_iterator_get_item(iter, (void **)&user) < 0 || qpol_user_get_value(p->p, user, &val) < 0 ||
+			    qpol_user_get_role_iter(p->p, user, &subiter) < 0) {
+				goto cleanup;
+			}
+			for (; !qpol_iterator_end(subiter); qpol_iterator_next(subiter)) {
+				qpol_role_t *role;
+				if (qpol_iterator_get_item(subiter, (void **)&role) < 0 || qpol_role_get_value(p->p, role, &role_val) < 0) {
+					goto cleanup;
+				}
+				if (role_val >= num_roles)
+					continue;
+				if (role_users[role_val] == NULL && (role_users[role_val] = apol_bitmap_create(num_users)) == NULL) {
+					ERR(p, "%s", strerror(errno));
+					goto cleanup;
+				}
+				apol_bitmap_set(role_users[role_val], val);
+			}
+			qpol_iterator_destroy(&subiter);
+		}
+		qpol_iterator_destroy(&iter);
+	}
+
+	if (qpol_policy_get_role_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_role_t *role;
+		if (qpol_iterator_get_item(iter, (void **)&role) < 0 || qpol_role_get_value(p->p, role, &role_val) < 0 ||
+		    qpol_role_get_type_iter(p->p, role, &subiter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(subiter); qpol_iterator_next(subiter)) {
+			qpol_type_t *type;
+			if (qpol_iterator_get_item(subiter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &val) < 0) {
+				goto cleanup;
+			}
+			if (val >= num_types || row_of[val] == 0)
+				continue;
+			i = row_of[val] - 1;
+			if (do_roles)
+				apol_bitmap_set(m->bits[MATRIX_ROLES][i], role_val);
+			if (do_users && role_val < num_roles && role_users[role_val] != NULL)
+				apol_bitmap_or(m->bits[MATRIX_USERS][i], role_users[role_val]);
+		}
+		qpol_iterator_destroy(&subiter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&subiter);
+	if (role_users != NULL) {
+		for (i = 0; i < num_roles; i++)
+			apol_bitmap_destroy(&role_users[i]);
+		free(role_users);
+	}
+	return retval;
+}
+
+/**
+ * Set each row's accessed types bitmap, by making a single pass over
+ * the policy's allow rules.  A type accesses every type that is (or
+ * is a member of) the target of an allow rule whose source is the
+ * type or one of its attributes.
+ */
+static int types_relation_matrix_access(const apol_policy_t * p, apol_types_relation_matrix_t * m, const size_t * row_of,
+					size_t num_types)
+{
+	qpol_iterator_t *iter = NULL;
+	apol_bitmap_t **targets = NULL;
+	apol_vector_t **sources = NULL;
+	size_t i;
+	uint32_t val;
+	int retval = -1;
+
+	if (types_relation_matrix_alloc_feature(p, m, MATRIX_ACCESS, num_types) < 0) {
+		goto cleanup;
+	}
+	/* expansions are cached by type value as they are first needed */
+	if ((targets = calloc(num_types, sizeof(apol_bitmap_t *))) == NULL ||
+	    (sources = calloc(num_types, sizeof(apol_vector_t *))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_avrule_iter(p->p, QPOL_RULE_ALLOW, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_avrule_t *rule;
+		const qpol_type_t *source, *target;
+		uint32_t source_val, target_val;
+		if (qpol_iterator_get_item(iter, (void **)&rule) < 0 ||
+		    qpol_avrule_get_source_type(p->p, rule, &source) < 0 ||
+		    qpol_avrule_get_target_type(p->p, rule, &target) < 0 ||
+		    qpol_type_get_value(p->p, source, &source_val) < 0 || qpol_type_get_value(p->p, target, &target_val) < 0) {
+			goto cleanup;
+		}
+		if (source_val >= num_types || target_val >= num_types) {
+			continue;
+		}
+		if (sources[source_val] == NULL) {
+			/* keep only the source's types that are matrix rows */
+			apol_vector_t *v = apol_query_expand_type(p, source);
+			if (v == NULL || (sources[source_val] = apol_vector_create(NULL)) == NULL) {
+				apol_vector_destroy(&v);
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+			for (i = 0; i < apol_vector_get_size(v); i++) {
+				if (qpol_type_get_value(p->p, apol_vector_get_element(v, i), &val) < 0) {
+					apol_vector_destroy(&v);
+					goto cleanup;
+				}
+				if (val < num_types && row_of[val] != 0 &&
+				    apol_vector_append(sources[source_val], (void *)(row_of[val] - 1)) < 0) {
+					apol_vector_destroy(&v);
+					ERR(p, "%s", strerror(errno));
+					goto cleanup;
+				}
+			}
+			apol_vector_destroy(&v);
+		}
+		if (apol_vector_get_size(sources[source_val]) == 0) {
+			continue;
+		}
+		if (targets[target_val] == NULL) {
+			apol_vector_t *v = apol_query_expand_type(p, target);
+			if (v == NULL || (targets[target_val] = apol_bitmap_create(num_types)) == NULL) {
+				apol_vector_destroy(&v);
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+			for (i = 0; i < apol_vector_get_size(v); i++) {
+				if (qpol_type_get_value(p->p, apol_vector_get_element(v, i), &val) < 0) {
+					apol_vector_destroy(&v);
+					goto cleanup;
+				}
+				apol_bitmap_set(targets[target_val], val);
+			}
+			apol_vector_destroy(&v);
+		}
+		for (i = 0; i < apol_vector_get_size(sources[source_val]); i++) {
+			size_t row = (size_t) apol_vector_get_element(sources[source_val], i);
+			apol_bitmap_or(m->bits[MATRIX_ACCESS][row], targets[target_val]);
+		}
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	for (i = 0; i < num_types; i++) {
+		if (targets != NULL)
+			apol_bitmap_destroy(&targets[i]);
+		if (sources != NULL)
+			apol_vector_destroy(&sources[i]);
+	}
+	free(targets);
+	free(sources);
+	return retval;
+}
+
+/**
+ * Fill in row i of the similarity table: the similarity of row i to
+ * each row before it.  Rows are independent of each other, so this
+ * is the task run in parallel by types_relation_matrix_similarity().
+ */
+static int types_relation_matrix_similarity_row(void *arg, size_t task)
+{
+	apol_types_relation_matrix_t *m = (apol_types_relation_matrix_t *) arg;
+	/* start with the longest rows, so that the short ones fill in
+	 * the gaps at the end */
+	size_t i = apol_vector_get_size(m->types) - 1 - task, j, f;
+	float *row = m->similarity + i * (i - 1) / 2;
+	for (j = 0; j < i; j++) {
+		size_t common = 0, total = 0;
+		for (f = 0; f < MATRIX_NUM_FEATURES; f++) {
+			size_t c;
+			if (m->bits[f] == NULL)
+				continue;
+			c = apol_bitmap_count_intersection(m->bits[f][i], m->bits[f][j]);
+			common += c;
+			total += m->counts[f][i] + m->counts[f][j] - c;
+		}
+		row[j] = (total ? (float)common / (float)total : 0.0f);
+	}
+	return 0;
+}
+
+/**
+ * Fill in the similarity of every pair of rows.  Similarity is the
+ * Jaccard index of the rows' combined features: the number of
+ * features they share divided by the number that either has.  The
+ * rows are filled in on one thread per processor; they only read
+ * the feature bitmaps, which are complete by now.
+ */
+static int types_relation_matrix_similarity(const apol_policy_t * p, apol_types_relation_matrix_t * m)
+{
+	size_t n = apol_vector_get_size(m->types), i, f;
+	for (f = 0; f < MATRIX_NUM_FEATURES; f++) {
+		if (m->bits[f] == NULL)
+			continue;
+		for (i = 0; i < n; i++)
+			m->counts[f][i] = apol_bitmap_count(m->bits[f][i]);
+	}
+	if (n < 2) {
+		return 0;
+	}
+	if ((m->similarity = malloc((n * (n - 1) / 2) * sizeof(float))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	if (apol_parallel_run(n - 1, 0, types_relation_matrix_similarity_row, m) < 0) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Find the types to use as matrix rows: those appended to the
+ * analysis, or else every type in the policy.
+ */
+static int types_relation_matrix_get_types(const apol_policy_t * p, const apol_types_relation_analysis_t * tr,
+					   apol_types_relation_matrix_t * m)
+{
+	qpol_iterator_t *iter = NULL;
+	size_t i;
+	int retval = -1;
+
+	if ((m->types = apol_vector_create(NULL)) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (tr->types != NULL && apol_vector_get_size(tr->types) > 0) {
+		for (i = 0; i < apol_vector_get_size(tr->types); i++) {
+			const char *name = apol_vector_get_element(tr->types, i);
+			const qpol_type_t *type;
+			unsigned char isattr;
+			if (apol_query_get_type(p, name, &type) < 0 || qpol_type_get_isattr(p->p, type, &isattr) < 0) {
+				goto cleanup;
+			}
+			if (isattr) {
+				ERR(p, "Symbol %s is an attribute.", name);
+				goto cleanup;
+			}
+			if (apol_vector_append(m->types, (void *)type) < 0) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+		}
+		apol_vector_sort_uniquify(m->types, NULL, NULL);
+	} else {
+		if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			qpol_type_t *type;
+			unsigned char isattr, isalias;
+			if (qpol_iterator_get_item(iter, (void **)&type) < 0 ||
+			    qpol_type_get_isattr(p->p, type, &isattr) < 0 || qpol_type_get_isalias(p->p, type, &isalias) < 0) {
+				goto cleanup;
+			}
+			if (!isattr && !isalias && apol_vector_append(m->types, type) < 0) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+		}
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+int apol_types_relation_matrix_do(const apol_policy_t * p, const apol_types_relation_analysis_t * tr,
+				  apol_types_relation_matrix_t ** m)
+{
+	qpol_iterator_t *iter = NULL;
+	size_t *row_of = NULL, num_types = 0, i;
+	uint32_t val;
+	int retval = -1;
+
+	if (m != NULL)
+		*m = NULL;
+	if (p == NULL || tr == NULL || m == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((*m = calloc(1, sizeof(**m))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (((*m)->features = tr->analyses & APOL_TYPES_RELATION_MATRIX_FEATURES) == 0) {
+		(*m)->features = APOL_TYPES_RELATION_MATRIX_FEATURES;
+	}
+	if (types_relation_matrix_get_types(p, tr, *m) < 0) {
+		goto cleanup;
+	}
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0 ||
+	    types_relation_matrix_value_range(p, iter, types_relation_type_value, &num_types) < 0) {
+		goto cleanup;
+	}
+	/* map each type value to one more than its row, or 0 if not a row */
+	if ((row_of = calloc(num_types, sizeof(size_t))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size((*m)->types); i++) {
+		if (qpol_type_get_value(p->p, apol_vector_get_element((*m)->types, i), &val) < 0) {
+			goto cleanup;
+		}
+		if (val < num_types)
+			row_of[val] = i + 1;
+	}
+
+	if (((*m)->features & APOL_TYPES_RELATION_COMMON_ATTRIBS) && types_relation_matrix_attribs(p, *m, num_types) < 0) {
+		goto cleanup;
+	}
+	if (((*m)->features & (APOL_TYPES_RELATION_COMMON_ROLES | APOL_TYPES_RELATION_COMMON_USERS)) &&
+	    types_relation_matrix_roles_users(p, *m, row_of, num_types) < 0) {
+		goto cleanup;
+	}
+	if (((*m)->features & APOL_TYPES_RELATION_SIMILAR_ACCESS) && types_relation_matrix_access(p, *m, row_of, num_types) < 0) {
+		goto cleanup;
+	}
+	if (types_relation_matrix_similarity(p, *m) < 0) {
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	free(row_of);
+	if (retval != 0) {
+		apol_types_relation_matrix_destroy(m);
+	}
+	return retval;
+}
+
+void apol_types_relation_matrix_destroy(apol_types_relation_matrix_t ** m)
+{
+	size_t i, f;
+	if (m == NULL || *m == NULL)
+		return;
+	for (f = 0; f < MATRIX_NUM_FEATURES; f++) {
+		if ((*m)->bits[f] != NULL) {
+			for (i = 0; i < apol_vector_get_size((*m)->types); i++)
+				apol_bitmap_destroy(&(*m)->bits[f][i]);
+			free((*m)->bits[f]);
+		}
+		free((*m)->counts[f]);
+	}
+	apol_vector_destroy(&(*m)->types);
+	free((*m)->similarity);
+	free(*m);
+	*m = NULL;
+}
+
+size_t apol_types_relation_matrix_get_size(const apol_types_relation_matrix_t * m)
+{
+	if (m == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return apol_vector_get_size(m->types);
+}
+
+const qpol_type_t *apol_types_relation_matrix_get_type(const apol_types_relation_matrix_t * m, size_t i)
+{
+	if (m == NULL || i >= apol_vector_get_size(m->types)) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return apol_vector_get_element(m->types, i);
+}
+
+double apol_types_relation_matrix_get_similarity(const apol_types_relation_matrix_t * m, size_t i, size_t j)
+{
+	size_t n;
+	if (m == NULL || i >= (n = apol_vector_get_size(m->types)) || j >= n) {
+		errno = EINVAL;
+		return 0.0;
+	}
+	if (i == j) {
+		return 1.0;
+	}
+	if (i < j) {
+		size_t tmp = i;
+		i = j;
+		j = tmp;
+	}
+	return m->similarity[i * (i - 1) / 2 + j];
+}
+
+size_t apol_types_relation_matrix_get_common(const apol_types_relation_matrix_t * m, size_t i, size_t j, unsigned int feature)
+{
+	unsigned int f = types_relation_matrix_feature_index(feature);
+	size_t n;
+	if (m == NULL || i >= (n = apol_vector_get_size(m->types)) || j >= n || f >= MATRIX_NUM_FEATURES || m->bits[f] == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	if (i == j) {
+		return m->counts[f][i];
+	}
+	return apol_bitmap_count_intersection(m->bits[f][i], m->bits[f][j]);
+}
+
 /*************** functions to access type relation results ***************/
 
 void apol_types_relation_result_destroy(apol_types_relation_result_t ** result)
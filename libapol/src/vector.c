@@ -162,6 +162,21 @@ void apol_vector_destroy(apol_vector_t ** v)
 	*v = NULL;
 }
 
+void apol_vector_clear(apol_vector_t * v)
+{
+	size_t i;
+
+	if (!v)
+		return;
+
+	if (v->fr) {
+		for (i = 0; i < v->size; i++) {
+			v->fr(v->array[i]);
+		}
+	}
+	v->size = 0;
+}
+
 size_t apol_vector_get_size(const apol_vector_t * v)
 {
 	if (!v) {
@@ -29,8 +29,12 @@
 #include <apol/avrule-query.h>
 #include <apol/policy.h>
 #include <apol/policy-path.h>
+#include <apol/type-query.h>
+#include <apol/util.h>
 #include <qpol/policy_extend.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 #define BIN_POLICY TEST_POLICIES "/setools-3.3/rules/rules-mls.21"
 #define SOURCE_POLICY TEST_POLICIES "/setools-3.3/rules/rules-mls.conf"
@@ -114,11 +118,137 @@ static void avrule_default(void)
 	apol_avrule_query_destroy(&aq);
 }
 
+static void avrule_render_buf(void)
+{
+	apol_avrule_query_t *aq = apol_avrule_query_create();
+	apol_render_buf_t *buf = apol_render_buf_create();
+	apol_vector_t *v = NULL;
+	char *expected = NULL, *s;
+	size_t i, expected_sz = 0;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(aq);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(buf);
+
+	CU_ASSERT_EQUAL_FATAL(apol_avrule_get_by_query(bp, aq, &v), 0);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) > 0);
+
+	/* rendering every rule into one buffer must match rendering
+	 * each to its own string */
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const qpol_avrule_t *rule = apol_vector_get_element(v, i);
+		s = apol_avrule_render(bp, rule);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(s);
+		CU_ASSERT(apol_str_appendf(&expected, &expected_sz, "%s\n", s) == 0);
+		free(s);
+		CU_ASSERT(apol_avrule_render_buf(bp, rule, buf) == 0);
+		CU_ASSERT(apol_render_buf_append(buf, "\n") == 0);
+	}
+	CU_ASSERT_PTR_NOT_NULL_FATAL(expected);
+	CU_ASSERT_STRING_EQUAL(apol_render_buf_get_string(buf), expected);
+	CU_ASSERT_EQUAL(apol_render_buf_get_length(buf), strlen(expected));
+
+	apol_render_buf_clear(buf);
+	CU_ASSERT_EQUAL(apol_render_buf_get_length(buf), 0);
+	CU_ASSERT_STRING_EQUAL(apol_render_buf_get_string(buf), "");
+
+	free(expected);
+	apol_render_buf_destroy(&buf);
+	CU_ASSERT_PTR_NULL(buf);
+	apol_vector_destroy(&v);
+	apol_avrule_query_destroy(&aq);
+}
+
+static void avrule_regex_repeat(void)
+{
+	apol_avrule_query_t *aq = apol_avrule_query_create();
+	apol_vector_t *v = NULL;
+	size_t num_all, i;
+	char pattern[32];
+	CU_ASSERT_PTR_NOT_NULL_FATAL(aq);
+
+	CU_ASSERT_EQUAL_FATAL(apol_avrule_get_by_query(bp, aq, &v), 0);
+	num_all = apol_vector_get_size(v);
+	apol_vector_destroy(&v);
+
+	/* every type matches, whether or not the pattern's results
+	 * were remembered from an earlier query */
+	CU_ASSERT(apol_avrule_query_set_regex(bp, aq, 1) == 0);
+	CU_ASSERT(apol_avrule_query_set_source(bp, aq, ".", 0) == 0);
+	CU_ASSERT(apol_avrule_query_set_target(bp, aq, ".", 0) == 0);
+	CU_ASSERT_EQUAL_FATAL(apol_avrule_get_by_query(bp, aq, &v), 0);
+	CU_ASSERT(apol_vector_get_size(v) == num_all);
+	apol_vector_destroy(&v);
+
+	/* push the pattern out of the policy's regex cache */
+	CU_ASSERT(apol_avrule_query_set_target(bp, aq, NULL, 0) == 0);
+	for (i = 0; i < 40; i++) {
+		snprintf(pattern, sizeof(pattern), "^no_such_type_%zu$", i);
+		CU_ASSERT(apol_avrule_query_set_source(bp, aq, pattern, 0) == 0);
+		CU_ASSERT_EQUAL_FATAL(apol_avrule_get_by_query(bp, aq, &v), 0);
+		CU_ASSERT(apol_vector_get_size(v) == 0);
+		apol_vector_destroy(&v);
+	}
+
+	CU_ASSERT(apol_avrule_query_set_source(bp, aq, ".", 0) == 0);
+	CU_ASSERT_EQUAL_FATAL(apol_avrule_get_by_query(bp, aq, &v), 0);
+	CU_ASSERT(apol_vector_get_size(v) == num_all);
+	apol_vector_destroy(&v);
+
+	/* an invalid expression is an error, not an empty result */
+	CU_ASSERT(apol_avrule_query_set_source(bp, aq, "(", 0) == 0);
+	CU_ASSERT(apol_avrule_get_by_query(bp, aq, &v) < 0);
+	CU_ASSERT_PTR_NULL(v);
+	apol_avrule_query_destroy(&aq);
+}
+
+static void avrule_type_bitmaps(void)
+{
+	apol_vector_t *attrs = NULL;
+	qpol_policy_t *q = apol_policy_get_qpol(bp);
+	qpol_iterator_t *iter = NULL;
+	size_t i, num_types;
+
+	CU_ASSERT_EQUAL_FATAL(apol_attr_get_by_query(bp, NULL, &attrs), 0);
+	CU_ASSERT_FATAL(apol_vector_get_size(attrs) > 0);
+	for (i = 0; i < apol_vector_get_size(attrs); i++) {
+		const qpol_type_t *attr = apol_vector_get_element(attrs, i), *type;
+		const apol_bitmap_t *types, *type_attrs;
+		uint32_t attr_value, type_value;
+
+		types = apol_type_get_expansion_bitmap(bp, attr);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(types);
+		CU_ASSERT(apol_bitmap_count(apol_type_get_attr_bitmap(bp, attr)) == 0);
+		CU_ASSERT(qpol_type_get_value(q, attr, &attr_value) == 0);
+
+		/* the bitmap holds exactly the attribute's types, each
+		 * of which has the attribute */
+		CU_ASSERT_FATAL(qpol_type_get_type_iter(q, attr, &iter) == 0);
+		CU_ASSERT(qpol_iterator_get_size(iter, &num_types) == 0);
+		CU_ASSERT_EQUAL(apol_bitmap_count(types), num_types);
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			CU_ASSERT(qpol_iterator_get_item(iter, (void **)&type) == 0);
+			CU_ASSERT(qpol_type_get_value(q, type, &type_value) == 0);
+			CU_ASSERT(apol_bitmap_get(types, type_value));
+			type_attrs = apol_type_get_attr_bitmap(bp, type);
+			CU_ASSERT_PTR_NOT_NULL_FATAL(type_attrs);
+			CU_ASSERT(apol_bitmap_get(type_attrs, attr_value));
+			CU_ASSERT(apol_bitmap_count(apol_type_get_expansion_bitmap(bp, type)) == 1);
+		}
+		qpol_iterator_destroy(&iter);
+	}
+	apol_vector_destroy(&attrs);
+}
+
 CU_TestInfo avrule_tests[] = {
 	{"basic syntactic search", avrule_basic_syn}
 	,
 	{"default query", avrule_default}
 	,
+	{"render into buffer", avrule_render_buf}
+	,
+	{"repeated regex search", avrule_regex_repeat}
+	,
+	{"type expansion bitmaps", avrule_type_bitmaps}
+	,
 	CU_TEST_INFO_NULL
 };
 
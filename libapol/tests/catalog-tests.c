@@ -0,0 +1,294 @@
+/**
+ *  @file
+ *
+ *  Test the policy's symbol catalog through the queries that use it,
+ *  both as loaded and after the policy has been rebuilt.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/avrule-query.h>
+#include <apol/bitmap.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/type-query.h>
+#include <apol/vector.h>
+#include <qpol/policy.h>
+#include <qpol/type_query.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* The lookups need types with several aliases and permissions whose
+ * names depend upon their values, so the tests write their own small
+ * policy rather than rely upon one from TEST_POLICIES. */
+static const char *catalog_policy =
+	"class file\n"
+	"class process\n"
+	"sid kernel\n"
+	"class file { read write getattr }\n"
+	"class process { transition signal }\n"
+	"attribute domain;\n"
+	"type kernel_t, domain;\n"
+	"type init_t alias { init_alias_t old_init_t }, domain;\n"
+	"type etc_t alias etc_alias_t;\n"
+	"type shadow_t;\n"
+	"allow init_alias_t kernel_t : process { signal transition };\n"
+	"allow kernel_t etc_alias_t : file getattr;\n"
+	"allow init_t shadow_t : file { getattr read };\n"
+	"role system_r types { kernel_t init_t };\n"
+	"user system_u roles { system_r };\n"
+	"sid kernel system_u:system_r:kernel_t\n";
+
+static apol_policy_t *sp = NULL;
+
+/**
+ * Run a type query and check that it finds exactly the named types,
+ * in policy order.
+ */
+static void catalog_check_type_query(const char *name, int is_regex, const char *const *expected, size_t num_expected)
+{
+	qpol_policy_t *qp = apol_policy_get_qpol(sp);
+	apol_type_query_t *q = apol_type_query_create();
+	apol_vector_t *v = NULL;
+	const char *found;
+	size_t i;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(q);
+
+	CU_ASSERT(apol_type_query_set_type(sp, q, name) == 0);
+	CU_ASSERT(apol_type_query_set_regex(sp, q, is_regex) == 0);
+	CU_ASSERT_FATAL(apol_type_get_by_query(sp, q, &v) == 0);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == num_expected);
+	for (i = 0; i < num_expected; i++) {
+		CU_ASSERT_FATAL(qpol_type_get_name(qp, apol_vector_get_element(v, i), &found) == 0);
+		CU_ASSERT_STRING_EQUAL(found, expected[i]);
+	}
+	apol_vector_destroy(&v);
+	apol_type_query_destroy(&q);
+}
+
+static void catalog_check_names(void)
+{
+	const char *init[] = { "init_t" };
+	const char *etc[] = { "etc_t" };
+
+	catalog_check_type_query("init_t", 0, init, 1);
+	catalog_check_type_query("init_alias_t", 0, init, 1);
+	catalog_check_type_query("old_init_t", 0, init, 1);
+	catalog_check_type_query("etc_alias_t", 0, etc, 1);
+	catalog_check_type_query("no_such_t", 0, NULL, 0);
+	/* attributes name no type of their own */
+	catalog_check_type_query("domain", 0, NULL, 0);
+}
+
+static void catalog_check_regex(void)
+{
+	const char *init[] = { "init_t" };
+	const char *etc_shadow[] = { "etc_t", "shadow_t" };
+
+	/* a type matches if its name or any of its aliases does */
+	catalog_check_type_query("^old_", 1, init, 1);
+	catalog_check_type_query("^init", 1, init, 1);
+	catalog_check_type_query("^(etc|shadow)_", 1, etc_shadow, 2);
+	catalog_check_type_query("^nothing", 1, NULL, 0);
+}
+
+/**
+ * Check that expanding the domain attribute, a lookup by type value,
+ * gives exactly its two member types.
+ */
+static void catalog_check_values(void)
+{
+	qpol_policy_t *qp = apol_policy_get_qpol(sp);
+	const char *names[] = { "kernel_t", "init_t", "etc_t", "shadow_t" };
+	int is_member[] = { 1, 1, 0, 0 };
+	const qpol_type_t *domain, *type;
+	const apol_bitmap_t *members;
+	uint32_t value;
+	size_t i;
+
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "domain", &domain) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(members = apol_type_get_expansion_bitmap(sp, domain));
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, names[i], &type) == 0);
+		CU_ASSERT_FATAL(qpol_type_get_value(qp, type, &value) == 0);
+		CU_ASSERT(apol_bitmap_get(members, value) == is_member[i]);
+	}
+}
+
+/**
+ * Query the AV rules whose source is the given type, and check that
+ * rendering them gives exactly the expected rules.  Rendering names
+ * the permissions from the catalog's per-class tables, in value order.
+ */
+static void catalog_check_render(const char *source, const char *const *expected, size_t num_expected)
+{
+	apol_avrule_query_t *q = apol_avrule_query_create();
+	apol_vector_t *v = NULL;
+	size_t i, j;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(q);
+
+	CU_ASSERT(apol_avrule_query_set_rules(sp, q, QPOL_RULE_ALLOW) == 0);
+	CU_ASSERT(apol_avrule_query_set_source(sp, q, source, 0) == 0);
+	CU_ASSERT_FATAL(apol_avrule_get_by_query(sp, q, &v) == 0);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == num_expected);
+	for (i = 0; i < num_expected; i++) {
+		int found = 0;
+		char *s = apol_avrule_render(sp, apol_vector_get_element(v, i));
+		CU_ASSERT_PTR_NOT_NULL_FATAL(s);
+		for (j = 0; j < num_expected; j++) {
+			if (strcmp(s, expected[j]) == 0)
+				found = 1;
+		}
+		CU_ASSERT(found);
+		free(s);
+	}
+	apol_vector_destroy(&v);
+	apol_avrule_query_destroy(&q);
+}
+
+static void catalog_check_perm_names(void)
+{
+	const char *init[] = {
+		"allow init_t kernel_t : process { transition signal };",
+		"allow init_t shadow_t : file { read getattr };"
+	};
+	const char *kernel[] = { "allow kernel_t etc_t : file getattr;" };
+
+	/* the source is given by alias, which the catalog resolves */
+	catalog_check_render("old_init_t", init, 2);
+	catalog_check_render("kernel_t", kernel, 1);
+}
+
+static void catalog_names(void)
+{
+	catalog_check_names();
+}
+
+static void catalog_regex(void)
+{
+	catalog_check_regex();
+}
+
+static void catalog_values(void)
+{
+	catalog_check_values();
+}
+
+static void catalog_perm_names(void)
+{
+	catalog_check_perm_names();
+}
+
+/**
+ * Rebuild the policy, which frees every qpol object the catalog
+ * pointed into, and check that each kind of lookup still works.  The
+ * regex queries were cached before the rebuild.  An attribute's
+ * expansion obtained before the rebuild must still be readable
+ * afterwards.
+ */
+static void catalog_rebuild(void)
+{
+	qpol_policy_t *qp = apol_policy_get_qpol(sp);
+	const qpol_type_t *type;
+	const apol_bitmap_t *held, *members;
+	uint32_t kernel_value, init_value;
+	unsigned long before, after;
+
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "kernel_t", &type) == 0);
+	CU_ASSERT_FATAL(qpol_type_get_value(qp, type, &kernel_value) == 0);
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "init_t", &type) == 0);
+	CU_ASSERT_FATAL(qpol_type_get_value(qp, type, &init_value) == 0);
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "domain", &type) == 0);
+	held = apol_type_get_expansion_bitmap(sp, type);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(held);
+
+	CU_ASSERT_FATAL(qpol_policy_get_generation(qp, &before) == 0);
+	CU_ASSERT_FATAL(qpol_policy_rebuild(qp, QPOL_POLICY_OPTION_NO_NEVERALLOWS) == 0);
+	CU_ASSERT_FATAL(qpol_policy_get_generation(qp, &after) == 0);
+	CU_ASSERT(after == before + 1);
+
+	/* building the rebuilt policy's matrix retires the old one */
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "domain", &type) == 0);
+	members = apol_type_get_expansion_bitmap(sp, type);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(members);
+	CU_ASSERT(members != held);
+	CU_ASSERT(apol_bitmap_count(members) == 2);
+	CU_ASSERT(apol_bitmap_count(held) == 2);
+	CU_ASSERT(apol_bitmap_get(held, kernel_value) && apol_bitmap_get(held, init_value));
+
+	catalog_check_names();
+	catalog_check_regex();
+	catalog_check_values();
+	catalog_check_perm_names();
+}
+
+CU_TestInfo catalog_tests[] = {
+	{"name and alias lookups", catalog_names}
+	,
+	{"regex lookups", catalog_regex}
+	,
+	{"value lookups", catalog_values}
+	,
+	{"permission names", catalog_perm_names}
+	,
+	{"lookups after rebuild", catalog_rebuild}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int catalog_init()
+{
+	char path[] = "/tmp/catalog-tests-XXXXXX";
+	apol_policy_path_t *ppath = NULL;
+	FILE *fp = NULL;
+	int fd, retval = 1;
+
+	if ((fd = mkstemp(path)) < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		goto cleanup;
+	}
+	if (fputs(catalog_policy, fp) == EOF) {
+		fclose(fp);
+		goto cleanup;
+	}
+	if (fclose(fp) != 0) {
+		goto cleanup;
+	}
+	if ((ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, path, NULL)) == NULL ||
+	    (sp = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL)) == NULL) {
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	apol_policy_path_destroy(&ppath);
+	unlink(path);
+	return retval;
+}
+
+int catalog_cleanup()
+{
+	apol_policy_destroy(&sp);
+	return 0;
+}
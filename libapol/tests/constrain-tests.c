@@ -30,6 +30,7 @@
 #include <apol/policy-path.h>
 #include <stdbool.h>
 #include <string.h>
+#include <apol/access-decision.h>
 #include <apol/constraint-query.h>
 #include <sepol/policydb/policydb.h>
 #include <sepol/policydb/constraint.h>
@@ -481,9 +482,134 @@ static void constrain_modular(void)
 	CU_PASS("Not yet implemented")
 }
 
+/* Build a context from the policy's first user and role, the given
+ * type, and (for MLS policies) the policy's first sensitivity. */
+static apol_context_t *constrain_eval_context(apol_policy_t *ap, const char *type_name)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(ap);
+	qpol_iterator_t *iter = NULL;
+	const qpol_user_t *user;
+	const qpol_role_t *role;
+	const qpol_level_t *level;
+	const char *name;
+	apol_context_t *context = apol_context_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(context);
+
+	CU_ASSERT_FATAL(qpol_policy_get_user_iter(q, &iter) == 0 && !qpol_iterator_end(iter));
+	CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&user) == 0 && qpol_user_get_name(q, user, &name) == 0);
+	CU_ASSERT(apol_context_set_user(ap, context, name) == 0);
+	qpol_iterator_destroy(&iter);
+
+	CU_ASSERT_FATAL(qpol_policy_get_role_iter(q, &iter) == 0 && !qpol_iterator_end(iter));
+	CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&role) == 0 && qpol_role_get_name(q, role, &name) == 0);
+	CU_ASSERT(apol_context_set_role(ap, context, name) == 0);
+	qpol_iterator_destroy(&iter);
+
+	CU_ASSERT(apol_context_set_type(ap, context, type_name) == 0);
+
+	if (apol_policy_is_mls(ap)) {
+		apol_mls_range_t *range;
+		CU_ASSERT_FATAL(qpol_policy_get_level_iter(q, &iter) == 0 && !qpol_iterator_end(iter));
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&level) == 0 && qpol_level_get_name(q, level, &name) == 0);
+		range = apol_mls_range_create_from_string(ap, name);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(range);
+		CU_ASSERT(apol_context_set_range(ap, context, range) == 0);
+		qpol_iterator_destroy(&iter);
+	}
+	return context;
+}
+
+static void constrain_eval(apol_policy_t *ap)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(ap);
+	apol_constraint_evaluator_t *e = apol_constraint_evaluator_create(ap);
+	qpol_iterator_t *iter = NULL;
+	const qpol_class_t *dir;
+	const char *other_type = NULL;
+	apol_context_t *source, *target;
+	apol_vector_t *scons, *tcons;
+	uint32_t read_val, denied, pair_denied[2];
+	apol_access_engine_t *engine;
+	apol_access_decision_t *decision;
+	int reason;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(e);
+
+	/* dir read requires that the source type is sysadm_t or
+	 * secadm_t, so any other type must be denied */
+	CU_ASSERT_FATAL(qpol_policy_get_type_iter(q, &iter) == 0);
+	for (; !qpol_iterator_end(iter) && other_type == NULL; qpol_iterator_next(iter)) {
+		const qpol_type_t *type;
+		const char *name;
+		unsigned char isattr, isalias;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&type) == 0);
+		CU_ASSERT_FATAL(qpol_type_get_isattr(q, type, &isattr) == 0 && qpol_type_get_isalias(q, type, &isalias) == 0);
+		CU_ASSERT_FATAL(qpol_type_get_name(q, type, &name) == 0);
+		if (!isattr && !isalias && strcmp(name, "sysadm_t") != 0 && strcmp(name, "secadm_t") != 0)
+			other_type = name;
+	}
+	qpol_iterator_destroy(&iter);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(other_type);
+
+	source = constrain_eval_context(ap, other_type);
+	target = constrain_eval_context(ap, "sysadm_t");
+	CU_ASSERT(apol_constraint_evaluator_check(e, source, target, "dir", "read") == 0);
+
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(q, "dir", &dir) == 0);
+	CU_ASSERT_FATAL(qpol_class_get_perm_value(q, dir, "read", &read_val) == 0 && read_val > 0);
+	CU_ASSERT(apol_constraint_evaluator_get_denied(e, source, target, "dir", &denied) == 0);
+	CU_ASSERT(denied & (1U << (read_val - 1)));
+
+	/* the batch interface must agree with the single one */
+	scons = apol_vector_create(NULL);
+	tcons = apol_vector_create(NULL);
+	CU_ASSERT_FATAL(scons != NULL && tcons != NULL);
+	apol_vector_append(scons, source);
+	apol_vector_append(tcons, target);
+	apol_vector_append(scons, target);
+	apol_vector_append(tcons, source);
+	CU_ASSERT(apol_constraint_evaluator_check_pairs(e, "dir", scons, tcons, pair_denied) == 0);
+	CU_ASSERT_EQUAL(pair_denied[0], denied);
+	CU_ASSERT(apol_constraint_evaluator_get_denied(e, target, source, "dir", &denied) == 0);
+	CU_ASSERT_EQUAL(pair_denied[1], denied);
+
+	/* the full access decision must deny it too, whether or not
+	 * an allow rule grants it */
+	engine = apol_access_engine_create(ap);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(engine);
+	CU_ASSERT(apol_access_engine_decide(engine, source, target, "dir", 1U << (read_val - 1), &decision) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(decision);
+	CU_ASSERT_EQUAL(apol_access_decision_get_granted(decision), 0);
+	CU_ASSERT_EQUAL(apol_access_decision_get_denied(decision), 1U << (read_val - 1));
+	reason = apol_access_decision_get_reason(decision, read_val);
+	CU_ASSERT(reason == APOL_ACCESS_DENIED_TE || reason == APOL_ACCESS_DENIED_CONSTRAINT);
+	CU_ASSERT(apol_access_decision_get_reason(decision, read_val == 1 ? 2 : 1) == APOL_ACCESS_NOT_REQUESTED);
+	apol_access_decision_destroy(&decision);
+	CU_ASSERT_PTR_NULL(decision);
+	apol_access_engine_destroy(&engine);
+
+	apol_vector_destroy(&scons);
+	apol_vector_destroy(&tcons);
+	apol_context_destroy(&source);
+	apol_context_destroy(&target);
+	apol_constraint_evaluator_destroy(&e);
+	CU_ASSERT_PTR_NULL(e);
+}
+
+static void constrain_eval_source(void)
+{
+	constrain_eval(ps);
+}
+
+static void constrain_eval_binary(void)
+{
+	constrain_eval(pb);
+}
+
 CU_TestInfo constrain_tests[] = {
 	{"constrain from source policy", constrain_source},
 	{"constrain from binary policy", constrain_binary},
+	{"constraint evaluation from source policy", constrain_eval_source},
+	{"constraint evaluation from binary policy", constrain_eval_binary},
 //	{"constrain from modular policy", constrain_modular},
 	CU_TEST_INFO_NULL
 };
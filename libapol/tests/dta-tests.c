@@ -484,6 +484,115 @@ static void dta_invalid(void)
 	apol_domain_trans_analysis_destroy(&d);
 }
 
+static void dta_reach(void)
+{
+	apol_domain_trans_reach_analysis_t *r = apol_domain_trans_reach_analysis_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+	int retval = apol_domain_trans_reach_analysis_append_start_type(p, r, "tuna_t");
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	apol_vector_t *v = NULL;
+	retval = apol_domain_trans_reach_analysis_do(p, r, &v);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_FATAL(v != NULL && apol_vector_get_size(v) > 0);
+
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	bool found_boat = false, found_sand = false;
+	unsigned int last_hops = 1;
+	size_t i, j;
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const apol_domain_trans_reach_result_t *drr = apol_vector_get_element(v, i);
+		const char *name;
+		unsigned int hops = apol_domain_trans_reach_result_get_num_hops(drr);
+		CU_ASSERT(hops >= last_hops);
+		last_hops = hops;
+
+		retval = qpol_type_get_name(q, apol_domain_trans_reach_result_get_start_type(drr), &name);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT_STRING_EQUAL(name, "tuna_t");
+		retval = qpol_type_get_name(q, apol_domain_trans_reach_result_get_end_type(drr), &name);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT_STRING_NOT_EQUAL(name, "tuna_t");
+		if (strcmp(name, "boat_t") == 0) {
+			found_boat = true;
+			CU_ASSERT(hops == 1);
+		} else if (strcmp(name, "sand_t") == 0) {
+			found_sand = true;
+			CU_ASSERT(hops == 1);
+		}
+
+		const apol_vector_t *doms = apol_domain_trans_reach_result_get_domains(drr);
+		CU_ASSERT(apol_vector_get_size(doms) == hops + 1);
+		CU_ASSERT(apol_vector_get_size(apol_domain_trans_reach_result_get_entrypoints(drr)) == hops);
+
+		apol_vector_t *steps = NULL;
+		retval = apol_domain_trans_reach_result_get_steps(p, drr, &steps);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT_FATAL(apol_vector_get_size(steps) == hops);
+		for (j = 0; j < apol_vector_get_size(steps); j++) {
+			const apol_domain_trans_result_t *dtr = apol_vector_get_element(steps, j);
+			CU_ASSERT(apol_domain_trans_result_is_trans_valid(dtr));
+			CU_ASSERT(apol_domain_trans_result_get_start_type(dtr) == apol_vector_get_element(doms, j));
+			CU_ASSERT(apol_domain_trans_result_get_end_type(dtr) == apol_vector_get_element(doms, j + 1));
+			CU_ASSERT(apol_vector_get_size(apol_domain_trans_result_get_proc_trans_rules(dtr)) > 0);
+			CU_ASSERT(apol_vector_get_size(apol_domain_trans_result_get_entrypoint_rules(dtr)) > 0);
+			CU_ASSERT(apol_vector_get_size(apol_domain_trans_result_get_exec_rules(dtr)) > 0);
+		}
+		apol_vector_destroy(&steps);
+	}
+	CU_ASSERT(found_boat && found_sand);
+	size_t all_size = apol_vector_get_size(v);
+	apol_vector_destroy(&v);
+
+	retval = apol_domain_trans_reach_analysis_set_max_hops(p, r, 1);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_domain_trans_reach_analysis_do(p, r, &v);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT(apol_vector_get_size(v) <= all_size);
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const apol_domain_trans_reach_result_t *drr = apol_vector_get_element(v, i);
+		CU_ASSERT(apol_domain_trans_reach_result_get_num_hops(drr) == 1);
+	}
+	apol_vector_destroy(&v);
+	apol_domain_trans_reach_analysis_destroy(&r);
+}
+
+static void dta_repeat(void)
+{
+	apol_domain_trans_analysis_t *d = apol_domain_trans_analysis_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(d);
+	int retval = apol_domain_trans_analysis_set_start_type(p, d, "tuna_t");
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_domain_trans_analysis_set_valid(p, d, APOL_DOMAIN_TRANS_SEARCH_BOTH);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	/* without resetting the table, repeated analyses must agree */
+	unsigned char dirs[] = { APOL_DOMAIN_TRANS_DIRECTION_FORWARD, APOL_DOMAIN_TRANS_DIRECTION_REVERSE };
+	for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+		retval = apol_domain_trans_analysis_set_direction(p, d, dirs[i]);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		apol_vector_t *v1 = NULL, *v2 = NULL;
+		retval = apol_domain_trans_analysis_do(p, d, &v1);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		retval = apol_domain_trans_analysis_do(p, d, &v2);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT(apol_vector_get_size(v1) > 0);
+		CU_ASSERT_EQUAL(apol_vector_get_size(v1), apol_vector_get_size(v2));
+		for (size_t j = 0; j < apol_vector_get_size(v1) && j < apol_vector_get_size(v2); j++) {
+			const apol_domain_trans_result_t *r1 = apol_vector_get_element(v1, j);
+			const apol_domain_trans_result_t *r2 = apol_vector_get_element(v2, j);
+			CU_ASSERT(apol_domain_trans_result_get_start_type(r1) == apol_domain_trans_result_get_start_type(r2));
+			CU_ASSERT(apol_domain_trans_result_get_entrypoint_type(r1) ==
+				  apol_domain_trans_result_get_entrypoint_type(r2));
+			CU_ASSERT(apol_domain_trans_result_get_end_type(r1) == apol_domain_trans_result_get_end_type(r2));
+			CU_ASSERT_EQUAL(apol_domain_trans_result_is_trans_valid(r1), apol_domain_trans_result_is_trans_valid(r2));
+		}
+		apol_vector_destroy(&v1);
+		apol_vector_destroy(&v2);
+	}
+	apol_domain_trans_analysis_destroy(&d);
+}
+
 CU_TestInfo dta_tests[] = {
 	{"dta forward", dta_forward}
 	,
@@ -499,6 +608,10 @@ CU_TestInfo dta_tests[] = {
 	,
 	{"dta invalid transitions", dta_invalid}
 	,
+	{"dta transitive reachability", dta_reach}
+	,
+	{"dta repeated analyses", dta_repeat}
+	,
 	CU_TEST_INFO_NULL
 };
 
@@ -29,11 +29,17 @@
 #include <CUnit/Basic.h>
 
 #include "avrule-tests.h"
+#include "catalog-tests.h"
 #include "dta-tests.h"
 #include "infoflow-tests.h"
+#include "mls-level-tests.h"
+#include "netcon-tests.h"
+#include "parallel-tests.h"
 #include "policy-21-tests.h"
+#include "relabel-tests.h"
 #include "role-tests.h"
 #include "terule-tests.h"
+#include "types-relation-tests.h"
 #include "constrain-tests.h"
 #include "user-tests.h"
 
@@ -46,10 +52,16 @@ int main(void)
 	CU_SuiteInfo suites[] = {
 		{"Policy Version 21", policy_21_init, policy_21_cleanup, policy_21_tests},
 		{"AV Rule Query", avrule_init, avrule_cleanup, avrule_tests},
+		{"Symbol Catalog", catalog_init, catalog_cleanup, catalog_tests},
 		{"Domain Transition Analysis", dta_init, dta_cleanup, dta_tests},
 		{"Infoflow Analysis", infoflow_init, infoflow_cleanup, infoflow_tests},
+		{"MLS Level", mls_level_init, mls_level_cleanup, mls_level_tests},
+		{"Netcon Index", netcon_init, netcon_cleanup, netcon_tests},
+		{"Parallel Run", parallel_init, parallel_cleanup, parallel_tests},
+		{"Relabel Analysis", relabel_init, relabel_cleanup, relabel_tests},
 		{"Role Query", role_init, role_cleanup, role_tests},
 		{"TE Rule Query", terule_init, terule_cleanup, terule_tests},
+		{"Types Relation Matrix", types_relation_init, types_relation_cleanup, types_relation_tests},
 		{"User Query", user_init, user_cleanup, user_tests},
 		{"Constrain query", constrain_init, constrain_cleanup, constrain_tests},
 		CU_SUITE_INFO_NULL
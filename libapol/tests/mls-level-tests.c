@@ -0,0 +1,269 @@
+/**
+ *  @file
+ *
+ *  Test MLS level comparison and validation.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/mls-query.h>
+#include <apol/mls_level.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <qpol/iterator.h>
+#include <qpol/mls_query.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOURCE_POLICY TEST_POLICIES "/setools-3.3/rules/rules-mls.conf"
+
+static apol_policy_t *sp = NULL;
+static qpol_policy_t *qp = NULL;
+
+/* the lowest sensitivity, and the highest one that allows at least
+ * two categories, along with two of those categories */
+static const char *low_sens = NULL, *high_sens = NULL;
+static const char *cat_a = NULL, *cat_b = NULL;
+
+/**
+ * Build a level from a sensitivity and up to two categories.
+ */
+static apol_mls_level_t *mls_level_build(const char *sens, const char *cat1, const char *cat2)
+{
+	apol_mls_level_t *l = apol_mls_level_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	CU_ASSERT_FATAL(apol_mls_level_set_sens(sp, l, sens) == 0);
+	if (cat1 != NULL) {
+		CU_ASSERT_FATAL(apol_mls_level_append_cats(sp, l, cat1) == 0);
+	}
+	if (cat2 != NULL) {
+		CU_ASSERT_FATAL(apol_mls_level_append_cats(sp, l, cat2) == 0);
+	}
+	return l;
+}
+
+static void mls_level_compare_same_sens(void)
+{
+	apol_mls_level_t *a = mls_level_build(high_sens, cat_a, NULL);
+	apol_mls_level_t *a2 = mls_level_build(high_sens, cat_a, NULL);
+	apol_mls_level_t *ab = mls_level_build(high_sens, cat_b, cat_a);
+	apol_mls_level_t *b = mls_level_build(high_sens, cat_b, NULL);
+
+	CU_ASSERT(apol_mls_level_compare(sp, a, a) == APOL_MLS_EQ);
+	CU_ASSERT(apol_mls_level_compare(sp, a, a2) == APOL_MLS_EQ);
+	CU_ASSERT(apol_mls_level_compare(sp, a, NULL) == APOL_MLS_EQ);
+	CU_ASSERT(apol_mls_level_compare(sp, ab, a) == APOL_MLS_DOM);
+	CU_ASSERT(apol_mls_level_compare(sp, a, ab) == APOL_MLS_DOMBY);
+	CU_ASSERT(apol_mls_level_compare(sp, a, b) == APOL_MLS_INCOMP);
+	CU_ASSERT(apol_mls_level_compare(sp, b, a) == APOL_MLS_INCOMP);
+
+	/* comparing must not change either level, so modifying one
+	 * afterwards is seen by the next comparison */
+	CU_ASSERT(apol_mls_level_append_cats(sp, a2, cat_b) == 0);
+	CU_ASSERT(apol_mls_level_compare(sp, a2, ab) == APOL_MLS_EQ);
+	CU_ASSERT(apol_mls_level_compare(sp, a2, a) == APOL_MLS_DOM);
+
+	apol_mls_level_destroy(&a);
+	apol_mls_level_destroy(&a2);
+	apol_mls_level_destroy(&ab);
+	apol_mls_level_destroy(&b);
+}
+
+static void mls_level_compare_diff_sens(void)
+{
+	apol_mls_level_t *lo = mls_level_build(low_sens, NULL, NULL);
+	apol_mls_level_t *lo_a = mls_level_build(low_sens, cat_a, NULL);
+	apol_mls_level_t *hi = mls_level_build(high_sens, NULL, NULL);
+	apol_mls_level_t *hi_a = mls_level_build(high_sens, cat_a, NULL);
+	apol_mls_level_t *hi_b = mls_level_build(high_sens, cat_b, NULL);
+
+	CU_ASSERT(apol_mls_level_compare(sp, hi, lo) == APOL_MLS_DOM);
+	CU_ASSERT(apol_mls_level_compare(sp, lo, hi) == APOL_MLS_DOMBY);
+	CU_ASSERT(apol_mls_level_compare(sp, hi_a, lo_a) == APOL_MLS_DOM);
+	CU_ASSERT(apol_mls_level_compare(sp, lo_a, hi_a) == APOL_MLS_DOMBY);
+	/* a higher sensitivity does not dominate categories it lacks */
+	CU_ASSERT(apol_mls_level_compare(sp, hi, lo_a) == APOL_MLS_INCOMP);
+	CU_ASSERT(apol_mls_level_compare(sp, hi_b, lo_a) == APOL_MLS_INCOMP);
+	CU_ASSERT(apol_mls_level_compare(sp, lo_a, hi_b) == APOL_MLS_INCOMP);
+
+	apol_mls_level_destroy(&lo);
+	apol_mls_level_destroy(&lo_a);
+	apol_mls_level_destroy(&hi);
+	apol_mls_level_destroy(&hi_a);
+	apol_mls_level_destroy(&hi_b);
+}
+
+static void mls_level_compare_unknown(void)
+{
+	apol_mls_level_t *a = mls_level_build(high_sens, cat_a, NULL);
+	apol_mls_level_t *bogus_cat = mls_level_build(high_sens, cat_a, "not_a_category");
+	apol_mls_level_t *bogus_sens = mls_level_build("not_a_sensitivity", cat_a, NULL);
+
+	CU_ASSERT(apol_mls_level_compare(sp, a, bogus_cat) < 0);
+	CU_ASSERT(apol_mls_level_compare(sp, bogus_cat, a) < 0);
+	CU_ASSERT(apol_mls_level_compare(sp, a, bogus_sens) < 0);
+	CU_ASSERT(apol_mls_level_compare(sp, bogus_sens, a) < 0);
+	/* a failed comparison leaves nothing behind to spoil the next */
+	CU_ASSERT(apol_mls_level_compare(sp, a, a) == APOL_MLS_EQ);
+
+	apol_mls_level_destroy(&a);
+	apol_mls_level_destroy(&bogus_cat);
+	apol_mls_level_destroy(&bogus_sens);
+}
+
+static void mls_level_validate(void)
+{
+	apol_mls_level_t *hi_ab = mls_level_build(high_sens, cat_a, cat_b);
+	apol_mls_level_t *hi = mls_level_build(high_sens, NULL, NULL);
+	apol_mls_level_t *bogus_cat = mls_level_build(high_sens, cat_a, "not_a_category");
+	apol_mls_level_t *bogus_sens = mls_level_build("not_a_sensitivity", NULL, NULL);
+	apol_mls_level_t *no_sens = apol_mls_level_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(no_sens);
+
+	CU_ASSERT(apol_mls_level_validate(sp, hi_ab) == 1);
+	CU_ASSERT(apol_mls_level_validate(sp, hi) == 1);
+	CU_ASSERT(apol_mls_level_validate(sp, bogus_cat) == 0);
+	CU_ASSERT(apol_mls_level_validate(sp, bogus_sens) < 0);
+	CU_ASSERT(apol_mls_level_validate(sp, no_sens) == 0);
+	CU_ASSERT(apol_mls_level_validate(NULL, hi) < 0);
+
+	apol_mls_level_destroy(&hi_ab);
+	apol_mls_level_destroy(&hi);
+	apol_mls_level_destroy(&bogus_cat);
+	apol_mls_level_destroy(&bogus_sens);
+	apol_mls_level_destroy(&no_sens);
+}
+
+static void mls_level_validate_disallowed(void)
+{
+	qpol_iterator_t *iter = NULL, *cat_iter = NULL;
+	size_t num_cats;
+
+	/* the chosen categories are valid for the sensitivity that
+	 * allows them, and invalid for any that allows none */
+	CU_ASSERT_FATAL(qpol_policy_get_level_iter(qp, &iter) == 0);
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_level_t *datum;
+		const char *sens;
+		unsigned char isalias;
+		apol_mls_level_t *l;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&datum) == 0);
+		CU_ASSERT_FATAL(qpol_level_get_isalias(qp, datum, &isalias) == 0);
+		if (isalias)
+			continue;
+		CU_ASSERT_FATAL(qpol_level_get_name(qp, datum, &sens) == 0);
+		CU_ASSERT_FATAL(qpol_level_get_cat_iter(qp, datum, &cat_iter) == 0);
+		CU_ASSERT_FATAL(qpol_iterator_get_size(cat_iter, &num_cats) == 0);
+		qpol_iterator_destroy(&cat_iter);
+
+		l = mls_level_build(sens, cat_a, cat_b);
+		if (strcmp(sens, high_sens) == 0) {
+			CU_ASSERT(apol_mls_level_validate(sp, l) == 1);
+		} else if (num_cats == 0) {
+			CU_ASSERT(apol_mls_level_validate(sp, l) == 0);
+		}
+		apol_mls_level_destroy(&l);
+	}
+	qpol_iterator_destroy(&iter);
+}
+
+CU_TestInfo mls_level_tests[] = {
+	{"compare within a sensitivity", mls_level_compare_same_sens}
+	,
+	{"compare across sensitivities", mls_level_compare_diff_sens}
+	,
+	{"compare unknown components", mls_level_compare_unknown}
+	,
+	{"validate", mls_level_validate}
+	,
+	{"validate disallowed categories", mls_level_validate_disallowed}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int mls_level_init()
+{
+	apol_policy_path_t *ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, SOURCE_POLICY, NULL);
+	qpol_iterator_t *iter = NULL, *cat_iter = NULL;
+	uint32_t val, low_val = UINT32_MAX, high_val = 0;
+	if (ppath == NULL) {
+		return 1;
+	}
+
+	if ((sp = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL)) == NULL) {
+		apol_policy_path_destroy(&ppath);
+		return 1;
+	}
+	apol_policy_path_destroy(&ppath);
+	qp = apol_policy_get_qpol(sp);
+
+	if (qpol_policy_get_level_iter(qp, &iter) < 0) {
+		return 1;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_level_t *datum;
+		const qpol_cat_t *cat1, *cat2;
+		const char *name;
+		unsigned char isalias;
+		size_t num_cats;
+		if (qpol_iterator_get_item(iter, (void **)&datum) < 0 ||
+		    qpol_level_get_isalias(qp, datum, &isalias) < 0 ||
+		    qpol_level_get_value(qp, datum, &val) < 0 || qpol_level_get_name(qp, datum, &name) < 0) {
+			goto err;
+		}
+		if (isalias)
+			continue;
+		if (val < low_val) {
+			low_val = val;
+			low_sens = name;
+		}
+		if (qpol_level_get_cat_iter(qp, datum, &cat_iter) < 0 || qpol_iterator_get_size(cat_iter, &num_cats) < 0) {
+			goto err;
+		}
+		if (num_cats >= 2 && val >= high_val) {
+			high_val = val;
+			high_sens = name;
+			if (qpol_iterator_get_item(cat_iter, (void **)&cat1) < 0 ||
+			    qpol_cat_get_name(qp, cat1, &cat_a) < 0 ||
+			    qpol_iterator_next(cat_iter) < 0 ||
+			    qpol_iterator_get_item(cat_iter, (void **)&cat2) < 0 || qpol_cat_get_name(qp, cat2, &cat_b) < 0) {
+				goto err;
+			}
+		}
+		qpol_iterator_destroy(&cat_iter);
+	}
+	qpol_iterator_destroy(&iter);
+	/* the comparisons across sensitivities need two distinct ones */
+	if (low_sens == NULL || high_sens == NULL || low_val == high_val) {
+		return 1;
+	}
+	return 0;
+      err:
+	qpol_iterator_destroy(&cat_iter);
+	qpol_iterator_destroy(&iter);
+	return 1;
+}
+
+int mls_level_cleanup()
+{
+	apol_policy_destroy(&sp);
+	return 0;
+}
@@ -0,0 +1,336 @@
+/**
+ *  @file
+ *
+ *  Test the netcon index's portcon and nodecon lookups.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/netcon-query.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/util.h>
+#include <qpol/context_query.h>
+#include <qpol/iterator.h>
+#include <qpol/nodecon_query.h>
+#include <qpol/portcon_query.h>
+#include <qpol/type_query.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* The lookups need overlapping and adjacent port ranges, both ends of
+ * the port space, and an irregular netmask, so the tests write their
+ * own small policy rather than rely upon one from TEST_POLICIES.
+ * Each statement's context has its own type, which identifies the
+ * statement a lookup found. */
+static const char *netcon_policy =
+	"class tcp_socket\n"
+	"class udp_socket\n"
+	"sid kernel\n"
+	"class tcp_socket { name_bind }\n"
+	"class udp_socket { name_bind }\n"
+	"type kernel_t;\n"
+	"type tcp_zero_t;\n"
+	"type tcp_a_t;\n"
+	"type tcp_b_t;\n"
+	"type tcp_c_t;\n"
+	"type tcp_wide_t;\n"
+	"type tcp_top_t;\n"
+	"type udp_all_t;\n"
+	"type node_ten_t;\n"
+	"type node_ten_one_t;\n"
+	"type node_odd_t;\n"
+	"type node_any_t;\n"
+	"type node6_doc_t;\n"
+	"type node6_lo_t;\n"
+	"allow kernel_t tcp_a_t : tcp_socket { name_bind };\n"
+	"role system_r types { kernel_t tcp_zero_t tcp_a_t tcp_b_t tcp_c_t tcp_wide_t tcp_top_t udp_all_t"
+	" node_ten_t node_ten_one_t node_odd_t node_any_t node6_doc_t node6_lo_t };\n"
+	"user system_u roles { system_r };\n"
+	"sid kernel system_u:system_r:kernel_t\n"
+	/* tcp_b overlaps the end of tcp_a; tcp_c is adjacent to
+	 * tcp_b; tcp_wide surrounds all three */
+	"portcon tcp 0 system_u:system_r:tcp_zero_t\n"
+	"portcon tcp 100-200 system_u:system_r:tcp_a_t\n"
+	"portcon tcp 150-300 system_u:system_r:tcp_b_t\n"
+	"portcon tcp 301-400 system_u:system_r:tcp_c_t\n"
+	"portcon tcp 50-1000 system_u:system_r:tcp_wide_t\n"
+	"portcon tcp 65535 system_u:system_r:tcp_top_t\n"
+	"portcon udp 0-65535 system_u:system_r:udp_all_t\n"
+	"nodecon 10.0.0.0 255.0.0.0 system_u:system_r:node_ten_t\n"
+	"nodecon 10.1.0.0 255.255.0.0 system_u:system_r:node_ten_one_t\n"
+	/* not a prefix: matches 192.168.*.1 */
+	"nodecon 192.168.0.1 255.255.0.255 system_u:system_r:node_odd_t\n"
+	"nodecon 0.0.0.0 0.0.0.0 system_u:system_r:node_any_t\n"
+	"nodecon 2001:db8:: ffff:ffff:: system_u:system_r:node6_doc_t\n"
+	"nodecon ::1 ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff system_u:system_r:node6_lo_t\n";
+
+static apol_policy_t *sp = NULL;
+static qpol_policy_t *qp = NULL;
+static apol_netcon_index_t *idx = NULL;
+
+static const char *netcon_context_type(const qpol_context_t * context)
+{
+	const qpol_type_t *type;
+	const char *name;
+	if (context == NULL || qpol_context_get_type(qp, context, &type) < 0 || qpol_type_get_name(qp, type, &name) < 0) {
+		return NULL;
+	}
+	return name;
+}
+
+static const char *portcon_type(const qpol_portcon_t * portcon)
+{
+	const qpol_context_t *context;
+	if (portcon == NULL || qpol_portcon_get_context(qp, portcon, &context) < 0) {
+		return NULL;
+	}
+	return netcon_context_type(context);
+}
+
+static const char *nodecon_type(const qpol_nodecon_t * nodecon)
+{
+	const qpol_context_t *context;
+	if (nodecon == NULL || qpol_nodecon_get_context(qp, nodecon, &context) < 0) {
+		return NULL;
+	}
+	return netcon_context_type(context);
+}
+
+/**
+ * Return 1 if a lookup found the statement whose context has the
+ * expected type, or found nothing when none was expected.
+ */
+static int netcon_type_is(const char *found, const char *expected)
+{
+	if (found == NULL || expected == NULL)
+		return found == expected;
+	return strcmp(found, expected) == 0;
+}
+
+/**
+ * Find the portcon for a port by walking every portcon in policy
+ * order, as the kernel does.
+ */
+static const qpol_portcon_t *portcon_linear_find(uint8_t protocol, uint16_t port)
+{
+	qpol_iterator_t *iter = NULL;
+	const qpol_portcon_t *found = NULL;
+	CU_ASSERT_FATAL(qpol_policy_get_portcon_iter(qp, &iter) == 0);
+	for (; found == NULL && !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_portcon_t *portcon;
+		uint16_t low, high;
+		uint8_t proto;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&portcon) == 0);
+		CU_ASSERT_FATAL(qpol_portcon_get_protocol(qp, portcon, &proto) == 0);
+		CU_ASSERT_FATAL(qpol_portcon_get_low_port(qp, portcon, &low) == 0);
+		CU_ASSERT_FATAL(qpol_portcon_get_high_port(qp, portcon, &high) == 0);
+		if (proto == protocol && low <= port && port <= high)
+			found = portcon;
+	}
+	qpol_iterator_destroy(&iter);
+	return found;
+}
+
+/**
+ * Find the type of the nodecon for an address by walking every
+ * nodecon in policy order, as the kernel does.
+ */
+static const char *nodecon_linear_find_type(int protocol, const uint32_t addr[4])
+{
+	qpol_iterator_t *iter = NULL;
+	const char *found = NULL;
+	size_t i, num_words = (protocol == QPOL_IPV4 ? 1 : 4);
+	CU_ASSERT_FATAL(qpol_policy_get_nodecon_iter(qp, &iter) == 0);
+	for (; found == NULL && !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_nodecon_t *nodecon;
+		uint32_t *n_addr, *n_mask;
+		unsigned char proto, proto_a, proto_m;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&nodecon) == 0);
+		CU_ASSERT_FATAL(qpol_nodecon_get_protocol(qp, nodecon, &proto) == 0);
+		CU_ASSERT_FATAL(qpol_nodecon_get_addr(qp, nodecon, &n_addr, &proto_a) == 0);
+		CU_ASSERT_FATAL(qpol_nodecon_get_mask(qp, nodecon, &n_mask, &proto_m) == 0);
+		if (proto == protocol) {
+			for (i = 0; i < num_words; i++) {
+				if ((addr[i] & n_mask[i]) != n_addr[i])
+					break;
+			}
+			if (i == num_words)
+				found = nodecon_type(nodecon);
+		}
+		free(nodecon);
+	}
+	qpol_iterator_destroy(&iter);
+	return found;
+}
+
+static void netcon_ports(void)
+{
+	struct
+	{
+		uint16_t port;
+		const char *type;
+	} tcp[] = {
+		{0, "tcp_zero_t"}, {1, NULL}, {49, NULL}, {50, "tcp_wide_t"}, {99, "tcp_wide_t"},
+		{100, "tcp_a_t"}, {149, "tcp_a_t"}, {150, "tcp_a_t"}, {200, "tcp_a_t"},
+		{201, "tcp_b_t"}, {300, "tcp_b_t"}, {301, "tcp_c_t"}, {400, "tcp_c_t"},
+		{401, "tcp_wide_t"}, {1000, "tcp_wide_t"}, {1001, NULL}, {65534, NULL}, {65535, "tcp_top_t"}
+	};
+	size_t i;
+
+	for (i = 0; i < sizeof(tcp) / sizeof(tcp[0]); i++) {
+		const qpol_portcon_t *portcon = apol_netcon_index_find_portcon(idx, IPPROTO_TCP, tcp[i].port);
+		CU_ASSERT(netcon_type_is(portcon_type(portcon), tcp[i].type));
+	}
+	CU_ASSERT(netcon_type_is(portcon_type(apol_netcon_index_find_portcon(idx, IPPROTO_UDP, 0)), "udp_all_t"));
+	CU_ASSERT(netcon_type_is(portcon_type(apol_netcon_index_find_portcon(idx, IPPROTO_UDP, 65535)), "udp_all_t"));
+	/* a protocol without any portcons */
+	CU_ASSERT_PTR_NULL(apol_netcon_index_find_portcon(idx, IPPROTO_ICMP, 0));
+	CU_ASSERT_PTR_NULL(apol_netcon_index_find_portcon(NULL, IPPROTO_TCP, 0));
+}
+
+static void netcon_ports_exhaustive(void)
+{
+	uint8_t protos[] = { IPPROTO_TCP, IPPROTO_UDP };
+	uint16_t *ports;
+	const qpol_portcon_t **results;
+	size_t i, n = (size_t) UINT16_MAX + 1, p;
+
+	ports = malloc(n * sizeof(*ports));
+	results = malloc(n * sizeof(*results));
+	CU_ASSERT_FATAL(ports != NULL && results != NULL);
+	/* give the batch lookup its ports in descending order, so that
+	 * it must sort them */
+	for (i = 0; i < n; i++)
+		ports[i] = (uint16_t) (UINT16_MAX - i);
+	for (p = 0; p < sizeof(protos) / sizeof(protos[0]); p++) {
+		CU_ASSERT_FATAL(apol_netcon_index_find_portcons(idx, protos[p], ports, n, results) == 0);
+		for (i = 0; i < n; i++) {
+			const qpol_portcon_t *expected = portcon_linear_find(protos[p], ports[i]);
+			CU_ASSERT(apol_netcon_index_find_portcon(idx, protos[p], ports[i]) == expected);
+			CU_ASSERT(results[i] == expected);
+		}
+	}
+	free(ports);
+	free(results);
+}
+
+static void netcon_nodes(void)
+{
+	struct
+	{
+		const char *addr;
+		const char *type;
+	} nodes[] = {
+		{"10.2.3.4", "node_ten_t"}, {"10.255.255.255", "node_ten_t"}, {"10.1.2.3", "node_ten_one_t"},
+		{"192.168.7.1", "node_odd_t"}, {"192.168.0.1", "node_odd_t"}, {"192.168.7.2", "node_any_t"},
+		{"192.169.7.1", "node_any_t"}, {"8.8.8.8", "node_any_t"}, {"0.0.0.0", "node_any_t"},
+		{"2001:db8::5", "node6_doc_t"}, {"2001:db8:ffff::1", "node6_doc_t"}, {"::1", "node6_lo_t"},
+		{"::2", NULL}, {"2001:db9::1", NULL}
+	};
+	uint32_t addr[4];
+	size_t i;
+	int proto;
+
+	for (i = 0; i < sizeof(nodes) / sizeof(nodes[0]); i++) {
+		CU_ASSERT_FATAL((proto = apol_str_to_internal_ip(nodes[i].addr, addr)) >= 0);
+		CU_ASSERT(netcon_type_is(nodecon_type(apol_netcon_index_find_nodecon(idx, proto, addr)), nodes[i].type));
+		CU_ASSERT(netcon_type_is(nodecon_linear_find_type(proto, addr), nodes[i].type));
+	}
+	CU_ASSERT_PTR_NULL(apol_netcon_index_find_nodecon(idx, QPOL_IPV6 + 1, addr));
+	CU_ASSERT_PTR_NULL(apol_netcon_index_find_nodecon(idx, QPOL_IPV4, NULL));
+}
+
+static void netcon_nodes_batch(void)
+{
+	const char *strs[] = {
+		"10.1.2.3", "192.168.200.1", "172.16.0.1", "10.0.0.0", "192.168.200.129", "255.255.255.255"
+	};
+	size_t i, num = sizeof(strs) / sizeof(strs[0]);
+	uint32_t addrs[sizeof(strs) / sizeof(strs[0])][4];
+	const qpol_nodecon_t *results[sizeof(strs) / sizeof(strs[0])];
+
+	for (i = 0; i < num; i++) {
+		CU_ASSERT_FATAL(apol_str_to_internal_ip(strs[i], addrs[i]) == QPOL_IPV4);
+	}
+	CU_ASSERT_FATAL(apol_netcon_index_find_nodecons(idx, QPOL_IPV4, (const uint32_t(*)[4])addrs, num, results) == 0);
+	for (i = 0; i < num; i++) {
+		CU_ASSERT(netcon_type_is(nodecon_type(results[i]), nodecon_linear_find_type(QPOL_IPV4, addrs[i])));
+	}
+}
+
+CU_TestInfo netcon_tests[] = {
+	{"port lookups", netcon_ports}
+	,
+	{"every port", netcon_ports_exhaustive}
+	,
+	{"node lookups", netcon_nodes}
+	,
+	{"node batch lookups", netcon_nodes_batch}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int netcon_init()
+{
+	char path[] = "/tmp/netcon-tests-XXXXXX";
+	apol_policy_path_t *ppath = NULL;
+	FILE *fp = NULL;
+	int fd, retval = 1;
+
+	if ((fd = mkstemp(path)) < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		goto cleanup;
+	}
+	if (fputs(netcon_policy, fp) == EOF) {
+		fclose(fp);
+		goto cleanup;
+	}
+	if (fclose(fp) != 0) {
+		goto cleanup;
+	}
+	if ((ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, path, NULL)) == NULL ||
+	    (sp = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL)) == NULL) {
+		goto cleanup;
+	}
+	qp = apol_policy_get_qpol(sp);
+	if ((idx = apol_netcon_index_create(sp)) == NULL) {
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	apol_policy_path_destroy(&ppath);
+	unlink(path);
+	return retval;
+}
+
+int netcon_cleanup()
+{
+	apol_netcon_index_destroy(&idx);
+	apol_policy_destroy(&sp);
+	return 0;
+}
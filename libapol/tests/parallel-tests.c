@@ -0,0 +1,104 @@
+/**
+ *  @file
+ *
+ *  Test running independent tasks across threads.
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/parallel.h>
+#include <errno.h>
+#include <string.h>
+
+#define PARALLEL_NUM_TASKS 10000
+
+/* each task writes only its own slot, as apol_parallel_run() asks */
+static unsigned char parallel_done[PARALLEL_NUM_TASKS];
+
+static int parallel_mark(void *arg, size_t task)
+{
+	size_t *fail_at = (size_t *) arg;
+	parallel_done[task]++;
+	if (fail_at != NULL && task == *fail_at) {
+		errno = ERANGE;
+		return -1;
+	}
+	return 0;
+}
+
+static void parallel_every_task(void)
+{
+	size_t num_threads[] = { 0, 1, 2, 7, 64 };
+	size_t i, j, num_done;
+	for (i = 0; i < sizeof(num_threads) / sizeof(num_threads[0]); i++) {
+		memset(parallel_done, 0, sizeof(parallel_done));
+		CU_ASSERT(apol_parallel_run(PARALLEL_NUM_TASKS, num_threads[i], parallel_mark, NULL) == 0);
+		for (j = 0, num_done = 0; j < PARALLEL_NUM_TASKS; j++) {
+			if (parallel_done[j] == 1)
+				num_done++;
+		}
+		CU_ASSERT(num_done == PARALLEL_NUM_TASKS);
+	}
+	CU_ASSERT(apol_parallel_run(0, 4, parallel_mark, NULL) == 0);
+	CU_ASSERT(apol_parallel_get_num_cpus() >= 1);
+}
+
+static void parallel_failed_task(void)
+{
+	size_t fail_at = PARALLEL_NUM_TASKS / 2, j;
+	int ran_twice = 0;
+
+	/* on one thread the tasks run in order and stop at the failure */
+	memset(parallel_done, 0, sizeof(parallel_done));
+	errno = 0;
+	CU_ASSERT(apol_parallel_run(PARALLEL_NUM_TASKS, 1, parallel_mark, &fail_at) < 0);
+	CU_ASSERT(errno == ERANGE);
+	CU_ASSERT(parallel_done[fail_at] == 1 && parallel_done[fail_at + 1] == 0);
+
+	memset(parallel_done, 0, sizeof(parallel_done));
+	errno = 0;
+	CU_ASSERT(apol_parallel_run(PARALLEL_NUM_TASKS, 4, parallel_mark, &fail_at) < 0);
+	CU_ASSERT(errno == ERANGE);
+	for (j = 0; j < PARALLEL_NUM_TASKS; j++) {
+		if (parallel_done[j] > 1)
+			ran_twice = 1;
+	}
+	CU_ASSERT(!ran_twice);
+
+	CU_ASSERT(apol_parallel_run(1, 1, NULL, NULL) < 0 && errno == EINVAL);
+}
+
+CU_TestInfo parallel_tests[] = {
+	{"every task runs once", parallel_every_task}
+	,
+	{"failed task", parallel_failed_task}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int parallel_init()
+{
+	return 0;
+}
+
+int parallel_cleanup()
+{
+	return 0;
+}
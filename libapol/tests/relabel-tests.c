@@ -0,0 +1,185 @@
+/**
+ *  @file
+ *
+ *  Test the relabel analysis code.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/relabel-analysis.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define BIG_POLICY TEST_POLICIES "/snapshots/fc4_targeted.policy.conf"
+
+/* number of types from a bulk analysis to recheck individually */
+#define RELABEL_RECHECK 16
+
+static apol_policy_t *p = NULL;
+
+/**
+ * Check that a single type's results from a bulk analysis agree with
+ * running the analysis for just that type.
+ */
+static void relabel_compare_to_single(apol_relabel_analysis_t * r, const apol_relabel_bulk_result_t * bulk)
+{
+	const char *name;
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const apol_vector_t *bulk_v = apol_relabel_bulk_result_get_results(bulk);
+	apol_vector_t *v = NULL;
+
+	int retval = qpol_type_get_name(q, apol_relabel_bulk_result_get_start_type(bulk), &name);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_relabel_analysis_set_type(p, r, name);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_relabel_analysis_do(p, r, &v);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), apol_vector_get_size(bulk_v));
+	for (size_t i = 0; i < apol_vector_get_size(v) && i < apol_vector_get_size(bulk_v); i++) {
+		const apol_relabel_result_t *a = apol_vector_get_element(v, i);
+		const apol_relabel_result_t *b = apol_vector_get_element(bulk_v, i);
+		CU_ASSERT(apol_relabel_result_get_result_type(a) == apol_relabel_result_get_result_type(b));
+		CU_ASSERT(apol_relabel_result_get_result_type(a) != apol_relabel_bulk_result_get_start_type(bulk));
+		CU_ASSERT_EQUAL(apol_vector_get_size(apol_relabel_result_get_to(a)),
+				apol_vector_get_size(apol_relabel_result_get_to(b)));
+		CU_ASSERT_EQUAL(apol_vector_get_size(apol_relabel_result_get_from(a)),
+				apol_vector_get_size(apol_relabel_result_get_from(b)));
+		CU_ASSERT_EQUAL(apol_vector_get_size(apol_relabel_result_get_both(a)),
+				apol_vector_get_size(apol_relabel_result_get_both(b)));
+	}
+	apol_vector_destroy(&v);
+}
+
+static void relabel_bulk(unsigned int dir)
+{
+	apol_relabel_analysis_t *r = apol_relabel_analysis_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+	int retval = apol_relabel_analysis_set_dir(p, r, dir);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	apol_vector_t *v = NULL;
+	retval = apol_relabel_analysis_do_all(p, r, &v);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(apol_vector_get_size(v) > 0);
+
+	for (size_t i = 0; i < apol_vector_get_size(v); i++) {
+		const apol_relabel_bulk_result_t *bulk = apol_vector_get_element(v, i);
+		const apol_vector_t *results = apol_relabel_bulk_result_get_results(bulk);
+		CU_ASSERT(apol_vector_get_size(results) > 0);
+		for (size_t j = 0; j < apol_vector_get_size(results); j++) {
+			const apol_relabel_result_t *res = apol_vector_get_element(results, j);
+			const apol_vector_t *to = apol_relabel_result_get_to(res);
+			for (size_t k = 0; k < apol_vector_get_size(to); k++) {
+				const apol_relabel_result_pair_t *pair = apol_vector_get_element(to, k);
+				CU_ASSERT_PTR_NOT_NULL(apol_relabel_result_pair_get_ruleA(pair));
+				if (dir == APOL_RELABEL_DIR_SUBJECT) {
+					CU_ASSERT_PTR_NULL(apol_relabel_result_pair_get_ruleB(pair));
+				} else {
+					CU_ASSERT_PTR_NOT_NULL(apol_relabel_result_pair_get_ruleB(pair));
+					CU_ASSERT_PTR_NOT_NULL(apol_relabel_result_pair_get_intermediate_type(pair));
+				}
+			}
+		}
+		if (i < RELABEL_RECHECK) {
+			relabel_compare_to_single(r, bulk);
+		}
+	}
+	apol_vector_destroy(&v);
+	apol_relabel_analysis_destroy(&r);
+}
+
+static void relabel_subject_bulk(void)
+{
+	relabel_bulk(APOL_RELABEL_DIR_SUBJECT);
+}
+
+static void relabel_object_bulk(void)
+{
+	relabel_bulk(APOL_RELABEL_DIR_BOTH);
+}
+
+static void relabel_prebuilt_table(void)
+{
+	apol_relabel_analysis_t *r = apol_relabel_analysis_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+	int retval = apol_relabel_analysis_set_dir(p, r, APOL_RELABEL_DIR_BOTH);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_relabel_analysis_append_class(p, r, "file");
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	/* results must not depend upon whether the index was built in advance */
+	apol_vector_t *before = NULL, *after = NULL;
+	retval = apol_relabel_analysis_do_all(p, r, &before);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_policy_build_relabel_table(p);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_relabel_analysis_do_all(p, r, &after);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	CU_ASSERT(apol_vector_get_size(before) > 0);
+	CU_ASSERT_EQUAL(apol_vector_get_size(before), apol_vector_get_size(after));
+	for (size_t i = 0; i < apol_vector_get_size(before) && i < apol_vector_get_size(after); i++) {
+		const apol_relabel_bulk_result_t *a = apol_vector_get_element(before, i);
+		const apol_relabel_bulk_result_t *b = apol_vector_get_element(after, i);
+		CU_ASSERT(apol_relabel_bulk_result_get_start_type(a) == apol_relabel_bulk_result_get_start_type(b));
+		CU_ASSERT_EQUAL(apol_vector_get_size(apol_relabel_bulk_result_get_results(a)),
+				apol_vector_get_size(apol_relabel_bulk_result_get_results(b)));
+	}
+	apol_vector_destroy(&before);
+	apol_vector_destroy(&after);
+	apol_relabel_analysis_destroy(&r);
+}
+
+CU_TestInfo relabel_tests[] = {
+	{"relabel subject bulk", relabel_subject_bulk}
+	,
+	{"relabel object bulk", relabel_object_bulk}
+	,
+	{"relabel prebuilt table", relabel_prebuilt_table}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int relabel_init()
+{
+	apol_policy_path_t *ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, BIG_POLICY, NULL);
+	if (ppath == NULL) {
+		return 1;
+	}
+
+	if ((p = apol_policy_create_from_policy_path(ppath, QPOL_POLICY_OPTION_NO_NEVERALLOWS, NULL, NULL)) == NULL) {
+		apol_policy_path_destroy(&ppath);
+		return 1;
+	}
+	apol_policy_path_destroy(&ppath);
+
+	return 0;
+}
+
+int relabel_cleanup()
+{
+	apol_policy_destroy(&p);
+	return 0;
+}
@@ -29,6 +29,8 @@
 #include <apol/role-query.h>
 #include <apol/policy.h>
 #include <apol/policy-path.h>
+#include <apol/rbac-analysis.h>
+#include <apol/user-query.h>
 #include <stdbool.h>
 
 #define SOURCE_POLICY TEST_POLICIES "/setools/apol/role_dom.conf"
@@ -121,11 +123,87 @@ static void role_regex(void)
 	apol_role_query_destroy(&q);
 }
 
+static void role_reach(void)
+{
+	apol_rbac_reach_t *r = apol_rbac_reach_create(sp);
+	apol_vector_t *roles = NULL, *users = NULL;
+	size_t i, j;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+
+	/* a role has every type that the policy lists for it */
+	CU_ASSERT_FATAL(apol_role_get_by_query(sp, NULL, &roles) == 0);
+	for (i = 0; i < apol_vector_get_size(roles); i++) {
+		const qpol_role_t *role = apol_vector_get_element(roles, i);
+		const apol_bitmap_t *types = apol_rbac_reach_get_role_types(r, role);
+		const apol_bitmap_t *closure = apol_rbac_reach_get_role_closure(r, role);
+		qpol_iterator_t *iter = NULL;
+		uint32_t value;
+		CU_ASSERT_PTR_NOT_NULL_FATAL(types);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(closure);
+		CU_ASSERT_FATAL(qpol_role_get_type_iter(qp, role, &iter) == 0);
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			const qpol_type_t *type;
+			unsigned char isattr;
+			CU_ASSERT(qpol_iterator_get_item(iter, (void **)&type) == 0);
+			CU_ASSERT(qpol_type_get_isattr(qp, type, &isattr) == 0);
+			CU_ASSERT(qpol_type_get_value(qp, type, &value) == 0);
+			CU_ASSERT(isattr || apol_bitmap_get(types, value));
+		}
+		qpol_iterator_destroy(&iter);
+		CU_ASSERT(qpol_role_get_value(qp, role, &value) == 0);
+		CU_ASSERT(apol_bitmap_get(closure, value));
+
+		/* the closure holds everything its roles reach */
+		for (j = 0; j < apol_vector_get_size(roles); j++) {
+			const qpol_role_t *other = apol_vector_get_element(roles, j);
+			CU_ASSERT(qpol_role_get_value(qp, other, &value) == 0);
+			if (apol_bitmap_get(closure, value)) {
+				CU_ASSERT(apol_bitmap_is_subset(apol_rbac_reach_get_role_closure(r, other), closure));
+			}
+		}
+	}
+
+	/* a user reaches the types of all of its roles, and from one
+	 * role at most that many */
+	CU_ASSERT_FATAL(apol_user_get_by_query(sp, NULL, &users) == 0);
+	CU_ASSERT_FATAL(apol_vector_get_size(users) > 0);
+	for (i = 0; i < apol_vector_get_size(users); i++) {
+		const qpol_user_t *user = apol_vector_get_element(users, i);
+		const apol_bitmap_t *user_roles = apol_rbac_reach_get_user_roles(r, user);
+		const apol_bitmap_t *user_types = apol_rbac_reach_get_user_types(r, user);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(user_roles);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(user_types);
+		for (j = 0; j < apol_vector_get_size(roles); j++) {
+			const qpol_role_t *role = apol_vector_get_element(roles, j);
+			apol_bitmap_t *reached_roles = NULL, *reached_types = NULL;
+			uint32_t value;
+			CU_ASSERT(qpol_role_get_value(qp, role, &value) == 0);
+			CU_ASSERT_FATAL(apol_rbac_reach_get_user_reachable_types(r, user, role, &reached_roles, &reached_types) == 0);
+			CU_ASSERT(apol_bitmap_is_subset(reached_roles, user_roles));
+			CU_ASSERT(apol_bitmap_is_subset(reached_types, user_types));
+			if (apol_bitmap_get(user_roles, value)) {
+				CU_ASSERT(apol_bitmap_is_subset(apol_rbac_reach_get_role_types(r, role), reached_types));
+			} else {
+				CU_ASSERT(apol_bitmap_count(reached_roles) == 0);
+			}
+			apol_bitmap_destroy(&reached_roles);
+			apol_bitmap_destroy(&reached_types);
+		}
+	}
+
+	apol_vector_destroy(&users);
+	apol_vector_destroy(&roles);
+	apol_rbac_reach_destroy(&r);
+	CU_ASSERT_PTR_NULL(r);
+}
+
 CU_TestInfo role_tests[] = {
 	{"basic query", role_basic}
 	,
 	{"regex query", role_regex}
 	,
+	{"RBAC reachability", role_reach}
+	,
 	CU_TEST_INFO_NULL
 };
 
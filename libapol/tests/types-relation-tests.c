@@ -0,0 +1,187 @@
+/**
+ *  @file
+ *
+ *  Test the types relation matrix against the two types relationship
+ *  analysis.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/types-relation-analysis.h>
+#include <apol/vector.h>
+
+#define SOURCE_POLICY TEST_POLICIES "/setools-3.3/rules/rules-mls.conf"
+
+/** number of rows (and columns) of the matrix to spot check */
+#define TR_NUM_SAMPLES 8
+
+static apol_policy_t *sp = NULL;
+static qpol_policy_t *qp = NULL;
+
+static const unsigned int tr_features[] = {
+	APOL_TYPES_RELATION_COMMON_ATTRIBS, APOL_TYPES_RELATION_COMMON_ROLES,
+	APOL_TYPES_RELATION_COMMON_USERS, APOL_TYPES_RELATION_SIMILAR_ACCESS
+};
+
+/**
+ * Run the two types relationship analysis on two rows of a matrix and
+ * check that each count the matrix holds for that cell matches.
+ */
+static void tr_check_cell(apol_types_relation_matrix_t * m, size_t i, size_t j)
+{
+	apol_types_relation_analysis_t *tr = apol_types_relation_analysis_create();
+	apol_types_relation_result_t *r = NULL;
+	const char *first, *other;
+	size_t f, expected = 0;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(tr);
+
+	CU_ASSERT_FATAL(qpol_type_get_name(qp, apol_types_relation_matrix_get_type(m, i), &first) == 0);
+	CU_ASSERT_FATAL(qpol_type_get_name(qp, apol_types_relation_matrix_get_type(m, j), &other) == 0);
+	CU_ASSERT(apol_types_relation_analysis_set_first_type(sp, tr, first) == 0);
+	CU_ASSERT(apol_types_relation_analysis_set_other_type(sp, tr, other) == 0);
+	CU_ASSERT(apol_types_relation_analysis_set_analyses(sp, tr,
+							    APOL_TYPES_RELATION_COMMON_ATTRIBS | APOL_TYPES_RELATION_COMMON_ROLES |
+							    APOL_TYPES_RELATION_COMMON_USERS | APOL_TYPES_RELATION_SIMILAR_ACCESS) == 0);
+	CU_ASSERT_FATAL(apol_types_relation_analysis_do(sp, tr, &r) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+
+	for (f = 0; f < sizeof(tr_features) / sizeof(tr_features[0]); f++) {
+		switch (tr_features[f]) {
+		case APOL_TYPES_RELATION_COMMON_ATTRIBS:
+			expected = apol_vector_get_size(apol_types_relation_result_get_attributes(r));
+			break;
+		case APOL_TYPES_RELATION_COMMON_ROLES:
+			expected = apol_vector_get_size(apol_types_relation_result_get_roles(r));
+			break;
+		case APOL_TYPES_RELATION_COMMON_USERS:
+			expected = apol_vector_get_size(apol_types_relation_result_get_users(r));
+			break;
+		case APOL_TYPES_RELATION_SIMILAR_ACCESS:
+			expected = apol_vector_get_size(apol_types_relation_result_get_similar_first(r));
+			break;
+		}
+		CU_ASSERT(apol_types_relation_matrix_get_common(m, i, j, tr_features[f]) == expected);
+		/* the matrix is symmetric */
+		CU_ASSERT(apol_types_relation_matrix_get_common(m, j, i, tr_features[f]) == expected);
+	}
+	apol_types_relation_result_destroy(&r);
+	apol_types_relation_analysis_destroy(&tr);
+}
+
+static void tr_matrix_all_types(void)
+{
+	apol_types_relation_analysis_t *tr = apol_types_relation_analysis_create();
+	apol_types_relation_matrix_t *m = NULL;
+	size_t n, i, j, step;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(tr);
+
+	CU_ASSERT_FATAL(apol_types_relation_matrix_do(sp, tr, &m) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	n = apol_types_relation_matrix_get_size(m);
+	CU_ASSERT_FATAL(n > 1);
+
+	/* spot check cells spread across the whole matrix, including
+	 * the diagonal and both ends of the packed triangle */
+	step = n / TR_NUM_SAMPLES;
+	if (step == 0) {
+		step = 1;
+	}
+	for (i = 0; i < n; i += step) {
+		for (j = i; j < n; j += step) {
+			tr_check_cell(m, i, j);
+		}
+		tr_check_cell(m, i, n - 1);
+	}
+	for (i = 0; i < n; i += step) {
+		double s = apol_types_relation_matrix_get_similarity(m, i, i);
+		CU_ASSERT(s == 0.0 || s == 1.0);
+		CU_ASSERT(apol_types_relation_matrix_get_similarity(m, i, n - 1) ==
+			  apol_types_relation_matrix_get_similarity(m, n - 1, i));
+	}
+
+	apol_types_relation_matrix_destroy(&m);
+	CU_ASSERT_PTR_NULL(m);
+	apol_types_relation_analysis_destroy(&tr);
+}
+
+static void tr_matrix_appended_types(void)
+{
+	apol_types_relation_analysis_t *tr = apol_types_relation_analysis_create();
+	apol_types_relation_matrix_t *all = NULL, *m = NULL;
+	const char *first, *last;
+	size_t n;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(tr);
+
+	CU_ASSERT_FATAL(apol_types_relation_matrix_do(sp, tr, &all) == 0);
+	n = apol_types_relation_matrix_get_size(all);
+	CU_ASSERT_FATAL(n > 1);
+	CU_ASSERT_FATAL(qpol_type_get_name(qp, apol_types_relation_matrix_get_type(all, n - 1), &first) == 0);
+	CU_ASSERT_FATAL(qpol_type_get_name(qp, apol_types_relation_matrix_get_type(all, 0), &last) == 0);
+
+	/* a two row matrix must agree with the analysis regardless of
+	 * the order in which its types were given */
+	CU_ASSERT(apol_types_relation_analysis_append_type(sp, tr, first) == 0);
+	CU_ASSERT(apol_types_relation_analysis_append_type(sp, tr, last) == 0);
+	CU_ASSERT_FATAL(apol_types_relation_matrix_do(sp, tr, &m) == 0);
+	CU_ASSERT_FATAL(apol_types_relation_matrix_get_size(m) == 2);
+	tr_check_cell(m, 0, 1);
+	tr_check_cell(m, 0, 0);
+
+	apol_types_relation_matrix_destroy(&m);
+
+	CU_ASSERT(apol_types_relation_analysis_append_type(sp, tr, "not_in_the_policy_t") == 0);
+	CU_ASSERT(apol_types_relation_matrix_do(sp, tr, &m) < 0);
+	CU_ASSERT_PTR_NULL(m);
+
+	apol_types_relation_matrix_destroy(&all);
+	apol_types_relation_analysis_destroy(&tr);
+}
+
+CU_TestInfo types_relation_tests[] = {
+	{"matrix of all types", tr_matrix_all_types}
+	,
+	{"matrix of appended types", tr_matrix_appended_types}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int types_relation_init()
+{
+	apol_policy_path_t *ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, SOURCE_POLICY, NULL);
+	if (ppath == NULL) {
+		return 1;
+	}
+
+	if ((sp = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL)) == NULL) {
+		apol_policy_path_destroy(&ppath);
+		return 1;
+	}
+	apol_policy_path_destroy(&ppath);
+	qp = apol_policy_get_qpol(sp);
+	return 0;
+}
+
+int types_relation_cleanup()
+{
+	apol_policy_destroy(&sp);
+	return 0;
+}
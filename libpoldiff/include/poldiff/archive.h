@@ -0,0 +1,242 @@
+/**
+ *  @file
+ *  Public interface for writing poldiff results to, and reading them
+ *  back from, a compact binary archive.
+ *
+ *  An archive begins with the eight bytes "PDARCHV\0" and a format
+ *  version byte.  A sequence of records follows, each introduced by
+ *  one tag byte; all integers are unsigned LEB128 varints.
+ *  <ul>
+ *  <li>'S' adds a string to the string table: its length, then its
+ *  bytes.  Strings are numbered from 0 in order of appearance.
+ *  <li>'I' holds one difference: the bit number of its component's
+ *  POLDIFF_DIFF_* flag, its form, its number of fields and their
+ *  string numbers, then its number of permissions and, for each,
+ *  (string number << 2 | change), where change is 0 for unmodified,
+ *  1 for added, and 2 for removed.
+ *  <li>'E' ends the archive, giving the number of strings and of
+ *  differences written.
+ *  </ul>
+ *  A string is written only before the first difference that uses
+ *  it, so an archive may be written while poldiff_run() is still
+ *  finding differences.
+ *
+ *  AV rules have the fields source, target, class, conditional
+ *  expression, and branch ("TRUE", "FALSE", or "" if unconditional),
+ *  plus their permissions.  TE rules have the same fields followed by
+ *  the original and modified default types ("" if none).  Every other
+ *  kind of difference has one field, its poldiff_*_to_string() text.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef POLDIFF_ARCHIVE_H
+#define POLDIFF_ARCHIVE_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <poldiff/poldiff.h>
+#include <stdio.h>
+#include <stdint.h>
+
+	typedef struct poldiff_archive_writer poldiff_archive_writer_t;
+	typedef struct poldiff_archive poldiff_archive_t;
+	typedef struct poldiff_archive_item poldiff_archive_item_t;
+
+/**
+ *  Start writing an archive of poldiff results to a stream.  The
+ *  archive's header is written immediately.
+ *
+ *  @param diff Policy difference structure whose results will be
+ *  written.  It is also used for error reporting.
+ *  @param fp Stream to which to write.  It must remain open until
+ *  poldiff_archive_writer_close().
+ *
+ *  @return A new archive writer, or NULL on error; if the call fails,
+ *  errno will be set.  The caller must call
+ *  poldiff_archive_writer_close() afterwards.
+ */
+	extern poldiff_archive_writer_t *poldiff_archive_writer_create(const poldiff_t * diff, FILE * fp);
+
+/**
+ *  Append one difference to an archive.  This has the signature of a
+ *  poldiff_item_fn_t, so that giving it and the writer to
+ *  poldiff_set_item_callback() writes each difference as soon as
+ *  poldiff_run() finds it.
+ *
+ *  @param writer Archive writer (poldiff_archive_writer_t *).
+ *  @param diff Policy difference structure from which the item came.
+ *  @param which Flag (one of POLDIFF_DIFF_*) for the item's component.
+ *  @param item The difference item to write.
+ *
+ *  @return 0 on success, < 0 on error; if the call fails, errno will
+ *  be set.
+ */
+	extern int poldiff_archive_write_item(void *writer, const poldiff_t * diff, uint32_t which, const void *item);
+
+/**
+ *  Append every difference that has been kept for the given
+ *  components to an archive.  Components that have not been run are
+ *  skipped.
+ *
+ *  @param writer Archive writer.
+ *  @param flags Bit-wise or'd set of POLDIFF_DIFF_* from poldiff.h.
+ *
+ *  @return 0 on success, < 0 on error; if the call fails, errno will
+ *  be set.
+ */
+	extern int poldiff_archive_write_results(poldiff_archive_writer_t * writer, uint32_t flags);
+
+/**
+ *  Finish an archive by writing its end record, flush the stream, and
+ *  free the writer.  The stream itself is not closed.
+ *
+ *  @param writer Reference to the archive writer.  This pointer will
+ *  be set to NULL afterwards.
+ *
+ *  @return 0 on success, < 0 on error; if the call fails, errno will
+ *  be set.  The writer is freed either way.
+ */
+	extern int poldiff_archive_writer_close(poldiff_archive_writer_t ** writer);
+
+/**
+ *  Load an archive written by poldiff_archive_writer_create() and
+ *  friends.  No policies are needed to read or query it.
+ *
+ *  @param fp Stream from which to read, positioned at the start of
+ *  the archive.
+ *
+ *  @return The loaded archive, or NULL on error; if the call fails,
+ *  errno will be set.  The caller must call
+ *  poldiff_archive_destroy() afterwards.
+ */
+	extern poldiff_archive_t *poldiff_archive_read(FILE * fp);
+
+/**
+ *  Free all memory used by a loaded archive.
+ *
+ *  @param archive Reference to the archive to destroy.  This pointer
+ *  will be set to NULL afterwards.
+ */
+	extern void poldiff_archive_destroy(poldiff_archive_t ** archive);
+
+/**
+ *  Get the number of differences within a loaded archive.
+ *
+ *  @param archive Archive to query.
+ *
+ *  @return Number of differences.
+ */
+	extern size_t poldiff_archive_get_num_items(const poldiff_archive_t * archive);
+
+/**
+ *  Get one difference from a loaded archive, in the order written.
+ *
+ *  @param archive Archive to query.
+ *  @param i Index of the difference.
+ *
+ *  @return The difference, or NULL if i is out of range.  The caller
+ *  must not free it.
+ */
+	extern const poldiff_archive_item_t *poldiff_archive_get_item(const poldiff_archive_t * archive, size_t i);
+
+/**
+ *  Get the number of differences of each form within a loaded
+ *  archive, as poldiff_get_stats() does for a policy difference
+ *  structure.
+ *
+ *  @param archive Archive to query.
+ *  @param flags Bit-wise or'd set of POLDIFF_DIFF_* for the
+ *  components to count.
+ *  @param stats Array into which to write the numbers (array must be
+ *  pre-allocated).  The order of the values written to the array is
+ *  as follows: number of items of form POLDIFF_FORM_ADDED, number of
+ *  POLDIFF_FORM_REMOVED, number of POLDIFF_FORM_MODIFIED, number of
+ *  POLDIFF_FORM_ADD_TYPE, and number of POLDIFF_FORM_REMOVE_TYPE.
+ */
+	extern void poldiff_archive_get_stats(const poldiff_archive_t * archive, uint32_t flags, size_t stats[5]);
+
+/**
+ *  Get the component of an archived difference.
+ *
+ *  @param item Archived difference.
+ *
+ *  @return Flag (one of POLDIFF_DIFF_*) for the item's component.
+ */
+	extern uint32_t poldiff_archive_item_get_component(const poldiff_archive_item_t * item);
+
+/**
+ *  Get the form of an archived difference.
+ *
+ *  @param item Archived difference.
+ *
+ *  @return Form of the difference.
+ */
+	extern poldiff_form_e poldiff_archive_item_get_form(const poldiff_archive_item_t * item);
+
+/**
+ *  Get the number of fields of an archived difference.
+ *
+ *  @param item Archived difference.
+ *
+ *  @return Number of fields.
+ */
+	extern size_t poldiff_archive_item_get_num_fields(const poldiff_archive_item_t * item);
+
+/**
+ *  Get one field of an archived difference.
+ *
+ *  @param item Archived difference.
+ *  @param i Index of the field.
+ *
+ *  @return The field's string, or NULL if i is out of range.  The
+ *  caller must not free it.
+ */
+	extern const char *poldiff_archive_item_get_field(const poldiff_archive_item_t * item, size_t i);
+
+/**
+ *  Get the number of permissions of an archived difference.  Only AV
+ *  rules have permissions.
+ *
+ *  @param item Archived difference.
+ *
+ *  @return Number of permissions.
+ */
+	extern size_t poldiff_archive_item_get_num_perms(const poldiff_archive_item_t * item);
+
+/**
+ *  Get one permission of an archived difference.
+ *
+ *  @param item Archived difference.
+ *  @param i Index of the permission.
+ *  @param change If not NULL, reference to how the permission
+ *  changed: POLDIFF_FORM_ADDED, POLDIFF_FORM_REMOVED, or
+ *  POLDIFF_FORM_NONE if it is unmodified.
+ *
+ *  @return The permission's name, or NULL if i is out of range.  The
+ *  caller must not free it.
+ */
+	extern const char *poldiff_archive_item_get_perm(const poldiff_archive_item_t * item, size_t i, poldiff_form_e * change);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif				       /* POLDIFF_ARCHIVE_H */
@@ -0,0 +1,172 @@
+/**
+ *  @file
+ *  Public interface for comparing one baseline policy against many
+ *  variant policies at once.  Every difference found between the
+ *  baseline and any variant becomes one entry, identified by its
+ *  component and a key; each entry records, as bitmaps indexed by
+ *  variant number, which variants add, remove, or modify it.
+ *
+ *  Each variant is compared with the baseline in its own two-way
+ *  pass, one after another.  The baseline's expanded AV and TE rules
+ *  are kept between passes and reused by each variant whose type map
+ *  numbers the baseline's types as the previous one did (see
+ *  poldiff_set_keep_baseline()); otherwise they are expanded again.
+ *  There is no type map spanning all of the policies, and pseudo-type
+ *  values differ from one pass to the next, so entries are matched
+ *  across variants by rendered names rather than by pseudo-types.
+ *
+ *  Keys are the item's name for symbols, "source target" for role
+ *  transitions, "source target : class" for range transitions, and
+ *  "source target : class" followed by "  [expression]:TRUE" or
+ *  ":FALSE" for conditional AV and TE rules.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef POLDIFF_NWAY_H
+#define POLDIFF_NWAY_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <poldiff/poldiff.h>
+#include <apol/bitmap.h>
+#include <apol/vector.h>
+#include <stdint.h>
+
+	typedef struct poldiff_nway poldiff_nway_t;
+	typedef struct poldiff_nway_entry poldiff_nway_entry_t;
+
+/**
+ *  Allocate a new N-way comparison against a baseline policy.  This
+ *  function takes ownership of the baseline, which is loaded once and
+ *  kept for every variant (see poldiff_set_mod_policy()).
+ *
+ *  @param baseline The baseline ("original") policy.
+ *  @param num_variants Number of variants that will be added.
+ *  @param fn Function to be called by the error handler.  If NULL
+ *  then write messages to standard error.
+ *  @param callback_arg Argument for the callback.
+ *
+ *  @return A new N-way comparison, or NULL on error; if the call
+ *  fails, errno will be set.  The caller must call
+ *  poldiff_nway_destroy() afterwards.
+ */
+	extern poldiff_nway_t *poldiff_nway_create(apol_policy_t * baseline, size_t num_variants, poldiff_handle_fn_t fn,
+						   void *callback_arg);
+
+/**
+ *  Free all memory used by an N-way comparison, including its
+ *  baseline policy.
+ *
+ *  @param nway Reference to the comparison to destroy.  This pointer
+ *  will be set to NULL afterwards.
+ */
+	extern void poldiff_nway_destroy(poldiff_nway_t ** nway);
+
+/**
+ *  Compare the next variant against the baseline and record its
+ *  differences.  Variants are numbered from 0 in the order added.
+ *  Only one variant is held in memory at a time; this function takes
+ *  ownership of the variant and destroys it before the next one is
+ *  added or the comparison is destroyed.
+ *
+ *  @param nway N-way comparison to which to add.
+ *  @param variant The variant ("modified") policy.
+ *  @param flags Bit-wise or'd set of POLDIFF_DIFF_* from poldiff.h
+ *  for the components to compare.
+ *
+ *  @return The variant's number on success, or < 0 on error; if the
+ *  call fails, errno will be set and the only defined operation on
+ *  the comparison is poldiff_nway_destroy().  The variant is owned by
+ *  the comparison even upon failure.
+ */
+	extern int poldiff_nway_add_variant(poldiff_nway_t * nway, apol_policy_t * variant, uint32_t flags);
+
+/**
+ *  Get the number of variants added so far.
+ *
+ *  @param nway N-way comparison to query.
+ *
+ *  @return Number of variants.
+ */
+	extern size_t poldiff_nway_get_num_variants(const poldiff_nway_t * nway);
+
+/**
+ *  Get every entry of an N-way comparison, sorted by component and
+ *  then by key.
+ *
+ *  @param nway N-way comparison to query.
+ *
+ *  @return Vector of entries (poldiff_nway_entry_t *), or NULL on
+ *  error.  The caller must not modify or destroy the vector; it is
+ *  invalidated by poldiff_nway_add_variant().
+ */
+	extern const apol_vector_t *poldiff_nway_get_entries(const poldiff_nway_t * nway);
+
+/**
+ *  Find the entry for one item.
+ *
+ *  @param nway N-way comparison to query.
+ *  @param which Flag (one of POLDIFF_DIFF_*) for the item's
+ *  component.
+ *  @param key Key of the item, as described above.
+ *
+ *  @return The entry, or NULL if no variant differs from the baseline
+ *  in that item.  The caller must not free it.
+ */
+	extern const poldiff_nway_entry_t *poldiff_nway_get_entry(const poldiff_nway_t * nway, uint32_t which, const char *key);
+
+/**
+ *  Get the component of an N-way entry.
+ *
+ *  @param entry Entry to query.
+ *
+ *  @return Flag (one of POLDIFF_DIFF_*) for the entry's component.
+ */
+	extern uint32_t poldiff_nway_entry_get_component(const poldiff_nway_entry_t * entry);
+
+/**
+ *  Get the key of an N-way entry.
+ *
+ *  @param entry Entry to query.
+ *
+ *  @return The entry's key.  The caller must not free it.
+ */
+	extern const char *poldiff_nway_entry_get_key(const poldiff_nway_entry_t * entry);
+
+/**
+ *  Get which variants differ from the baseline in an entry's item, in
+ *  the given way.  POLDIFF_FORM_ADD_TYPE and POLDIFF_FORM_REMOVE_TYPE
+ *  are recorded as POLDIFF_FORM_ADDED and POLDIFF_FORM_REMOVED.
+ *
+ *  @param entry Entry to query.
+ *  @param form One of POLDIFF_FORM_ADDED, POLDIFF_FORM_REMOVED, or
+ *  POLDIFF_FORM_MODIFIED.
+ *
+ *  @return Bitmap in which bit v is set if variant v differs that
+ *  way, or NULL on error.  The caller must not modify or destroy it.
+ */
+	extern const apol_bitmap_t *poldiff_nway_entry_get_variants(const poldiff_nway_entry_t * entry, poldiff_form_e form);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif				       /* POLDIFF_NWAY_H */
@@ -72,6 +72,61 @@ extern "C"
 
 	typedef void (*poldiff_handle_fn_t) (void *arg, const poldiff_t * diff, int level, const char *fmt, va_list va_args);
 
+/**
+ *  Callback function signature for receiving each difference as soon
+ *  as poldiff_run() finds it; see poldiff_set_item_callback().
+ *
+ *  @param arg Argument given to poldiff_set_item_callback().
+ *  @param diff The policy difference structure being run.
+ *  @param which Flag (one of POLDIFF_DIFF_*) for the component to
+ *  which the item belongs.  Pass this to
+ *  poldiff_get_component_record() to obtain the functions that
+ *  operate upon the item.
+ *  @param item The difference item, such as a poldiff_avrule_t.  It
+ *  is destroyed after the callback returns.
+ *
+ *  @return 0 to continue, or < 0 to stop poldiff_run() with an error.
+ */
+	typedef int (*poldiff_item_fn_t) (void *arg, const poldiff_t * diff, uint32_t which, const void *item);
+
+/**
+ *  Phases of work done by poldiff_run() and poldiff_set_mod_policy(),
+ *  reported through poldiff_set_phase_callback().
+ */
+	typedef enum poldiff_phase
+	{
+	/** rebuild the original policy with the rules requested */
+		POLDIFF_PHASE_LOAD_ORIG = 0,
+	/** rebuild the modified policy with the rules requested */
+		POLDIFF_PHASE_LOAD_MOD,
+	/** discard a component's results after the policies or the
+	 *  type map changed */
+		POLDIFF_PHASE_RESET,
+	/** infer or rebuild the type map */
+		POLDIFF_PHASE_TYPE_MAP,
+	/** get a component's items from the original policy */
+		POLDIFF_PHASE_ORIG_ITEMS,
+	/** get a component's items from the modified policy */
+		POLDIFF_PHASE_MOD_ITEMS,
+	/** compare a component's items and record the differences */
+		POLDIFF_PHASE_MERGE
+	} poldiff_phase_e;
+
+/**
+ *  Callback function signature for being told when each phase of a
+ *  difference begins and ends; see poldiff_set_phase_callback().
+ *
+ *  @param arg Argument given to poldiff_set_phase_callback().
+ *  @param diff The policy difference structure being run.
+ *  @param phase Phase beginning or ending.
+ *  @param which For POLDIFF_PHASE_RESET, POLDIFF_PHASE_ORIG_ITEMS,
+ *  POLDIFF_PHASE_MOD_ITEMS and POLDIFF_PHASE_MERGE, the flag (one of
+ *  POLDIFF_DIFF_*) of the component concerned; otherwise 0.
+ *  @param is_end 0 when the phase begins, 1 when it ends.  A phase
+ *  that fails is not reported as ending.
+ */
+	typedef void (*poldiff_phase_fn_t) (void *arg, const poldiff_t * diff, poldiff_phase_e phase, uint32_t which, int is_end);
+
 #include <poldiff/attrib_diff.h>
 #include <poldiff/avrule_diff.h>
 #include <poldiff/cat_diff.h>
@@ -87,6 +142,8 @@ extern "C"
 #include <poldiff/user_diff.h>
 #include <poldiff/type_map.h>
 #include <poldiff/util.h>
+#include <poldiff/archive.h>
+#include <poldiff/nway.h>
 
 /* NOTE: while defined OCONS are not currently supported */
 #define POLDIFF_DIFF_CLASSES       0x00000001U
@@ -154,6 +211,46 @@ extern "C"
  */
 	extern void poldiff_destroy(poldiff_t ** diff);
 
+/**
+ *  Replace the modified policy of a policy difference structure,
+ *  keeping the original policy as a baseline.  The original policy is
+ *  not reloaded, nor rebuilt unless a later poldiff_run() needs rules
+ *  it has not yet loaded.  If poldiff_set_keep_baseline() was called,
+ *  the original policy's expanded AV and TE rules are also kept, and
+ *  the next poldiff_run() reuses them if the new type map and
+ *  permission numbering treat the original policy's types, classes,
+ *  and permissions as before; otherwise it gathers them anew.  All
+ *  results and the type map (including any user remappings) are
+ *  discarded; call poldiff_run() again afterwards.  The new
+ *  policy is rebuilt with the baseline's options before it replaces
+ *  the previous modified policy, which is then destroyed.  This
+ *  function takes ownership of the new policy.
+ *
+ *  @param diff The policy difference structure.
+ *  @param mod_policy The new modified policy.
+ *
+ *  @return 0 on success or < 0 on error; if the call fails, errno
+ *  will be set.  If the new policy could not be rebuilt or its type
+ *  map could not be inferred, then the new policy is destroyed and
+ *  the difference structure is unchanged.  Otherwise, upon failure,
+ *  the only defined operation on the difference structure is
+ *  poldiff_destroy().
+ */
+	extern int poldiff_set_mod_policy(poldiff_t * diff, apol_policy_t * mod_policy);
+
+/**
+ *  Keep the original policy's expanded AV and TE rules after each
+ *  poldiff_run(), so that a run after poldiff_set_mod_policy() need
+ *  not expand them again.  The kept rules stay in memory until the
+ *  difference structure is destroyed, the policies are rebuilt, the
+ *  types are remapped, or keeping is turned off.
+ *
+ *  @param diff The policy difference structure.
+ *  @param keep Non-zero to keep the rules, 0 to discard any kept
+ *  rules and stop keeping them (the default).
+ */
+	extern void poldiff_set_keep_baseline(poldiff_t * diff, int keep);
+
 /**
  *  Run the difference algorithm for the selected policy components/rules.
  *  @param diff The policy difference structure for which to compute
@@ -211,6 +308,50 @@ extern "C"
  */
 	extern int poldiff_enable_line_numbers(poldiff_t * diff);
 
+/**
+ *  Stream the differences found by poldiff_run() instead of keeping
+ *  them.  Each difference is handed to the callback as soon as it is
+ *  found and is then destroyed, so memory stays bounded by the size
+ *  of one component's pseudo-items rather than by the number of
+ *  differences.  Afterwards the components' result vectors are empty,
+ *  though poldiff_get_stats() still counts every difference.
+ *
+ *  @param diff The policy difference structure.
+ *  @param fn Function to receive each difference, or NULL to keep
+ *  differences (the default).
+ *  @param arg Argument passed to the callback.
+ */
+	extern void poldiff_set_item_callback(poldiff_t * diff, poldiff_item_fn_t fn, void *arg);
+
+/**
+ *  Report the beginning and end of each phase of poldiff_run() and
+ *  poldiff_set_mod_policy() to a callback, such as to time them.
+ *  Unlike the informational messages, which may change wording,
+ *  phases are identified by poldiff_phase_e values.
+ *
+ *  @param diff The policy difference structure.
+ *  @param fn Function to be told of each phase, or NULL to stop
+ *  reporting phases (the default).
+ *  @param arg Argument passed to the callback.
+ */
+	extern void poldiff_set_phase_callback(poldiff_t * diff, poldiff_phase_fn_t fn, void *arg);
+
+/**
+ *  Set the largest number of threads poldiff_run() may use to find
+ *  the differences in AV and TE rules.  A component's rules are split
+ *  into shards that are compared independently; this is only done
+ *  for components with enough rules to be worth it, and never while
+ *  an item callback is set, since that callback is always called
+ *  from the thread that called poldiff_run().  The message callback
+ *  is likewise only called from that thread.
+ *
+ *  @param diff The policy difference structure to configure.
+ *  @param num_threads Largest number of threads to use, or 0 for one
+ *  per online processor (the default).  If 1, rules are compared on
+ *  the calling thread only.
+ */
+	extern void poldiff_set_num_threads(poldiff_t * diff, size_t num_threads);
+
 #ifdef	__cplusplus
 }
 #endif
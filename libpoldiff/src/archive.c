@@ -0,0 +1,654 @@
+/**
+ *  @file
+ *  Implementation of the compact binary archive of poldiff results.
+ *  See poldiff/archive.h for a description of the format.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include "poldiff_internal.h"
+
+#include <poldiff/archive.h>
+#include <poldiff/component_record.h>
+#include <apol/condrule-query.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARCHIVE_MAGIC "PDARCHV"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_TAG_STRING 'S'
+#define ARCHIVE_TAG_ITEM 'I'
+#define ARCHIVE_TAG_END 'E'
+
+/** most fields that any kind of difference has */
+#define ARCHIVE_MAX_FIELDS 8
+
+/* a string already written to the archive, and its number */
+typedef struct archive_string
+{
+	char *s;
+	size_t num;
+} archive_string_t;
+
+struct poldiff_archive_writer
+{
+	const poldiff_t *diff;
+	FILE *fp;
+	/** BST of archive_string_t, by string */
+	apol_bst_t *strings;
+	size_t num_strings;
+	size_t num_items;
+};
+
+struct poldiff_archive_item
+{
+	uint32_t which;
+	poldiff_form_e form;
+	/** pointers into the archive's string table */
+	const char **fields;
+	size_t num_fields;
+	/** pointers into the archive's string table */
+	const char **perms;
+	/** POLDIFF_FORM_NONE, _ADDED, or _REMOVED for each permission */
+	unsigned char *changes;
+	size_t num_perms;
+};
+
+struct poldiff_archive
+{
+	char **strings;
+	size_t num_strings;
+	poldiff_archive_item_t *items;
+	size_t num_items;
+};
+
+static int archive_string_comp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	const archive_string_t *x = (const archive_string_t *)a;
+	const archive_string_t *y = (const archive_string_t *)b;
+	return strcmp(x->s, y->s);
+}
+
+static void archive_string_free(void *elem)
+{
+	archive_string_t *str = (archive_string_t *) elem;
+	if (str != NULL) {
+		free(str->s);
+		free(str);
+	}
+}
+
+static void archive_put_varint(FILE * fp, uint64_t n)
+{
+	while (n >= 0x80) {
+		putc((int)((n & 0x7f) | 0x80), fp);
+		n >>= 7;
+	}
+	putc((int)n, fp);
+}
+
+/**
+ * Read one varint from a stream.
+ *
+ * @return 0 on success, < 0 on end of file or if the varint is too
+ * long.
+ */
+static int archive_get_varint(FILE * fp, uint64_t * n)
+{
+	int c, shift;
+	*n = 0;
+	for (shift = 0; shift < 64; shift += 7) {
+		if ((c = getc(fp)) == EOF) {
+			return -1;
+		}
+		*n |= (uint64_t) (c & 0x7f) << shift;
+		if (!(c & 0x80)) {
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Get the number of a string within the archive, first writing it to
+ * the string table if this is its first use.
+ */
+static int archive_intern(poldiff_archive_writer_t * w, const char *s, size_t * num)
+{
+	archive_string_t key, *str = NULL;
+	size_t len;
+	int error;
+
+	key.s = (char *)s;
+	if (apol_bst_get_element(w->strings, &key, NULL, (void **)&str) == 0) {
+		*num = str->num;
+		return 0;
+	}
+	if ((str = calloc(1, sizeof(*str))) == NULL || (str->s = strdup(s)) == NULL ||
+	    apol_bst_insert(w->strings, str, NULL) < 0) {
+		error = errno;
+		archive_string_free(str);
+		ERR(w->diff, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	str->num = w->num_strings++;
+	len = strlen(s);
+	putc(ARCHIVE_TAG_STRING, w->fp);
+	archive_put_varint(w->fp, len);
+	fwrite(s, 1, len, w->fp);
+	*num = str->num;
+	return 0;
+}
+
+poldiff_archive_writer_t *poldiff_archive_writer_create(const poldiff_t * diff, FILE * fp)
+{
+	poldiff_archive_writer_t *w = NULL;
+	int error;
+
+	if (fp == NULL) {
+		ERR(diff, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((w = calloc(1, sizeof(*w))) == NULL || (w->strings = apol_bst_create(archive_string_comp, archive_string_free)) == NULL) {
+		error = errno;
+		free(w);
+		ERR(diff, "%s", strerror(error));
+		errno = error;
+		return NULL;
+	}
+	w->diff = diff;
+	w->fp = fp;
+	fwrite(ARCHIVE_MAGIC, 1, sizeof(ARCHIVE_MAGIC), fp);
+	putc(ARCHIVE_VERSION, fp);
+	if (ferror(fp)) {
+		error = errno;
+		ERR(diff, "Could not write archive: %s", strerror(error));
+		apol_bst_destroy(&w->strings);
+		free(w);
+		errno = error;
+		return NULL;
+	}
+	return w;
+}
+
+/**
+ * Fill in the conditional expression and branch fields of a rule.
+ * The rendered expression, if any, is returned through expr and must
+ * be freed by the caller.
+ */
+static int archive_cond_fields(const poldiff_t * diff, const qpol_cond_t * cond, uint32_t which_list, const apol_policy_t * p,
+			       const char **fields, char **expr)
+{
+	*expr = NULL;
+	if (cond == NULL) {
+		fields[0] = fields[1] = "";
+		return 0;
+	}
+	if ((*expr = apol_cond_expr_render(p, cond)) == NULL) {
+		int error = errno;
+		ERR(diff, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	fields[0] = *expr;
+	fields[1] = (which_list ? "TRUE" : "FALSE");
+	return 0;
+}
+
+int poldiff_archive_write_item(void *writer, const poldiff_t * diff, uint32_t which, const void *item)
+{
+	poldiff_archive_writer_t *w = (poldiff_archive_writer_t *) writer;
+	const poldiff_component_record_t *rec = NULL;
+	const char *fields[ARCHIVE_MAX_FIELDS];
+	size_t nums[ARCHIVE_MAX_FIELDS], num_fields = 0, num, i, j;
+	const apol_vector_t *perm_v[3] = { NULL, NULL, NULL };
+	const qpol_cond_t *cond;
+	const apol_policy_t *p;
+	uint32_t which_list, bit;
+	poldiff_form_e form;
+	char *text = NULL, *expr = NULL;
+	int retval = -1, error = 0;
+
+	if (w == NULL || item == NULL || (rec = poldiff_get_component_record(which)) == NULL) {
+		error = EINVAL;
+		ERR(w == NULL ? diff : w->diff, "%s", strerror(error));
+		goto cleanup;
+	}
+	if (diff == NULL) {
+		diff = w->diff;
+	}
+	form = poldiff_component_record_get_form_fn(rec) (item);
+	if (which & POLDIFF_DIFF_AVRULES) {
+		const poldiff_avrule_t *avrule = item;
+		fields[0] = poldiff_avrule_get_source_type(avrule);
+		fields[1] = poldiff_avrule_get_target_type(avrule);
+		fields[2] = poldiff_avrule_get_object_class(avrule);
+		poldiff_avrule_get_cond(diff, avrule, &cond, &which_list, &p);
+		if (archive_cond_fields(diff, cond, which_list, p, fields + 3, &expr) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		num_fields = 5;
+		perm_v[0] = poldiff_avrule_get_unmodified_perms(avrule);
+		perm_v[1] = poldiff_avrule_get_added_perms(avrule);
+		perm_v[2] = poldiff_avrule_get_removed_perms(avrule);
+	} else if (which & POLDIFF_DIFF_TERULES) {
+		const poldiff_terule_t *terule = item;
+		fields[0] = poldiff_terule_get_source_type(terule);
+		fields[1] = poldiff_terule_get_target_type(terule);
+		fields[2] = poldiff_terule_get_object_class(terule);
+		poldiff_terule_get_cond(diff, terule, &cond, &which_list, &p);
+		if (archive_cond_fields(diff, cond, which_list, p, fields + 3, &expr) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		fields[5] = poldiff_terule_get_original_default(terule);
+		fields[6] = poldiff_terule_get_modified_default(terule);
+		num_fields = 7;
+	} else {
+		if ((text = poldiff_component_record_get_to_string_fn(rec) (diff, item)) == NULL) {
+			error = errno;
+			goto cleanup;
+		}
+		fields[0] = text;
+		num_fields = 1;
+	}
+
+	/* strings must precede the item that refers to them */
+	for (i = 0; i < num_fields; i++) {
+		if (archive_intern(w, (fields[i] == NULL ? "" : fields[i]), nums + i) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+	for (j = 0; j < 3; j++) {
+		for (i = 0; i < apol_vector_get_size(perm_v[j]); i++) {
+			if (archive_intern(w, apol_vector_get_element(perm_v[j], i), &num) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+		}
+	}
+	for (bit = 0; !(which & (1U << bit)); bit++) ;
+	putc(ARCHIVE_TAG_ITEM, w->fp);
+	archive_put_varint(w->fp, bit);
+	archive_put_varint(w->fp, form);
+	archive_put_varint(w->fp, num_fields);
+	for (i = 0; i < num_fields; i++) {
+		archive_put_varint(w->fp, nums[i]);
+	}
+	archive_put_varint(w->fp,
+			   apol_vector_get_size(perm_v[0]) + apol_vector_get_size(perm_v[1]) + apol_vector_get_size(perm_v[2]));
+	for (j = 0; j < 3; j++) {
+		for (i = 0; i < apol_vector_get_size(perm_v[j]); i++) {
+			/* already interned above, so this only looks it up */
+			archive_intern(w, apol_vector_get_element(perm_v[j], i), &num);
+			archive_put_varint(w->fp, ((uint64_t) num << 2) | j);
+		}
+	}
+	if (ferror(w->fp)) {
+		error = errno;
+		ERR(w->diff, "Could not write archive: %s", strerror(error));
+		goto cleanup;
+	}
+	w->num_items++;
+	retval = 0;
+      cleanup:
+	free(text);
+	free(expr);
+	errno = error;
+	return retval;
+}
+
+int poldiff_archive_write_results(poldiff_archive_writer_t * writer, uint32_t flags)
+{
+	const poldiff_component_record_t *rec;
+	const apol_vector_t *v;
+	uint32_t bit;
+	size_t i;
+
+	if (writer == NULL) {
+		ERR(NULL, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	for (bit = 0; bit < 32; bit++) {
+		uint32_t which = 1U << bit;
+		if (!(flags & which) || (rec = poldiff_get_component_record(which)) == NULL || !poldiff_is_run(writer->diff, which)) {
+			continue;
+		}
+		if ((v = poldiff_component_record_get_results_fn(rec) (writer->diff)) == NULL) {
+			return -1;
+		}
+		for (i = 0; i < apol_vector_get_size(v); i++) {
+			if (poldiff_archive_write_item(writer, writer->diff, which, apol_vector_get_element(v, i)) < 0) {
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+int poldiff_archive_writer_close(poldiff_archive_writer_t ** writer)
+{
+	poldiff_archive_writer_t *w;
+	int retval = 0, error = 0;
+
+	if (writer == NULL || *writer == NULL) {
+		return 0;
+	}
+	w = *writer;
+	putc(ARCHIVE_TAG_END, w->fp);
+	archive_put_varint(w->fp, w->num_strings);
+	archive_put_varint(w->fp, w->num_items);
+	if (fflush(w->fp) != 0 || ferror(w->fp)) {
+		error = errno;
+		ERR(w->diff, "Could not write archive: %s", strerror(error));
+		retval = -1;
+	}
+	apol_bst_destroy(&w->strings);
+	free(w);
+	*writer = NULL;
+	errno = error;
+	return retval;
+}
+
+/**
+ * Read one string record's body and append it to the string table.
+ */
+static int archive_read_string(poldiff_archive_t * a, FILE * fp, size_t * strings_cap)
+{
+	uint64_t len;
+	char *s, **new_strings;
+
+	if (archive_get_varint(fp, &len) < 0 || len > 0x100000) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (a->num_strings >= *strings_cap) {
+		size_t cap = (*strings_cap == 0 ? 64 : *strings_cap * 2);
+		if ((new_strings = realloc(a->strings, cap * sizeof(*new_strings))) == NULL) {
+			return -1;
+		}
+		a->strings = new_strings;
+		*strings_cap = cap;
+	}
+	if ((s = malloc(len + 1)) == NULL) {
+		return -1;
+	}
+	if (fread(s, 1, len, fp) != len) {
+		free(s);
+		errno = EINVAL;
+		return -1;
+	}
+	s[len] = '\0';
+	a->strings[a->num_strings++] = s;
+	return 0;
+}
+
+/**
+ * Read one item record's body and append it to the archive's items.
+ */
+static int archive_read_item(poldiff_archive_t * a, FILE * fp, size_t * items_cap)
+{
+	poldiff_archive_item_t *item, *new_items;
+	uint64_t bit, form, count, num;
+	size_t i;
+
+	if (a->num_items >= *items_cap) {
+		size_t cap = (*items_cap == 0 ? 64 : *items_cap * 2);
+		if ((new_items = realloc(a->items, cap * sizeof(*new_items))) == NULL) {
+			return -1;
+		}
+		a->items = new_items;
+		*items_cap = cap;
+	}
+	item = a->items + a->num_items;
+	memset(item, 0, sizeof(*item));
+	if (archive_get_varint(fp, &bit) < 0 || bit >= 32 ||
+	    archive_get_varint(fp, &form) < 0 || form > POLDIFF_FORM_REMOVE_TYPE ||
+	    archive_get_varint(fp, &count) < 0 || count > ARCHIVE_MAX_FIELDS) {
+		errno = EINVAL;
+		return -1;
+	}
+	item->which = 1U << bit;
+	item->form = (poldiff_form_e) form;
+	/* count the item now, so that its arrays are freed on error */
+	a->num_items++;
+	if ((item->fields = calloc(count + 1, sizeof(*item->fields))) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < count; i++) {
+		if (archive_get_varint(fp, &num) < 0 || num >= a->num_strings) {
+			errno = EINVAL;
+			return -1;
+		}
+		item->fields[item->num_fields++] = a->strings[num];
+	}
+	/* permissions are distinct strings, so there cannot be more of
+	 * them than there are strings */
+	if (archive_get_varint(fp, &count) < 0 || count > a->num_strings) {
+		errno = EINVAL;
+		return -1;
+	}
+	if ((item->perms = calloc(count + 1, sizeof(*item->perms))) == NULL ||
+	    (item->changes = calloc(count + 1, sizeof(*item->changes))) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < count; i++) {
+		if (archive_get_varint(fp, &num) < 0 || (num >> 2) >= a->num_strings || (num & 3) == 3) {
+			errno = EINVAL;
+			return -1;
+		}
+		item->perms[item->num_perms] = a->strings[num >> 2];
+		switch (num & 3) {
+		case 1:
+			item->changes[item->num_perms] = POLDIFF_FORM_ADDED;
+			break;
+		case 2:
+			item->changes[item->num_perms] = POLDIFF_FORM_REMOVED;
+			break;
+		default:
+			item->changes[item->num_perms] = POLDIFF_FORM_NONE;
+			break;
+		}
+		item->num_perms++;
+	}
+	return 0;
+}
+
+poldiff_archive_t *poldiff_archive_read(FILE * fp)
+{
+	poldiff_archive_t *a = NULL;
+	char magic[sizeof(ARCHIVE_MAGIC)];
+	size_t strings_cap = 0, items_cap = 0;
+	uint64_t num_strings, num_items;
+	int c, error = 0;
+
+	if (fp == NULL) {
+		error = EINVAL;
+		ERR(NULL, "%s", strerror(error));
+		goto err;
+	}
+	if ((a = calloc(1, sizeof(*a))) == NULL) {
+		error = errno;
+		ERR(NULL, "%s", strerror(error));
+		goto err;
+	}
+	if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) || memcmp(magic, ARCHIVE_MAGIC, sizeof(magic)) != 0) {
+		error = EINVAL;
+		ERR(NULL, "%s", "Not a poldiff archive.");
+		goto err;
+	}
+	if ((c = getc(fp)) != ARCHIVE_VERSION) {
+		error = ENOTSUP;
+		ERR(NULL, "Unsupported poldiff archive version %d.", c);
+		goto err;
+	}
+	while (1) {
+		c = getc(fp);
+		if (c == ARCHIVE_TAG_STRING) {
+			if (archive_read_string(a, fp, &strings_cap) < 0) {
+				error = errno;
+				break;
+			}
+		} else if (c == ARCHIVE_TAG_ITEM) {
+			if (archive_read_item(a, fp, &items_cap) < 0) {
+				error = errno;
+				break;
+			}
+		} else if (c == ARCHIVE_TAG_END) {
+			if (archive_get_varint(fp, &num_strings) < 0 || archive_get_varint(fp, &num_items) < 0 ||
+			    num_strings != a->num_strings || num_items != a->num_items) {
+				error = EINVAL;
+			}
+			break;
+		} else {
+			/* also covers an archive that was never finished */
+			error = EINVAL;
+			break;
+		}
+	}
+	if (error != 0) {
+		if (error == EINVAL) {
+			ERR(NULL, "%s", "Malformed poldiff archive.");
+		} else {
+			ERR(NULL, "%s", strerror(error));
+		}
+		goto err;
+	}
+	return a;
+      err:
+	poldiff_archive_destroy(&a);
+	errno = error;
+	return NULL;
+}
+
+void poldiff_archive_destroy(poldiff_archive_t ** archive)
+{
+	size_t i;
+	if (archive == NULL || *archive == NULL)
+		return;
+	for (i = 0; i < (*archive)->num_items; i++) {
+		free((*archive)->items[i].fields);
+		free((*archive)->items[i].perms);
+		free((*archive)->items[i].changes);
+	}
+	free((*archive)->items);
+	for (i = 0; i < (*archive)->num_strings; i++) {
+		free((*archive)->strings[i]);
+	}
+	free((*archive)->strings);
+	free(*archive);
+	*archive = NULL;
+}
+
+size_t poldiff_archive_get_num_items(const poldiff_archive_t * archive)
+{
+	if (archive == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return archive->num_items;
+}
+
+const poldiff_archive_item_t *poldiff_archive_get_item(const poldiff_archive_t * archive, size_t i)
+{
+	if (archive == NULL || i >= archive->num_items) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return archive->items + i;
+}
+
+void poldiff_archive_get_stats(const poldiff_archive_t * archive, uint32_t flags, size_t stats[5])
+{
+	size_t i;
+	if (archive == NULL || stats == NULL) {
+		errno = EINVAL;
+		return;
+	}
+	memset(stats, 0, 5 * sizeof(size_t));
+	for (i = 0; i < archive->num_items; i++) {
+		const poldiff_archive_item_t *item = archive->items + i;
+		if ((item->which & flags) && item->form != POLDIFF_FORM_NONE) {
+			stats[item->form - 1]++;
+		}
+	}
+}
+
+uint32_t poldiff_archive_item_get_component(const poldiff_archive_item_t * item)
+{
+	if (item == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return item->which;
+}
+
+poldiff_form_e poldiff_archive_item_get_form(const poldiff_archive_item_t * item)
+{
+	if (item == NULL) {
+		errno = EINVAL;
+		return POLDIFF_FORM_NONE;
+	}
+	return item->form;
+}
+
+size_t poldiff_archive_item_get_num_fields(const poldiff_archive_item_t * item)
+{
+	if (item == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return item->num_fields;
+}
+
+const char *poldiff_archive_item_get_field(const poldiff_archive_item_t * item, size_t i)
+{
+	if (item == NULL || i >= item->num_fields) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return item->fields[i];
+}
+
+size_t poldiff_archive_item_get_num_perms(const poldiff_archive_item_t * item)
+{
+	if (item == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return item->num_perms;
+}
+
+const char *poldiff_archive_item_get_perm(const poldiff_archive_item_t * item, size_t i, poldiff_form_e * change)
+{
+	if (item == NULL || i >= item->num_perms) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if (change != NULL) {
+		*change = (poldiff_form_e) item->changes[i];
+	}
+	return item->perms[i];
+}
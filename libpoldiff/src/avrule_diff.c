@@ -82,12 +82,11 @@ typedef struct pseudo_avrule
 	uint32_t spec;
 	/** pseudo-type values */
 	uint32_t source, target;
-	/** pointer into the class_bst BST */
-	char *cls;
-	/** array of pointers into the perm_bst BST */
-	/* (use an array here to save space) */
-	char **perms;
-	size_t num_perms;
+	/** class's index within the diff's permission index */
+	uint32_t cls;
+	/** bitmask of permissions, over the class's permissions in the
+	 *  permission index (see perm_index_lookup()) */
+	uint64_t perms;
 	/** array of pointers into the bool_bst BST */
 	char *bools[5];
 	uint32_t bool_val;
@@ -430,6 +429,139 @@ const apol_vector_t *poldiff_avrule_get_mod_line_numbers(const poldiff_avrule_t
 	return avrule->mod_linenos;
 }
 
+/**
+ * Line number and permissions of one syntactic rule.
+ */
+typedef struct avrule_syn_line
+{
+	unsigned long lineno;
+	/** array of pointers into the perm_bst BST */
+	char **perms;
+	size_t num_perms;
+} avrule_syn_line_t;
+
+/**
+ * Syntactic rules from which one qpol_avrule_t came; an entry of the
+ * poldiff's line number index.
+ */
+typedef struct avrule_lines
+{
+	const qpol_avrule_t *rule;
+	avrule_syn_line_t *lines;
+	size_t num_lines;
+} avrule_lines_t;
+
+static int avrule_lines_comp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	const avrule_lines_t *x = (const avrule_lines_t *)a;
+	const avrule_lines_t *y = (const avrule_lines_t *)b;
+	if (x->rule == y->rule)
+		return 0;
+	return (x->rule < y->rule ? -1 : 1);
+}
+
+static void avrule_lines_free(void *elem)
+{
+	avrule_lines_t *l = (avrule_lines_t *) elem;
+	size_t i;
+	if (l != NULL) {
+		for (i = 0; i < l->num_lines; i++) {
+			free(l->lines[i].perms);
+		}
+		free(l->lines);
+		free(l);
+	}
+}
+
+/**
+ * Get the syntactic rules, with their line numbers and permissions,
+ * for a qpol_avrule_t.  These are looked up once per rule and then
+ * kept in the poldiff's line number index, because the same rule is
+ * shared by every pseudo-rule that it expands into.
+ *
+ * @param diff Policy difference structure holding the index.
+ * @param q Policy from which the rule came.
+ * @param rule Rule to look up.
+ *
+ * @return The rule's entry in the index, or NULL on error.
+ */
+static const avrule_lines_t *avrule_get_lines(const poldiff_t * diff, const qpol_policy_t * q, const qpol_avrule_t * rule)
+{
+	/* the index is a cache, so it may be filled in through a
+	 * const poldiff */
+	poldiff_t *d = (poldiff_t *) diff;
+	avrule_lines_t key, *l = NULL;
+	avrule_syn_line_t *line;
+	qpol_iterator_t *syn_iter = NULL, *perm_iter = NULL;
+	qpol_syn_avrule_t *syn_rule;
+	char *perm_name, *pseudo_perm;
+	size_t num_syn, num_perms;
+	int error = 0;
+
+	if (d->avrule_lines == NULL && (d->avrule_lines = apol_bst_create(avrule_lines_comp, avrule_lines_free)) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto err;
+	}
+	key.rule = rule;
+	if (apol_bst_get_element(d->avrule_lines, &key, NULL, (void **)&l) == 0) {
+		return l;
+	}
+	if ((l = calloc(1, sizeof(*l))) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto err;
+	}
+	l->rule = rule;
+	if (qpol_avrule_get_syn_avrule_iter(q, rule, &syn_iter) < 0 || qpol_iterator_get_size(syn_iter, &num_syn) < 0) {
+		error = errno;
+		goto err;
+	}
+	if ((l->lines = calloc(num_syn + 1, sizeof(*l->lines))) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto err;
+	}
+	for (; !qpol_iterator_end(syn_iter); qpol_iterator_next(syn_iter)) {
+		line = l->lines + l->num_lines++;
+		if (qpol_iterator_get_item(syn_iter, (void **)&syn_rule) < 0 ||
+		    qpol_syn_avrule_get_lineno(q, syn_rule, &line->lineno) < 0 ||
+		    qpol_syn_avrule_get_perm_iter(q, syn_rule, &perm_iter) < 0 || qpol_iterator_get_size(perm_iter, &num_perms) < 0) {
+			error = errno;
+			goto err;
+		}
+		if ((line->perms = calloc(num_perms + 1, sizeof(*line->perms))) == NULL) {
+			error = errno;
+			ERR(diff, "%s", strerror(error));
+			goto err;
+		}
+		for (; !qpol_iterator_end(perm_iter); qpol_iterator_next(perm_iter)) {
+			if (qpol_iterator_get_item(perm_iter, (void **)&perm_name) < 0) {
+				error = errno;
+				goto err;
+			}
+			/* permissions of neither policy cannot be asked about */
+			if (apol_bst_get_element(diff->perm_bst, perm_name, NULL, (void **)&pseudo_perm) == 0) {
+				line->perms[line->num_perms++] = pseudo_perm;
+			}
+		}
+		qpol_iterator_destroy(&perm_iter);
+	}
+	qpol_iterator_destroy(&syn_iter);
+	if (apol_bst_insert(d->avrule_lines, l, NULL) < 0) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto err;
+	}
+	return l;
+      err:
+	qpol_iterator_destroy(&syn_iter);
+	qpol_iterator_destroy(&perm_iter);
+	avrule_lines_free(l);
+	errno = error;
+	return NULL;
+}
+
 /**
  * Get the line numbers from an array of qpol_avrule_t that contain
  * the given permission.
@@ -438,8 +570,9 @@ static apol_vector_t *avrule_get_line_numbers_for_perm(const poldiff_t * diff, c
 						       qpol_avrule_t ** rules, const size_t num_rules)
 {
 	apol_vector_t *v = NULL;
-	qpol_iterator_t *syn_iter = NULL, *perm_iter = NULL;
-	size_t i;
+	const avrule_lines_t *l;
+	char *pseudo_perm;
+	size_t i, j, k;
 	int error = 0;
 
 	if ((v = apol_vector_create(NULL)) == NULL) {
@@ -447,38 +580,30 @@ static apol_vector_t *avrule_get_line_numbers_for_perm(const poldiff_t * diff, c
 		ERR(diff, "%s", strerror(errno));
 		goto cleanup;
 	}
+	if (apol_bst_get_element(diff->perm_bst, (void *)perm, NULL, (void **)&pseudo_perm) < 0) {
+		/* not a permission of either policy */
+		goto cleanup;
+	}
 	for (i = 0; i < num_rules; i++) {
-		if (qpol_avrule_get_syn_avrule_iter(q, rules[i], &syn_iter) < 0) {
+		if ((l = avrule_get_lines(diff, q, rules[i])) == NULL) {
 			error = errno;
 			goto cleanup;
 		}
-		for (; !qpol_iterator_end(syn_iter); qpol_iterator_next(syn_iter)) {
-			qpol_syn_avrule_t *syn_rule;
-			qpol_iterator_get_item(syn_iter, (void **)&syn_rule);
-			if (qpol_syn_avrule_get_perm_iter(q, syn_rule, &perm_iter) < 0) {
-				error = errno;
-				goto cleanup;
-			}
-			for (; !qpol_iterator_end(perm_iter); qpol_iterator_next(perm_iter)) {
-				char *syn_perm;
-				qpol_iterator_get_item(perm_iter, (void **)&syn_perm);
-				if (strcmp(perm, syn_perm) == 0) {
-					unsigned long lineno;
-					qpol_syn_avrule_get_lineno(q, syn_rule, &lineno);
-					if (apol_vector_append(v, (void *)lineno) < 0) {
-						ERR(diff, "%s", strerror(errno));
+		for (j = 0; j < l->num_lines; j++) {
+			for (k = 0; k < l->lines[j].num_perms; k++) {
+				if (l->lines[j].perms[k] == pseudo_perm) {
+					if (apol_vector_append(v, (void *)l->lines[j].lineno) < 0) {
+						error = errno;
+						ERR(diff, "%s", strerror(error));
+						goto cleanup;
 					}
 					break;
 				}
 			}
-			qpol_iterator_destroy(&perm_iter);
 		}
-		qpol_iterator_destroy(&syn_iter);
 	}
 	apol_vector_sort_uniquify(v, NULL, NULL);
       cleanup:
-	qpol_iterator_destroy(&syn_iter);
-	qpol_iterator_destroy(&perm_iter);
 	if (error != 0) {
 		apol_vector_destroy(&v);
 		errno = error;
@@ -579,6 +704,8 @@ static int avrule_reset(poldiff_t * diff, avrule_offset_e idx)
 {
 	int error = 0;
 
+	/* rules' pointers may change, so drop the line number index */
+	apol_bst_destroy(&diff->avrule_lines);
 	avrule_destroy(&diff->avrule_diffs[idx]);
 	diff->avrule_diffs[idx] = avrule_create();
 	if (diff->avrule_diffs[idx] == NULL) {
@@ -615,7 +742,6 @@ static void avrule_free_item(void *item)
 {
 	pseudo_avrule_t *a = (pseudo_avrule_t *) item;
 	if (item != NULL) {
-		free(a->perms);
 		free(a->rules);
 		free(a);
 	}
@@ -627,7 +753,7 @@ static void avrule_free_item(void *item)
  * <ul>
  * <li>Sort by target pseudo-type value,
  * <li>Then by source pseudo-type value,
- * <li>Then by object class's BST's pointer value,
+ * <li>Then by object class's index,
  * <li>Then by rule specified (allow, neverallow, etc.),
  * <li>Then choose unconditional rules over conditional rules,
  * <li>Then by conditional expression's BST's boolean pointer value.
@@ -650,7 +776,7 @@ static int pseudo_avrule_comp(const pseudo_avrule_t * rule1, const pseudo_avrule
 		return rule1->source - rule2->source;
 	}
 	if (rule1->cls != rule2->cls) {
-		return (int)(rule1->cls - rule2->cls);
+		return (rule1->cls < rule2->cls ? -1 : 1);
 	}
 	if (rule1->spec != rule2->spec) {
 		return rule1->spec - rule2->spec;
@@ -801,40 +927,50 @@ static int avrule_build_cond(poldiff_t * diff, const apol_policy_t * p, const qp
 }
 
 /**
- * Bubble sort the permissions within a pseudo-avrule, sorted by
- * pointer value.  (Bubble-sort is fine because the number of
- * permissions will usually be less than 10.)  Then uniquify the list.
+ * Given a rule, fill in the parts of a pseudo-avrule that do not
+ * depend upon the rule's source and target: its kind, class,
+ * permissions, and conditional expression.
+ *
+ * @param diff Policy difference structure.
+ * @param p Policy from which the rule came.
+ * @param rule AV rule to convert.
+ * @param key Location to write converted rule.
  *
- * @param key Rule whose permissions to sort.
+ * @return 0 on success, < 0 on error.
  */
-static void sort_and_uniquify_perms(pseudo_avrule_t * key)
+static int avrule_build_key(poldiff_t * diff, const apol_policy_t * p, const qpol_avrule_t * rule, pseudo_avrule_t * key)
 {
-	size_t i, j;
-	char *t;
-	for (i = key->num_perms; i > 1; i--) {
-		for (j = 1; j < i; j++) {
-			if (key->perms[j - 1] > key->perms[j]) {
-				t = key->perms[j];
-				key->perms[j] = key->perms[j - 1];
-				key->perms[j - 1] = t;
-			}
-		}
+	const qpol_class_t *obj_class;
+	const qpol_cond_t *cond;
+	uint32_t class_value, mask;
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	int which = (p == diff->orig_pol ? POLDIFF_POLICY_ORIG : POLDIFF_POLICY_MOD);
+	if (qpol_avrule_get_rule_type(q, rule, &(key->spec)) < 0 ||
+	    qpol_avrule_get_object_class(q, rule, &obj_class) < 0 ||
+	    qpol_class_get_value(q, obj_class, &class_value) < 0 ||
+	    qpol_avrule_get_perm_mask(q, rule, &mask) < 0 || qpol_avrule_get_cond(q, rule, &cond) < 0) {
+		return -1;
 	}
-	for (i = 1; i < key->num_perms; i++) {
-		if (key->perms[i] == key->perms[i - 1]) {
-			memmove(key->perms + i, key->perms + i + 1, (key->num_perms - i - 1) * sizeof(key->perms[0]));
-			key->num_perms--;
-		}
+	if (perm_index_lookup(diff, which, class_value, mask, &key->cls, &key->perms) < 0) {
+		assert(0);
+		return -1;
+	}
+	if (cond != NULL && (qpol_avrule_get_which_list(q, rule, &(key->branch)) < 0 || avrule_build_cond(diff, p, cond, key) < 0)) {
+		return -1;
 	}
+	return 0;
 }
 
 /**
- * Given a rule, construct a new pseudo-avrule and insert it into the
- * BST if not already there.
+ * Given a pseudo-avrule for a rule, merge it into the BST with the
+ * given source and target.  If the BST already has an equivalent
+ * pseudo-avrule then add to that one's permissions; otherwise insert
+ * a copy of the key.
  *
  * @param diff Policy difference structure.
  * @param p Policy from which the rule came.
- * @param rule AV rule to insert.
+ * @param rule AV rule being inserted.
+ * @param key Pseudo-avrule built by avrule_build_key().
  * @param source Source pseudo-type value.
  * @param target Target pseudo-type value.
  * @param b BST containing pseudo-avrules.
@@ -842,81 +978,33 @@ static void sort_and_uniquify_perms(pseudo_avrule_t * key)
  * @return 0 on success, < 0 on error.
  */
 static int avrule_add_to_bst(poldiff_t * diff, const apol_policy_t * p,
-			     const qpol_avrule_t * rule, uint32_t source, uint32_t target, apol_bst_t * b)
+			     const qpol_avrule_t * rule, pseudo_avrule_t * key, uint32_t source, uint32_t target, apol_bst_t * b)
 {
-	pseudo_avrule_t *key, *inserted_key;
-	const qpol_class_t *obj_class;
-	qpol_iterator_t *perm_iter = NULL;
-	const char *class_name;
-	char *perm_name, *pseudo_perm, **t;
-	size_t num_perms;
-	const qpol_cond_t *cond;
+	pseudo_avrule_t *inserted_key = NULL;
 	qpol_policy_t *q = apol_policy_get_qpol(p);
-	int retval = -1, error = 0, compval;
-	if ((key = calloc(1, sizeof(*key))) == NULL) {
-		error = errno;
-		ERR(diff, "%s", strerror(error));
-		goto cleanup;
-	}
-	if (qpol_avrule_get_rule_type(q, rule, &(key->spec)) < 0 ||
-	    qpol_avrule_get_object_class(q, rule, &obj_class) < 0 ||
-	    qpol_avrule_get_perm_iter(q, rule, &perm_iter) < 0 || qpol_avrule_get_cond(q, rule, &cond) < 0) {
-		error = errno;
-		goto cleanup;
-	}
-	if (qpol_class_get_name(q, obj_class, &class_name) < 0) {
-		error = errno;
-		goto cleanup;
-	}
-	if (apol_bst_get_element(diff->class_bst, (void *)class_name, NULL, (void **)&key->cls) < 0) {
-		error = EBADRQC;       /* should never get here */
-		ERR(diff, "%s", strerror(error));
-		assert(0);
-		goto cleanup;
-	}
+	int error = 0;
 	key->source = source;
 	key->target = target;
-	if (cond != NULL && (qpol_avrule_get_which_list(q, rule, &(key->branch)) < 0 || avrule_build_cond(diff, p, cond, key) < 0)) {
-		error = errno;
-		goto cleanup;
-	}
 
 	/* insert this pseudo into the tree if not already there */
-	if ((compval = apol_bst_insert_and_get(b, (void **)&key, NULL)) < 0) {
-		error = errno;
-		ERR(diff, "%s", strerror(error));
-		goto cleanup;
-	}
-	inserted_key = key;
-	key = NULL;
-
-	/* append and uniquify this rule's permissions */
-	if (qpol_iterator_get_size(perm_iter, &num_perms) < 0) {
-		error = errno;
-		goto cleanup;
-	}
-	if ((t = realloc(inserted_key->perms, (inserted_key->num_perms + num_perms) * sizeof(*t))) == NULL) {
-		error = errno;
-		ERR(diff, "%s", strerror(error));
-		goto cleanup;
-	}
-	inserted_key->perms = t;
-	for (; !qpol_iterator_end(perm_iter); qpol_iterator_next(perm_iter)) {
-		if (qpol_iterator_get_item(perm_iter, (void *)&perm_name) < 0) {
+	if (apol_bst_get_element(b, key, NULL, (void **)&inserted_key) < 0) {
+		if ((inserted_key = malloc(sizeof(*inserted_key))) == NULL) {
 			error = errno;
-			goto cleanup;
+			ERR(diff, "%s", strerror(error));
+			errno = error;
+			return -1;
 		}
-		if (apol_bst_get_element(diff->perm_bst, perm_name, NULL, (void **)&pseudo_perm) < 0) {
-			error = EBADRQC;	/* should never get here */
+		*inserted_key = *key;
+		if (apol_bst_insert(b, inserted_key, NULL) < 0) {
+			error = errno;
 			ERR(diff, "%s", strerror(error));
-			assert(0);
-			free(perm_name);
-			goto cleanup;
+			free(inserted_key);
+			errno = error;
+			return -1;
 		}
-		free(perm_name);
-		inserted_key->perms[(inserted_key->num_perms)++] = pseudo_perm;
+	} else {
+		inserted_key->perms |= key->perms;
 	}
-	sort_and_uniquify_perms(inserted_key);
 
 	/* store the rule pointer, to be used for showing line numbers */
 	if (qpol_policy_has_capability(q, QPOL_CAP_LINE_NUMBERS)) {
@@ -925,20 +1013,13 @@ static int avrule_add_to_bst(poldiff_t * diff, const apol_policy_t * p,
 		if (a == NULL) {
 			error = errno;
 			ERR(diff, "%s", strerror(error));
-			goto cleanup;
+			errno = error;
+			return -1;
 		}
 		inserted_key->rules = a;
 		inserted_key->rules[inserted_key->num_rules++] = rule;
 	}
-
-	retval = 0;
-      cleanup:
-	qpol_iterator_destroy(&perm_iter);
-	if (retval < 0) {
-		avrule_free_item(key);
-	}
-	errno = error;
-	return retval;
+	return 0;
 }
 
 /**
@@ -955,87 +1036,39 @@ static int avrule_add_to_bst(poldiff_t * diff, const apol_policy_t * p,
  */
 static int avrule_expand(poldiff_t * diff, const apol_policy_t * p, const qpol_avrule_t * rule, apol_bst_t * b)
 {
-	const qpol_type_t *source, *orig_target, *target;
-	unsigned char source_attr, target_attr;
-	qpol_iterator_t *source_iter = NULL, *target_iter = NULL;
+	const qpol_type_t *source, *target;
+	const apol_bitmap_t *sources, *targets;
+	pseudo_avrule_t key;
+	size_t s, t;
 	uint32_t source_val, target_val;
 	qpol_policy_t *q = apol_policy_get_qpol(p);
 	int which = (p == diff->orig_pol ? POLDIFF_POLICY_ORIG : POLDIFF_POLICY_MOD);
-	int retval = -1, error = 0;
+	memset(&key, 0, sizeof(key));
 	if (qpol_avrule_get_source_type(q, rule, &source) < 0 ||
-	    qpol_avrule_get_target_type(q, rule, &orig_target) < 0 ||
-	    qpol_type_get_isattr(q, source, &source_attr) < 0 || qpol_type_get_isattr(q, orig_target, &target_attr)) {
-		error = errno;
-		goto cleanup;
-	}
-#ifdef SETOOLS_DEBUG
-	const char *orig_source_name, *orig_target_name;
-	qpol_type_get_name(q, source, &orig_source_name);
-	qpol_type_get_name(q, orig_target, &orig_target_name);
-#endif
-
-	if (source_attr) {
-		if (qpol_type_get_type_iter(q, source, &source_iter) < 0) {
-			error = errno;
-			goto cleanup;
-		}
-		/* handle situation where a rule has as its source an
-		 * attribute without any types */
-		if (qpol_iterator_end(source_iter)) {
-			retval = 0;
-			goto cleanup;
-		}
+	    qpol_avrule_get_target_type(q, rule, &target) < 0 ||
+	    (sources = apol_type_get_expansion_bitmap(p, source)) == NULL ||
+	    (targets = apol_type_get_expansion_bitmap(p, target)) == NULL || avrule_build_key(diff, p, rule, &key) < 0) {
+		return -1;
 	}
-	do {
-		if (source_attr) {
-			if (qpol_iterator_get_item(source_iter, (void **)&source) < 0) {
-				error = errno;
-				goto cleanup;
-			}
-			qpol_iterator_next(source_iter);
+	/* an attribute without any types expands to nothing */
+	for (s = apol_bitmap_next(sources, 0); s < apol_bitmap_get_size(sources); s = apol_bitmap_next(sources, s + 1)) {
+		if ((source_val = type_map_lookup_value(diff, (uint32_t) s, which)) == 0) {
+			ERR(diff, "%s", strerror(EBADRQC));	/* should never get here */
+			errno = EBADRQC;
+			return -1;
 		}
-		if (target_attr) {
-			if (qpol_type_get_type_iter(q, orig_target, &target_iter) < 0) {
-				error = errno;
-				goto cleanup;
+		for (t = apol_bitmap_next(targets, 0); t < apol_bitmap_get_size(targets); t = apol_bitmap_next(targets, t + 1)) {
+			if ((target_val = type_map_lookup_value(diff, (uint32_t) t, which)) == 0) {
+				ERR(diff, "%s", strerror(EBADRQC));	/* should never get here */
+				errno = EBADRQC;
+				return -1;
 			}
-			/* handle situation where a rule has as its
-			 * target an attribute without any types */
-			if (qpol_iterator_end(target_iter)) {
-				retval = 0;
-				goto cleanup;
+			if (avrule_add_to_bst(diff, p, rule, &key, source_val, target_val, b) < 0) {
+				return -1;
 			}
-		} else {
-			target = orig_target;
 		}
-		do {
-			if (target_attr) {
-				if (qpol_iterator_get_item(target_iter, (void **)&target) < 0) {
-					error = errno;
-					goto cleanup;
-				}
-				qpol_iterator_next(target_iter);
-			}
-#ifdef SETOOLS_DEBUG
-			const char *n1, *n2;
-			qpol_type_get_name(q, source, &n1);
-			qpol_type_get_name(q, target, &n2);
-#endif
-			if ((source_val = type_map_lookup(diff, source, which)) == 0 ||
-			    (target_val = type_map_lookup(diff, target, which)) == 0 ||
-			    avrule_add_to_bst(diff, p, rule, source_val, target_val, b) < 0) {
-				error = errno;
-				goto cleanup;
-			}
-		} while (target_attr && !qpol_iterator_end(target_iter));
-		qpol_iterator_destroy(&target_iter);
-	} while (source_attr && !qpol_iterator_end(source_iter));
-	retval = 0;
-      cleanup:
-	qpol_iterator_destroy(&source_iter);
-	qpol_iterator_destroy(&target_iter);
-	errno = error;
-	return retval;
+	}
+	return 0;
 }
 
 /**
@@ -1209,7 +1242,7 @@ static poldiff_avrule_t *make_avdiff(poldiff_t * diff, poldiff_form_e form, pseu
 	pa->spec = rule->spec;
 	pa->source = n1;
 	pa->target = n2;
-	pa->cls = rule->cls;
+	pa->cls = perm_index_get_class(diff, rule->cls);
 	pa->form = form;
 	pa->cond = rule->cond;
 	pa->branch = rule->branch;
@@ -1242,7 +1275,6 @@ static int avrule_new_diff(poldiff_t * diff, poldiff_form_e form, const void *it
 	const apol_vector_t *v1, *v2;
 	apol_vector_t **target;
 	apol_policy_t *p;
-	size_t i;
 	int retval = -1, error = errno;
 
 	/* check if form should really become ADD_TYPE / REMOVE_TYPE,
@@ -1292,19 +1324,15 @@ static int avrule_new_diff(poldiff_t * diff, poldiff_form_e form, const void *it
 		}
 		target = &pa->removed_perms;
 	}
-	if ((*target = apol_vector_create_with_capacity(rule->num_perms, NULL)) == NULL) {
+	if ((*target = apol_vector_create_with_capacity(1, NULL)) == NULL) {
 		error = errno;
 		ERR(diff, "%s", strerror(error));
 		goto cleanup;
 	}
-	for (i = 0; i < rule->num_perms; i++) {
-		if (apol_vector_append(*target, rule->perms[i]) < 0) {
-			error = errno;
-			ERR(diff, "%s", strerror(error));
-			goto cleanup;
-		}
+	if (perm_index_append_perms(diff, rule->cls, rule->perms, *target) < 0) {
+		error = errno;
+		goto cleanup;
 	}
-	apol_vector_sort(*target, apol_str_strcmp, NULL);
 
 	if (qpol_policy_has_capability(apol_policy_get_qpol(p), QPOL_CAP_LINE_NUMBERS)) {
 		/* calculate line numbers */
@@ -1417,8 +1445,6 @@ static int avrule_deep_diff(poldiff_t * diff, const void *x, const void *y, avru
 	pseudo_avrule_t *r1 = (pseudo_avrule_t *) x;
 	pseudo_avrule_t *r2 = (pseudo_avrule_t *) y;
 	apol_vector_t *unmodified_perms = NULL, *added_perms = NULL, *removed_perms = NULL;
-	size_t i, j;
-	char *perm1, *perm2;
 	poldiff_avrule_t *pa = NULL;
 	int retval = -1, error = 0;
 
@@ -1428,53 +1454,13 @@ static int avrule_deep_diff(poldiff_t * diff, const void *x, const void *y, avru
 		ERR(diff, "%s", strerror(error));
 		goto cleanup;
 	}
-	for (i = j = 0; i < r1->num_perms;) {
-		if (j >= r2->num_perms)
-			break;
-		perm1 = r1->perms[i];
-		perm2 = r2->perms[j];
-		if (perm2 > perm1) {
-			if (apol_vector_append(removed_perms, perm1) < 0) {
-				error = errno;
-				ERR(diff, "%s", strerror(error));
-				goto cleanup;
-			}
-			i++;
-		} else if (perm1 > perm2) {
-			if (apol_vector_append(added_perms, perm2) < 0) {
-				error = errno;
-				ERR(diff, "%s", strerror(error));
-				goto cleanup;
-			}
-			j++;
-		} else {
-			if (apol_vector_append(unmodified_perms, perm1) < 0) {
-				error = errno;
-				ERR(diff, "%s", strerror(error));
-				goto cleanup;
-			}
-			i++;
-			j++;
-		}
-	}
-
-	for (; i < r1->num_perms; i++) {
-		perm1 = r1->perms[i];
-		if (apol_vector_append(removed_perms, perm1) < 0) {
-			error = errno;
-			ERR(diff, "%s", strerror(error));
-			goto cleanup;
-		}
-	}
-	for (; j < r2->num_perms; j++) {
-		perm2 = r2->perms[j];
-		if (apol_vector_append(added_perms, perm2) < 0) {
-			error = errno;
-			ERR(diff, "%s", strerror(error));
-			goto cleanup;
-		}
+	if (perm_index_append_perms(diff, r1->cls, r1->perms & r2->perms, unmodified_perms) < 0 ||
+	    perm_index_append_perms(diff, r1->cls, r2->perms & ~r1->perms, added_perms) < 0 ||
+	    perm_index_append_perms(diff, r1->cls, r1->perms & ~r2->perms, removed_perms) < 0) {
+		error = errno;
+		goto cleanup;
 	}
-	if (apol_vector_get_size(added_perms) > 0 || apol_vector_get_size(removed_perms) > 0) {
+	if ((r1->perms ^ r2->perms) != 0) {
 		if ((pa = make_avdiff(diff, POLDIFF_FORM_MODIFIED, r1)) == NULL) {
 			error = errno;
 			goto cleanup;
@@ -1485,9 +1471,6 @@ static int avrule_deep_diff(poldiff_t * diff, const void *x, const void *y, avru
 		unmodified_perms = NULL;
 		added_perms = NULL;
 		removed_perms = NULL;
-		apol_vector_sort(pa->unmodified_perms, apol_str_strcmp, NULL);
-		apol_vector_sort(pa->added_perms, apol_str_strcmp, NULL);
-		apol_vector_sort(pa->removed_perms, apol_str_strcmp, NULL);
 
 		/* calculate line numbers */
 		if (qpol_policy_has_capability(apol_policy_get_qpol(diff->orig_pol), QPOL_CAP_LINE_NUMBERS)) {
@@ -1564,15 +1547,167 @@ int avrule_deep_diff_neverallow(poldiff_t * diff, const void *x, const void *y)
 	return avrule_deep_diff(diff, x, y, AVRULE_OFFSET_NEVERALLOW);
 }
 
+uint32_t avrule_hash(const void *item)
+{
+	const pseudo_avrule_t *r = (const pseudo_avrule_t *)item;
+	uint32_t h = r->source * 0x9e3779b1u;
+	h = (h ^ r->target) * 0x85ebca6bu;
+	h = (h ^ r->cls) * 0xc2b2ae35u;
+	return h ^ (h >> 16);
+}
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty AV rule results.  The results' vector does not free its
+ * elements, so that avrule_merge_shard() can move them elsewhere.
+ *
+ * @param shard Copy of the policy difference structure.
+ * @param idx Index into the AV rule differences specifying which
+ * results to replace.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+static int avrule_create_shard(poldiff_t * shard, avrule_offset_e idx)
+{
+	poldiff_avrule_summary_t *rs;
+	if ((rs = calloc(1, sizeof(*rs))) == NULL) {
+		return -1;
+	}
+	if ((rs->diffs = apol_vector_create(NULL)) == NULL) {
+		int error = errno;
+		free(rs);
+		errno = error;
+		return -1;
+	}
+	shard->avrule_diffs[idx] = rs;
+	return 0;
+}
+
+/**
+ * Append a shard's AV rule differences, and add its counts, to
+ * the policy difference structure's.  Then destroy the shard's
+ * results, along with any differences that were not moved.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * avrule_create_shard().
+ * @param idx Index into the AV rule differences specifying which
+ * results to move.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+static int avrule_merge_shard(poldiff_t * diff, poldiff_t * shard, avrule_offset_e idx)
+{
+	poldiff_avrule_summary_t *from = shard->avrule_diffs[idx], *to;
+	size_t i;
+	int retval = -1, error = 0;
+
+	if (from == NULL) {
+		return 0;
+	}
+	shard->avrule_diffs[idx] = NULL;
+	if (diff != NULL) {
+		to = diff->avrule_diffs[idx];
+		if (apol_vector_cat(to->diffs, from->diffs) < 0) {
+			error = errno;
+			ERR(diff, "%s", strerror(error));
+			goto cleanup;
+		}
+		apol_vector_destroy(&from->diffs);
+		to->num_added += from->num_added;
+		to->num_removed += from->num_removed;
+		to->num_modified += from->num_modified;
+		to->num_added_type += from->num_added_type;
+		to->num_removed_type += from->num_removed_type;
+		to->diffs_sorted = 0;
+	}
+	retval = 0;
+      cleanup:
+	for (i = 0; i < apol_vector_get_size(from->diffs); i++) {
+		poldiff_avrule_free(apol_vector_get_element(from->diffs, i));
+	}
+	apol_vector_destroy(&from->diffs);
+	free(from);
+	errno = error;
+	return retval;
+}
+
+int avrule_create_shard_allow(poldiff_t * shard)
+{
+	return avrule_create_shard(shard, AVRULE_OFFSET_ALLOW);
+}
+
+int avrule_create_shard_auditallow(poldiff_t * shard)
+{
+	return avrule_create_shard(shard, AVRULE_OFFSET_AUDITALLOW);
+}
+
+int avrule_create_shard_dontaudit(poldiff_t * shard)
+{
+	return avrule_create_shard(shard, AVRULE_OFFSET_DONTAUDIT);
+}
+
+int avrule_create_shard_neverallow(poldiff_t * shard)
+{
+	return avrule_create_shard(shard, AVRULE_OFFSET_NEVERALLOW);
+}
+
+int avrule_merge_shard_allow(poldiff_t * diff, poldiff_t * shard)
+{
+	return avrule_merge_shard(diff, shard, AVRULE_OFFSET_ALLOW);
+}
+
+int avrule_merge_shard_auditallow(poldiff_t * diff, poldiff_t * shard)
+{
+	return avrule_merge_shard(diff, shard, AVRULE_OFFSET_AUDITALLOW);
+}
+
+int avrule_merge_shard_dontaudit(poldiff_t * diff, poldiff_t * shard)
+{
+	return avrule_merge_shard(diff, shard, AVRULE_OFFSET_DONTAUDIT);
+}
+
+int avrule_merge_shard_neverallow(poldiff_t * diff, poldiff_t * shard)
+{
+	return avrule_merge_shard(diff, shard, AVRULE_OFFSET_NEVERALLOW);
+}
+
+/**
+ * Append the line numbers of every syntactic rule behind an array of
+ * qpol_avrule_t to a vector, then sort and uniquify it.
+ */
+static int avrule_append_line_numbers(poldiff_t * diff, const qpol_policy_t * q, qpol_avrule_t ** rules, size_t num_rules,
+				      apol_vector_t * v)
+{
+	const avrule_lines_t *l;
+	size_t i, j;
+	int error;
+
+	for (i = 0; i < num_rules; i++) {
+		if ((l = avrule_get_lines(diff, q, rules[i])) == NULL) {
+			return -1;
+		}
+		for (j = 0; j < l->num_lines; j++) {
+			if (apol_vector_append(v, (void *)l->lines[j].lineno) < 0) {
+				error = errno;
+				ERR(diff, "%s", strerror(error));
+				errno = error;
+				return -1;
+			}
+		}
+	}
+	apol_vector_sort_uniquify(v, NULL, NULL);
+	return 0;
+}
+
 int avrule_enable_line_numbers(poldiff_t * diff, avrule_offset_e idx)
 {
 	const apol_vector_t *av = NULL;
 	poldiff_avrule_t *avrule = NULL;
-	size_t i, j;
-	qpol_iterator_t *iter = NULL;
-	qpol_syn_avrule_t *sav = NULL;
-	int error = 0;
-	unsigned long lineno = 0;
+	size_t i;
 
 	av = poldiff_get_avrule_vector(diff, idx);
 
@@ -1580,57 +1715,12 @@ int avrule_enable_line_numbers(poldiff_t * diff, avrule_offset_e idx)
 		avrule = apol_vector_get_element(av, i);
 		if (apol_vector_get_size(avrule->mod_linenos) || apol_vector_get_size(avrule->orig_linenos))
 			continue;
-		for (j = 0; j < avrule->num_orig_rules; j++) {
-			if (qpol_avrule_get_syn_avrule_iter(diff->orig_qpol, avrule->orig_rules[j], &iter)) {
-				error = errno;
-				goto err;
-			}
-			for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-				if (qpol_iterator_get_item(iter, (void **)&sav) < 0) {
-					error = errno;
-					ERR(diff, "%s", strerror(error));
-					goto err;
-				}
-				if (qpol_syn_avrule_get_lineno(diff->orig_qpol, sav, &lineno) < 0) {
-					error = errno;
-					goto err;
-				}
-				if (apol_vector_append(avrule->orig_linenos, (void *)lineno) < 0) {
-					error = errno;
-					ERR(diff, "%s", strerror(error));
-					goto err;
-				}
-			}
-			qpol_iterator_destroy(&iter);
-		}
-		apol_vector_sort_uniquify(avrule->orig_linenos, NULL, NULL);
-		for (j = 0; j < avrule->num_mod_rules; j++) {
-			if (qpol_avrule_get_syn_avrule_iter(diff->mod_qpol, avrule->mod_rules[j], &iter)) {
-				error = errno;
-				goto err;
-			}
-			for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-				if (qpol_iterator_get_item(iter, (void **)&sav) < 0) {
-					error = errno;
-					ERR(diff, "%s", strerror(error));
-					goto err;
-				}
-				if (qpol_syn_avrule_get_lineno(diff->mod_qpol, sav, &lineno) < 0) {
-					error = errno;
-					goto err;
-				}
-				if (apol_vector_append(avrule->mod_linenos, (void *)lineno) < 0) {
-					error = errno;
-					ERR(diff, "%s", strerror(error));
-					goto err;
-				}
-			}
-			qpol_iterator_destroy(&iter);
+		if (avrule_append_line_numbers(diff, diff->orig_qpol, avrule->orig_rules, avrule->num_orig_rules,
+					       avrule->orig_linenos) < 0 ||
+		    avrule_append_line_numbers(diff, diff->mod_qpol, avrule->mod_rules, avrule->num_mod_rules,
+					       avrule->mod_linenos) < 0) {
+			return -1;
 		}
-		apol_vector_sort_uniquify(avrule->mod_linenos, NULL, NULL);
 	}
 	return 0;
-      err:
-	qpol_iterator_destroy(&iter);
-	return -1;
 }
@@ -162,6 +162,16 @@ extern "C"
  */
 	int avrule_comp(const void *x, const void *y, const poldiff_t * diff);
 
+/**
+ * Hash a pseudo_avrule_t by its source, target, and class.  Rules for which
+ * avrule_comp() returns 0 always have the same hash.
+ *
+ * @param item The pseudo-av rule to hash.
+ *
+ * @return Hash value for the rule.
+ */
+	uint32_t avrule_hash(const void *item);
+
 /**
  * Create, initialize, and insert a new semantic difference entry for
  * a pseudo-av rule that was originally an allow rule.
@@ -278,6 +288,106 @@ extern "C"
  */
 	int avrule_deep_diff_neverallow(poldiff_t * diff, const void *x, const void *y);
 
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for AV allow rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int avrule_create_shard_allow(poldiff_t * shard);
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for AV auditallow rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int avrule_create_shard_auditallow(poldiff_t * shard);
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for AV dontaudit rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int avrule_create_shard_dontaudit(poldiff_t * shard);
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for AV neverallow rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int avrule_create_shard_neverallow(poldiff_t * shard);
+
+/**
+ * Move a shard's results for AV allow rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * avrule_create_shard_allow().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int avrule_merge_shard_allow(poldiff_t * diff, poldiff_t * shard);
+
+/**
+ * Move a shard's results for AV auditallow rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * avrule_create_shard_auditallow().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int avrule_merge_shard_auditallow(poldiff_t * diff, poldiff_t * shard);
+
+/**
+ * Move a shard's results for AV dontaudit rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * avrule_create_shard_dontaudit().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int avrule_merge_shard_dontaudit(poldiff_t * diff, poldiff_t * shard);
+
+/**
+ * Move a shard's results for AV neverallow rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * avrule_create_shard_neverallow().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int avrule_merge_shard_neverallow(poldiff_t * diff, poldiff_t * shard);
+
 /**
  * Iterate through an AV rule difference, filling in its line numbers.
  *
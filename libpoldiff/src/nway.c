@@ -0,0 +1,391 @@
+/**
+ *  @file
+ *  Implementation of N-way comparison of a baseline policy against
+ *  many variants.  One poldiff structure keeps the baseline loaded,
+ *  along with its expanded rules; each variant in turn replaces its
+ *  modified policy, and the differences are streamed into per-item
+ *  entries rather than kept.  Pseudo-type values belong to one pair
+ *  of policies, so entries are keyed by rendered names instead.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include "poldiff_internal.h"
+
+#include <poldiff/nway.h>
+#include <poldiff/component_record.h>
+#include <apol/condrule-query.h>
+#include <apol/util.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct poldiff_nway_entry
+{
+	uint32_t which;
+	char *key;
+	/** variants that add, remove, and modify the item */
+	apol_bitmap_t *forms[3];
+};
+
+struct poldiff_nway
+{
+	/** baseline policy, until it is given to diff */
+	apol_policy_t *baseline;
+	/** difference structure holding the baseline and the most
+	 *  recent variant */
+	poldiff_t *diff;
+	poldiff_handle_fn_t fn;
+	void *handle_arg;
+	size_t num_variants, max_variants;
+	/** BST of poldiff_nway_entry_t, by component and key */
+	apol_bst_t *entries;
+	/** sorted vector of entries, built when first requested */
+	apol_vector_t *entries_v;
+};
+
+static int nway_entry_comp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	const poldiff_nway_entry_t *x = (const poldiff_nway_entry_t *)a;
+	const poldiff_nway_entry_t *y = (const poldiff_nway_entry_t *)b;
+	if (x->which != y->which) {
+		return (x->which < y->which ? -1 : 1);
+	}
+	return strcmp(x->key, y->key);
+}
+
+static void nway_entry_free(void *elem)
+{
+	poldiff_nway_entry_t *e = (poldiff_nway_entry_t *) elem;
+	size_t i;
+	if (e != NULL) {
+		free(e->key);
+		for (i = 0; i < 3; i++) {
+			apol_bitmap_destroy(&e->forms[i]);
+		}
+		free(e);
+	}
+}
+
+/**
+ * Append a rule's conditional, if it has one, to a key in the same
+ * form that the to_string functions use.
+ */
+static int nway_append_cond(const qpol_cond_t * cond, uint32_t which_list, const apol_policy_t * p, char **key, size_t * len)
+{
+	char *expr;
+	int retval;
+	if (cond == NULL) {
+		return 0;
+	}
+	if ((expr = apol_cond_expr_render(p, cond)) == NULL) {
+		return -1;
+	}
+	retval = apol_str_appendf(key, len, "  [%s]:%s", expr, (which_list ? "TRUE" : "FALSE"));
+	free(expr);
+	return retval;
+}
+
+/**
+ * Build the key that identifies a difference item across variants.
+ *
+ * @return A newly allocated key, or NULL on error.
+ */
+static char *nway_item_key(const poldiff_t * diff, uint32_t which, const void *item)
+{
+	const qpol_cond_t *cond;
+	const apol_policy_t *p;
+	uint32_t which_list;
+	const char *name = NULL;
+	char *key = NULL;
+	size_t len = 0;
+	int retval = 0;
+
+	if (which & POLDIFF_DIFF_AVRULES) {
+		const poldiff_avrule_t *avrule = item;
+		poldiff_avrule_get_cond(diff, avrule, &cond, &which_list, &p);
+		retval = apol_str_appendf(&key, &len, "%s %s : %s", poldiff_avrule_get_source_type(avrule),
+					  poldiff_avrule_get_target_type(avrule), poldiff_avrule_get_object_class(avrule));
+		if (retval == 0)
+			retval = nway_append_cond(cond, which_list, p, &key, &len);
+	} else if (which & POLDIFF_DIFF_TERULES) {
+		const poldiff_terule_t *terule = item;
+		poldiff_terule_get_cond(diff, terule, &cond, &which_list, &p);
+		retval = apol_str_appendf(&key, &len, "%s %s : %s", poldiff_terule_get_source_type(terule),
+					  poldiff_terule_get_target_type(terule), poldiff_terule_get_object_class(terule));
+		if (retval == 0)
+			retval = nway_append_cond(cond, which_list, p, &key, &len);
+	} else if (which == POLDIFF_DIFF_ROLE_TRANS) {
+		retval = apol_str_appendf(&key, &len, "%s %s", poldiff_role_trans_get_source_role(item),
+					  poldiff_role_trans_get_target_type(item));
+	} else if (which == POLDIFF_DIFF_RANGE_TRANS) {
+		retval = apol_str_appendf(&key, &len, "%s %s : %s", poldiff_range_trans_get_source_type(item),
+					  poldiff_range_trans_get_target_type(item), poldiff_range_trans_get_target_class(item));
+	} else {
+		switch (which) {
+		case POLDIFF_DIFF_CLASSES:
+			name = poldiff_class_get_name(item);
+			break;
+		case POLDIFF_DIFF_COMMONS:
+			name = poldiff_common_get_name(item);
+			break;
+		case POLDIFF_DIFF_TYPES:
+			name = poldiff_type_get_name(item);
+			break;
+		case POLDIFF_DIFF_ATTRIBS:
+			name = poldiff_attrib_get_name(item);
+			break;
+		case POLDIFF_DIFF_ROLES:
+			name = poldiff_role_get_name(item);
+			break;
+		case POLDIFF_DIFF_USERS:
+			name = poldiff_user_get_name(item);
+			break;
+		case POLDIFF_DIFF_BOOLS:
+			name = poldiff_bool_get_name(item);
+			break;
+		case POLDIFF_DIFF_LEVELS:
+			name = poldiff_level_get_name(item);
+			break;
+		case POLDIFF_DIFF_CATS:
+			name = poldiff_cat_get_name(item);
+			break;
+		case POLDIFF_DIFF_ROLE_ALLOWS:
+			name = poldiff_role_allow_get_name(item);
+			break;
+		default:
+			errno = EINVAL;
+			return NULL;
+		}
+		if (name == NULL || (key = strdup(name)) == NULL) {
+			return NULL;
+		}
+	}
+	if (retval < 0) {
+		free(key);
+		return NULL;
+	}
+	return key;
+}
+
+/**
+ * Record one difference found while adding a variant.  This is the
+ * item callback given to the poldiff structure.
+ */
+static int nway_record_item(void *arg, const poldiff_t * diff, uint32_t which, const void *item)
+{
+	poldiff_nway_t *nway = (poldiff_nway_t *) arg;
+	poldiff_nway_entry_t key, *e = NULL;
+	poldiff_form_e form;
+	size_t i;
+	int error, f;
+
+	form = poldiff_component_record_get_form_fn(poldiff_get_component_record(which)) (item);
+	switch (form) {
+	case POLDIFF_FORM_ADDED:
+	case POLDIFF_FORM_ADD_TYPE:
+		f = 0;
+		break;
+	case POLDIFF_FORM_REMOVED:
+	case POLDIFF_FORM_REMOVE_TYPE:
+		f = 1;
+		break;
+	case POLDIFF_FORM_MODIFIED:
+		f = 2;
+		break;
+	default:
+		return 0;
+	}
+	key.which = which;
+	if ((key.key = nway_item_key(diff, which, item)) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	if (apol_bst_get_element(nway->entries, &key, NULL, (void **)&e) < 0) {
+		if ((e = calloc(1, sizeof(*e))) == NULL) {
+			error = errno;
+			goto err;
+		}
+		e->which = which;
+		e->key = key.key;
+		key.key = NULL;
+		for (i = 0; i < 3; i++) {
+			if ((e->forms[i] = apol_bitmap_create(nway->max_variants)) == NULL) {
+				error = errno;
+				goto err;
+			}
+		}
+		if (apol_bst_insert(nway->entries, e, NULL) < 0) {
+			error = errno;
+			goto err;
+		}
+	}
+	free(key.key);
+	return apol_bitmap_set(e->forms[f], nway->num_variants);
+      err:
+	free(key.key);
+	nway_entry_free(e);
+	ERR(diff, "%s", strerror(error));
+	errno = error;
+	return -1;
+}
+
+poldiff_nway_t *poldiff_nway_create(apol_policy_t * baseline, size_t num_variants, poldiff_handle_fn_t fn, void *callback_arg)
+{
+	poldiff_nway_t *nway = NULL;
+	int error;
+
+	if (baseline == NULL) {
+		ERR(NULL, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((nway = calloc(1, sizeof(*nway))) == NULL || (nway->entries = apol_bst_create(nway_entry_comp, nway_entry_free)) == NULL) {
+		error = errno;
+		free(nway);
+		ERR(NULL, "%s", strerror(error));
+		errno = error;
+		return NULL;
+	}
+	nway->baseline = baseline;
+	nway->max_variants = num_variants;
+	nway->fn = fn;
+	nway->handle_arg = callback_arg;
+	return nway;
+}
+
+void poldiff_nway_destroy(poldiff_nway_t ** nway)
+{
+	if (nway == NULL || *nway == NULL)
+		return;
+	apol_policy_destroy(&(*nway)->baseline);
+	poldiff_destroy(&(*nway)->diff);
+	apol_bst_destroy(&(*nway)->entries);
+	apol_vector_destroy(&(*nway)->entries_v);
+	free(*nway);
+	*nway = NULL;
+}
+
+int poldiff_nway_add_variant(poldiff_nway_t * nway, apol_policy_t * variant, uint32_t flags)
+{
+	int error;
+
+	if (nway == NULL || variant == NULL || nway->num_variants >= nway->max_variants) {
+		ERR(nway == NULL ? NULL : nway->diff, "%s", strerror(EINVAL));
+		apol_policy_destroy(&variant);
+		errno = EINVAL;
+		return -1;
+	}
+	apol_vector_destroy(&nway->entries_v);
+	if (nway->diff == NULL) {
+		/* the baseline now belongs to the poldiff structure */
+		nway->diff = poldiff_create(nway->baseline, variant, nway->fn, nway->handle_arg);
+		nway->baseline = NULL;
+		if (nway->diff == NULL) {
+			return -1;
+		}
+		poldiff_set_keep_baseline(nway->diff, 1);
+	} else if (poldiff_set_mod_policy(nway->diff, variant) < 0) {
+		return -1;
+	}
+	poldiff_set_item_callback(nway->diff, nway_record_item, nway);
+	if (poldiff_run(nway->diff, flags) < 0) {
+		error = errno;
+		poldiff_set_item_callback(nway->diff, NULL, NULL);
+		errno = error;
+		return -1;
+	}
+	poldiff_set_item_callback(nway->diff, NULL, NULL);
+	return (int)nway->num_variants++;
+}
+
+size_t poldiff_nway_get_num_variants(const poldiff_nway_t * nway)
+{
+	if (nway == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return nway->num_variants;
+}
+
+const apol_vector_t *poldiff_nway_get_entries(const poldiff_nway_t * nway)
+{
+	/* the sorted vector is a cache, so it may be built through a
+	 * const comparison */
+	poldiff_nway_t *n = (poldiff_nway_t *) nway;
+	int error;
+
+	if (nway == NULL) {
+		ERR(NULL, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if (n->entries_v == NULL && (n->entries_v = apol_bst_get_vector(n->entries, 0)) == NULL) {
+		error = errno;
+		ERR(nway->diff, "%s", strerror(error));
+		errno = error;
+		return NULL;
+	}
+	return n->entries_v;
+}
+
+const poldiff_nway_entry_t *poldiff_nway_get_entry(const poldiff_nway_t * nway, uint32_t which, const char *key)
+{
+	poldiff_nway_entry_t k, *e = NULL;
+
+	if (nway == NULL || key == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	k.which = which;
+	k.key = (char *)key;
+	if (apol_bst_get_element(nway->entries, &k, NULL, (void **)&e) < 0) {
+		return NULL;
+	}
+	return e;
+}
+
+uint32_t poldiff_nway_entry_get_component(const poldiff_nway_entry_t * entry)
+{
+	if (entry == NULL) {
+		errno = EINVAL;
+		return 0;
+	}
+	return entry->which;
+}
+
+const char *poldiff_nway_entry_get_key(const poldiff_nway_entry_t * entry)
+{
+	if (entry == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return entry->key;
+}
+
+const apol_bitmap_t *poldiff_nway_entry_get_variants(const poldiff_nway_entry_t * entry, poldiff_form_e form)
+{
+	if (entry == NULL || form < POLDIFF_FORM_ADDED || form > POLDIFF_FORM_MODIFIED) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return entry->forms[form - POLDIFF_FORM_ADDED];
+}
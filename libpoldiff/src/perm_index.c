@@ -0,0 +1,323 @@
+/**
+ *  @file
+ *  Implementation of the unified permission index.  Classes and
+ *  permissions are numbered by name across both policies, and each
+ *  policy's own class and permission values are mapped onto those
+ *  numbers, so that a rule's permissions become one bitmask that is
+ *  comparable between the policies.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include "poldiff_internal.h"
+
+#include <apol/policy-query.h>
+#include <apol/util.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* one class, with the union of its permissions in both policies */
+typedef struct perm_index_class
+{
+	/** pointer into the class_bst BST */
+	char *cls;
+	/** pointers into the perm_bst BST, sorted by name; bit i of a
+	 *  permission mask is perms[i] */
+	char *perms[PERM_INDEX_MAX_PERMS];
+	size_t num_perms;
+} perm_index_class_t;
+
+/* one policy's class, mapped onto the index */
+typedef struct perm_index_map
+{
+	/** unified class index plus one, or 0 if the value is unused */
+	uint32_t cls;
+	/** unified bit of the permission with value v is bits[v - 1],
+	 *  or PERM_INDEX_UNMAPPED if the class has no such permission */
+	unsigned char bits[32];
+} perm_index_map_t;
+
+#define PERM_INDEX_UNMAPPED 0xff
+
+struct perm_index
+{
+	/** every class of either policy, sorted by name */
+	perm_index_class_t *classes;
+	size_t num_classes;
+	/** for the original and modified policies, indexed by class
+	 *  value */
+	perm_index_map_t *maps[2];
+	size_t num_maps[2];
+};
+
+static int perm_name_comp(const void *a, const void *b)
+{
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * Visit every permission of a class, including those from its
+ * common.  If map is NULL then add the permissions to the class's
+ * entry; otherwise record where each permission's value lands within
+ * the entry.
+ */
+static int perm_index_walk_class(poldiff_t * diff, qpol_policy_t * q, const qpol_class_t * obj_class, perm_index_class_t * entry,
+				 perm_index_map_t * map)
+{
+	const qpol_common_t *common;
+	qpol_iterator_t *iter = NULL;
+	char *perm_name, *pseudo_perm;
+	uint32_t perm_value;
+	size_t i;
+	int k, retval = -1, error = 0;
+
+	if (qpol_class_get_common(q, obj_class, &common) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	for (k = 0; k < 2; k++) {
+		if (k == 0 && common == NULL) {
+			continue;
+		}
+		if ((k == 0 && qpol_common_get_perm_iter(q, common, &iter) < 0) ||
+		    (k == 1 && qpol_class_get_perm_iter(q, obj_class, &iter) < 0)) {
+			error = errno;
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			if (qpol_iterator_get_item(iter, (void **)&perm_name) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+			if (apol_bst_get_element(diff->perm_bst, perm_name, NULL, (void **)&pseudo_perm) < 0) {
+				error = EBADRQC;	/* should never get here */
+				ERR(diff, "%s", strerror(error));
+				goto cleanup;
+			}
+			for (i = 0; i < entry->num_perms && entry->perms[i] != pseudo_perm; i++) ;
+			if (map == NULL) {
+				if (i < entry->num_perms) {
+					continue;
+				}
+				if (entry->num_perms >= PERM_INDEX_MAX_PERMS) {
+					error = ERANGE;
+					ERR(diff, "Class %s has too many permissions.", entry->cls);
+					goto cleanup;
+				}
+				entry->perms[entry->num_perms++] = pseudo_perm;
+			} else {
+				if (qpol_class_get_perm_value(q, obj_class, perm_name, &perm_value) < 0) {
+					error = errno;
+					goto cleanup;
+				}
+				if (i < entry->num_perms && perm_value >= 1 && perm_value <= 32) {
+					map->bits[perm_value - 1] = (unsigned char)i;
+				}
+			}
+		}
+		qpol_iterator_destroy(&iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	errno = error;
+	return retval;
+}
+
+/**
+ * Find a class's entry within the index by name, or NULL if it has
+ * none.
+ */
+static perm_index_class_t *perm_index_find_class(const perm_index_t * idx, const char *name)
+{
+	size_t lo = 0, hi = idx->num_classes;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int compval = strcmp(idx->classes[mid].cls, name);
+		if (compval == 0) {
+			return idx->classes + mid;
+		} else if (compval < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return NULL;
+}
+
+perm_index_t *perm_index_build(poldiff_t * diff)
+{
+	perm_index_t *idx = NULL;
+	apol_vector_t *names = NULL, *classes = NULL;
+	const qpol_class_t *obj_class;
+	const char *class_name;
+	perm_index_class_t *entry;
+	uint32_t class_value;
+	size_t i, j;
+	int pass, which, error = 0;
+
+	if ((idx = calloc(1, sizeof(*idx))) == NULL || (names = apol_bst_get_vector(diff->class_bst, 0)) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto err;
+	}
+	idx->num_classes = apol_vector_get_size(names);
+	if ((idx->classes = calloc(idx->num_classes + 1, sizeof(*idx->classes))) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto err;
+	}
+	for (i = 0; i < idx->num_classes; i++) {
+		idx->classes[i].cls = apol_vector_get_element(names, i);
+	}
+
+	/* first collect every class's permissions from both policies
+	 * and number them by name, then map each policy's own values
+	 * onto those numbers */
+	for (pass = 0; pass < 2; pass++) {
+		for (which = 0; which < 2; which++) {
+			apol_policy_t *p = (which == 0 ? diff->orig_pol : diff->mod_pol);
+			qpol_policy_t *q = apol_policy_get_qpol(p);
+			if (apol_class_get_by_query(p, NULL, &classes) < 0) {
+				error = errno;
+				goto err;
+			}
+			if (pass == 1) {
+				for (j = 0; j < apol_vector_get_size(classes); j++) {
+					obj_class = apol_vector_get_element(classes, j);
+					if (qpol_class_get_value(q, obj_class, &class_value) < 0) {
+						error = errno;
+						goto err;
+					}
+					if (class_value >= idx->num_maps[which])
+						idx->num_maps[which] = class_value + 1;
+				}
+				if ((idx->maps[which] = calloc(idx->num_maps[which] + 1, sizeof(perm_index_map_t))) == NULL) {
+					error = errno;
+					ERR(diff, "%s", strerror(error));
+					goto err;
+				}
+			}
+			for (j = 0; j < apol_vector_get_size(classes); j++) {
+				perm_index_map_t *map = NULL;
+				obj_class = apol_vector_get_element(classes, j);
+				if (qpol_class_get_name(q, obj_class, &class_name) < 0 ||
+				    qpol_class_get_value(q, obj_class, &class_value) < 0) {
+					error = errno;
+					goto err;
+				}
+				if ((entry = perm_index_find_class(idx, class_name)) == NULL) {
+					error = EBADRQC;	/* should never get here */
+					ERR(diff, "%s", strerror(error));
+					goto err;
+				}
+				if (pass == 1) {
+					map = idx->maps[which] + class_value;
+					map->cls = (uint32_t) (entry - idx->classes) + 1;
+					memset(map->bits, PERM_INDEX_UNMAPPED, sizeof(map->bits));
+				}
+				if (perm_index_walk_class(diff, q, obj_class, entry, map) < 0) {
+					error = errno;
+					goto err;
+				}
+			}
+			apol_vector_destroy(&classes);
+		}
+		if (pass == 0) {
+			for (i = 0; i < idx->num_classes; i++) {
+				qsort(idx->classes[i].perms, idx->classes[i].num_perms, sizeof(char *), perm_name_comp);
+			}
+		}
+	}
+	apol_vector_destroy(&names);
+	return idx;
+
+      err:
+	apol_vector_destroy(&names);
+	apol_vector_destroy(&classes);
+	perm_index_destroy(&idx);
+	errno = error;
+	return NULL;
+}
+
+void perm_index_destroy(perm_index_t ** idx)
+{
+	if (idx == NULL || *idx == NULL)
+		return;
+	free((*idx)->classes);
+	free((*idx)->maps[0]);
+	free((*idx)->maps[1]);
+	free(*idx);
+	*idx = NULL;
+}
+
+int perm_index_orig_equal(const perm_index_t * a, const perm_index_t * b)
+{
+	if (a == NULL || b == NULL || a->num_maps[0] != b->num_maps[0]) {
+		return 0;
+	}
+	return memcmp(a->maps[0], b->maps[0], a->num_maps[0] * sizeof(perm_index_map_t)) == 0;
+}
+
+int perm_index_lookup(const poldiff_t * diff, int which_pol, uint32_t class_value, uint32_t mask, uint32_t * cls,
+		      uint64_t * perms)
+{
+	const perm_index_t *idx = diff->perm_index;
+	const perm_index_map_t *map;
+	int which = (which_pol == POLDIFF_POLICY_ORIG ? 0 : 1);
+
+	if (idx == NULL || class_value >= idx->num_maps[which] || idx->maps[which][class_value].cls == 0) {
+		ERR(diff, "%s", strerror(EBADRQC));
+		errno = EBADRQC;
+		return -1;
+	}
+	map = idx->maps[which] + class_value;
+	*cls = map->cls - 1;
+	*perms = 0;
+	for (; mask != 0; mask &= mask - 1) {
+		unsigned char bit = map->bits[__builtin_ctz(mask)];
+		if (bit == PERM_INDEX_UNMAPPED) {
+			ERR(diff, "Class %s has no permission with value %d.", idx->classes[*cls].cls, __builtin_ctz(mask) + 1);
+			errno = EBADRQC;
+			return -1;
+		}
+		*perms |= (uint64_t) 1 << bit;
+	}
+	return 0;
+}
+
+char *perm_index_get_class(const poldiff_t * diff, uint32_t cls)
+{
+	return diff->perm_index->classes[cls].cls;
+}
+
+int perm_index_append_perms(const poldiff_t * diff, uint32_t cls, uint64_t perms, apol_vector_t * v)
+{
+	const perm_index_class_t *entry = diff->perm_index->classes + cls;
+	for (; perms != 0; perms &= perms - 1) {
+		if (apol_vector_append(v, entry->perms[__builtin_ctzll(perms)]) < 0) {
+			int error = errno;
+			ERR(diff, "%s", strerror(error));
+			errno = error;
+			return -1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ *  @file
+ *  Protected interface for the unified permission index, which
+ *  numbers the classes and permissions of both policies so that
+ *  pseudo-rules can hold their permissions as bitmasks.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef POLDIFF_PERM_INDEX_INTERNAL_H
+#define POLDIFF_PERM_INDEX_INTERNAL_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <apol/vector.h>
+#include <stdint.h>
+
+	typedef struct perm_index perm_index_t;
+
+/** most permissions that one class may have across both policies */
+#define PERM_INDEX_MAX_PERMS 64
+
+/**
+ *  Build the permission index for a policy difference structure.
+ *  Each class named by either policy gets an index, by order of name;
+ *  each permission of that class in either policy gets a bit, again
+ *  by order of name.  The class and permission BSTs must have been
+ *  built first (see poldiff_build_bsts()).
+ *
+ *  @param diff Policy difference structure containing the policies.
+ *
+ *  @return A new permission index.  The caller must call
+ *  perm_index_destroy() afterwards.  On error, return NULL and set
+ *  errno.
+ */
+	perm_index_t *perm_index_build(poldiff_t * diff);
+
+/**
+ *  Free all memory used by a permission index.
+ *
+ *  @param idx Reference pointer to the index to destroy.  This
+ *  pointer will be set to NULL afterwards.
+ */
+	void perm_index_destroy(perm_index_t ** idx);
+
+/**
+ *  Determine if two permission indexes give every class and
+ *  permission of the original policy the same unified index and bit.
+ *  Pseudo-rules gathered from the original policy under one index are
+ *  then valid under the other.
+ *
+ *  @param a A permission index.
+ *  @param b Another permission index.
+ *
+ *  @return Non-zero if the indexes agree upon the original policy, 0
+ *  if not or if either is NULL.
+ */
+	int perm_index_orig_equal(const perm_index_t * a, const perm_index_t * b);
+
+/**
+ *  Convert a class and a set of its permissions, as given by one
+ *  policy, to the unified class index and permission bitmask.
+ *
+ *  @param diff Policy difference structure whose index to use.
+ *  @param which_pol One of POLDIFF_POLICY_ORIG or POLDIFF_POLICY_MOD.
+ *  @param class_value Value of the class within that policy.
+ *  @param mask Permissions within that policy, where the permission
+ *  with value v is bit (v - 1); see qpol_avrule_get_perm_mask().
+ *  @param cls Reference to the unified class index.
+ *  @param perms Reference to the unified permission bitmask.
+ *
+ *  @return 0 on success, < 0 if the class is not indexed or if the
+ *  mask holds a value that the class does not define.
+ */
+	int perm_index_lookup(const poldiff_t * diff, int which_pol, uint32_t class_value, uint32_t mask, uint32_t * cls,
+			      uint64_t * perms);
+
+/**
+ *  Get the name of a class from its unified index.
+ *
+ *  @param diff Policy difference structure whose index to use.
+ *  @param cls Unified class index.
+ *
+ *  @return Name of the class, a pointer into the class BST.
+ */
+	char *perm_index_get_class(const poldiff_t * diff, uint32_t cls);
+
+/**
+ *  Append the names of a set of permissions to a vector, in order of
+ *  name.
+ *
+ *  @param diff Policy difference structure whose index to use.
+ *  @param cls Unified class index.
+ *  @param perms Unified permission bitmask for that class.
+ *  @param v Vector to which to append pointers into the permission
+ *  BST (char *).
+ *
+ *  @return 0 on success, < 0 on error.
+ */
+	int perm_index_append_perms(const poldiff_t * diff, uint32_t cls, uint64_t perms, apol_vector_t * v);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif				       /* POLDIFF_PERM_INDEX_INTERNAL_H */
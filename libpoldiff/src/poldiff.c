@@ -27,6 +27,7 @@
 #include "poldiff_internal.h"
 #include <poldiff/component_record.h>
 
+#include <apol/parallel.h>
 #include <apol/util.h>
 #include <qpol/policy_extend.h>
 #include <errno.h>
@@ -51,6 +52,20 @@ struct poldiff_component_record
 	poldiff_item_comp_fn_t comp;
 	poldiff_new_diff_fn_t new_diff;
 	poldiff_deep_diff_fn_t deep_diff;
+	/** non-zero if the component maps types through the type map
+	 *  (see type_map_build()) */
+	int uses_type_map;
+	/** non-zero if the component's items from the original policy
+	 *  depend only upon that policy, the type map, and the
+	 *  permission index, and so may be kept across
+	 *  poldiff_set_mod_policy() */
+	int keeps_orig_items;
+	/** if not NULL, hash used to split the component's items into
+	 *  shards that are diffed in parallel; the two shard callbacks
+	 *  below must then be set too */
+	poldiff_item_hash_fn_t hash;
+	poldiff_create_shard_fn_t create_shard;
+	poldiff_merge_shard_fn_t merge_shard;
 };
 
 static const poldiff_component_record_t component_records[] = {
@@ -66,6 +81,11 @@ static const poldiff_component_record_t component_records[] = {
 	 attrib_comp,
 	 attrib_new_diff,
 	 attrib_deep_diff,
+	 1,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "Allow Rules",
@@ -79,6 +99,11 @@ static const poldiff_component_record_t component_records[] = {
 	 avrule_comp,
 	 avrule_new_diff_allow,
 	 avrule_deep_diff_allow,
+	 1,
+	 1,
+	 avrule_hash,
+	 avrule_create_shard_allow,
+	 avrule_merge_shard_allow,
 	 },
 	{
 	 "Audit Allow Rules",
@@ -92,6 +117,11 @@ static const poldiff_component_record_t component_records[] = {
 	 avrule_comp,
 	 avrule_new_diff_auditallow,
 	 avrule_deep_diff_auditallow,
+	 1,
+	 1,
+	 avrule_hash,
+	 avrule_create_shard_auditallow,
+	 avrule_merge_shard_auditallow,
 	 },
 	{
 	 "Don't Audit Rules",
@@ -105,6 +135,11 @@ static const poldiff_component_record_t component_records[] = {
 	 avrule_comp,
 	 avrule_new_diff_dontaudit,
 	 avrule_deep_diff_dontaudit,
+	 1,
+	 1,
+	 avrule_hash,
+	 avrule_create_shard_dontaudit,
+	 avrule_merge_shard_dontaudit,
 	 },
 	{
 	 "Never Allow Rules",
@@ -118,6 +153,11 @@ static const poldiff_component_record_t component_records[] = {
 	 avrule_comp,
 	 avrule_new_diff_neverallow,
 	 avrule_deep_diff_neverallow,
+	 1,
+	 1,
+	 avrule_hash,
+	 avrule_create_shard_neverallow,
+	 avrule_merge_shard_neverallow,
 	 },
 	{
 	 "bool",
@@ -131,6 +171,11 @@ static const poldiff_component_record_t component_records[] = {
 	 bool_comp,
 	 bool_new_diff,
 	 bool_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "category",
@@ -144,6 +189,11 @@ static const poldiff_component_record_t component_records[] = {
 	 cat_comp,
 	 cat_new_diff,
 	 cat_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "class",
@@ -157,6 +207,11 @@ static const poldiff_component_record_t component_records[] = {
 	 class_comp,
 	 class_new_diff,
 	 class_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "common",
@@ -170,6 +225,11 @@ static const poldiff_component_record_t component_records[] = {
 	 common_comp,
 	 common_new_diff,
 	 common_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "level",
@@ -183,6 +243,11 @@ static const poldiff_component_record_t component_records[] = {
 	 level_comp,
 	 level_new_diff,
 	 level_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "range transition",
@@ -196,6 +261,11 @@ static const poldiff_component_record_t component_records[] = {
 	 range_trans_comp,
 	 range_trans_new_diff,
 	 range_trans_deep_diff,
+	 1,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "role",
@@ -209,6 +279,11 @@ static const poldiff_component_record_t component_records[] = {
 	 role_comp,
 	 role_new_diff,
 	 role_deep_diff,
+	 1,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "role_allow",
@@ -222,6 +297,11 @@ static const poldiff_component_record_t component_records[] = {
 	 role_allow_comp,
 	 role_allow_new_diff,
 	 role_allow_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "role_transition",
@@ -235,6 +315,11 @@ static const poldiff_component_record_t component_records[] = {
 	 role_trans_comp,
 	 role_trans_new_diff,
 	 role_trans_deep_diff,
+	 1,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "Type Change rules",
@@ -248,6 +333,11 @@ static const poldiff_component_record_t component_records[] = {
 	 terule_comp,
 	 terule_new_diff_change,
 	 terule_deep_diff_change,
+	 1,
+	 1,
+	 terule_hash,
+	 terule_create_shard_change,
+	 terule_merge_shard_change,
 	 },
 	{
 	 "Type Member Rules",
@@ -261,6 +351,11 @@ static const poldiff_component_record_t component_records[] = {
 	 terule_comp,
 	 terule_new_diff_member,
 	 terule_deep_diff_member,
+	 1,
+	 1,
+	 terule_hash,
+	 terule_create_shard_member,
+	 terule_merge_shard_member,
 	 },
 	{
 	 "Type Transition Rules",
@@ -274,6 +369,11 @@ static const poldiff_component_record_t component_records[] = {
 	 terule_comp,
 	 terule_new_diff_trans,
 	 terule_deep_diff_trans,
+	 1,
+	 1,
+	 terule_hash,
+	 terule_create_shard_trans,
+	 terule_merge_shard_trans,
 	 },
 	{
 	 "type",
@@ -287,6 +387,11 @@ static const poldiff_component_record_t component_records[] = {
 	 type_comp,
 	 type_new_diff,
 	 type_deep_diff,
+	 1,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 	{
 	 "user",
@@ -300,6 +405,11 @@ static const poldiff_component_record_t component_records[] = {
 	 user_comp,
 	 user_new_diff,
 	 user_deep_diff,
+	 0,
+	 0,
+	 NULL,
+	 NULL,
+	 NULL,
 	 },
 };
 
@@ -379,15 +489,37 @@ poldiff_t *poldiff_create(apol_policy_t * orig_policy, apol_policy_t * mod_polic
 	return diff;
 }
 
+/**
+ * Discard the original policy's kept items, along with the type map
+ * and permission index set aside to check them.
+ *
+ * @param diff The policy difference structure.
+ */
+static void poldiff_drop_orig_items(poldiff_t * diff)
+{
+	size_t i, num_items = sizeof(component_records) / sizeof(poldiff_component_record_t);
+	if (diff->orig_items != NULL) {
+		for (i = 0; i < num_items; i++) {
+			apol_vector_destroy(&diff->orig_items[i]);
+		}
+	}
+	type_map_destroy(&diff->orig_items_map);
+	perm_index_destroy(&diff->orig_items_perms);
+}
+
 void poldiff_destroy(poldiff_t ** diff)
 {
 	if (!diff || !(*diff))
 		return;
+	poldiff_drop_orig_items(*diff);
+	free((*diff)->orig_items);
 	apol_policy_destroy(&(*diff)->orig_pol);
 	apol_policy_destroy(&(*diff)->mod_pol);
 	apol_bst_destroy(&(*diff)->class_bst);
 	apol_bst_destroy(&(*diff)->perm_bst);
 	apol_bst_destroy(&(*diff)->bool_bst);
+	perm_index_destroy(&(*diff)->perm_index);
+	apol_bst_destroy(&(*diff)->avrule_lines);
 
 	type_map_destroy(&(*diff)->type_map);
 	attrib_summary_destroy(&(*diff)->attrib_diffs);
@@ -414,49 +546,72 @@ void poldiff_destroy(poldiff_t ** diff)
 }
 
 /**
- * Given a particular policy item record (e.g., one for object
- * classes), (re-)perform a diff of them between the two policies
- * listed in the poldiff_t structure.  Upon success, set the status
- * flag within 'diff' to indicate that this diff is done.
+ * Tell the phase callback, if there is one, that a phase begins or
+ * ends.
+ */
+static void poldiff_phase(const poldiff_t * diff, poldiff_phase_e phase, uint32_t which, int is_end)
+{
+	if (diff->phase_fn != NULL) {
+		diff->phase_fn(diff->phase_arg, diff, phase, which, is_end);
+	}
+}
+
+/**
+ * If the policy difference structure is streaming, then hand each
+ * difference that the component has just created to the item
+ * callback and then destroy it.
  *
- * @param diff The policy difference structure containing the policies
- * to compare and to populate with the item differences.
- * @param component_record Item record containg callbacks to perform each
- * step of the computation for a particular kind of item.
+ * @param diff The policy difference structure.
+ * @param component_record Item record for the component being run.
  *
- * @return 0 on success and < 0 on error; if the call fails; errno
- * will be set and the only defined operation on the policy difference
- * structure will be poldiff_destroy().
+ * @return 0 on success and < 0 on error or if the callback asked to
+ * stop; if the call fails; errno will be set.
  */
-static int poldiff_do_item_diff(poldiff_t * diff, const poldiff_component_record_t * component_record)
+static int poldiff_stream_results(poldiff_t * diff, const poldiff_component_record_t * component_record)
 {
-	apol_vector_t *p1_v = NULL, *p2_v = NULL;
-	int error = 0, retv;
-	size_t x = 0, y = 0;
-	void *item_x = NULL, *item_y = NULL;
+	apol_vector_t *v;
+	size_t i;
 
-	if (!diff || !component_record) {
-		ERR(diff, "%s", strerror(EINVAL));
-		errno = EINVAL;
+	if (diff->item_fn == NULL) {
+		return 0;
+	}
+	/* the results belong to this library, so it may empty them */
+	if ((v = (apol_vector_t *) component_record->get_results(diff)) == NULL) {
 		return -1;
 	}
-	diff->diff_status &= (~component_record->flag_bit);
-
-	INFO(diff, "Getting %s items from original policy.", component_record->item_name);
-	p1_v = component_record->get_items(diff, diff->orig_pol);
-	if (!p1_v) {
-		error = errno;
-		goto err;
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		if (diff->item_fn(diff->item_arg, diff, component_record->flag_bit, apol_vector_get_element(v, i)) < 0) {
+			ERR(diff, "Stopped while streaming %s differences.", component_record->item_name);
+			apol_vector_clear(v);
+			errno = ECANCELED;
+			return -1;
+		}
 	}
+	apol_vector_clear(v);
+	return 0;
+}
 
-	INFO(diff, "Getting %s items from modified policy.", component_record->item_name);
-	p2_v = component_record->get_items(diff, diff->mod_pol);
-	if (!p2_v) {
-		error = errno;
-		goto err;
-	}
+/**
+ * Walk two sorted vectors of items in step, creating a difference
+ * for each item found in only one of them and deep diffing those
+ * found in both.
+ *
+ * @param diff The policy difference structure to populate.
+ * @param component_record Item record containg callbacks to perform each
+ * step of the computation for a particular kind of item.
+ * @param p1_v Sorted items from the original policy.
+ * @param p2_v Sorted items from the modified policy.
+ *
+ * @return 0 on success and < 0 on error; if the call fails; errno
+ * will be set.
+ */
+static int poldiff_merge_items(poldiff_t * diff, const poldiff_component_record_t * component_record, const apol_vector_t * p1_v,
+			       const apol_vector_t * p2_v)
+{
+	size_t x = 0, y = 0;
+	void *item_x = NULL, *item_y = NULL;
+	int retv;
 
-	INFO(diff, "Finding differences in %s.", component_record->item_name);
 	for (x = 0, y = 0; x < apol_vector_get_size(p1_v);) {
 		if (y >= apol_vector_get_size(p2_v))
 			break;
@@ -465,40 +620,328 @@ static int poldiff_do_item_diff(poldiff_t * diff, const poldiff_component_record
 		retv = component_record->comp(item_x, item_y, diff);
 		if (retv < 0) {
 			if (component_record->new_diff(diff, POLDIFF_FORM_REMOVED, item_x)) {
-				error = errno;
-				goto err;
+				return -1;
 			}
 			x++;
 		} else if (retv > 0) {
 			if (component_record->new_diff(diff, POLDIFF_FORM_ADDED, item_y)) {
-				error = errno;
-				goto err;
+				return -1;
 			}
 			y++;
 		} else {
 			if (component_record->deep_diff(diff, item_x, item_y)) {
-				error = errno;
-				goto err;
+				return -1;
 			}
 			x++;
 			y++;
 		}
+		if (poldiff_stream_results(diff, component_record) < 0) {
+			return -1;
+		}
 	}
 	for (; x < apol_vector_get_size(p1_v); x++) {
 		item_x = apol_vector_get_element(p1_v, x);
-		if (component_record->new_diff(diff, POLDIFF_FORM_REMOVED, item_x)) {
-			error = errno;
-			goto err;
+		if (component_record->new_diff(diff, POLDIFF_FORM_REMOVED, item_x) ||
+		    poldiff_stream_results(diff, component_record) < 0) {
+			return -1;
 		}
 	}
 	for (; y < apol_vector_get_size(p2_v); y++) {
 		item_y = apol_vector_get_element(p2_v, y);
-		if (component_record->new_diff(diff, POLDIFF_FORM_ADDED, item_y)) {
+		if (component_record->new_diff(diff, POLDIFF_FORM_ADDED, item_y) ||
+		    poldiff_stream_results(diff, component_record) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/** number of shards into which a component's items are split when
+ *  diffed on several threads */
+#define POLDIFF_ITEM_SHARDS 16
+/** fewest items, counting both policies, for which sharding is worth
+ *  starting threads */
+#define POLDIFF_ITEM_SHARD_MIN 4096
+
+typedef struct poldiff_shard_set
+{
+	const poldiff_component_record_t *component_record;
+	/** for each policy, the items that hash into each shard */
+	apol_vector_t *items[2][POLDIFF_ITEM_SHARDS];
+	/** copies of the policy difference structure, each with its
+	 *  own results for the component */
+	poldiff_t diffs[POLDIFF_ITEM_SHARDS];
+} poldiff_shard_set_t;
+
+/**
+ * Message handler for the shards' copies of the policy difference
+ * structure.  Worker threads must not call the user's handler, so
+ * their messages are dropped; a failed shard is reported afterwards
+ * on the calling thread.
+ */
+static void poldiff_shard_handle_msg(void *arg __attribute__ ((unused)), const poldiff_t * diff __attribute__ ((unused)),
+				     int level __attribute__ ((unused)), const char *fmt __attribute__ ((unused)),
+				     va_list va_args __attribute__ ((unused)))
+{
+}
+
+/**
+ * Split a sorted vector of items into one sorted vector per shard,
+ * according to the component's hash.
+ *
+ * @param v Sorted items to split.
+ * @param hash Hash callback of the component.
+ * @param shards Array of POLDIFF_ITEM_SHARDS vectors to create.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, errno
+ * will be set and the vectors that were created must still be
+ * destroyed by the caller.
+ */
+static int poldiff_shard_items(const apol_vector_t * v, poldiff_item_hash_fn_t hash, apol_vector_t ** shards)
+{
+	size_t i, cap = apol_vector_get_size(v) / POLDIFF_ITEM_SHARDS + 1;
+	void *item;
+
+	for (i = 0; i < POLDIFF_ITEM_SHARDS; i++) {
+		if ((shards[i] = apol_vector_create_with_capacity(cap, NULL)) == NULL) {
+			return -1;
+		}
+	}
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		item = apol_vector_get_element(v, i);
+		if (apol_vector_append(shards[hash(item) % POLDIFF_ITEM_SHARDS], item) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Diff the items of one shard into that shard's copy of the policy
+ * difference structure.  Called by apol_parallel_run().
+ *
+ * @param arg The poldiff_shard_set_t.
+ * @param shard Index of the shard to diff.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, errno
+ * will be set.
+ */
+static int poldiff_diff_shard(void *arg, size_t shard)
+{
+	poldiff_shard_set_t *set = (poldiff_shard_set_t *) arg;
+	return poldiff_merge_items(&set->diffs[shard], set->component_record, set->items[0][shard], set->items[1][shard]);
+}
+
+/**
+ * Split two sorted vectors of items into shards by hash, so that
+ * items that compare equal land in the same shard, then walk each
+ * shard's pair of vectors on its own thread.  Each shard writes into
+ * its own results; these are moved into the policy difference
+ * structure in shard order once all are done.  The results are
+ * therefore not in the order that poldiff_merge_items() would give,
+ * but every component that shards sorts its results when they are
+ * retrieved.
+ *
+ * @param diff The policy difference structure to populate.
+ * @param component_record Item record of the component, whose hash,
+ * create_shard, and merge_shard callbacks must be set.
+ * @param p1_v Sorted items from the original policy.
+ * @param p2_v Sorted items from the modified policy.
+ * @param num_threads Largest number of threads to use.
+ *
+ * @return 0 on success and < 0 on error; if the call fails; errno
+ * will be set.
+ */
+static int poldiff_merge_shards(poldiff_t * diff, const poldiff_component_record_t * component_record, const apol_vector_t * p1_v,
+				const apol_vector_t * p2_v, size_t num_threads)
+{
+	poldiff_shard_set_t *set = NULL;
+	size_t i, num_created = 0;
+	int retval = -1, error = 0;
+
+	if ((set = calloc(1, sizeof(*set))) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto cleanup;
+	}
+	set->component_record = component_record;
+	if (poldiff_shard_items(p1_v, component_record->hash, set->items[0]) < 0 ||
+	    poldiff_shard_items(p2_v, component_record->hash, set->items[1]) < 0) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (; num_created < POLDIFF_ITEM_SHARDS; num_created++) {
+		set->diffs[num_created] = *diff;
+		set->diffs[num_created].fn = poldiff_shard_handle_msg;
+		set->diffs[num_created].item_fn = NULL;
+		set->diffs[num_created].phase_fn = NULL;
+		if (component_record->create_shard(&set->diffs[num_created]) < 0) {
+			error = errno;
+			ERR(diff, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	if (apol_parallel_run(POLDIFF_ITEM_SHARDS, num_threads, poldiff_diff_shard, set) < 0) {
+		error = errno;
+		ERR(diff, "Could not find differences in %s: %s", component_record->item_name, strerror(error));
+		goto cleanup;
+	}
+	for (i = 0; i < POLDIFF_ITEM_SHARDS; i++) {
+		if (component_record->merge_shard(diff, &set->diffs[i]) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+	retval = 0;
+      cleanup:
+	if (set != NULL) {
+		for (i = 0; i < num_created; i++) {
+			component_record->merge_shard(NULL, &set->diffs[i]);
+		}
+		for (i = 0; i < POLDIFF_ITEM_SHARDS; i++) {
+			apol_vector_destroy(&set->items[0][i]);
+			apol_vector_destroy(&set->items[1][i]);
+		}
+		free(set);
+	}
+	errno = error;
+	return retval;
+}
+
+/**
+ * Determine if any of the original policy's items are being kept.
+ *
+ * @param diff The policy difference structure.
+ *
+ * @return Non-zero if there are kept items.
+ */
+static int poldiff_has_orig_items(const poldiff_t * diff)
+{
+	size_t i, num_items = sizeof(component_records) / sizeof(poldiff_component_record_t);
+	if (diff->orig_items != NULL) {
+		for (i = 0; i < num_items; i++) {
+			if (diff->orig_items[i] != NULL)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * After poldiff_set_mod_policy(), check that the new type map and
+ * permission index number the original policy's types, classes, and
+ * permissions as the previous ones did.  If so then the kept items
+ * are still valid; otherwise discard them.  The type map must have
+ * been built.
+ *
+ * @param diff The policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, errno
+ * will be set.
+ */
+static int poldiff_check_orig_items(poldiff_t * diff)
+{
+	if (diff->orig_items_map == NULL) {
+		return 0;
+	}
+	if (poldiff_build_bsts(diff) < 0) {
+		return -1;
+	}
+	if (type_map_orig_equal(diff->orig_items_map, diff->type_map) &&
+	    perm_index_orig_equal(diff->orig_items_perms, diff->perm_index)) {
+		INFO(diff, "%s", "Keeping items from original policy.");
+		type_map_destroy(&diff->orig_items_map);
+		perm_index_destroy(&diff->orig_items_perms);
+	} else {
+		poldiff_drop_orig_items(diff);
+	}
+	return 0;
+}
+
+/**
+ * Given a particular policy item record (e.g., one for object
+ * classes), (re-)perform a diff of them between the two policies
+ * listed in the poldiff_t structure.  Upon success, set the status
+ * flag within 'diff' to indicate that this diff is done.
+ *
+ * @param diff The policy difference structure containing the policies
+ * to compare and to populate with the item differences.
+ * @param component_record Item record containg callbacks to perform each
+ * step of the computation for a particular kind of item.
+ *
+ * @return 0 on success and < 0 on error; if the call fails; errno
+ * will be set and the only defined operation on the policy difference
+ * structure will be poldiff_destroy().
+ */
+static int poldiff_do_item_diff(poldiff_t * diff, const poldiff_component_record_t * component_record)
+{
+	apol_vector_t *p1_v = NULL, *p2_v = NULL;
+	size_t idx, num_items = sizeof(component_records) / sizeof(poldiff_component_record_t);
+	size_t num_threads = diff->num_threads;
+	int error = 0, retv;
+
+	if (!diff || !component_record) {
+		ERR(diff, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	diff->diff_status &= (~component_record->flag_bit);
+	idx = (size_t) (component_record - component_records);
+
+	if (diff->orig_items != NULL && diff->orig_items[idx] != NULL) {
+		/* kept from before poldiff_set_mod_policy() */
+		INFO(diff, "Reusing %s items from original policy.", component_record->item_name);
+		p1_v = diff->orig_items[idx];
+		diff->orig_items[idx] = NULL;
+	} else {
+		INFO(diff, "Getting %s items from original policy.", component_record->item_name);
+		poldiff_phase(diff, POLDIFF_PHASE_ORIG_ITEMS, component_record->flag_bit, 0);
+		p1_v = component_record->get_items(diff, diff->orig_pol);
+		if (!p1_v) {
 			error = errno;
 			goto err;
 		}
+		poldiff_phase(diff, POLDIFF_PHASE_ORIG_ITEMS, component_record->flag_bit, 1);
 	}
 
+	INFO(diff, "Getting %s items from modified policy.", component_record->item_name);
+	poldiff_phase(diff, POLDIFF_PHASE_MOD_ITEMS, component_record->flag_bit, 0);
+	p2_v = component_record->get_items(diff, diff->mod_pol);
+	if (!p2_v) {
+		error = errno;
+		goto err;
+	}
+	poldiff_phase(diff, POLDIFF_PHASE_MOD_ITEMS, component_record->flag_bit, 1);
+
+	INFO(diff, "Finding differences in %s.", component_record->item_name);
+	poldiff_phase(diff, POLDIFF_PHASE_MERGE, component_record->flag_bit, 0);
+	if (num_threads == 0) {
+		num_threads = apol_parallel_get_num_cpus();
+	}
+	/* a streaming diff hands each result to the caller's callback
+	 * as it is made, which must happen on the caller's thread */
+	if (component_record->hash != NULL && diff->item_fn == NULL && num_threads > 1 &&
+	    apol_vector_get_size(p1_v) + apol_vector_get_size(p2_v) >= POLDIFF_ITEM_SHARD_MIN) {
+		retv = poldiff_merge_shards(diff, component_record, p1_v, p2_v, num_threads);
+	} else {
+		retv = poldiff_merge_items(diff, component_record, p1_v, p2_v);
+	}
+	if (retv < 0) {
+		error = errno;
+		goto err;
+	}
+	poldiff_phase(diff, POLDIFF_PHASE_MERGE, component_record->flag_bit, 1);
+
+	if (diff->keep_orig_items && component_record->keeps_orig_items) {
+		if (diff->orig_items == NULL && (diff->orig_items = calloc(num_items, sizeof(apol_vector_t *))) == NULL) {
+			error = errno;
+			ERR(diff, "%s", strerror(error));
+			goto err;
+		}
+		diff->orig_items[idx] = p1_v;
+		p1_v = NULL;
+	}
 	apol_vector_destroy(&p1_v);
 	apol_vector_destroy(&p2_v);
 	diff->diff_status |= component_record->flag_bit;
@@ -513,6 +956,7 @@ static int poldiff_do_item_diff(poldiff_t * diff, const poldiff_component_record
 int poldiff_run(poldiff_t * diff, uint32_t flags)
 {
 	size_t i, num_items;
+	int uses_type_map = 0;
 
 	if (!flags)
 		return 0;	       /* nothing to do */
@@ -532,13 +976,17 @@ int poldiff_run(poldiff_t * diff, uint32_t flags)
 	}
 	if (policy_opts != diff->policy_opts) {
 		INFO(diff, "%s", "Loading rules from original policy.");
+		poldiff_phase(diff, POLDIFF_PHASE_LOAD_ORIG, 0, 0);
 		if (qpol_policy_rebuild(diff->orig_qpol, policy_opts)) {
 			return -1;
 		}
+		poldiff_phase(diff, POLDIFF_PHASE_LOAD_ORIG, 0, 1);
 		INFO(diff, "%s", "Loading rules from modified policy.");
+		poldiff_phase(diff, POLDIFF_PHASE_LOAD_MOD, 0, 0);
 		if (qpol_policy_rebuild(diff->mod_qpol, policy_opts)) {
 			return -1;
 		}
+		poldiff_phase(diff, POLDIFF_PHASE_LOAD_MOD, 0, 1);
 		// force flushing of existing pointers into policies
 		diff->remapped = 1;
 		diff->policy_opts = policy_opts;
@@ -549,19 +997,47 @@ int poldiff_run(poldiff_t * diff, uint32_t flags)
 		for (i = 0; i < num_items; i++) {
 			if (component_records[i].flag_bit & POLDIFF_DIFF_REMAPPED) {
 				INFO(diff, "Resetting %s diff.", component_records[i].item_name);
+				poldiff_phase(diff, POLDIFF_PHASE_RESET, component_records[i].flag_bit, 0);
 				if (component_records[i].reset(diff))
 					return -1;
+				poldiff_phase(diff, POLDIFF_PHASE_RESET, component_records[i].flag_bit, 1);
 			}
 		}
 		diff->diff_status &= ~(POLDIFF_DIFF_REMAPPED);
 		diff->remapped = 0;
+		/* the policies were rebuilt or the types remapped */
+		poldiff_drop_orig_items(diff);
 	}
 
-	INFO(diff, "%s", "Building type map.");
-	if (type_map_build(diff)) {
-		return -1;
+	/* build the type map only if a component about to run uses it */
+	for (i = 0; i < num_items; i++) {
+		if ((flags & component_records[i].flag_bit) && !(component_records[i].flag_bit & diff->diff_status)) {
+			uses_type_map |= component_records[i].uses_type_map;
+		}
+	}
+	if (uses_type_map) {
+		INFO(diff, "%s", "Building type map.");
+		poldiff_phase(diff, POLDIFF_PHASE_TYPE_MAP, 0, 0);
+		if (type_map_build(diff)) {
+			return -1;
+		}
+		poldiff_phase(diff, POLDIFF_PHASE_TYPE_MAP, 0, 1);
+		if (poldiff_check_orig_items(diff) < 0) {
+			return -1;
+		}
 	}
 
+	/* Components run one after another, not concurrently.  The AV
+	 * and TE rule components' get_items callbacks step each
+	 * policy's booleans through every combination to build the
+	 * truth tables of conditional rules, and lazily build the class, permission, and boolean
+	 * BSTs that both kinds share, so no two of them may run at
+	 * once.  They are by far the slowest components; the others
+	 * finish in a fraction of the time and report progress through
+	 * the caller's message and phase callbacks, which need not be
+	 * thread-safe.  Threads are instead used within each rule
+	 * component, whose items are diffed in shards (see
+	 * poldiff_merge_shards()). */
 	diff->line_numbers_enabled = 0;
 	for (i = 0; i < num_items; i++) {
 		/* item requested but not yet run */
@@ -616,6 +1092,134 @@ int poldiff_get_stats(const poldiff_t * diff, uint32_t flags, size_t stats[5])
 	return 0;
 }
 
+int poldiff_set_mod_policy(poldiff_t * diff, apol_policy_t * mod_policy)
+{
+	apol_policy_t *old_pol;
+	qpol_policy_t *old_qpol;
+	type_map_t *old_map;
+	size_t i, num_items;
+	int error;
+
+	if (!diff || !mod_policy) {
+		ERR(diff, "%s", strerror(EINVAL));
+		apol_policy_destroy(&mod_policy);
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* bring the new policy to the baseline's options before
+	 * installing it, so that a failure leaves the diff as it was */
+	INFO(diff, "%s", "Loading rules from modified policy.");
+	poldiff_phase(diff, POLDIFF_PHASE_LOAD_MOD, 0, 0);
+	if (qpol_policy_rebuild(apol_policy_get_qpol(mod_policy), diff->policy_opts)) {
+		error = errno;
+		goto err;
+	}
+	poldiff_phase(diff, POLDIFF_PHASE_LOAD_MOD, 0, 1);
+
+	/* the type map depends upon both policies */
+	old_pol = diff->mod_pol;
+	old_qpol = diff->mod_qpol;
+	old_map = diff->type_map;
+	diff->mod_pol = mod_policy;
+	diff->mod_qpol = apol_policy_get_qpol(mod_policy);
+	poldiff_phase(diff, POLDIFF_PHASE_TYPE_MAP, 0, 0);
+	if ((diff->type_map = type_map_create()) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+	} else if (type_map_infer(diff) < 0) {
+		error = errno;
+		type_map_destroy(&diff->type_map);
+	}
+	if (diff->type_map == NULL) {
+		diff->mod_pol = old_pol;
+		diff->mod_qpol = old_qpol;
+		diff->type_map = old_map;
+		goto err;
+	}
+	poldiff_phase(diff, POLDIFF_PHASE_TYPE_MAP, 0, 1);
+
+	/* everything else that refers to the previous modified policy
+	 * must go before that policy does */
+	num_items = sizeof(component_records) / sizeof(poldiff_component_record_t);
+	for (i = 0; i < num_items; i++) {
+		poldiff_phase(diff, POLDIFF_PHASE_RESET, component_records[i].flag_bit, 0);
+		if (component_records[i].reset(diff)) {
+			error = errno;
+			type_map_destroy(&old_map);
+			if (old_pol != mod_policy) {
+				apol_policy_destroy(&old_pol);
+			}
+			errno = error;
+			return -1;
+		}
+		poldiff_phase(diff, POLDIFF_PHASE_RESET, component_records[i].flag_bit, 1);
+	}
+	/* the kept items of the original policy, and the BSTs of names
+	 * into which they point, stay; set aside the numbering under
+	 * which the items were gathered, unless a previous call already
+	 * did so, to be compared with the new policy's by the next
+	 * poldiff_run() */
+	if (poldiff_has_orig_items(diff) && diff->orig_items_map == NULL) {
+		diff->orig_items_map = old_map;
+		diff->orig_items_perms = diff->perm_index;
+		old_map = NULL;
+		diff->perm_index = NULL;
+		if (diff->orig_items_perms == NULL) {
+			poldiff_drop_orig_items(diff);
+		}
+	}
+	perm_index_destroy(&diff->perm_index);
+	type_map_destroy(&old_map);
+	if (old_pol != mod_policy) {
+		apol_policy_destroy(&old_pol);
+	}
+	diff->diff_status = 0;
+	diff->remapped = 0;
+	diff->line_numbers_enabled = 0;
+	return 0;
+
+      err:
+	if (mod_policy != diff->mod_pol) {
+		apol_policy_destroy(&mod_policy);
+	}
+	errno = error;
+	return -1;
+}
+
+void poldiff_set_item_callback(poldiff_t * diff, poldiff_item_fn_t fn, void *arg)
+{
+	if (diff == NULL)
+		return;
+	diff->item_fn = fn;
+	diff->item_arg = arg;
+}
+
+void poldiff_set_keep_baseline(poldiff_t * diff, int keep)
+{
+	if (diff == NULL)
+		return;
+	diff->keep_orig_items = keep;
+	if (!keep) {
+		poldiff_drop_orig_items(diff);
+	}
+}
+
+void poldiff_set_phase_callback(poldiff_t * diff, poldiff_phase_fn_t fn, void *arg)
+{
+	if (diff == NULL)
+		return;
+	diff->phase_fn = fn;
+	diff->phase_arg = arg;
+}
+
+void poldiff_set_num_threads(poldiff_t * diff, size_t num_threads)
+{
+	if (diff == NULL)
+		return;
+	diff->num_threads = num_threads;
+}
+
 int poldiff_enable_line_numbers(poldiff_t * diff)
 {
 	int retval;
@@ -665,12 +1269,14 @@ int poldiff_build_bsts(poldiff_t * diff)
 	const char *name;
 	char *new_name;
 	int retval = -1, error = 0;
-	if (diff->class_bst != NULL) {
+	if (diff->perm_index != NULL) {
 		return 0;
 	}
-	if ((diff->class_bst = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (diff->perm_bst = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (diff->bool_bst = apol_bst_create(apol_str_strcmp, free)) == NULL) {
+	/* the BSTs outlive poldiff_set_mod_policy(), for the sake of
+	 * kept items that point into them, so only add names to them */
+	if ((diff->class_bst == NULL && (diff->class_bst = apol_bst_create(apol_str_strcmp, free)) == NULL) ||
+	    (diff->perm_bst == NULL && (diff->perm_bst = apol_bst_create(apol_str_strcmp, free)) == NULL) ||
+	    (diff->bool_bst == NULL && (diff->bool_bst = apol_bst_create(apol_str_strcmp, free)) == NULL)) {
 		error = errno;
 		ERR(diff, "%s", strerror(error));
 		goto cleanup;
@@ -719,6 +1325,10 @@ int poldiff_build_bsts(poldiff_t * diff)
 			}
 		}
 	}
+	if ((diff->perm_index = perm_index_build(diff)) == NULL) {
+		error = errno;
+		goto cleanup;
+	}
 	retval = 0;
       cleanup:
 	apol_vector_destroy(&classes[0]);
@@ -62,6 +62,7 @@ extern "C"
 #include "type_internal.h"
 
 #include "type_map_internal.h"
+#include "perm_index_internal.h"
 
 /* forward declarations */
 	struct poldiff_attrib_summary;
@@ -98,8 +99,39 @@ extern "C"
 		apol_bst_t *perm_bst;
 		/** BST of duplicated strings, used when making pseudo-rules */
 		apol_bst_t *bool_bst;
+		/** unified class and permission numbering for both
+		 *  policies, used to hold pseudo-rules' permissions as
+		 *  bitmasks */
+		perm_index_t *perm_index;
+		/** if non-zero, keep the original policy's items for
+		 *  reuse after poldiff_set_mod_policy() */
+		int keep_orig_items;
+		/** for each component record that allows it, the
+		 *  original policy's items from its last run, or NULL */
+		apol_vector_t **orig_items;
+		/** type map and permission index under which
+		 *  orig_items were gathered, set aside by
+		 *  poldiff_set_mod_policy() until the next
+		 *  poldiff_run() compares them to the new ones */
+		type_map_t *orig_items_map;
+		perm_index_t *orig_items_perms;
+		/** BST of the syntactic rules' line numbers and
+		 *  permissions for each AV rule, filled in as line
+		 *  numbers are requested */
+		apol_bst_t *avrule_lines;
 		poldiff_handle_fn_t fn;
 		void *handle_arg;
+		/** if not NULL, stream each difference to this callback
+		 *  rather than keeping it */
+		poldiff_item_fn_t item_fn;
+		void *item_arg;
+		/** if not NULL, tell this callback when each phase
+		 *  begins and ends */
+		poldiff_phase_fn_t phase_fn;
+		void *phase_arg;
+		/** largest number of threads with which to diff a
+		 *  component's shards, or 0 for one per processor */
+		size_t num_threads;
 		/** set of POLDIF_DIFF_* bits for diffs run */
 		uint32_t diff_status;
 		struct poldiff_attrib_summary *attrib_diffs;
@@ -155,6 +187,48 @@ extern "C"
  */
 	typedef int (*poldiff_item_comp_fn_t) (const void *x, const void *y, const poldiff_t * diff);
 
+/**
+ *  Callback function signature for hashing an item, so that the
+ *  items of a component may be partitioned into shards that are
+ *  diffed independently of each other.
+ *
+ *  @param item The item to hash.
+ *
+ *  @return Hash value for the item.  Two items for which the compare
+ *  callback returns 0 must have the same hash value.
+ */
+	typedef uint32_t(*poldiff_item_hash_fn_t) (const void *item);
+
+/**
+ *  Callback function signature for giving one shard's copy of the
+ *  policy difference structure its own empty results for a
+ *  component, so that the new_diff and deep_diff callbacks for that
+ *  shard write there instead of into the shared results.
+ *
+ *  @param shard Copy of the policy difference structure used by the
+ *  shard.
+ *
+ *  @return 0 on success and < 0 on error; if the call fails, set
+ *  errno and leave the copy unchanged.
+ */
+	typedef int (*poldiff_create_shard_fn_t) (poldiff_t * shard);
+
+/**
+ *  Callback function signature for moving a shard's results for a
+ *  component into the policy difference structure, after which the
+ *  shard's results are destroyed.
+ *
+ *  @param diff The policy difference structure to which to add the
+ *  results, or NULL to only destroy them.
+ *  @param shard Copy of the policy difference structure given to the
+ *  create_shard callback.  Calling this again on the same copy does
+ *  nothing.
+ *
+ *  @return 0 on success and < 0 on error; if the call fails, set
+ *  errno.  The shard's results are destroyed either way.
+ */
+	typedef int (*poldiff_merge_shard_fn_t) (poldiff_t * diff, poldiff_t * shard);
+
 /**
  *  Callback function signature for creating, initializing and inserting
  *  a new semantic difference entry for an item.
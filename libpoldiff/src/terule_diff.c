@@ -792,65 +792,37 @@ static int terule_add_to_bst(poldiff_t * diff, const apol_policy_t * p,
  */
 static int terule_expand(poldiff_t * diff, const apol_policy_t * p, const qpol_terule_t * rule, apol_bst_t * b)
 {
-	const qpol_type_t *source, *orig_target, *target;
-	unsigned char source_attr, target_attr;
-	qpol_iterator_t *source_iter = NULL, *target_iter = NULL;
+	const qpol_type_t *source, *target;
+	const apol_bitmap_t *sources, *targets;
+	size_t s, t;
 	uint32_t source_val, target_val;
 	qpol_policy_t *q = apol_policy_get_qpol(p);
 	int which = (p == diff->orig_pol ? POLDIFF_POLICY_ORIG : POLDIFF_POLICY_MOD);
-	int retval = -1, error = 0;
 	if (qpol_terule_get_source_type(q, rule, &source) < 0 ||
-	    qpol_terule_get_target_type(q, rule, &orig_target) < 0 ||
-	    qpol_type_get_isattr(q, source, &source_attr) < 0 || qpol_type_get_isattr(q, orig_target, &target_attr)) {
-		error = errno;
-		goto cleanup;
-	}
-	if (source_attr && qpol_type_get_type_iter(q, source, &source_iter) < 0) {
-		error = errno;
-		goto cleanup;
+	    qpol_terule_get_target_type(q, rule, &target) < 0 ||
+	    (sources = apol_type_get_expansion_bitmap(p, source)) == NULL ||
+	    (targets = apol_type_get_expansion_bitmap(p, target)) == NULL) {
+		return -1;
 	}
-	do {
-		if (source_attr) {
-			if (qpol_iterator_get_item(source_iter, (void **)&source) < 0) {
-				error = errno;
-				goto cleanup;
-			}
-			qpol_iterator_next(source_iter);
-		}
-		if (target_attr) {
-			if (qpol_type_get_type_iter(q, orig_target, &target_iter) < 0) {
-				error = errno;
-				goto cleanup;
-			}
-		} else {
-			target = orig_target;
+	/* an attribute without any types expands to nothing */
+	for (s = apol_bitmap_next(sources, 0); s < apol_bitmap_get_size(sources); s = apol_bitmap_next(sources, s + 1)) {
+		if ((source_val = type_map_lookup_value(diff, (uint32_t) s, which)) == 0) {
+			ERR(diff, "%s", strerror(EBADRQC));	/* should never get here */
+			errno = EBADRQC;
+			return -1;
 		}
-		do {
-			if (target_attr) {
-				if (qpol_iterator_get_item(target_iter, (void **)&target) < 0) {
-					error = errno;
-					goto cleanup;
-				}
-				qpol_iterator_next(target_iter);
+		for (t = apol_bitmap_next(targets, 0); t < apol_bitmap_get_size(targets); t = apol_bitmap_next(targets, t + 1)) {
+			if ((target_val = type_map_lookup_value(diff, (uint32_t) t, which)) == 0) {
+				ERR(diff, "%s", strerror(EBADRQC));	/* should never get here */
+				errno = EBADRQC;
+				return -1;
 			}
-			const char *n1, *n2;
-			qpol_type_get_name(q, source, &n1);
-			qpol_type_get_name(q, target, &n2);
-			if ((source_val = type_map_lookup(diff, source, which)) == 0 ||
-			    (target_val = type_map_lookup(diff, target, which)) == 0 ||
-			    terule_add_to_bst(diff, p, rule, source_val, target_val, b) < 0) {
-				error = errno;
-				goto cleanup;
+			if (terule_add_to_bst(diff, p, rule, source_val, target_val, b) < 0) {
+				return -1;
 			}
-		} while (target_attr && !qpol_iterator_end(target_iter));
-		qpol_iterator_destroy(&target_iter);
-	} while (source_attr && !qpol_iterator_end(source_iter));
-	retval = 0;
-      cleanup:
-	qpol_iterator_destroy(&source_iter);
-	qpol_iterator_destroy(&target_iter);
-	errno = error;
-	return retval;
+		}
+	}
+	return 0;
 }
 
 /**
@@ -1256,6 +1228,123 @@ int terule_deep_diff_trans(poldiff_t * diff, const void *x, const void *y)
 	return terule_deep_diff(diff, x, y, TERULE_OFFSET_TRANS);
 }
 
+uint32_t terule_hash(const void *item)
+{
+	const pseudo_terule_t *r = (const pseudo_terule_t *)item;
+	uint32_t h = r->source * 0x9e3779b1u;
+	h = (h ^ r->target) * 0x85ebca6bu;
+	return h ^ (h >> 16);
+}
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty TE rule results.  The results' vector does not free its
+ * elements, so that terule_merge_shard() can move them elsewhere.
+ *
+ * @param shard Copy of the policy difference structure.
+ * @param idx Index into the TE rule differences specifying which
+ * results to replace.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+static int terule_create_shard(poldiff_t * shard, terule_offset_e idx)
+{
+	poldiff_terule_summary_t *rs;
+	if ((rs = calloc(1, sizeof(*rs))) == NULL) {
+		return -1;
+	}
+	if ((rs->diffs = apol_vector_create(NULL)) == NULL) {
+		int error = errno;
+		free(rs);
+		errno = error;
+		return -1;
+	}
+	shard->terule_diffs[idx] = rs;
+	return 0;
+}
+
+/**
+ * Append a shard's TE rule differences, and add its counts, to
+ * the policy difference structure's.  Then destroy the shard's
+ * results, along with any differences that were not moved.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * terule_create_shard().
+ * @param idx Index into the TE rule differences specifying which
+ * results to move.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+static int terule_merge_shard(poldiff_t * diff, poldiff_t * shard, terule_offset_e idx)
+{
+	poldiff_terule_summary_t *from = shard->terule_diffs[idx], *to;
+	size_t i;
+	int retval = -1, error = 0;
+
+	if (from == NULL) {
+		return 0;
+	}
+	shard->terule_diffs[idx] = NULL;
+	if (diff != NULL) {
+		to = diff->terule_diffs[idx];
+		if (apol_vector_cat(to->diffs, from->diffs) < 0) {
+			error = errno;
+			ERR(diff, "%s", strerror(error));
+			goto cleanup;
+		}
+		apol_vector_destroy(&from->diffs);
+		to->num_added += from->num_added;
+		to->num_removed += from->num_removed;
+		to->num_modified += from->num_modified;
+		to->num_added_type += from->num_added_type;
+		to->num_removed_type += from->num_removed_type;
+		to->diffs_sorted = 0;
+	}
+	retval = 0;
+      cleanup:
+	for (i = 0; i < apol_vector_get_size(from->diffs); i++) {
+		poldiff_terule_free(apol_vector_get_element(from->diffs, i));
+	}
+	apol_vector_destroy(&from->diffs);
+	free(from);
+	errno = error;
+	return retval;
+}
+
+int terule_create_shard_change(poldiff_t * shard)
+{
+	return terule_create_shard(shard, TERULE_OFFSET_CHANGE);
+}
+
+int terule_create_shard_member(poldiff_t * shard)
+{
+	return terule_create_shard(shard, TERULE_OFFSET_MEMBER);
+}
+
+int terule_create_shard_trans(poldiff_t * shard)
+{
+	return terule_create_shard(shard, TERULE_OFFSET_TRANS);
+}
+
+int terule_merge_shard_change(poldiff_t * diff, poldiff_t * shard)
+{
+	return terule_merge_shard(diff, shard, TERULE_OFFSET_CHANGE);
+}
+
+int terule_merge_shard_member(poldiff_t * diff, poldiff_t * shard)
+{
+	return terule_merge_shard(diff, shard, TERULE_OFFSET_MEMBER);
+}
+
+int terule_merge_shard_trans(poldiff_t * diff, poldiff_t * shard)
+{
+	return terule_merge_shard(diff, shard, TERULE_OFFSET_TRANS);
+}
+
 int terule_enable_line_numbers(poldiff_t * diff, terule_offset_e idx)
 {
 	const apol_vector_t *te = NULL;
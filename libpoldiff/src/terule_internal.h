@@ -139,6 +139,16 @@ extern "C"
  */
 	int terule_comp(const void *x, const void *y, const poldiff_t * diff);
 
+/**
+ * Hash a pseudo_terule_t by its source and target.  Rules for which
+ * terule_comp() returns 0 always have the same hash.
+ *
+ * @param item The pseudo-te rule to hash.
+ *
+ * @return Hash value for the rule.
+ */
+	uint32_t terule_hash(const void *item);
+
 /**
  * Create, initialize, and insert a new semantic difference entry for
  * a pseudo-te rule that was originally from a type_change rule.
@@ -237,6 +247,81 @@ extern "C"
  */
 	int terule_enable_line_numbers(poldiff_t * diff, unsigned int idx);
 
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for type_change rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int terule_create_shard_change(poldiff_t * shard);
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for type_member rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int terule_create_shard_member(poldiff_t * shard);
+
+/**
+ * Give a shard's copy of the policy difference structure its own
+ * empty results for type_transition rules.
+ *
+ * @param shard Copy of the policy difference structure.
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno and leave the copy unchanged.
+ */
+	int terule_create_shard_trans(poldiff_t * shard);
+
+/**
+ * Move a shard's results for type_change rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * terule_create_shard_change().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int terule_merge_shard_change(poldiff_t * diff, poldiff_t * shard);
+
+/**
+ * Move a shard's results for type_member rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * terule_create_shard_member().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int terule_merge_shard_member(poldiff_t * diff, poldiff_t * shard);
+
+/**
+ * Move a shard's results for type_transition rules into the policy
+ * difference structure, then destroy them.
+ *
+ * @param diff The policy difference structure to which to add the
+ * results, or NULL to only destroy them.
+ * @param shard Copy of the policy difference structure given to
+ * terule_create_shard_trans().
+ *
+ * @return 0 on success and < 0 on error; if the call fails, set
+ * errno.
+ */
+	int terule_merge_shard_trans(poldiff_t * diff, poldiff_t * shard);
+
 #ifdef	__cplusplus
 }
 #endif
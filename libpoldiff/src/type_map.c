@@ -792,6 +792,430 @@ static int type_map_entry_append_qtypes(poldiff_t * diff, poldiff_type_remap_ent
 	return 0;
 }
 
+/* number of min-hash values kept per type */
+#define TYPE_MAP_SKETCH_SIZE 32
+/* number of bands the min-hash values are split into when looking
+ * for candidate pairs; each band has SKETCH_SIZE / BANDS values */
+#define TYPE_MAP_SKETCH_BANDS 8
+/* fewest features that a type needs before it is sketched */
+#define TYPE_MAP_SKETCH_MIN_FEATURES 4
+/* fewest matching min-hash values for two types to be similar */
+#define TYPE_MAP_SKETCH_THRESHOLD 24
+/* buckets with more types than this on either side are ambiguous */
+#define TYPE_MAP_SKETCH_MAX_BUCKET 16
+
+/**
+ * Min-hash sketches of the types in one policy that were not matched
+ * by name.
+ */
+typedef struct type_map_sketch
+{
+	/** number of types sketched */
+	size_t num;
+	/** for each sketched type, its index into the policy's type
+	 *  vector */
+	size_t *index;
+	/** for each type value - 1, its sketch number + 1, or 0 if the
+	 *  type is not sketched */
+	size_t *slot;
+	size_t num_values;
+	/** num * TYPE_MAP_SKETCH_SIZE min-hash values */
+	uint32_t *sigs;
+	/** for each sketched type, the number of features seen */
+	size_t *num_features;
+} type_map_sketch_t;
+
+typedef struct type_map_bucket
+{
+	uint32_t key;
+	/** 0 for the original policy, 1 for the modified */
+	uint32_t side;
+	uint32_t slot;
+} type_map_bucket_t;
+
+typedef struct type_map_candidate
+{
+	size_t sim;
+	size_t orig_slot, mod_slot;
+} type_map_candidate_t;
+
+static uint32_t type_map_hash_str(uint32_t h, const char *s)
+{
+	for (; *s != '\0'; s++) {
+		h = (h ^ (unsigned char)*s) * 16777619u;
+	}
+	return (h ^ 0xff) * 16777619u;
+}
+
+static uint32_t type_map_mix(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	return h ^ (h >> 16);
+}
+
+/**
+ * Add a feature to the sketch of the type with the given value, if
+ * that type is being sketched.
+ */
+static void type_map_sketch_add(type_map_sketch_t * s, uint32_t val, uint32_t feature)
+{
+	size_t slot, k;
+	uint32_t *sig, h;
+	if (val == 0 || val > s->num_values || s->slot[val - 1] == 0) {
+		return;
+	}
+	slot = s->slot[val - 1] - 1;
+	sig = s->sigs + slot * TYPE_MAP_SKETCH_SIZE;
+	for (k = 0; k < TYPE_MAP_SKETCH_SIZE; k++) {
+		h = type_map_mix(feature + (uint32_t) k * 0x9e3779b9u);
+		if (h < sig[k]) {
+			sig[k] = h;
+		}
+	}
+	s->num_features[slot]++;
+}
+
+static void type_map_sketch_destroy(type_map_sketch_t * s)
+{
+	free(s->index);
+	free(s->slot);
+	free(s->sigs);
+	free(s->num_features);
+}
+
+/**
+ * Sketch every type of a policy that has not yet been mapped.  A
+ * type's features are its attributes, the roles that may use it,
+ * and, if the policy has rules loaded, the allow rules whose source
+ * or target is the type or one of its attributes (with the other
+ * side's name and the class).  None of these depend upon the type's
+ * own name, so a renamed type keeps its features.
+ */
+static int type_map_sketch_build(poldiff_t * diff, const apol_policy_t * p, const apol_vector_t * types, const char *done,
+				 type_map_sketch_t * s)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *iter = NULL, *iter2 = NULL;
+	apol_vector_t *roles = NULL;
+	apol_bitmap_t *sketched = NULL;
+	const apol_bitmap_t *sources, *targets;
+	const qpol_type_t *t, *source, *target;
+	const qpol_role_t *role;
+	const qpol_class_t *obj_class;
+	const qpol_avrule_t *rule;
+	const char *name, *other_name, *class_name;
+	uint32_t val, h;
+	size_t i, v, num_types = apol_vector_get_size(types);
+	int error = 0, retval = -1;
+
+	memset(s, 0, sizeof(*s));
+	for (i = 0; i < num_types; i++) {
+		t = apol_vector_get_element(types, i);
+		if (qpol_type_get_value(q, t, &val) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		if (val > s->num_values) {
+			s->num_values = val;
+		}
+	}
+	if ((s->index = calloc(num_types + 1, sizeof(*s->index))) == NULL ||
+	    (s->slot = calloc(s->num_values + 1, sizeof(*s->slot))) == NULL ||
+	    (s->sigs = malloc((num_types + 1) * TYPE_MAP_SKETCH_SIZE * sizeof(*s->sigs))) == NULL ||
+	    (s->num_features = calloc(num_types + 1, sizeof(*s->num_features))) == NULL ||
+	    (sketched = apol_bitmap_create(s->num_values + 1)) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto cleanup;
+	}
+	memset(s->sigs, 0xff, (num_types + 1) * TYPE_MAP_SKETCH_SIZE * sizeof(*s->sigs));
+	for (i = 0; i < num_types; i++) {
+		if (done[i]) {
+			continue;
+		}
+		t = apol_vector_get_element(types, i);
+		if (qpol_type_get_value(q, t, &val) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		s->index[s->num] = i;
+		s->slot[val - 1] = ++s->num;
+		apol_bitmap_set(sketched, val);
+	}
+	if (s->num == 0) {
+		retval = 0;
+		goto cleanup;
+	}
+
+	/* attributes */
+	for (i = 0; i < s->num; i++) {
+		t = apol_vector_get_element(types, s->index[i]);
+		if (qpol_type_get_value(q, t, &val) < 0 || qpol_type_get_attr_iter(q, t, &iter) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			const qpol_type_t *attr;
+			if (qpol_iterator_get_item(iter, (void **)&attr) < 0 || qpol_type_get_name(q, attr, &name) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+			type_map_sketch_add(s, val, type_map_hash_str(2166136261u ^ 'a', name));
+		}
+		qpol_iterator_destroy(&iter);
+	}
+
+	/* roles */
+	if (apol_role_get_by_query(p, NULL, &roles) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(roles); i++) {
+		role = apol_vector_get_element(roles, i);
+		if (qpol_role_get_name(q, role, &name) < 0 || qpol_role_get_type_iter(q, role, &iter) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		h = type_map_hash_str(2166136261u ^ 'r', name);
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			if (qpol_iterator_get_item(iter, (void **)&t) < 0 || qpol_type_get_value(q, t, &val) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+			type_map_sketch_add(s, val, h);
+		}
+		qpol_iterator_destroy(&iter);
+	}
+
+	/* allow rules */
+	if (qpol_policy_has_capability(q, QPOL_CAP_RULES_LOADED)) {
+		if (qpol_policy_get_avrule_iter(q, QPOL_RULE_ALLOW, &iter2) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter2); qpol_iterator_next(iter2)) {
+			if (qpol_iterator_get_item(iter2, (void **)&rule) < 0 ||
+			    qpol_avrule_get_source_type(q, rule, &source) < 0 ||
+			    qpol_avrule_get_target_type(q, rule, &target) < 0 ||
+			    qpol_avrule_get_object_class(q, rule, &obj_class) < 0 ||
+			    qpol_class_get_name(q, obj_class, &class_name) < 0 ||
+			    (sources = apol_type_get_expansion_bitmap(p, source)) == NULL ||
+			    (targets = apol_type_get_expansion_bitmap(p, target)) == NULL) {
+				error = errno;
+				goto cleanup;
+			}
+			/* a rule upon an attribute is a feature of each of
+			 * the attribute's types */
+			if (apol_bitmap_intersects(sources, sketched)) {
+				if (qpol_type_get_name(q, target, &other_name) < 0) {
+					error = errno;
+					goto cleanup;
+				}
+				h = type_map_hash_str(type_map_hash_str(2166136261u ^ 's', other_name), class_name);
+				for (v = apol_bitmap_next(sources, 0); v < apol_bitmap_get_size(sources); v = apol_bitmap_next(sources, v + 1)) {
+					type_map_sketch_add(s, (uint32_t) v, h);
+				}
+			}
+			if (apol_bitmap_intersects(targets, sketched)) {
+				if (qpol_type_get_name(q, source, &other_name) < 0) {
+					error = errno;
+					goto cleanup;
+				}
+				h = type_map_hash_str(type_map_hash_str(2166136261u ^ 't', other_name), class_name);
+				for (v = apol_bitmap_next(targets, 0); v < apol_bitmap_get_size(targets); v = apol_bitmap_next(targets, v + 1)) {
+					type_map_sketch_add(s, (uint32_t) v, h);
+				}
+			}
+		}
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&iter2);
+	apol_vector_destroy(&roles);
+	apol_bitmap_destroy(&sketched);
+	errno = error;
+	return retval;
+}
+
+static int type_map_bucket_comp(const void *a, const void *b)
+{
+	const type_map_bucket_t *x = a, *y = b;
+	if (x->key != y->key) {
+		return (x->key < y->key ? -1 : 1);
+	}
+	if (x->side != y->side) {
+		return (int)x->side - (int)y->side;
+	}
+	return (x->slot < y->slot ? -1 : (x->slot > y->slot ? 1 : 0));
+}
+
+static int type_map_candidate_comp(const void *a, const void *b)
+{
+	const type_map_candidate_t *x = a, *y = b;
+	if (x->sim != y->sim) {
+		return (x->sim > y->sim ? -1 : 1);
+	}
+	if (x->orig_slot != y->orig_slot) {
+		return (x->orig_slot < y->orig_slot ? -1 : 1);
+	}
+	return (x->mod_slot < y->mod_slot ? -1 : (x->mod_slot > y->mod_slot ? 1 : 0));
+}
+
+/**
+ * Propose remaps for types left unmatched by name, by comparing
+ * min-hash sketches of their attributes, roles, and rules.  Candidate
+ * pairs are found by banding the sketches (locality-sensitive
+ * hashing), so the cost grows nearly linearly with the number of
+ * types.  A pair is proposed only if it is the sole best match for
+ * both of its types; a type whose best match is a tie is never
+ * proposed.  Proposals are inferred entries that start out disabled,
+ * for the user to review and enable.
+ */
+static int type_map_infer_structural(poldiff_t * diff, const apol_vector_t * ov, const apol_vector_t * mv, char *orig_done,
+				     char *mod_done)
+{
+	type_map_sketch_t sk[2];
+	type_map_bucket_t *buckets = NULL;
+	type_map_candidate_t *cands = NULL, *c, *d;
+	char *tied[2] = { NULL, NULL };
+	size_t num_cands = 0, cap_cands = 0, num_buckets, band, rows = TYPE_MAP_SKETCH_SIZE / TYPE_MAP_SKETCH_BANDS;
+	size_t i, j, k, start, mid, end, o, m, sim;
+	const uint32_t *sig;
+	poldiff_type_remap_entry_t *entry;
+	int side, error = 0, retval = -1;
+
+	memset(sk, 0, sizeof(sk));
+	if (type_map_sketch_build(diff, diff->orig_pol, ov, orig_done, &sk[0]) < 0 ||
+	    type_map_sketch_build(diff, diff->mod_pol, mv, mod_done, &sk[1]) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	if (sk[0].num == 0 || sk[1].num == 0) {
+		retval = 0;
+		goto cleanup;
+	}
+	if ((buckets = malloc((sk[0].num + sk[1].num) * sizeof(*buckets))) == NULL ||
+	    (tied[0] = calloc(sk[0].num, sizeof(char))) == NULL || (tied[1] = calloc(sk[1].num, sizeof(char))) == NULL) {
+		error = errno;
+		ERR(diff, "%s", strerror(error));
+		goto cleanup;
+	}
+
+	/* gather candidate pairs that share any band */
+	for (band = 0; band < TYPE_MAP_SKETCH_BANDS; band++) {
+		num_buckets = 0;
+		for (side = 0; side < 2; side++) {
+			for (i = 0; i < sk[side].num; i++) {
+				uint32_t key = 2166136261u;
+				if (sk[side].num_features[i] < TYPE_MAP_SKETCH_MIN_FEATURES) {
+					continue;
+				}
+				sig = sk[side].sigs + i * TYPE_MAP_SKETCH_SIZE + band * rows;
+				for (k = 0; k < rows; k++) {
+					key = type_map_mix(key ^ sig[k]);
+				}
+				buckets[num_buckets].key = key;
+				buckets[num_buckets].side = side;
+				buckets[num_buckets].slot = i;
+				num_buckets++;
+			}
+		}
+		qsort(buckets, num_buckets, sizeof(*buckets), type_map_bucket_comp);
+		for (start = 0; start < num_buckets; start = end) {
+			for (mid = start; mid < num_buckets && buckets[mid].key == buckets[start].key && buckets[mid].side == 0; mid++) ;
+			for (end = mid; end < num_buckets && buckets[end].key == buckets[start].key; end++) ;
+			if (mid == start || end == mid || mid - start > TYPE_MAP_SKETCH_MAX_BUCKET
+			    || end - mid > TYPE_MAP_SKETCH_MAX_BUCKET) {
+				continue;
+			}
+			for (i = start; i < mid; i++) {
+				for (j = mid; j < end; j++) {
+					const uint32_t *s1 = sk[0].sigs + buckets[i].slot * TYPE_MAP_SKETCH_SIZE;
+					const uint32_t *s2 = sk[1].sigs + buckets[j].slot * TYPE_MAP_SKETCH_SIZE;
+					for (sim = 0, k = 0; k < TYPE_MAP_SKETCH_SIZE; k++) {
+						sim += (s1[k] == s2[k]);
+					}
+					if (sim < TYPE_MAP_SKETCH_THRESHOLD) {
+						continue;
+					}
+					if (num_cands >= cap_cands) {
+						size_t new_cap = (cap_cands == 0 ? 16 : cap_cands * 2);
+						type_map_candidate_t *t = realloc(cands, new_cap * sizeof(*t));
+						if (t == NULL) {
+							error = errno;
+							ERR(diff, "%s", strerror(error));
+							goto cleanup;
+						}
+						cands = t;
+						cap_cands = new_cap;
+					}
+					cands[num_cands].sim = sim;
+					cands[num_cands].orig_slot = buckets[i].slot;
+					cands[num_cands].mod_slot = buckets[j].slot;
+					num_cands++;
+				}
+			}
+		}
+	}
+
+	/* accept the best pairs first, skipping ties; the same pair may
+	 * have been found through several bands.  Both types of a tie
+	 * are then left out of every worse pair as well, since neither
+	 * one's best match is unique. */
+	qsort(cands, num_cands, sizeof(*cands), type_map_candidate_comp);
+	for (i = 0; i < num_cands; i = j) {
+		for (j = i; j < num_cands && cands[j].sim == cands[i].sim; j++) ;
+		for (c = cands + i; c < cands + j; c++) {
+			int unique = 1;
+			o = sk[0].index[c->orig_slot];
+			m = sk[1].index[c->mod_slot];
+			if (orig_done[o] || mod_done[m]) {
+				continue;
+			}
+			if (tied[0][c->orig_slot] || tied[1][c->mod_slot]) {
+				unique = 0;
+			}
+			for (d = cands + i; unique && d < cands + j; d++) {
+				if ((d->orig_slot == c->orig_slot) != (d->mod_slot == c->mod_slot) &&
+				    !orig_done[sk[0].index[d->orig_slot]] && !mod_done[sk[1].index[d->mod_slot]]) {
+					unique = 0;
+					break;
+				}
+			}
+			if (!unique) {
+				tied[0][c->orig_slot] = 1;
+				tied[1][c->mod_slot] = 1;
+				continue;
+			}
+			if ((entry = poldiff_type_remap_entry_create(diff)) == NULL ||
+			    type_map_entry_append_qtypes(diff, entry, apol_vector_get_element(ov, o),
+							 apol_vector_get_element(mv, m)) < 0) {
+				error = errno;
+				ERR(diff, "%s", strerror(error));
+				goto cleanup;
+			}
+			entry->inferred = 1;
+			entry->enabled = 0;
+			orig_done[o] = 1;
+			mod_done[m] = 1;
+		}
+	}
+	retval = 0;
+      cleanup:
+	type_map_sketch_destroy(&sk[0]);
+	type_map_sketch_destroy(&sk[1]);
+	free(buckets);
+	free(cands);
+	free(tied[0]);
+	free(tied[1]);
+	errno = error;
+	return retval;
+}
+
 int type_map_infer(poldiff_t * diff)
 {
 	apol_vector_t *ov = NULL, *mv = NULL;
@@ -924,6 +1348,12 @@ int type_map_infer(poldiff_t * diff)
 		mod_done[j] = 1;
 	}
 
+	/* finally propose remaps for renamed types by structure */
+	if (type_map_infer_structural(diff, ov, mv, orig_done, mod_done) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+
 	type_remap_vector_dump(diff);
 
 	retval = 0;
@@ -940,23 +1370,36 @@ int type_map_infer(poldiff_t * diff)
 uint32_t type_map_lookup(const poldiff_t * diff, const qpol_type_t * type, int which_pol)
 {
 	uint32_t val;
+	if (qpol_type_get_value(which_pol == POLDIFF_POLICY_ORIG ? diff->orig_qpol : diff->mod_qpol, type, &val) < 0) {
+		return 0;
+	}
+	return type_map_lookup_value(diff, val, which_pol);
+}
+
+uint32_t type_map_lookup_value(const poldiff_t * diff, uint32_t val, int which_pol)
+{
 	if (which_pol == POLDIFF_POLICY_ORIG) {
-		if (qpol_type_get_value(diff->orig_qpol, type, &val) < 0) {
+		if (val == 0 || val > diff->type_map->num_orig_types) {
 			return 0;
 		}
-		assert(val <= diff->type_map->num_orig_types);
-		assert(diff->type_map->orig_to_pseudo[val - 1] != 0);
 		return diff->type_map->orig_to_pseudo[val - 1];
 	} else {
-		if (qpol_type_get_value(diff->mod_qpol, type, &val) < 0) {
+		if (val == 0 || val > diff->type_map->num_mod_types) {
 			return 0;
 		}
-		assert(val <= diff->type_map->num_mod_types);
-		assert(diff->type_map->mod_to_pseudo[val - 1] != 0);
 		return diff->type_map->mod_to_pseudo[val - 1];
 	}
 }
 
+int type_map_orig_equal(const type_map_t * a, const type_map_t * b)
+{
+	if (a == NULL || b == NULL || a->orig_to_pseudo == NULL || b->orig_to_pseudo == NULL ||
+	    a->num_orig_types != b->num_orig_types) {
+		return 0;
+	}
+	return memcmp(a->orig_to_pseudo, b->orig_to_pseudo, a->num_orig_types * sizeof(uint32_t)) == 0;
+}
+
 const apol_vector_t *type_map_lookup_reverse(const poldiff_t * diff, uint32_t val, int which_pol)
 {
 	if (which_pol == POLDIFF_POLICY_ORIG) {
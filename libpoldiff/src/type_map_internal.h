@@ -102,6 +102,13 @@ extern "C"
  *  all of the aliases of one type are exactly the same as another
  *  type's aliases then map it.
  *
+ *  <li>For all remaining unmapped primary types in both policies,
+ *  compare min-hash sketches of their attributes, roles, and allow
+ *  rules.  If a type's sketch is the sole closest match to another
+ *  type's sketch, and the two are similar enough, then propose a
+ *  mapping between them.  These proposals are added as disabled
+ *  entries, for the user to review and enable.
+ *
  *  <li>All remaining types are left as unmapped.
  *
  *  </ol>
@@ -131,6 +138,34 @@ extern "C"
  */
 	uint32_t type_map_lookup(const poldiff_t * diff, const qpol_type_t * type, int which_pol);
 
+/**
+ *  Given a type's value and a flag indicating from which the policy
+ *  the type originated, return its remapped value.  (type_map_build()
+ *  must have been first called.)
+ *
+ *  @param diff The policy difference structure assocated with the
+ *  types.
+ *  @param val Value of the type within its policy.
+ *  @param which_pol One of POLDIFF_POLICY_ORIG or POLDIFF_POLICY_MOD.
+ *
+ *  @return The type's remapped value, or 0 if the value is not that
+ *  of a type within the map.
+ */
+	uint32_t type_map_lookup_value(const poldiff_t * diff, uint32_t val, int which_pol);
+
+/**
+ *  Determine if two built type maps give every type of the original
+ *  policy the same pseudo-type value.  Items gathered from the
+ *  original policy under one map are then valid under the other.
+ *
+ *  @param a A type map, after type_map_build().
+ *  @param b Another type map, after type_map_build().
+ *
+ *  @return Non-zero if the maps agree upon the original policy, 0 if
+ *  not or if either map has not been built.
+ */
+	int type_map_orig_equal(const type_map_t * a, const type_map_t * b);
+
 /**
  *  Given a pseudo-type's value and a flag indicating for which policy
  *  to look up, return a vector of qpol_type_t pointers to reference
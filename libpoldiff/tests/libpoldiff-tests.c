@@ -223,37 +223,49 @@ component_funcs_t *init_test_funcs(poldiff_get_diff_vector get_diff_vector, pold
 	return funcs;
 }
 
-poldiff_t *init_poldiff(char *orig_base_path, char *mod_base_path)
+apol_policy_t *load_policy(const char *base_path)
 {
-	poldiff_t *return_diff = NULL;
-	uint32_t flags = POLDIFF_DIFF_ALL;
-	apol_policy_path_t *mod_pol_path = NULL;
-	apol_policy_path_t *orig_pol_path = NULL;
+	apol_policy_path_t *pol_path = NULL;
+	apol_policy_t *policy = NULL;
 
-	orig_pol_path = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, orig_base_path, NULL);
-	if (!orig_pol_path) {
+	if ((pol_path = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, base_path, NULL)) == NULL) {
 		ERR(NULL, "%s", strerror(errno));
-		goto err;
+		return NULL;
 	}
-
-	mod_pol_path = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, mod_base_path, NULL);
-	if (!mod_pol_path) {
+	if ((policy = apol_policy_create_from_policy_path(pol_path, 0, NULL, NULL)) == NULL) {
 		ERR(NULL, "%s", strerror(errno));
-		goto err;
 	}
+	apol_policy_path_destroy(&pol_path);
+	return policy;
+}
 
-	orig_policy = apol_policy_create_from_policy_path(orig_pol_path, 0, NULL, NULL);
-	if (!orig_policy) {
-		ERR(NULL, "%s", strerror(errno));
+poldiff_t *create_poldiff(const char *orig_base_path, const char *mod_base_path)
+{
+	apol_policy_t *orig = NULL, *mod = NULL;
+	poldiff_t *return_diff = NULL;
+
+	if ((orig = load_policy(orig_base_path)) == NULL || (mod = load_policy(mod_base_path)) == NULL) {
 		goto err;
 	}
-
-	mod_policy = apol_policy_create_from_policy_path(mod_pol_path, 0, NULL, NULL);
-	if (!mod_policy) {
+	if (!(return_diff = poldiff_create(orig, mod, NULL, NULL))) {
 		ERR(NULL, "%s", strerror(errno));
 		goto err;
 	}
+	return return_diff;
+      err:
+	apol_policy_destroy(&orig);
+	apol_policy_destroy(&mod);
+	return NULL;
+}
+
+poldiff_t *init_poldiff(char *orig_base_path, char *mod_base_path)
+{
+	poldiff_t *return_diff = NULL;
+	uint32_t flags = POLDIFF_DIFF_ALL;
 
+	if ((orig_policy = load_policy(orig_base_path)) == NULL || (mod_policy = load_policy(mod_base_path)) == NULL) {
+		goto err;
+	}
 	if (!(return_diff = poldiff_create(orig_policy, mod_policy, NULL, NULL))) {
 		ERR(NULL, "%s", strerror(errno));
 		goto err;
@@ -261,14 +273,12 @@ poldiff_t *init_poldiff(char *orig_base_path, char *mod_base_path)
 	if (poldiff_run(return_diff, flags)) {
 		goto err;
 	}
-	apol_policy_path_destroy(&orig_pol_path);
-	apol_policy_path_destroy(&mod_pol_path);
 	return return_diff;
       err:
-	apol_policy_destroy(&orig_policy);
-	apol_policy_destroy(&mod_policy);
-	apol_policy_path_destroy(&orig_pol_path);
-	apol_policy_path_destroy(&mod_pol_path);
+	if (return_diff == NULL) {
+		apol_policy_destroy(&orig_policy);
+		apol_policy_destroy(&mod_policy);
+	}
 	poldiff_destroy(&return_diff);
 	return NULL;
 }
@@ -317,6 +327,26 @@ int main()
 	CU_TestInfo rules_tests_arr[] = {
 		{"AV Rules", rules_avrules_tests}
 		,
+		{"Streamed AV Rules", rules_avrules_stream_tests}
+		,
+		{"Phases of a Run", rules_phase_tests}
+		,
+		{"Rules Against a Kept Baseline", rules_avrules_baseline_tests}
+		,
+		{"AV Rule Line Numbers Across a Reset", rules_avrules_line_numbers_tests}
+		,
+		{"Archived Rules", rules_archive_tests}
+		,
+		{"N-way Rules", rules_nway_tests}
+		,
+		{"Renamed Type Proposals", rules_renamed_type_tests}
+		,
+		{"Renamed Types Reached Through Attributes", rules_renamed_type_attr_tests}
+		,
+		{"Wildcard Rules Against a New Permission", rules_wildcard_perm_tests}
+		,
+		{"Rules Diffed in Shards", rules_sharded_tests}
+		,
 		{"TE Rules", rules_terules_tests}
 		,
 		{"Role Allow Rules", rules_roleallow_tests}
@@ -58,6 +58,8 @@ typedef enum _test_numbers
 } test_numbers_e;
 
 poldiff_t *init_poldiff(char *orig_base_path, char *mod_base_path);
+apol_policy_t *load_policy(const char *base_path);
+poldiff_t *create_poldiff(const char *orig_base_path, const char *mod_base_path);
 component_funcs_t *init_test_funcs(poldiff_get_diff_vector, poldiff_get_name, poldiff_get_form, poldiff_get_added,
 				   poldiff_get_removed);
 void run_test(component_funcs_t *, poldiff_test_answers_t *, test_numbers_e);
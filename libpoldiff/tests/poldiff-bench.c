@@ -0,0 +1,513 @@
+/**
+ *  @file
+ *
+ *  Benchmark libpoldiff upon synthetic policies.  A pair of source
+ *  policies is generated from a seed, with configurable numbers of
+ *  types, attributes, and rules, and then diffed.  Each phase of
+ *  poldiff_run() is timed through poldiff_set_phase_callback(), and
+ *  the results are written to standard output as one JSON object,
+ *  for regression tracking.
+ *
+ *  Copyright (C) 2026 SETools contributors
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <poldiff/poldiff.h>
+#include <poldiff/component_record.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/util.h>
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define BENCH_MAX_PHASES 256
+#define BENCH_NUM_CLASSES 4
+#define BENCH_NUM_PERMS 16
+
+/* parameters of the generated policies */
+typedef struct bench_params
+{
+	size_t num_types;
+	size_t num_attribs;
+	/** attributes per type */
+	size_t fanout;
+	size_t num_rules;
+	size_t num_bools;
+	/** fraction of rules within a conditional */
+	double cond_ratio;
+	/** fraction of rules, type transitions, and types that differ
+	 *  in the modified policy */
+	double change_rate;
+	uint64_t seed;
+} bench_params_t;
+
+typedef struct bench_phase
+{
+	poldiff_phase_e phase;
+	/** component flag, or 0 for phases of the whole diff */
+	uint32_t which;
+	double seconds;
+} bench_phase_t;
+
+/* phases seen so far, in the order they first began */
+typedef struct bench_timer
+{
+	bench_phase_t phases[BENCH_MAX_PHASES];
+	size_t num_phases;
+	/** start of the phase now running */
+	double phase_start;
+} bench_timer_t;
+
+/* indexed by poldiff_phase_e */
+static const char *bench_phase_names[] = { "load original rules", "load modified rules", "reset", "type map",
+	"original items", "modified items", "merge"
+};
+
+static const char *bench_classes[BENCH_NUM_CLASSES] = { "file", "dir", "process", "socket" };
+
+static struct option const longopts[] = {
+	{"types", required_argument, NULL, 't'},
+	{"attribs", required_argument, NULL, 'a'},
+	{"fanout", required_argument, NULL, 'f'},
+	{"rules", required_argument, NULL, 'r'},
+	{"bools", required_argument, NULL, 'b'},
+	{"cond-ratio", required_argument, NULL, 'c'},
+	{"change-rate", required_argument, NULL, 'x'},
+	{"seed", required_argument, NULL, 's'},
+	{"keep", no_argument, NULL, 'k'},
+	{"help", no_argument, NULL, 'h'},
+	{NULL, 0, NULL, 0}
+};
+
+static void usage(const char *prog_name, int brief)
+{
+	printf("Usage: %s [OPTIONS]\n\n", prog_name);
+	if (brief) {
+		printf("\tTry %s --help for more help.\n\n", prog_name);
+		return;
+	}
+	printf("Generate a pair of synthetic policies, diff them, and report the time\n");
+	printf("spent in each phase as JSON.  The following options are available:\n\n");
+	printf("  -t, --types=N          number of types (default 1000)\n");
+	printf("  -a, --attribs=N        number of attributes (default 50)\n");
+	printf("  -f, --fanout=N         attributes per type (default 3)\n");
+	printf("  -r, --rules=N          number of allow rules (default 20000)\n");
+	printf("  -b, --bools=N          number of booleans (default 20)\n");
+	printf("  -c, --cond-ratio=R     fraction of rules that are conditional (default 0.1)\n");
+	printf("  -x, --change-rate=R    fraction of the policy changed (default 0.05)\n");
+	printf("  -s, --seed=N           seed for the generator (default 1)\n");
+	printf("  -k, --keep             keep the generated policies\n");
+	printf("  -h, --help             print this help text and exit\n\n");
+}
+
+static double bench_now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* xorshift64*, so that a seed gives the same policies everywhere */
+static uint64_t bench_rand(uint64_t * state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 2685821657736338717ULL;
+}
+
+static double bench_rand_unit(uint64_t * state)
+{
+	return (bench_rand(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Write one allow rule with a random source, target, class, and set
+ * of permissions.  Sources and targets are sometimes attributes, so
+ * that the diff must expand them.  The permissions are then
+ * toggled by perm_xor, so that a rule may be altered while keeping
+ * its source, target, and class.
+ */
+static void bench_write_rule(FILE * fp, const bench_params_t * params, uint64_t * state, uint64_t perm_xor)
+{
+	uint64_t perms;
+	size_t i;
+	int k;
+
+	for (k = 0; k < 2; k++) {
+		if (params->num_attribs > 0 && bench_rand_unit(state) < 0.2) {
+			fprintf(fp, "%sa%zu", (k == 0 ? "allow " : " "), (size_t)(bench_rand(state) % params->num_attribs));
+		} else {
+			fprintf(fp, "%st%zu_t", (k == 0 ? "allow " : " "), (size_t)(bench_rand(state) % params->num_types));
+		}
+	}
+	fprintf(fp, " : %s {", bench_classes[bench_rand(state) % BENCH_NUM_CLASSES]);
+	if ((perms = (bench_rand(state) ^ perm_xor) & ((1U << BENCH_NUM_PERMS) - 1)) == 0) {
+		perms = 1;
+	}
+	for (i = 0; i < BENCH_NUM_PERMS; i++) {
+		if (perms & (1U << i)) {
+			fprintf(fp, " p%zu", i);
+		}
+	}
+	fprintf(fp, " };\n");
+}
+
+/**
+ * Write one synthetic policy.  The original and modified policies
+ * share a seed, so that they draw the same rules; the modified one
+ * then drops, alters, or adds a change_rate fraction of them.
+ */
+static int bench_write_policy(FILE * fp, const bench_params_t * params, int modified)
+{
+	uint64_t state = params->seed * 2654435761ULL + 1, change_state = params->seed + 0x9e3779b97f4a7c15ULL;
+	size_t num_types = params->num_types, i, j, b;
+	int pass;
+
+	if (modified) {
+		num_types += (size_t)(params->num_types * params->change_rate);
+	}
+	for (i = 0; i < BENCH_NUM_CLASSES; i++) {
+		fprintf(fp, "class %s\n", bench_classes[i]);
+	}
+	fprintf(fp, "sid kernel\n");
+	fprintf(fp, "common base {");
+	for (i = 0; i < BENCH_NUM_PERMS / 2; i++) {
+		fprintf(fp, " p%zu", i);
+	}
+	fprintf(fp, " }\n");
+	for (i = 0; i < BENCH_NUM_CLASSES; i++) {
+		fprintf(fp, "class %s inherits base {", bench_classes[i]);
+		for (j = BENCH_NUM_PERMS / 2; j < BENCH_NUM_PERMS; j++) {
+			fprintf(fp, " p%zu", j);
+		}
+		fprintf(fp, " }\n");
+	}
+	for (i = 0; i < params->num_attribs; i++) {
+		fprintf(fp, "attribute a%zu;\n", i);
+	}
+	/* t1, t2, and t3 are keywords of the policy language, so type
+	 * names take a suffix */
+	for (i = 0; i < num_types; i++) {
+		fprintf(fp, "type t%zu_t", i);
+		for (j = 0; j < params->fanout && j < params->num_attribs; j++) {
+			fprintf(fp, ", a%zu", (size_t)((i * 31 + j) % params->num_attribs));
+		}
+		fprintf(fp, ";\n");
+	}
+	for (b = 0; b < params->num_bools; b++) {
+		fprintf(fp, "bool b%zu %s;\n", b, (b % 2 ? "true" : "false"));
+	}
+
+	/* unconditional rules first, then each boolean's rules */
+	for (pass = -1; pass < (int)params->num_bools; pass++) {
+		uint64_t pass_state = state, pass_change = change_state;
+		if (pass >= 0) {
+			/* one fixed rule, so that no block is empty */
+			fprintf(fp, "if (b%d) {\nallow t%zu_t t%zu_t : file { p0 };\n", pass, pass % params->num_types,
+				pass % params->num_types);
+		}
+		for (i = 0; i < params->num_rules; i++) {
+			double c = bench_rand_unit(&pass_change);
+			int in_pass;
+			uint64_t rule_state = bench_rand(&pass_state);
+			if (params->num_bools == 0 || bench_rand_unit(&rule_state) >= params->cond_ratio) {
+				in_pass = (pass < 0);
+			} else {
+				in_pass = (pass == (int)(bench_rand(&rule_state) % params->num_bools));
+			}
+			if (!in_pass) {
+				continue;
+			}
+			if (modified && c < params->change_rate / 3) {
+				/* dropped */
+				continue;
+			} else if (modified && c < params->change_rate * 2 / 3) {
+				/* same source, target, and class; one permission
+				 * toggled */
+				bench_write_rule(fp, params, &rule_state, 1U << (bench_rand(&pass_change) % BENCH_NUM_PERMS));
+				continue;
+			}
+			bench_write_rule(fp, params, &rule_state, 0);
+			if (modified && c < params->change_rate) {
+				/* kept, plus a new rule */
+				bench_write_rule(fp, params, &rule_state, 0);
+			}
+		}
+		if (pass >= 0) {
+			fprintf(fp, "}\n");
+		}
+	}
+	if (modified) {
+		/* give each added type some rules of its own */
+		for (i = params->num_types; i < num_types; i++) {
+			fprintf(fp, "allow t%zu_t t%zu_t : file { p0 p1 };\n", i, i);
+			fprintf(fp, "allow t%zu_t t0_t : process { p8 };\n", i);
+		}
+	}
+
+	/* type transitions, one per pair of consecutive types */
+	for (i = 0; i + 1 < params->num_types; i++) {
+		size_t dflt = i;
+		if (modified && bench_rand_unit(&change_state) < params->change_rate) {
+			dflt = (i + 2) % params->num_types;
+		}
+		fprintf(fp, "type_transition t%zu_t t%zu_t : file t%zu_t;\n", i, i + 1, dflt);
+	}
+
+	fprintf(fp, "role r types {");
+	for (i = 0; i < num_types; i++) {
+		fprintf(fp, " t%zu_t", i);
+	}
+	fprintf(fp, " };\n");
+	fprintf(fp, "user u roles { r };\n");
+	fprintf(fp, "sid kernel u:r:t0_t\n");
+	return ferror(fp) ? -1 : 0;
+}
+
+/**
+ * Generate one policy into a temporary file.
+ *
+ * @return Newly allocated path of the file, or NULL on error.
+ */
+static char *bench_generate(const bench_params_t * params, int modified)
+{
+	const char *dir = getenv("TMPDIR");
+	char *path = NULL;
+	FILE *fp;
+	int fd;
+
+	if (asprintf(&path, "%s/poldiff-bench-%s-XXXXXX", (dir != NULL ? dir : "/tmp"), (modified ? "mod" : "orig")) < 0) {
+		return NULL;
+	}
+	if ((fd = mkstemp(path)) < 0 || (fp = fdopen(fd, "w")) == NULL) {
+		perror("Could not create policy");
+		free(path);
+		return NULL;
+	}
+	if (bench_write_policy(fp, params, modified) < 0 || fclose(fp) != 0) {
+		perror("Could not write policy");
+		unlink(path);
+		free(path);
+		return NULL;
+	}
+	return path;
+}
+
+/**
+ * Phase callback that adds the time spent in each phase to that
+ * phase's total for its component.
+ */
+static void bench_handle_phase(void *arg, const poldiff_t * diff __attribute__ ((unused)), poldiff_phase_e phase, uint32_t which,
+			       int is_end)
+{
+	bench_timer_t *t = (bench_timer_t *) arg;
+	double now = bench_now();
+	size_t i;
+
+	if (!is_end) {
+		t->phase_start = now;
+		return;
+	}
+	for (i = 0; i < t->num_phases; i++) {
+		if (t->phases[i].phase == phase && t->phases[i].which == which)
+			break;
+	}
+	if (i == t->num_phases) {
+		if (t->num_phases >= BENCH_MAX_PHASES)
+			return;
+		t->phases[i].phase = phase;
+		t->phases[i].which = which;
+		t->phases[i].seconds = 0;
+		t->num_phases++;
+	}
+	t->phases[i].seconds += now - t->phase_start;
+}
+
+/**
+ * Message handler that prints warnings and errors, and drops the
+ * informational messages that mark each phase.
+ */
+static void bench_handle_msg(void *arg __attribute__ ((unused)), const poldiff_t * diff __attribute__ ((unused)), int level,
+			     const char *fmt, va_list va_args)
+{
+	/* libpoldiff's message levels are the same as libapol's */
+	if (level == APOL_MSG_INFO) {
+		return;
+	}
+	vfprintf(stderr, fmt, va_args);
+	fprintf(stderr, "\n");
+}
+
+/**
+ * Write the name of a timed phase, followed by the label of its
+ * component if it has one.
+ */
+static void bench_print_phase_name(const bench_phase_t * p)
+{
+	const poldiff_component_record_t *rec;
+	putchar('"');
+	fputs(bench_phase_names[p->phase], stdout);
+	if (p->which != 0 && (rec = poldiff_get_component_record(p->which)) != NULL) {
+		printf(" %s", poldiff_component_record_get_label(rec));
+	}
+	putchar('"');
+}
+
+int main(int argc, char **argv)
+{
+	bench_params_t params = { 1000, 50, 3, 20000, 20, 0.1, 0.05, 1 };
+	bench_timer_t timer;
+	apol_policy_path_t *orig_path = NULL, *mod_path = NULL;
+	apol_policy_t *orig_policy = NULL, *mod_policy = NULL;
+	poldiff_t *diff = NULL;
+	char *orig_file = NULL, *mod_file = NULL;
+	size_t stats[5], num_diffs = 0, i;
+	double start, load_seconds, run_seconds;
+	struct rusage usage_info;
+	int optc, keep = 0, rt = 1;
+
+	while ((optc = getopt_long(argc, argv, "t:a:f:r:b:c:x:s:kh", longopts, NULL)) != -1) {
+		switch (optc) {
+		case 't':
+			params.num_types = strtoul(optarg, NULL, 10);
+			break;
+		case 'a':
+			params.num_attribs = strtoul(optarg, NULL, 10);
+			break;
+		case 'f':
+			params.fanout = strtoul(optarg, NULL, 10);
+			break;
+		case 'r':
+			params.num_rules = strtoul(optarg, NULL, 10);
+			break;
+		case 'b':
+			params.num_bools = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			params.cond_ratio = strtod(optarg, NULL);
+			break;
+		case 'x':
+			params.change_rate = strtod(optarg, NULL);
+			break;
+		case 's':
+			params.seed = strtoull(optarg, NULL, 10);
+			break;
+		case 'k':
+			keep = 1;
+			break;
+		case 'h':
+			usage(argv[0], 0);
+			exit(0);
+		default:
+			usage(argv[0], 1);
+			exit(1);
+		}
+	}
+	if (optind < argc || params.num_types < 2 || params.cond_ratio < 0 || params.cond_ratio > 1 || params.change_rate < 0 ||
+	    params.change_rate > 1) {
+		usage(argv[0], 1);
+		exit(1);
+	}
+	memset(&timer, 0, sizeof(timer));
+
+	if ((orig_file = bench_generate(&params, 0)) == NULL || (mod_file = bench_generate(&params, 1)) == NULL) {
+		goto cleanup;
+	}
+	orig_path = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, orig_file, NULL);
+	mod_path = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, mod_file, NULL);
+	if (orig_path == NULL || mod_path == NULL) {
+		perror("Error creating policy paths");
+		goto cleanup;
+	}
+	start = bench_now();
+	orig_policy = apol_policy_create_from_policy_path(orig_path, 0, NULL, NULL);
+	mod_policy = apol_policy_create_from_policy_path(mod_path, 0, NULL, NULL);
+	load_seconds = bench_now() - start;
+	if (orig_policy == NULL || mod_policy == NULL) {
+		fprintf(stderr, "Could not load generated policies.\n");
+		goto cleanup;
+	}
+	start = bench_now();
+	if ((diff = poldiff_create(orig_policy, mod_policy, bench_handle_msg, NULL)) == NULL) {
+		orig_policy = mod_policy = NULL;
+		goto cleanup;
+	}
+	orig_policy = mod_policy = NULL;
+	poldiff_set_phase_callback(diff, bench_handle_phase, &timer);
+	if (poldiff_run(diff, POLDIFF_DIFF_ALL) < 0) {
+		goto cleanup;
+	}
+	run_seconds = bench_now() - start;
+	if (poldiff_get_stats(diff, POLDIFF_DIFF_ALL, stats) < 0) {
+		goto cleanup;
+	}
+	for (i = 0; i < 5; i++) {
+		num_diffs += stats[i];
+	}
+	getrusage(RUSAGE_SELF, &usage_info);
+
+	printf("{\"params\": {\"types\": %zu, \"attribs\": %zu, \"fanout\": %zu, \"rules\": %zu, \"bools\": %zu, "
+	       "\"cond_ratio\": %g, \"change_rate\": %g, \"seed\": %llu},\n", params.num_types, params.num_attribs, params.fanout,
+	       params.num_rules, params.num_bools, params.cond_ratio, params.change_rate, (unsigned long long)params.seed);
+	printf(" \"load_seconds\": %.6f,\n \"run_seconds\": %.6f,\n", load_seconds, run_seconds);
+	printf(" \"phases\": [");
+	for (i = 0; i < timer.num_phases; i++) {
+		printf("%s\n  {\"name\": ", (i > 0 ? "," : ""));
+		bench_print_phase_name(timer.phases + i);
+		printf(", \"seconds\": %.6f}", timer.phases[i].seconds);
+	}
+	printf("],\n");
+	printf(" \"differences\": %zu,\n \"stats\": [%zu, %zu, %zu, %zu, %zu],\n", num_diffs, stats[0], stats[1], stats[2],
+	       stats[3], stats[4]);
+	/* both policies' generated allow rules, per second of poldiff_run() */
+	printf(" \"rules_per_second\": %.1f,\n", (run_seconds > 0 ? 2.0 * params.num_rules / run_seconds : 0));
+	/* ru_maxrss is in kilobytes on Linux */
+	printf(" \"peak_rss_kb\": %ld}\n", usage_info.ru_maxrss);
+	rt = 0;
+
+      cleanup:
+	poldiff_destroy(&diff);
+	apol_policy_destroy(&orig_policy);
+	apol_policy_destroy(&mod_policy);
+	apol_policy_path_destroy(&orig_path);
+	apol_policy_path_destroy(&mod_path);
+	if (orig_file != NULL) {
+		if (keep)
+			fprintf(stderr, "Kept %s\n", orig_file);
+		else
+			unlink(orig_file);
+	}
+	if (mod_file != NULL) {
+		if (keep)
+			fprintf(stderr, "Kept %s\n", mod_file);
+		else
+			unlink(mod_file);
+	}
+	free(orig_file);
+	free(mod_file);
+	return rt;
+}
@@ -38,6 +38,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <errno.h>
+#include <unistd.h>
 #include <getopt.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -904,6 +905,644 @@ void rules_roletrans_tests()
 	cleanup_test(answers);
 }
 
+static int count_streamed_item(void *arg, const poldiff_t * d __attribute__ ((unused)), uint32_t which, const void *item)
+{
+	size_t *count = arg;
+	CU_ASSERT(which & POLDIFF_DIFF_AVRULES);
+	CU_ASSERT_PTR_NOT_NULL(item);
+	(*count)++;
+	return 0;
+}
+
+void rules_avrules_stream_tests()
+{
+	poldiff_t *d = NULL;
+	size_t stats[5], streamed_stats[5], total = 0, count = 0, i;
+
+	d = create_poldiff(RULES_ORIG_POLICY, RULES_MOD_POLICY);
+	CU_ASSERT_FATAL(d != NULL);
+
+	/* every difference reaches the callback, and none are kept */
+	poldiff_set_item_callback(d, count_streamed_item, &count);
+	CU_ASSERT(poldiff_run(d, POLDIFF_DIFF_AVRULES) == 0);
+	CU_ASSERT(poldiff_get_stats(diff, POLDIFF_DIFF_AVRULES, stats) == 0);
+	CU_ASSERT(poldiff_get_stats(d, POLDIFF_DIFF_AVRULES, streamed_stats) == 0);
+	for (i = 0; i < 5; i++) {
+		CU_ASSERT(stats[i] == streamed_stats[i]);
+		total += stats[i];
+	}
+	CU_ASSERT(count == total);
+	CU_ASSERT(apol_vector_get_size(poldiff_get_avrule_vector_allow(d)) == 0);
+
+	poldiff_destroy(&d);
+}
+
+/* begun and ended phases seen by the phase callback */
+typedef struct rules_phase_log
+{
+	size_t num_begun[POLDIFF_PHASE_MERGE + 1];
+	size_t num_ended[POLDIFF_PHASE_MERGE + 1];
+	/** phase now running, or -1 if none */
+	int current;
+} rules_phase_log_t;
+
+static void rules_log_phase(void *arg, const poldiff_t * d __attribute__ ((unused)), poldiff_phase_e phase, uint32_t which,
+			    int is_end)
+{
+	rules_phase_log_t *log = arg;
+	switch (phase) {
+	case POLDIFF_PHASE_RESET:
+	case POLDIFF_PHASE_ORIG_ITEMS:
+	case POLDIFF_PHASE_MOD_ITEMS:
+	case POLDIFF_PHASE_MERGE:
+		CU_ASSERT(which == POLDIFF_DIFF_AVALLOW || phase == POLDIFF_PHASE_RESET);
+		break;
+	default:
+		CU_ASSERT(which == 0);
+	}
+	/* phases do not nest, and each end matches its beginning */
+	if (is_end) {
+		CU_ASSERT(log->current == (int)phase);
+		log->num_ended[phase]++;
+		log->current = -1;
+	} else {
+		CU_ASSERT(log->current == -1);
+		log->num_begun[phase]++;
+		log->current = phase;
+	}
+}
+
+void rules_phase_tests()
+{
+	poldiff_t *d = NULL;
+	rules_phase_log_t log;
+	int phase;
+
+	memset(&log, 0, sizeof(log));
+	log.current = -1;
+	d = create_poldiff(RULES_ORIG_POLICY, RULES_MOD_POLICY);
+	CU_ASSERT_FATAL(d != NULL);
+	poldiff_set_phase_callback(d, rules_log_phase, &log);
+	CU_ASSERT_FATAL(poldiff_run(d, POLDIFF_DIFF_AVALLOW) == 0);
+	CU_ASSERT(log.current == -1);
+	for (phase = POLDIFF_PHASE_LOAD_ORIG; phase <= POLDIFF_PHASE_MERGE; phase++) {
+		CU_ASSERT(log.num_begun[phase] == log.num_ended[phase]);
+	}
+	/* the first run loads the rules and maps the types, then runs
+	 * the one component asked for */
+	CU_ASSERT(log.num_ended[POLDIFF_PHASE_LOAD_ORIG] == 1);
+	CU_ASSERT(log.num_ended[POLDIFF_PHASE_LOAD_MOD] == 1);
+	CU_ASSERT(log.num_ended[POLDIFF_PHASE_TYPE_MAP] == 1);
+	CU_ASSERT(log.num_ended[POLDIFF_PHASE_ORIG_ITEMS] == 1);
+	CU_ASSERT(log.num_ended[POLDIFF_PHASE_MOD_ITEMS] == 1);
+	CU_ASSERT(log.num_ended[POLDIFF_PHASE_MERGE] == 1);
+
+	/* a component already run is not run again */
+	memset(&log, 0, sizeof(log));
+	log.current = -1;
+	CU_ASSERT_FATAL(poldiff_run(d, POLDIFF_DIFF_AVALLOW) == 0);
+	for (phase = POLDIFF_PHASE_LOAD_ORIG; phase <= POLDIFF_PHASE_MERGE; phase++) {
+		CU_ASSERT(log.num_begun[phase] == 0);
+	}
+	poldiff_destroy(&d);
+}
+
+static void rules_count_orig_items(void *arg, const poldiff_t * d __attribute__ ((unused)), poldiff_phase_e phase,
+				   uint32_t which __attribute__ ((unused)), int is_end)
+{
+	size_t *count = arg;
+	if (phase == POLDIFF_PHASE_ORIG_ITEMS && !is_end) {
+		(*count)++;
+	}
+}
+
+void rules_avrules_baseline_tests()
+{
+	apol_policy_t *p2 = NULL;
+	poldiff_t *d = NULL;
+	size_t stats[5], baseline_stats[5], num_gathered, i;
+	int pass;
+
+	d = create_poldiff(RULES_ORIG_POLICY, RULES_MOD_POLICY);
+	CU_ASSERT_FATAL(d != NULL);
+	CU_ASSERT(poldiff_get_stats(diff, POLDIFF_DIFF_AVRULES | POLDIFF_DIFF_TERULES, stats) == 0);
+	poldiff_set_keep_baseline(d, 1);
+	poldiff_set_phase_callback(d, rules_count_orig_items, &num_gathered);
+
+	/* diffing against a fresh copy of the modified policy, with the
+	 * baseline kept loaded, gives the same results each time; the
+	 * copy maps the baseline's types as before, so the baseline's
+	 * rules are expanded only by the first run */
+	for (pass = 0; pass < 3; pass++) {
+		if (pass > 0) {
+			p2 = load_policy(RULES_MOD_POLICY);
+			CU_ASSERT_FATAL(p2 != NULL);
+			CU_ASSERT_FATAL(poldiff_set_mod_policy(d, p2) == 0);
+			CU_ASSERT(poldiff_is_run(d, POLDIFF_DIFF_AVRULES) == 0);
+		}
+		num_gathered = 0;
+		CU_ASSERT(poldiff_run(d, POLDIFF_DIFF_AVRULES | POLDIFF_DIFF_TERULES) == 0);
+		CU_ASSERT(num_gathered == (pass == 0 ? 7 : 0));
+		CU_ASSERT(poldiff_get_stats(d, POLDIFF_DIFF_AVRULES | POLDIFF_DIFF_TERULES, baseline_stats) == 0);
+		for (i = 0; i < 5; i++) {
+			CU_ASSERT(stats[i] == baseline_stats[i]);
+		}
+	}
+
+	/* without keeping, every run expands the baseline again */
+	poldiff_set_keep_baseline(d, 0);
+	p2 = load_policy(RULES_MOD_POLICY);
+	CU_ASSERT_FATAL(p2 != NULL);
+	CU_ASSERT_FATAL(poldiff_set_mod_policy(d, p2) == 0);
+	num_gathered = 0;
+	CU_ASSERT(poldiff_run(d, POLDIFF_DIFF_AVRULES | POLDIFF_DIFF_TERULES) == 0);
+	CU_ASSERT(num_gathered == 7);
+
+	poldiff_destroy(&d);
+}
+
+void rules_archive_tests()
+{
+	poldiff_t *d = NULL;
+	poldiff_archive_writer_t *w = NULL;
+	poldiff_archive_t *a = NULL;
+	const poldiff_archive_item_t *item;
+	uint32_t flags = POLDIFF_DIFF_AVRULES | POLDIFF_DIFF_TERULES | POLDIFF_DIFF_ROLE_ALLOWS;
+	size_t stats[5], archive_stats[5], total = 0, i;
+	FILE *fp;
+
+	d = create_poldiff(RULES_ORIG_POLICY, RULES_MOD_POLICY);
+	CU_ASSERT_FATAL(d != NULL);
+	fp = tmpfile();
+	CU_ASSERT_FATAL(fp != NULL);
+
+	/* write the archive while diffing, then load it back */
+	w = poldiff_archive_writer_create(d, fp);
+	CU_ASSERT_FATAL(w != NULL);
+	poldiff_set_item_callback(d, poldiff_archive_write_item, w);
+	CU_ASSERT(poldiff_run(d, flags) == 0);
+	CU_ASSERT(poldiff_archive_writer_close(&w) == 0);
+	rewind(fp);
+	a = poldiff_archive_read(fp);
+	CU_ASSERT_FATAL(a != NULL);
+
+	CU_ASSERT(poldiff_get_stats(diff, flags, stats) == 0);
+	poldiff_archive_get_stats(a, flags, archive_stats);
+	for (i = 0; i < 5; i++) {
+		CU_ASSERT(stats[i] == archive_stats[i]);
+		total += stats[i];
+	}
+	CU_ASSERT(poldiff_archive_get_num_items(a) == total);
+	for (i = 0; i < poldiff_archive_get_num_items(a); i++) {
+		item = poldiff_archive_get_item(a, i);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(item);
+		if (poldiff_archive_item_get_component(item) & POLDIFF_DIFF_AVRULES) {
+			CU_ASSERT(poldiff_archive_item_get_num_fields(item) == 5);
+			CU_ASSERT(poldiff_archive_item_get_num_perms(item) > 0);
+		} else if (poldiff_archive_item_get_component(item) & POLDIFF_DIFF_TERULES) {
+			CU_ASSERT(poldiff_archive_item_get_num_fields(item) == 7);
+			CU_ASSERT(poldiff_archive_item_get_num_perms(item) == 0);
+		} else {
+			CU_ASSERT(poldiff_archive_item_get_num_fields(item) == 1);
+		}
+	}
+
+	/* a truncated archive is rejected */
+	rewind(fp);
+	CU_ASSERT(ftruncate(fileno(fp), 12) == 0);
+	CU_ASSERT(poldiff_archive_read(fp) == NULL);
+
+	poldiff_archive_destroy(&a);
+	fclose(fp);
+	poldiff_destroy(&d);
+}
+
+void rules_nway_tests()
+{
+	apol_policy_t *base = NULL, *v0 = NULL, *v1 = NULL;
+	poldiff_nway_t *nway = NULL;
+	const apol_vector_t *entries;
+	const poldiff_nway_entry_t *entry;
+	size_t stats[5], total = 0, i;
+	int f;
+
+	base = load_policy(RULES_ORIG_POLICY);
+	v0 = load_policy(RULES_MOD_POLICY);
+	v1 = load_policy(RULES_ORIG_POLICY);
+	CU_ASSERT_FATAL(base != NULL && v0 != NULL && v1 != NULL);
+	nway = poldiff_nway_create(base, 2, NULL, NULL);
+	CU_ASSERT_FATAL(nway != NULL);
+
+	/* variant 0 is the modified policy; variant 1 is a copy of the
+	 * baseline, and so differs in nothing */
+	CU_ASSERT(poldiff_nway_add_variant(nway, v0, POLDIFF_DIFF_AVRULES) == 0);
+	CU_ASSERT(poldiff_nway_add_variant(nway, v1, POLDIFF_DIFF_AVRULES) == 1);
+	CU_ASSERT(poldiff_nway_get_num_variants(nway) == 2);
+
+	CU_ASSERT(poldiff_get_stats(diff, POLDIFF_DIFF_AVRULES, stats) == 0);
+	for (i = 0; i < 5; i++) {
+		total += stats[i];
+	}
+	entries = poldiff_nway_get_entries(nway);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(entries);
+	CU_ASSERT(apol_vector_get_size(entries) == total);
+	for (i = 0; i < apol_vector_get_size(entries); i++) {
+		size_t count = 0;
+		entry = apol_vector_get_element(entries, i);
+		CU_ASSERT(poldiff_nway_entry_get_component(entry) & POLDIFF_DIFF_AVRULES);
+		for (f = POLDIFF_FORM_ADDED; f <= POLDIFF_FORM_MODIFIED; f++) {
+			const apol_bitmap_t *b = poldiff_nway_entry_get_variants(entry, (poldiff_form_e) f);
+			CU_ASSERT_PTR_NOT_NULL_FATAL(b);
+			CU_ASSERT(apol_bitmap_get(b, 1) == 0);
+			count += apol_bitmap_count(b);
+		}
+		CU_ASSERT(count == 1);
+		CU_ASSERT(poldiff_nway_get_entry(nway, poldiff_nway_entry_get_component(entry),
+						 poldiff_nway_entry_get_key(entry)) == entry);
+	}
+	CU_ASSERT(poldiff_nway_get_entry(nway, POLDIFF_DIFF_AVALLOW, "no_such_type no_such_type : file") == NULL);
+
+	poldiff_nway_destroy(&nway);
+}
+
+/**
+ * Append to a string one line of numbers for each permission of
+ * each allow rule difference, from both policies.  Return the number
+ * of line numbers found, or -1 on error.
+ */
+static int rules_append_perm_lines(poldiff_t * d, char **s, size_t * len)
+{
+	const apol_vector_t *v = poldiff_get_avrule_vector_allow(d), *perms[3];
+	apol_vector_t *lines[2];
+	size_t i, j, k, l, m;
+	int found = 0;
+
+	if (v == NULL) {
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const poldiff_avrule_t *avrule = apol_vector_get_element(v, i);
+		char *rule = poldiff_avrule_to_string(d, avrule);
+		if (rule == NULL || apol_str_appendf(s, len, "%s\n", rule) < 0) {
+			free(rule);
+			return -1;
+		}
+		free(rule);
+		perms[0] = poldiff_avrule_get_unmodified_perms(avrule);
+		perms[1] = poldiff_avrule_get_added_perms(avrule);
+		perms[2] = poldiff_avrule_get_removed_perms(avrule);
+		for (j = 0; j < 3; j++) {
+			for (k = 0; k < apol_vector_get_size(perms[j]); k++) {
+				const char *perm = apol_vector_get_element(perms[j], k);
+				lines[0] = poldiff_avrule_get_orig_line_numbers_for_perm(d, avrule, perm);
+				lines[1] = poldiff_avrule_get_mod_line_numbers_for_perm(d, avrule, perm);
+				if (apol_str_appendf(s, len, "  %s:", perm) < 0) {
+					return -1;
+				}
+				for (l = 0; l < 2; l++) {
+					if (apol_str_append(s, len, (l == 0 ? " orig" : " mod")) < 0) {
+						return -1;
+					}
+					for (m = 0; m < apol_vector_get_size(lines[l]); m++) {
+						if (apol_str_appendf(s, len, " %lu", (unsigned long)apol_vector_get_element(lines[l], m)) < 0) {
+							return -1;
+						}
+						found++;
+					}
+					apol_vector_destroy(&lines[l]);
+				}
+				if (apol_str_append(s, len, "\n") < 0) {
+					return -1;
+				}
+			}
+		}
+	}
+	return found;
+}
+
+void rules_avrules_line_numbers_tests()
+{
+	poldiff_t *d = NULL;
+	char *before = NULL, *after = NULL;
+	size_t before_len = 0, after_len = 0;
+	int found;
+
+	d = create_poldiff(RULES_ORIG_POLICY, RULES_MOD_POLICY);
+	CU_ASSERT_FATAL(d != NULL);
+
+	CU_ASSERT_FATAL(poldiff_run(d, POLDIFF_DIFF_AVALLOW) == 0);
+	CU_ASSERT_FATAL(poldiff_enable_line_numbers(d) == 0);
+	found = rules_append_perm_lines(d, &before, &before_len);
+	CU_ASSERT(found > 0);
+
+	/* loading the neverallows rebuilds both policies, which resets
+	 * the AV rule components and drops their line number index */
+	CU_ASSERT_FATAL(poldiff_run(d, POLDIFF_DIFF_AVNEVERALLOW) == 0);
+	CU_ASSERT(poldiff_is_run(d, POLDIFF_DIFF_AVALLOW) == 0);
+	CU_ASSERT_FATAL(poldiff_run(d, POLDIFF_DIFF_AVALLOW) == 0);
+	CU_ASSERT_FATAL(poldiff_enable_line_numbers(d) == 0);
+	CU_ASSERT(rules_append_perm_lines(d, &after, &after_len) == found);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(before);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(after);
+	CU_ASSERT_STRING_EQUAL(before, after);
+
+	free(before);
+	free(after);
+	poldiff_destroy(&d);
+}
+
+/**
+ * Load a monolithic policy from source text, by way of a temporary
+ * file.
+ */
+static apol_policy_t *rules_policy_from_string(const char *text)
+{
+	char path[] = "/tmp/rules-tests-XXXXXX";
+	apol_policy_path_t *ppath = NULL;
+	apol_policy_t *p = NULL;
+	FILE *fp = NULL;
+	int fd;
+
+	if ((fd = mkstemp(path)) < 0) {
+		return NULL;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		goto cleanup;
+	}
+	if (fputs(text, fp) == EOF) {
+		fclose(fp);
+		goto cleanup;
+	}
+	if (fclose(fp) != 0) {
+		goto cleanup;
+	}
+	if ((ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, path, NULL)) != NULL) {
+		p = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL);
+	}
+      cleanup:
+	apol_policy_path_destroy(&ppath);
+	unlink(path);
+	return p;
+}
+
+/**
+ * Create a difference, not yet run, between two policies written as
+ * source text.
+ */
+static poldiff_t *rules_diff_from_strings(const char *orig_text, const char *mod_text)
+{
+	apol_policy_t *p1 = NULL, *p2 = NULL;
+	poldiff_t *d = NULL;
+
+	if ((p1 = rules_policy_from_string(orig_text)) == NULL || (p2 = rules_policy_from_string(mod_text)) == NULL ||
+	    (d = poldiff_create(p1, p2, NULL, NULL)) == NULL) {
+		apol_policy_destroy(&p1);
+		apol_policy_destroy(&p2);
+	}
+	return d;
+}
+
+/* web_t is renamed to httpd_t but keeps its four attributes and its
+ * role; old_t is replaced by new_t, and each has too few features to
+ * be compared */
+#define RENAMED_POLICY(web, old, old_attr) \
+	"class file\n" \
+	"sid kernel\n" \
+	"class file { read getattr }\n" \
+	"attribute attr_a;\n" \
+	"attribute attr_b;\n" \
+	"attribute attr_c;\n" \
+	"attribute attr_d;\n" \
+	"type kernel_t;\n" \
+	"type " web ", attr_a, attr_b, attr_c, attr_d;\n" \
+	"type " old ", " old_attr ";\n" \
+	"allow kernel_t " web " : file read;\n" \
+	"role system_r types { kernel_t " web " " old " };\n" \
+	"user system_u roles { system_r };\n" \
+	"sid kernel system_u:system_r:kernel_t\n"
+
+/**
+ * Check that a difference proposes exactly one remap, from one
+ * original type to one modified type, and nothing else.
+ */
+static void rules_check_one_proposal(poldiff_t * d, const char *orig_name, const char *mod_name)
+{
+	apol_vector_t *entries, *orig_names, *mod_names;
+	poldiff_type_remap_entry_t *entry, *proposed = NULL;
+	size_t i, num_proposed = 0;
+
+	entries = poldiff_type_remap_get_entries(d);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(entries);
+	for (i = 0; i < apol_vector_get_size(entries); i++) {
+		entry = apol_vector_get_element(entries, i);
+		CU_ASSERT(poldiff_type_remap_entry_get_is_inferred(entry));
+		if (!poldiff_type_remap_entry_get_is_enabled(entry)) {
+			proposed = entry;
+			num_proposed++;
+		}
+	}
+	CU_ASSERT_FATAL(num_proposed == 1);
+	orig_names = poldiff_type_remap_entry_get_original_types(d, proposed);
+	mod_names = poldiff_type_remap_entry_get_modified_types(d, proposed);
+	CU_ASSERT_FATAL(orig_names != NULL && mod_names != NULL);
+	CU_ASSERT(apol_vector_get_size(orig_names) == 1 && apol_vector_get_size(mod_names) == 1);
+	CU_ASSERT_STRING_EQUAL(apol_vector_get_element(orig_names, 0), orig_name);
+	CU_ASSERT_STRING_EQUAL(apol_vector_get_element(mod_names, 0), mod_name);
+	apol_vector_destroy(&orig_names);
+	apol_vector_destroy(&mod_names);
+}
+
+void rules_renamed_type_tests()
+{
+	poldiff_t *d = NULL;
+
+	d = rules_diff_from_strings(RENAMED_POLICY("web_t", "old_t", "attr_a"),
+				    RENAMED_POLICY("httpd_t", "new_t", "attr_b"));
+	CU_ASSERT_FATAL(d != NULL);
+	rules_check_one_proposal(d, "web_t", "httpd_t");
+	poldiff_destroy(&d);
+}
+
+/* web_t is renamed to httpd_t; it has only one attribute, and the
+ * allow rules reach it through that attribute rather than by name */
+#define RENAMED_ATTR_POLICY(web) \
+	"class file\n" \
+	"sid kernel\n" \
+	"class file { read getattr }\n" \
+	"attribute attr_a;\n" \
+	"type kernel_t;\n" \
+	"type " web ", attr_a;\n" \
+	"allow attr_a kernel_t : file read;\n" \
+	"allow kernel_t attr_a : file getattr;\n" \
+	"role system_r types { kernel_t " web " };\n" \
+	"user system_u roles { system_r };\n" \
+	"sid kernel system_u:system_r:kernel_t\n"
+
+void rules_renamed_type_attr_tests()
+{
+	poldiff_t *d = NULL;
+
+	d = rules_diff_from_strings(RENAMED_ATTR_POLICY("web_t"), RENAMED_ATTR_POLICY("httpd_t"));
+	CU_ASSERT_FATAL(d != NULL);
+	rules_check_one_proposal(d, "web_t", "httpd_t");
+	poldiff_destroy(&d);
+}
+
+/* file gains an append permission, which sorts before the others;
+ * the allow rule grants every permission of file in both policies */
+#define WILDCARD_POLICY(perms) \
+	"class file\n" \
+	"sid kernel\n" \
+	"class file { " perms " }\n" \
+	"type kernel_t;\n" \
+	"type file_t;\n" \
+	"allow kernel_t file_t : file *;\n" \
+	"dontaudit kernel_t file_t : file read;\n" \
+	"role system_r types { kernel_t file_t };\n" \
+	"user system_u roles { system_r };\n" \
+	"sid kernel system_u:system_r:kernel_t\n"
+
+void rules_wildcard_perm_tests()
+{
+	poldiff_t *d = NULL;
+	const apol_vector_t *v;
+	const poldiff_avrule_t *avrule;
+	const apol_vector_t *added, *removed, *unmodified;
+
+	d = rules_diff_from_strings(WILDCARD_POLICY("read getattr"),
+				    WILDCARD_POLICY("read getattr append"));
+	CU_ASSERT_FATAL(d != NULL);
+	CU_ASSERT_FATAL(poldiff_run(d, POLDIFF_DIFF_AVALLOW | POLDIFF_DIFF_AVDONTAUDIT) == 0);
+
+	/* the original rule's '*' did not already grant append */
+	v = poldiff_get_avrule_vector_allow(d);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == 1);
+	avrule = apol_vector_get_element(v, 0);
+	CU_ASSERT(poldiff_avrule_get_form(avrule) == POLDIFF_FORM_MODIFIED);
+	added = poldiff_avrule_get_added_perms(avrule);
+	removed = poldiff_avrule_get_removed_perms(avrule);
+	unmodified = poldiff_avrule_get_unmodified_perms(avrule);
+	CU_ASSERT_FATAL(apol_vector_get_size(added) == 1);
+	CU_ASSERT_STRING_EQUAL(apol_vector_get_element(added, 0), "append");
+	CU_ASSERT(apol_vector_get_size(removed) == 0);
+	CU_ASSERT(apol_vector_get_size(unmodified) == 2);
+
+	/* a dontaudit rule is stored with its bits flipped, which must
+	 * not name permissions past the class's last one either */
+	v = poldiff_get_avrule_vector_dontaudit(d);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(apol_vector_get_size(v) == 0);
+
+	poldiff_destroy(&d);
+}
+
+/* enough types that each policy has more allow and type_transition
+ * rules than the fewest that are diffed in shards */
+#define SHARDED_NUM_TYPES 72
+
+/**
+ * Generate a policy in which every type may read every type and has a
+ * type_transition to every type.  The modified policy grants getattr
+ * instead for some pairs, drops the allow rule for others, and
+ * changes the default type of some transitions.
+ */
+static char *rules_sharded_policy(int is_mod)
+{
+	char *text = NULL;
+	size_t sz = 0, i, j;
+
+	if (apol_str_append(&text, &sz, "class file\nsid kernel\nclass file { read getattr }\n") < 0) {
+		return NULL;
+	}
+	for (i = 0; i < SHARDED_NUM_TYPES; i++) {
+		if (apol_str_appendf(&text, &sz, "type t%zu;\n", i) < 0) {
+			return NULL;
+		}
+	}
+	for (i = 0; i < SHARDED_NUM_TYPES; i++) {
+		for (j = 0; j < SHARDED_NUM_TYPES; j++) {
+			if (!is_mod || (i * j) % 11 != 1) {
+				if (apol_str_appendf(&text, &sz, "allow t%zu t%zu : file %s;\n", i, j,
+						     is_mod && (i + j) % 7 == 0 ? "getattr" : "read") < 0) {
+					return NULL;
+				}
+			}
+			if (apol_str_appendf(&text, &sz, "type_transition t%zu t%zu : file t%zu;\n", i, j,
+					     (i + j + (is_mod && (i ^ j) % 5 == 0)) % SHARDED_NUM_TYPES) < 0) {
+				return NULL;
+			}
+		}
+	}
+	if (apol_str_append(&text, &sz, "role system_r types { ") < 0) {
+		return NULL;
+	}
+	for (i = 0; i < SHARDED_NUM_TYPES; i++) {
+		if (apol_str_appendf(&text, &sz, "t%zu ", i) < 0) {
+			return NULL;
+		}
+	}
+	if (apol_str_append(&text, &sz, "};\nuser system_u roles { system_r };\nsid kernel system_u:system_r:t0\n") < 0) {
+		return NULL;
+	}
+	return text;
+}
+
+/**
+ * Check that two runs found the same differences for one component,
+ * in the same order once retrieved.
+ */
+static void rules_check_same_results(poldiff_t * d1, poldiff_t * d2, uint32_t flag, const apol_vector_t * v1,
+				     const apol_vector_t * v2, char *(*to_string) (const poldiff_t *, const void *))
+{
+	size_t stats1[5], stats2[5], i;
+	char *s1, *s2;
+
+	CU_ASSERT_FATAL(poldiff_get_stats(d1, flag, stats1) == 0 && poldiff_get_stats(d2, flag, stats2) == 0);
+	CU_ASSERT(memcmp(stats1, stats2, sizeof(stats1)) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v1);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v2);
+	CU_ASSERT_FATAL(apol_vector_get_size(v1) == apol_vector_get_size(v2));
+	CU_ASSERT(apol_vector_get_size(v1) > 0);
+	for (i = 0; i < apol_vector_get_size(v1); i++) {
+		s1 = to_string(d1, apol_vector_get_element(v1, i));
+		s2 = to_string(d2, apol_vector_get_element(v2, i));
+		CU_ASSERT_FATAL(s1 != NULL && s2 != NULL);
+		CU_ASSERT_STRING_EQUAL(s1, s2);
+		free(s1);
+		free(s2);
+	}
+}
+
+void rules_sharded_tests()
+{
+	poldiff_t *d1 = NULL, *d4 = NULL;
+	char *orig_text, *mod_text;
+	uint32_t flags = POLDIFF_DIFF_AVALLOW | POLDIFF_DIFF_TETRANS;
+
+	orig_text = rules_sharded_policy(0);
+	mod_text = rules_sharded_policy(1);
+	CU_ASSERT_FATAL(orig_text != NULL && mod_text != NULL);
+	d1 = rules_diff_from_strings(orig_text, mod_text);
+	d4 = rules_diff_from_strings(orig_text, mod_text);
+	free(orig_text);
+	free(mod_text);
+	CU_ASSERT_FATAL(d1 != NULL && d4 != NULL);
+
+	poldiff_set_num_threads(d1, 1);
+	poldiff_set_num_threads(d4, 4);
+	CU_ASSERT_FATAL(poldiff_run(d1, flags) == 0);
+	CU_ASSERT_FATAL(poldiff_run(d4, flags) == 0);
+	rules_check_same_results(d1, d4, POLDIFF_DIFF_AVALLOW, poldiff_get_avrule_vector_allow(d1),
+				 poldiff_get_avrule_vector_allow(d4), poldiff_avrule_to_string);
+	rules_check_same_results(d1, d4, POLDIFF_DIFF_TETRANS, poldiff_get_terule_vector_trans(d1),
+				 poldiff_get_terule_vector_trans(d4), poldiff_terule_to_string);
+
+	poldiff_destroy(&d1);
+	poldiff_destroy(&d4);
+}
+
 int rules_test_init()
 {
 	if (!(diff = init_poldiff(RULES_ORIG_POLICY, RULES_MOD_POLICY))) {
@@ -28,9 +28,19 @@ int rules_test_init();
 int rules_test_cleanup();
 
 void rules_avrules_tests();
+void rules_avrules_stream_tests();
+void rules_avrules_baseline_tests();
+void rules_avrules_line_numbers_tests();
+void rules_archive_tests();
+void rules_nway_tests();
+void rules_phase_tests();
+void rules_renamed_type_tests();
+void rules_renamed_type_attr_tests();
 void rules_roleallow_tests();
 void rules_roletrans_tests();
+void rules_sharded_tests();
 void rules_terules_tests();
+void rules_wildcard_perm_tests();
 
 void build_avrule_vecs();
 void build_terule_vecs();
@@ -114,6 +114,20 @@ extern "C"
  */
 	extern int qpol_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_avrule_t * rule, qpol_iterator_t ** perms);
 
+/**
+ *  Get the permissions in an av rule as a bit mask.  Bit (n - 1) is
+ *  set if the permission whose value is n (see
+ *  qpol_class_get_perm_value()) is part of the rule.  Only bits for
+ *  the permissions that the rule's class defines are ever set.  This
+ *  avoids the string conversions done by qpol_avrule_get_perm_iter().
+ *  @param policy Policy from which the rule comes.
+ *  @param rule The rule from which to get the permissions.
+ *  @param mask Integer in which to store the permission mask.
+ *  @returm 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *mask will be 0.
+ */
+	extern int qpol_avrule_get_perm_mask(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * mask);
+
 /**
  *  Get the rule type value for an av rule.
  *  @param policy Policy from which the rule comes.
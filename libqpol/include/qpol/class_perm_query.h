@@ -105,6 +105,23 @@ extern "C"
  */
 	extern int qpol_class_get_value(const qpol_policy_t * policy, const qpol_class_t * obj_class, uint32_t * value);
 
+/**
+ *  Get the integer value of a permission within a class, searching
+ *  the permissions inherited from the class's common as well.  The
+ *  permission occupies bit (value - 1) of the access vectors returned
+ *  by qpol_avrule_get_perm_mask().
+ *  @param policy The policy with which the class is associated.
+ *  @param obj_class Class in which to look up the permission. Must be non-NULL.
+ *  @param perm Name of the permission. Must be non-NULL.
+ *  @param value Pointer to the integer to be set to the value. If the
+ *  class has no such permission *value will be set to 0 and the call
+ *  is considered successful.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *value will be 0.
+ */
+	extern int qpol_class_get_perm_value(const qpol_policy_t * policy, const qpol_class_t * obj_class, const char *perm,
+					     uint32_t * value);
+
 /** 
  *  Get the common used by a class.
  *  @param policy The policy with which the class is associated. 
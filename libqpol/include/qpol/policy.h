@@ -229,6 +229,19 @@ extern "C"
  */
 	extern int qpol_policy_rebuild(qpol_policy_t * policy, const int options);
 
+/**
+ *  Get the policy's generation number.  It starts at zero and is
+ *  incremented each time qpol_policy_rebuild() replaces the policy's
+ *  contents, which invalidates every qpol object previously obtained
+ *  from it.  Callers that cache such objects can compare generations
+ *  to know when their caches must be rebuilt.
+ *  @param policy The policy to query.
+ *  @param generation Pointer to set to the generation number.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *generation will be 0.
+ */
+	extern int qpol_policy_get_generation(const qpol_policy_t * policy, unsigned long *generation);
+
 /**
  *  Get an iterator of all modules in a policy.
  *  @param policy The policy from which to get the iterator.
@@ -194,6 +194,39 @@ int qpol_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_avrule_t
 	return STATUS_SUCCESS;
 }
 
+int qpol_avrule_get_perm_mask(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * mask)
+{
+	policydb_t *db = NULL;
+	avtab_ptr_t avrule = NULL;
+	uint32_t nprim;
+
+	if (mask) {
+		*mask = 0;
+	}
+
+	if (!policy || !rule || !mask) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+
+	db = &policy->p->p;
+	avrule = (avtab_ptr_t) rule;
+	if (avrule->key.specified & QPOL_RULE_DONTAUDIT) {
+		*mask = ~(avrule->datum.data);	/* stored as auditdeny flip the bits */
+	} else {
+		*mask = avrule->datum.data;
+	}
+	/* '*', '~' and dontaudit rules set bits past the class's last
+	 * permission; drop them, as the permission iterator does */
+	nprim = db->class_val_to_struct[avrule->key.target_class - 1]->permissions.nprim;
+	if (nprim < 32) {
+		*mask &= (1U << nprim) - 1;
+	}
+
+	return STATUS_SUCCESS;
+}
+
 int qpol_avrule_get_rule_type(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * rule_type)
 {
 	policydb_t *db = NULL;
@@ -901,6 +901,7 @@ int qpol_policy_rebuild_opt(qpol_policy_t * policy, const int options)
 	qpol_extended_image_destroy(&ext);
 
 	sepol_policydb_free(old_p);
+	policy->generation++;
 
 	return STATUS_SUCCESS;
 
@@ -1505,6 +1506,22 @@ int qpol_policy_get_policy_version(const qpol_policy_t * policy, unsigned int *v
 	return STATUS_SUCCESS;
 }
 
+int qpol_policy_get_generation(const qpol_policy_t * policy, unsigned long *generation)
+{
+	if (generation != NULL)
+		*generation = 0;
+
+	if (policy == NULL || generation == NULL) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+
+	*generation = policy->generation;
+
+	return STATUS_SUCCESS;
+}
+
 int qpol_policy_get_policy_handle_unknown(const qpol_policy_t * policy, unsigned int *handle_unknown)
 {
 	policydb_t *db;
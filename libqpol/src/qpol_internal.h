@@ -71,6 +71,8 @@ extern "C"
 		char *file_data;
 		size_t file_data_sz;
 		int file_data_type;
+		/** incremented each time the policydb is replaced */
+		unsigned long generation;
 	};
 /* qpol_policy_t.file_data_type will be one of the following to denote
  * the proper method of destroying the data:
@@ -189,7 +189,6 @@ int attribs_wo_types_run(sechk_module_t * mod, apol_policy_t * policy, void *arg
 	sechk_proof_t *proof = NULL;
 	size_t i;
 	apol_vector_t *attr_vector = NULL;
-	qpol_iterator_t *types = NULL;
 	qpol_policy_t *q = apol_policy_get_qpol(policy);
 	int error = 0;
 
@@ -231,14 +230,15 @@ int attribs_wo_types_run(sechk_module_t * mod, apol_policy_t * policy, void *arg
 	for (i = 0; i < apol_vector_get_size(attr_vector); i++) {
 		qpol_type_t *attr;
 		const char *attr_name;
-		int at_end;
+		const apol_bitmap_t *attr_types;
 
 		attr = apol_vector_get_element(attr_vector, i);
 		qpol_type_get_name(q, attr, &attr_name);
-		qpol_type_get_type_iter(q, attr, &types);
-		at_end = qpol_iterator_end(types);
-		qpol_iterator_destroy(&types);
-		if (!at_end)
+		if ((attr_types = apol_type_get_expansion_bitmap(policy, attr)) == NULL) {
+			error = errno;
+			goto attribs_wo_types_run_fail;
+		}
+		if (apol_bitmap_count(attr_types) > 0)
 			continue;
 
 		proof = sechk_proof_new(NULL);
@@ -276,7 +276,6 @@ int attribs_wo_types_run(sechk_module_t * mod, apol_policy_t * policy, void *arg
 			goto attribs_wo_types_run_fail;
 		}
 	}
-	qpol_iterator_destroy(&types);
 	apol_vector_destroy(&attr_vector);
 
 	mod->result = res;
@@ -332,7 +332,8 @@ static void print_av_results(const apol_policy_t * policy, const options_t * opt
 	qpol_policy_t *q = apol_policy_get_qpol(policy);
 	size_t i, num_rules = 0;
 	const qpol_avrule_t *rule = NULL;
-	char *tmp = NULL, *rule_str = NULL, *expr = NULL;
+	char *tmp = NULL, *expr = NULL;
+	apol_render_buf_t *out = NULL;
 	char enable_char = ' ', branch_char = ' ';
 	qpol_iterator_t *iter = NULL;
 	const qpol_cond_t *cond = NULL;
@@ -345,6 +346,8 @@ static void print_av_results(const apol_policy_t * policy, const options_t * opt
 		return;
 
 	fprintf(stdout, "Found %zd semantic av rules:\n", num_rules);
+	if (!(out = apol_render_buf_create_file(stdout)))
+		goto cleanup;
 
 	for (i = 0; i < num_rules; i++) {
 		enable_char = branch_char = ' ';
@@ -372,18 +375,16 @@ static void print_av_results(const apol_policy_t * policy, const options_t * opt
 					goto cleanup;
 			}
 		}
-		if (!(rule_str = apol_avrule_render(policy, rule)))
+		if (apol_render_buf_appendf(out, "%c%c ", enable_char, branch_char) ||
+		    apol_avrule_render_buf(policy, rule, out) || apol_render_buf_appendf(out, " %s\n", expr ? expr : ""))
 			goto cleanup;
-		fprintf(stdout, "%c%c %s %s\n", enable_char, branch_char, rule_str, expr ? expr : "");
-		free(rule_str);
-		rule_str = NULL;
 		free(expr);
 		expr = NULL;
 	}
 
       cleanup:
+	apol_render_buf_destroy(&out);
 	free(tmp);
-	free(rule_str);
 	free(expr);
 }
 
@@ -535,7 +536,8 @@ static void print_te_results(const apol_policy_t * policy, const options_t * opt
 	qpol_policy_t *q = apol_policy_get_qpol(policy);
 	size_t i, num_rules = 0;
 	const qpol_terule_t *rule = NULL;
-	char *tmp = NULL, *rule_str = NULL, *expr = NULL;
+	char *tmp = NULL, *expr = NULL;
+	apol_render_buf_t *out = NULL;
 	char enable_char = ' ', branch_char = ' ';
 	qpol_iterator_t *iter = NULL;
 	const qpol_cond_t *cond = NULL;
@@ -548,6 +550,8 @@ static void print_te_results(const apol_policy_t * policy, const options_t * opt
 		goto cleanup;
 
 	fprintf(stdout, "Found %zd semantic te rules:\n", num_rules);
+	if (!(out = apol_render_buf_create_file(stdout)))
+		goto cleanup;
 
 	for (i = 0; i < num_rules; i++) {
 		enable_char = branch_char = ' ';
@@ -577,18 +581,16 @@ static void print_te_results(const apol_policy_t * policy, const options_t * opt
 					goto cleanup;
 			}
 		}
-		if (!(rule_str = apol_terule_render(policy, rule)))
+		if (apol_render_buf_appendf(out, "%c%c ", enable_char, branch_char) ||
+		    apol_terule_render_buf(policy, rule, out) || apol_render_buf_appendf(out, " %s\n", expr ? expr : ""))
 			goto cleanup;
-		fprintf(stdout, "%c%c %s %s\n", enable_char, branch_char, rule_str, expr ? expr : "");
-		free(rule_str);
-		rule_str = NULL;
 		free(expr);
 		expr = NULL;
 	}
 
       cleanup:
+	apol_render_buf_destroy(&out);
 	free(tmp);
-	free(rule_str);
 	free(expr);
 }
 
@@ -960,10 +962,39 @@ static void print_range_results(const apol_policy_t * policy, const options_t *
 	}
 }
 
+/* one kind of rule that sesearch can search for, in the order that
+ * the kinds are searched and printed.  The kinds are searched one at
+ * a time, not with apol_parallel_run().  Each query fills in the
+ * policy's symbol catalog as it runs: the catalog builds its type
+ * bitmaps on first use, and its regex cache bumps a shared clock on
+ * every hit and frees the least recently used matches on a miss,
+ * which may be the very bitmap another query is still reading.
+ * perform_av_query() also splits the permission list with strtok()
+ * and appends to opt->perm_vector.  Instead, each kind's results are
+ * printed and flushed as soon as it finishes. */
+typedef struct search_kind
+{
+	int (*perform) (const apol_policy_t * policy, const options_t * opt, apol_vector_t ** v);
+	void (*print) (const apol_policy_t * policy, const options_t * opt, const apol_vector_t * v);
+	/** how to print syntactic results, or NULL if this kind is
+	 *  always searched semantically */
+	void (*print_syn) (const apol_policy_t * policy, const options_t * opt, const apol_vector_t * v);
+} search_kind_t;
+
+static const search_kind_t search_kinds[] = {
+	{perform_av_query, print_av_results, print_syn_av_results},
+	{perform_te_query, print_te_results, print_syn_te_results},
+	{perform_ft_query, print_ft_results, NULL},
+	{perform_ra_query, print_ra_results, NULL},
+	{perform_rt_query, print_rt_results, NULL},
+	{perform_range_query, print_range_results, NULL}
+};
+
 int main(int argc, char **argv)
 {
 	options_t cmd_opts;
 	int optc, rt = -1;
+	size_t i;
 
 	apol_policy_t *policy = NULL;
 	apol_vector_t *v = NULL;
@@ -1249,68 +1280,24 @@ int main(int argc, char **argv)
 		cmd_opts.lineno = 0;
 	}
 
-	if (perform_av_query(policy, &cmd_opts, &v)) {
-		rt = 1;
-		goto cleanup;
-	}
-	if (v) {
-		if (!cmd_opts.semantic && qpol_policy_has_capability(apol_policy_get_qpol(policy), QPOL_CAP_SYN_RULES))
-			print_syn_av_results(policy, &cmd_opts, v);
-		else
-			print_av_results(policy, &cmd_opts, v);
-		fprintf(stdout, "\n");
-	}
-	apol_vector_destroy(&v);
-	if (perform_te_query(policy, &cmd_opts, &v)) {
-		rt = 1;
-		goto cleanup;
-	}
-	if (v) {
-		if (!cmd_opts.semantic && qpol_policy_has_capability(apol_policy_get_qpol(policy), QPOL_CAP_SYN_RULES))
-			print_syn_te_results(policy, &cmd_opts, v);
-		else
-			print_te_results(policy, &cmd_opts, v);
-		fprintf(stdout, "\n");
-	}
-
-	apol_vector_destroy(&v);
-	if (perform_ft_query(policy, &cmd_opts, &v)) {
-		rt = 1;
-		goto cleanup;
-	}
-	if (v) {
-		print_ft_results(policy, &cmd_opts, v);
-		fprintf(stdout, "\n");
-	}
-
-	apol_vector_destroy(&v);
-	if (perform_ra_query(policy, &cmd_opts, &v)) {
-		rt = 1;
-		goto cleanup;
-	}
-	if (v) {
-		print_ra_results(policy, &cmd_opts, v);
-		fprintf(stdout, "\n");
-	}
-	apol_vector_destroy(&v);
-	if (perform_rt_query(policy, &cmd_opts, &v)) {
-		rt = 1;
-		goto cleanup;
-	}
-	if (v) {
-		print_rt_results(policy, &cmd_opts, v);
-		fprintf(stdout, "\n");
-	}
-	apol_vector_destroy(&v);
-	if (perform_range_query(policy, &cmd_opts, &v)) {
-		rt = 1;
-		goto cleanup;
-	}
-	if (v) {
-		print_range_results(policy, &cmd_opts, v);
-		fprintf(stdout, "\n");
+	for (i = 0; i < sizeof(search_kinds) / sizeof(search_kinds[0]); i++) {
+		const search_kind_t *kind = search_kinds + i;
+		if (kind->perform(policy, &cmd_opts, &v)) {
+			rt = 1;
+			goto cleanup;
+		}
+		if (v) {
+			if (kind->print_syn != NULL && !cmd_opts.semantic)
+				kind->print_syn(policy, &cmd_opts, v);
+			else
+				kind->print(policy, &cmd_opts, v);
+			fprintf(stdout, "\n");
+			/* let a consumer start on these results while
+			 * the next kind is searched */
+			fflush(stdout);
+		}
+		apol_vector_destroy(&v);
 	}
-	apol_vector_destroy(&v);
 	rt = 0;
       cleanup:
 	apol_policy_destroy(&policy);